@@ -22,10 +22,7 @@
 
 #include "dataIO_transportContainer.h"
 
-// XML Parser
-#include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <util_config.h>
 
 
 namespace osgVisual
@@ -64,14 +61,25 @@ public:
 	/**
 	 * \brief Pure virtual function for initialization. Must be implemented in derived class.
 	 * 
+	 * @param configurationNode : cluster element of the dataIO configuration, NULL if not configured.
 	 */ 
- 	virtual bool init( xmlNode* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_) = 0;
+ 	virtual bool init( const util_config::node* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_) = 0;
 
 	/**
 	 * \brief Pure virtual function for XML configuration. Must be implemented in derived class.
 	 * 
 	 */ 
-	virtual bool processXMLConfiguration(xmlNode* clusterConfig_) = 0;
+	virtual bool processXMLConfiguration(const util_config::node* clusterConfig_) = 0;
+
+	/**
+	 * \brief This function establishes the connection to the master. It is called after init() and may block, e.g. while retrying to connect.
+	 * 
+	 * It does not access the viewer or the scene graph, therefore it can be executed in a background thread during startup.
+	 * Implementations without a blocking connection setup keep this default implementation.
+	 * 
+	 * @return : True if connected or no connection is required.
+	 */ 
+	virtual bool connect() {return true;};
 	
 	/**
 	 * \brief Acess function to retrieve whether hardSync is enabled.
@@ -113,6 +121,9 @@ public:
 	/**
 	 * \brief Pure virtual function for reporting slave as ready to swap. Must be implemented in derived class.
 	 * 
+	 * The swap barrier functions (reportAsReadyToSwap(), waitForSwap(), waitForAllReadyToSwap(), sendSwapCommand()) are called by the draw thread
+	 * while the main thread may call sendTO_OBJvaluesToSlaves() or readTO_OBJvaluesFromMaster() for the next frame. visual_dataIO does not
+	 * serialize both groups, so an implementation has to protect state shared by them itself.
 	 */ 
 	virtual void reportAsReadyToSwap() = 0;
 
@@ -37,8 +37,8 @@ public:
 	dataIO_clusterDummy();
 	virtual ~dataIO_clusterDummy(void);
 
-	bool init(xmlNode* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_);
-	bool processXMLConfiguration(xmlNode* clusterConfig_);
+	bool init(const util_config::node* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_);
+	bool processXMLConfiguration(const util_config::node* clusterConfig_);
 	void shutdown();
 
 	void init();
@@ -43,8 +43,9 @@ public:
 	dataIO_clusterENet();
 	virtual ~dataIO_clusterENet(void);
 
-	bool init(xmlNode* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_);
-	bool processXMLConfiguration(xmlNode* clusterConfig_);
+	bool init(const util_config::node* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_);
+	bool processXMLConfiguration(const util_config::node* clusterConfig_);
+	bool connect();
 	void shutdown();
 
 	void init();
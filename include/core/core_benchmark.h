@@ -0,0 +1,232 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+#include <osg/ArgumentParser>
+#include <osg/AnimationPath>
+#include <osg/GraphicsContext>
+#include <osg/Viewport>
+#include <osg/Timer>
+
+#include <osgViewer/Viewer>
+
+#include <visual_dataIO.h>
+#include <util_frameTimeStatistics.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class implements the headless and the deterministic benchmark mode of visual_core.
+ *
+ * Headless mode (--headless) renders into an offscreen pbuffer instead of a window, which also works with software OpenGL implementations.
+ *
+ * Benchmark mode (--benchmark <path file>) replays a run with fixed inputs:
+ * - The simulation time advances by a fixed time step per frame, independent of the wall clock.
+ * - The camera follows a recorded animation path (e.g. bin/*.path) at the simulation time.
+ * - TO_OBJ slot values are replayed from a recorded CSV file (--benchmark-data), see loadSlotData().
+ * - The run ends after a fixed number of frames.
+ * On exit the frame time percentiles are printed. Terrain and model paging is still asynchronous, so warmup frames can be excluded from the statistics.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class core_benchmark : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	core_benchmark();
+
+	/**
+	 * \brief This function reads the headless and benchmark options from the command line and loads the recorded inputs.
+	 *
+	 * @param arguments_ : Command line arguments.
+	 * @return : True if headless or benchmark mode is requested.
+	 */
+	bool init( osg::ArgumentParser& arguments_ );
+
+	/**
+	 * \brief This function adds the command line options to the application usage.
+	 *
+	 * @param usage_ : Application usage to add the options to.
+	 */
+	static void addUsage( osg::ApplicationUsage* usage_ );
+
+	/**
+	 * \brief This function configures the viewer: offscreen context in headless mode, single threaded rendering and no camera manipulator in benchmark mode.
+	 *
+	 * Call it before the viewer is realized. In benchmark mode, call it again after the camera manipulators are installed to remove them.
+	 *
+	 * @param viewer_ : Viewer to configure.
+	 * @return : True if successful.
+	 */
+	bool setupViewer( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function returns if the benchmark mode is active.
+	 *
+	 * @return : True if active.
+	 */
+	bool isBenchmark() {return benchmark;};
+
+	/**
+	 * \brief This function returns if the headless mode is active.
+	 *
+	 * @return : True if active.
+	 */
+	bool isHeadless() {return headless;};
+
+	/**
+	 * \brief This function returns if all benchmark frames are rendered.
+	 *
+	 * @return : True if the benchmark is finished.
+	 */
+	bool isFinished() {return benchmark && frameNumber >= numFrames;};
+
+	/**
+	 * \brief This function returns the simulation time of the actual frame.
+	 *
+	 * @return : Simulation time in s.
+	 */
+	double getSimulationTime() {return frameNumber * timeStep;};
+
+	/**
+	 * \brief This function starts the measurement of a frame and applies the recorded inputs: camera view and TO_OBJ slot values.
+	 *
+	 * Call it after viewer->advance() and before the event traversal.
+	 *
+	 * @param viewer_ : Viewer to apply the camera view to.
+	 */
+	void beginFrame( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function waits until the frame is rendered completely and records its duration.
+	 *
+	 * @param viewer_ : Viewer which rendered the frame.
+	 */
+	void endFrame( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function prints the frame time statistics and writes the per frame report, if configured.
+	 *
+	 */
+	void report();
+
+private:
+	/**
+	 * \brief This function loads the recorded TO_OBJ slot values.
+	 *
+	 * The file is a CSV file with a header line: "time,<slot name>,<slot name>,..". Each following line contains the simulation time in s
+	 * and the slot values at this time. A line is applied from its time until the time of the next line. Numerical values are set as
+	 * DOUBLE slots, all others as STRING slots. Empty values leave the slot unchanged.
+	 *
+	 * @param filename_ : CSV file to load.
+	 * @return : True if successful.
+	 */
+	bool loadSlotData( const std::string& filename_ );
+
+	/**
+	 * \brief This function sets the TO_OBJ slot values which are valid at the actual simulation time.
+	 *
+	 */
+	void applySlotData();
+
+	/**
+	 * Flag if the headless mode is active.
+	 */
+	bool headless;
+
+	/**
+	 * Flag if the benchmark mode is active.
+	 */
+	bool benchmark;
+
+	/**
+	 * Size of the offscreen buffer in headless mode.
+	 */
+	unsigned int width, height;
+
+	/**
+	 * Simulation time step per frame in s.
+	 */
+	double timeStep;
+
+	/**
+	 * Number of frames to render.
+	 */
+	unsigned int numFrames;
+
+	/**
+	 * Number of frames at the beginning which are not included in the statistics.
+	 */
+	unsigned int numWarmupFrames;
+
+	/**
+	 * Number of the actual benchmark frame.
+	 */
+	unsigned int frameNumber;
+
+	/**
+	 * Camera path, NULL if the camera is not driven by the benchmark.
+	 */
+	osg::ref_ptr<osg::AnimationPath> cameraPath;
+
+	/**
+	 * Names of the replayed slots.
+	 */
+	std::vector<std::string> slotNames;
+
+	/**
+	 * Simulation times of the recorded slot values.
+	 */
+	std::vector<double> slotTimes;
+
+	/**
+	 * Recorded slot values, one vector per line of the recording.
+	 */
+	std::vector< std::vector<std::string> > slotValues;
+
+	/**
+	 * Next line of the recording to apply.
+	 */
+	unsigned int nextSlotLine;
+
+	/**
+	 * File to write the frame times to, empty if not requested.
+	 */
+	std::string reportFilename;
+
+	/**
+	 * Start of the actual frame.
+	 */
+	osg::Timer_t frameStartTick;
+
+	/**
+	 * Collected frame times.
+	 */
+	osg::ref_ptr<util_frameTimeStatistics> statistics;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,180 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+#include <osg/Timer>
+
+#include <osgViewer/Viewer>
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <string>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class reduces the scene detail automatically if the frames take longer than the configured frame time.
+ *
+ * The frame time is measured with the wall clock and smoothed by an exponential moving average. If the smoothed frame time exceeds
+ * the target frame time, the detail level is raised by one step. If there is headroom, it is lowered again. As a synchronized buffer swap
+ * hides the headroom (the frame time never drops below the refresh period), a lower level is also probed after some time at the target.
+ * A probe which overloads again doubles the time until the next probe.
+ *
+ * The detail level controls, with increasing level:
+ * - Level 1 and above: the LOD scale of the main camera rises up to maxlodscale, and the incremental compile operation compiles less objects per frame,
+ *   which limits the page-in rate of the DatabasePager.
+ * - Level 2 and above: object_groundClamper queries the terrain only every 2nd, 4th, .. frame.
+ * - Level 3 and above: the object labels are hidden.
+ *
+ * Each change of the level is logged. The level is written into the viewer stats as "Detail level".
+ *
+ * It is configured in the XML configuration:
+ * <module name="detailgovernor" enabled="yes"><detailgovernor targetframetime="15.0" maxlevel="4" maxlodscale="2.5"></detailgovernor></module>
+ * To keep the projectors at their refresh rate, choose a target frame time slightly below the refresh period.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class core_detailGovernor : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	core_detailGovernor();
+
+	/**
+	 * \brief This function reads the configuration and prepares the viewer. Call it before the viewer is realized.
+	 *
+	 * @param viewer_ : Viewer to govern.
+	 * @return : True if the governor is configured and enabled.
+	 */
+	bool init( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function processes the elapsed frame and adjusts the detail level. Call it once per frame after the rendering traversals.
+	 *
+	 * @param viewer_ : Viewer which rendered the frame.
+	 */
+	void update( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function restores the full detail.
+	 *
+	 * @param viewer_ : Governed viewer.
+	 */
+	void shutdown( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function returns the actual detail level.
+	 *
+	 * @return : Detail level, 0 means full detail.
+	 */
+	unsigned int getLevel() {return level;};
+
+	/**
+	 * \brief This function returns the smoothed frame time.
+	 *
+	 * @return : Smoothed frame time in ms, 0 before the first update.
+	 */
+	double getSmoothedFrameTime() {return smoothedFrameTime;};
+
+private:
+	/**
+	 * \brief This function changes the detail level and applies it to the viewer and the modules.
+	 *
+	 * @param viewer_ : Governed viewer.
+	 * @param level_ : New detail level.
+	 * @param reason_ : Reason of the change for the log.
+	 */
+	void setLevel( osgViewer::Viewer* viewer_, unsigned int level_, const char* reason_ );
+
+	/**
+	 * Frame time to achieve in ms.
+	 */
+	double targetFrameTime;
+
+	/**
+	 * Highest detail level.
+	 */
+	unsigned int maxLevel;
+
+	/**
+	 * LOD scale factor at the highest detail level.
+	 */
+	double maxLODScale;
+
+	/**
+	 * Actual detail level.
+	 */
+	unsigned int level;
+
+	/**
+	 * LOD scale of the main camera at full detail. Changes by the user (LODScaleHandler) are adopted.
+	 */
+	double baseLODScale;
+
+	/**
+	 * LOD scale which was set by the governor.
+	 */
+	double appliedLODScale;
+
+	/**
+	 * Objects compiled per frame by the incremental compile operation at full detail.
+	 */
+	unsigned int baseObjectsToCompile;
+
+	/**
+	 * Smoothed frame time in ms.
+	 */
+	double smoothedFrameTime;
+
+	/**
+	 * Weight of the latest frame time in the moving average.
+	 */
+	double smoothing;
+
+	/**
+	 * Start of the elapsed frame.
+	 */
+	osg::Timer_t lastTick;
+
+	/**
+	 * Time of the last level change in s.
+	 */
+	double lastChangeTime;
+
+	/**
+	 * Time at the target frame time in s until a lower level is probed.
+	 */
+	double probeInterval;
+
+	/**
+	 * Flag if the last change was a probe, an overload right after it doubles the probe interval.
+	 */
+	bool probing;
+
+	/**
+	 * Number of processed frames.
+	 */
+	unsigned int numFrames;
+};
+
+}	// END NAMESPACE
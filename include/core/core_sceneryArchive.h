@@ -0,0 +1,401 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Node>
+#include <osg/OperationThread>
+#include <osg/Notify>
+
+#include <visual_object.h>
+#include <util_mappedFile.h>
+#include <util_config.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class reads a compiled scenery archive, which replaces the parsing of the scenery configuration and the loading of the models at startup.
+ *
+ * The archive is compiled by osgVisualSceneryCompiler from the <scenery> section of the XML configuration. It contains the object table,
+ * the geometry of each referenced model file once, optimized and stored as .osgb, and the date, visibility, cloud and wind layer parameters.
+ * It is mapped into memory with one util_mappedFile. The geometries are deserialized in parallel by loadOperations, objects which use
+ * the same model file share its geometry.
+ *
+ * The archive is stale if the scenery section of the configuration, one of the model files or one of the images and external references
+ * embedded into their geometries was changed after compilation: The archive contains a hash of the scenery section and the modification
+ * time and size of each of these files. A stale archive is rejected by open(), osgVisual then sets up the scenery from the XML configuration
+ * as without archive.
+ *
+ * The file is in host byte order:
+ * - fileHeader
+ * - sourceRecord for each model file
+ * - dependencyRecord for each file referenced by the model files
+ * - objectRecord for each object, followed by the footprint points of all objects as 3 doubles each
+ * - cloudLayerRecord for each cloud layer, windLayerRecord for each wind layer
+ * - String table, referenced by stringRefs
+ * - The .osgb data of each geometry, each aligned to 8 bytes
+ *
+ * It is configured in the scenery section of the XML configuration:
+ * <scenery>
+ *   <sceneryarchive filename="scenery.ovsc"></sceneryarchive>
+ * </scenery>
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class core_sceneryArchive : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * Version of the file format.
+	 */
+	static const unsigned int FILE_VERSION = 2;
+
+	/**
+	 * \brief This struct contains the parameters of a cloud layer as specified by a <cloudlayer> node.
+	 *
+	 * Parameters which are not specified are -1. type is the name of the cloud type, see visual_skySilverLining::getCloudTypeByName().
+	 */
+	struct cloudLayer
+	{
+		cloudLayer() : slot(-1), baseLength(-1), baseWidth(-1), thickness(-1), baseHeight(-1), density(-1.0),
+			rate_mmPerHour_rain(-1.0), rate_mmPerHour_drySnow(-1.0), rate_mmPerHour_wetSnow(-1.0), rate_mmPerHour_sleet(-1.0) {};
+
+		int slot, baseLength, baseWidth, thickness, baseHeight;
+		double density;
+		std::string type;
+		double rate_mmPerHour_rain, rate_mmPerHour_drySnow, rate_mmPerHour_wetSnow, rate_mmPerHour_sleet;
+	};
+
+	/**
+	 * \brief This struct contains the parameters of a wind layer as specified by a <windlayer> node.
+	 *
+	 */
+	struct windLayer
+	{
+		windLayer() : bottom(0.0), top(5000.0), speed(25.0), direction(0.0) {};
+
+		double bottom, top, speed, direction;
+	};
+
+	/**
+	 * \brief This struct contains the environment of the scenery: date, time, visibility, clouds and wind.
+	 *
+	 */
+	struct environment
+	{
+		environment() : dateTime(false), day(-1), month(-1), year(-1), hour(-1), minute(-1), visibility(false), range(50000.0), turbidity(2.2) {};
+
+		bool dateTime;			// Flag if a <datetime> node is specified
+		int day, month, year, hour, minute;
+		bool visibility;		// Flag if a <visibility> node is specified
+		double range, turbidity;
+		std::vector<cloudLayer> cloudLayers;
+		std::vector<windLayer> windLayers;
+	};
+
+	/**
+	 * \brief This struct contains the content of the scenery section which is compiled into the archive.
+	 *
+	 */
+	struct scenery
+	{
+		scenery() : trackModel(false), trackingID(-1) {};
+
+		std::vector<visual_object::objectConfig> objects;
+		bool trackModel;		// Flag if a <trackmodel> node is specified
+		int trackingID;
+		std::string trackingIdUpdaterSlot;
+		environment env;
+	};
+
+	/**
+	 * \brief Reference to a string in the string table.
+	 *
+	 */
+	struct stringRef
+	{
+		unsigned int offset;
+		unsigned int length;
+	};
+
+	/**
+	 * \brief Header at the begin of the file.
+	 *
+	 */
+	struct fileHeader
+	{
+		char magic[4];				// "OVSC"
+		unsigned int version;
+		unsigned long long sceneryHash;	// hashScenery() of the compiled scenery section
+		unsigned int numSources;
+		unsigned int numDependencies;
+		unsigned int numObjects;
+		unsigned int numFootprintPoints;
+		unsigned int numCloudLayers;
+		unsigned int numWindLayers;
+		unsigned int flags;			// FLAG_*
+		int day, month, year, hour, minute;
+		int trackingID;
+		stringRef trackingIdUpdaterSlot;
+		double range, turbidity;
+		unsigned long long stringTableOffset;
+		unsigned long long stringTableSize;
+	};
+
+	/**
+	 * Flags of the file header.
+	 */
+	static const unsigned int FLAG_DATETIME = 1;
+	static const unsigned int FLAG_VISIBILITY = 2;
+	static const unsigned int FLAG_TRACKMODEL = 4;
+
+	/**
+	 * \brief Model file and its geometry.
+	 *
+	 */
+	struct sourceRecord
+	{
+		stringRef filename;			// As specified in the configuration
+		long long modificationTime;	// Of the model file at compilation, -1 if the file was not found
+		unsigned long long fileSize;
+		unsigned long long geometryOffset;	// File offset of the .osgb data, 0 if the model could not be loaded
+		unsigned long long geometrySize;
+		unsigned int firstDependency;
+		unsigned int numDependencies;
+	};
+
+	/**
+	 * \brief Image or external reference embedded into the geometry of a model file, see util_modelCache::collectDependencies().
+	 *
+	 */
+	struct dependencyRecord
+	{
+		stringRef filename;			// Resolved path
+		long long modificationTime;	// At compilation, -1 if the file was not found
+		unsigned long long fileSize;
+	};
+
+	/**
+	 * \brief Object of the scenery, see visual_object::objectConfig.
+	 *
+	 */
+	struct objectRecord
+	{
+		stringRef objectname, label;
+		stringRef updater_lat, updater_lon, updater_alt, updater_rot_x, updater_rot_y, updater_rot_z, updater_label;
+		int source;					// Index of the model file, -1 without geometry
+		int trackingID;
+		unsigned int flags;			// OBJECT_*
+		unsigned int firstFootprintPoint;
+		unsigned int numFootprintPoints;
+		unsigned int reserved;
+		double lat, lon, alt, rot_x, rot_y, rot_z;
+		double cam_trans_x, cam_trans_y, cam_trans_z, cam_rot_x, cam_rot_y, cam_rot_z;
+		double geometry_rot_x, geometry_rot_y, geometry_rot_z;
+		double geometry_scale_x, geometry_scale_y, geometry_scale_z;
+		double groundclamp_offset;
+	};
+
+	/**
+	 * Flags of the object record.
+	 */
+	static const unsigned int OBJECT_DYNAMIC = 1;
+	static const unsigned int OBJECT_GROUNDCLAMP = 2;
+	static const unsigned int OBJECT_GROUNDCLAMP_ATTITUDE = 4;
+
+	/**
+	 * \brief Cloud layer, see cloudLayer.
+	 *
+	 */
+	struct cloudLayerRecord
+	{
+		int slot, baseLength, baseWidth, thickness, baseHeight;
+		stringRef type;
+		int reserved;
+		double density;
+		double rate_mmPerHour_rain, rate_mmPerHour_drySnow, rate_mmPerHour_wetSnow, rate_mmPerHour_sleet;
+	};
+
+	/**
+	 * \brief Wind layer, see windLayer.
+	 *
+	 */
+	struct windLayerRecord
+	{
+		double bottom, top, speed, direction;
+	};
+
+	/**
+	 * \brief This operation deserializes a part of the geometries of an archive. Each geometry is deserialized by exactly one part.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class loadOperation : public osg::Operation
+	{
+	public:
+		loadOperation(core_sceneryArchive* archive_, unsigned int part_, unsigned int numParts_)
+			: osg::Operation("core_sceneryArchive::loadOperation", false), archive(archive_), part(part_), numParts(numParts_) {};
+		virtual void operator () (osg::Object*)
+		{
+			archive->loadGeometry( part, numParts );
+		}
+	private:
+		osg::ref_ptr<core_sceneryArchive> archive;
+		unsigned int part;
+		unsigned int numParts;
+	};
+
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	core_sceneryArchive();
+
+	/**
+	 * \brief This function maps an archive and decodes the object table. It fails if the archive is missing, invalid or stale.
+	 *
+	 * @param filename_ : Archive to open.
+	 * @param sceneryNode_ : <scenery> node of the configuration to check the archive against.
+	 * @return : True if the archive is valid and up to date.
+	 */
+	bool open( const std::string& filename_, const util_config::node* sceneryNode_ );
+
+	/**
+	 * \brief This function deserializes the geometries with the index i for which i % numParts_ == part_. It is thread safe for different parts.
+	 *
+	 * @param part_ : Part to load.
+	 * @param numParts_ : Number of parts.
+	 */
+	void loadGeometry( unsigned int part_ = 0, unsigned int numParts_ = 1 );
+
+	/**
+	 * \brief This function returns the scenery of the archive.
+	 *
+	 * @return : Scenery.
+	 */
+	const scenery& getScenery() const {return content;};
+
+	/**
+	 * \brief This function returns the deserialized geometry of a model file.
+	 *
+	 * @param source_ : Index of the model file, objectConfig::filename is resolved by getSource().
+	 * @return : Geometry, NULL if it is not loaded.
+	 */
+	osg::Node* getGeometry( int source_ ) const;
+
+	/**
+	 * \brief This function returns the model file index of an object.
+	 *
+	 * @param object_ : Index of the object in getScenery().objects.
+	 * @return : Index of the model file, -1 if the object has no geometry.
+	 */
+	int getSource( unsigned int object_ ) const {return object_ < objectSources.size() ? objectSources[object_] : -1;};
+
+	/**
+	 * \brief This function releases the mapped archive and the deserialized geometries, which are referenced by the objects afterwards.
+	 *
+	 */
+	void close();
+
+	/**
+	 * \brief This function parses the environment nodes (<datetime>, <visibility>, <clouds>, <windlayer>) of the scenery section.
+	 *
+	 * @param sceneryNode_ : <scenery> node.
+	 * @param env_ : Environment to fill.
+	 */
+	static void parseEnvironment( const util_config::node* sceneryNode_, environment& env_ );
+
+	/**
+	 * \brief This function parses the models, the tracked model and the environment of the scenery section.
+	 *
+	 * @param sceneryNode_ : <scenery> node.
+	 * @param scenery_ : Scenery to fill.
+	 */
+	static void parseScenery( const util_config::node* sceneryNode_, scenery& scenery_ );
+
+	/**
+	 * \brief This function computes a hash over all elements and attributes of the scenery section, except the <sceneryarchive> node.
+	 *
+	 * @param sceneryNode_ : <scenery> node.
+	 * @return : 64 bit FNV-1a hash.
+	 */
+	static unsigned long long hashScenery( const util_config::node* sceneryNode_ );
+
+	/**
+	 * \brief This function compiles the scenery section into an archive. It loads and optionally optimizes each referenced model file.
+	 *
+	 * @param filename_ : Archive to write.
+	 * @param sceneryNode_ : <scenery> node.
+	 * @param optimize_ : True to optimize the models with the optimizer chain of util_modelCache before they are stored.
+	 * @return : True if successful.
+	 */
+	static bool write( const std::string& filename_, const util_config::node* sceneryNode_, bool optimize_ = true );
+
+protected:
+	/**
+	 * \brief Protected destructor.
+	 *
+	 */
+	virtual ~core_sceneryArchive();
+
+private:
+	/**
+	 * \brief This function returns a string of the string table.
+	 *
+	 * @param ref_ : Reference to the string.
+	 * @return : String, empty if the reference is invalid.
+	 */
+	std::string getString( const stringRef& ref_ ) const;
+
+	/**
+	 * Mapped archive.
+	 */
+	osg::ref_ptr<util_mappedFile> file;
+
+	/**
+	 * Header of the mapped archive.
+	 */
+	const fileHeader* header;
+
+	/**
+	 * Model file records of the mapped archive.
+	 */
+	const sourceRecord* sources;
+
+	/**
+	 * Decoded scenery.
+	 */
+	scenery content;
+
+	/**
+	 * Model file index of each object.
+	 */
+	std::vector<int> objectSources;
+
+	/**
+	 * Deserialized geometry of each model file.
+	 */
+	std::vector< osg::ref_ptr<osg::Node> > geometries;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,189 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/OperationThread>
+#include <osg/Timer>
+#include <osg/Notify>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class executes independent startup work in parallel and reports the startup timing.
+ *
+ * Background tasks (file loading, network connects) are executed on their own threads while the main thread continues with the
+ * initialization steps which require the viewer or the scene graph. Where the main thread requires the result of a task, it joins it via wait().
+ * The tasks do not use util_workerPool, so a long running task (e.g. the cluster connect with its retries) never delays the
+ * runAndWait() calls of the main thread and the pool threads stay free for the frame work.
+ * Main thread steps are recorded with beginStep(), so printReport() shows the complete startup breakdown.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class core_startupTasks : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This operation calls a member function without parameters, e.g. to execute a loading function of visual_core as startup task.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	template<class T>
+	class methodOperation : public osg::Operation
+	{
+	public:
+		methodOperation(T* object_, void (T::*method_)())
+			: osg::Operation("core_startupTasks::methodOperation", false), object(object_), method(method_) {};
+
+		virtual void operator () (osg::Object*)
+		{
+			(object->*method)();
+		}
+	private:
+		T* object;
+		void (T::*method)();
+	};
+
+	/**
+	 * \brief Constructor: The startup time is measured from here.
+	 *
+	 */
+	core_startupTasks();
+
+	/**
+	 * \brief Destructor: Waits for all tasks, because they may access objects which are destroyed afterwards.
+	 *
+	 */
+	~core_startupTasks();
+
+	/**
+	 * \brief This function starts a task on a new thread. The task must not access the viewer or the scene graph.
+	 *
+	 * @param name_ : Name of the task, used by wait() and in the report.
+	 * @param operation_ : Operation to execute.
+	 */
+	void addTask( const std::string& name_, osg::Operation* operation_ );
+
+	/**
+	 * \brief This function blocks until the task is completed. Unknown tasks are ignored.
+	 *
+	 * @param name_ : Name of the task.
+	 */
+	void wait( const std::string& name_ );
+
+	/**
+	 * \brief This function blocks until all tasks are completed and joins their threads.
+	 *
+	 */
+	void waitForAll();
+
+	/**
+	 * \brief This function starts the time measurement of a main thread step and finishes the previous step.
+	 *
+	 * @param name_ : Name of the step.
+	 */
+	void beginStep( const std::string& name_ );
+
+	/**
+	 * \brief This function finishes the time measurement of the actual main thread step.
+	 *
+	 */
+	void endStep();
+
+	/**
+	 * \brief This function prints start and duration of all steps and tasks and the total startup time.
+	 *
+	 */
+	void printReport();
+
+private:
+	/**
+	 * \brief This struct contains the timing of a step or task.
+	 */
+	struct entry : public osg::Referenced
+	{
+		entry() : background(false), done(false), startTick(0), endTick(0) {};
+
+		std::string name;
+		bool background;		// Executed by a task thread
+		bool done;
+		osg::Timer_t startTick;
+		osg::Timer_t endTick;
+	};
+
+	/**
+	 * \brief This thread executes one task and records its timing.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class taskThread : public OpenThreads::Thread
+	{
+	public:
+		taskThread(core_startupTasks* tasks_, entry* entry_, osg::Operation* operation_)
+			: tasks(tasks_), task(entry_), operation(operation_) {};
+
+		virtual void run();
+	private:
+		core_startupTasks* tasks;
+		osg::ref_ptr<entry> task;
+		osg::ref_ptr<osg::Operation> operation;
+	};
+
+	/**
+	 * Start of the startup.
+	 */
+	osg::Timer_t startTick;
+
+	/**
+	 * Actual main thread step, NULL if none.
+	 */
+	osg::ref_ptr<entry> actualStep;
+
+	/**
+	 * All steps and tasks in the order of their creation.
+	 */
+	std::vector< osg::ref_ptr<entry> > entries;
+
+	/**
+	 * Threads of the tasks, joined by waitForAll().
+	 */
+	std::vector<taskThread*> threads;
+
+	/**
+	 * Mutex to protect the entries and the threads. The entries are completed by the task threads.
+	 */
+	OpenThreads::Mutex mutex;
+
+	/**
+	 * Condition which is signaled when a task is completed.
+	 */
+	OpenThreads::Condition completed;
+};
+
+}	// END NAMESPACE
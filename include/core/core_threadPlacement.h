@@ -0,0 +1,226 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+#include <osg/Timer>
+
+#include <osgViewer/Viewer>
+
+#include <util_frameTimeStatistics.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class places the threads of osgVisual on dedicated processor cores, raises the priority of the render and sync threads and locks the memory.
+ *
+ * On shared render nodes the draw thread, the DatabasePager threads and the network servicing compete with the noise of the operating system,
+ * which causes single long frames and breaks the frame lock of the cluster. This class configures:
+ * - Processor affinity of the main thread (event, update, dataIO and cluster I/O, which is serviced in the update traversal), the cull threads,
+ *   the draw threads and the DatabasePager threads. A thread may get a list of cores, the pager threads are distributed over their list.
+ * - SCHED_FIFO priority of the main, cull and draw threads (Linux, requires CAP_SYS_NICE or an rtprio limit). On Windows, a priority above 0
+ *   selects THREAD_PRIORITY_TIME_CRITICAL.
+ * - mlockall() of all current and future pages and a pre-faulted heap reserve (Linux, requires a sufficient memlock limit).
+ *   Each thread stack is locked completely, so the locked memory grows with the number of threads.
+ *
+ * The cull and draw threads are started by the viewer, so their settings are applied by an operation which the threads execute themselves.
+ * If the threading model is changed at runtime, the new threads run without placement.
+ *
+ * Additionally the wall clock frame times are recorded. At shutdown, their distribution and the number of spikes are reported as jitter report.
+ * To compare the frame time distributions with and without the placement, record a run with apply="no" into a CSV file and pass it
+ * as baseline to a run with apply="yes".
+ *
+ * It is configured in the XML configuration:
+ * <module name="threadplacement" enabled="yes">
+ *   <threadplacement apply="yes" mlockall="yes" prefaultheap="256" warmupframes="100" spikethreshold="20.0" jitterreport="jitter.csv" baseline="jitter_baseline.csv">
+ *     <thread name="main" cpus="1" priority="60"></thread>
+ *     <thread name="cull" cpus="2"></thread>
+ *     <thread name="draw" cpus="3" priority="70"></thread>
+ *     <thread name="pager" cpus="4-5"></thread>
+ *   </threadplacement>
+ * </module>
+ * prefaultheap is the size of the pre-faulted heap reserve in MB. spikethreshold is the frame time in ms above which a frame counts as spike, 0 means twice the median.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class core_threadPlacement : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This enum lists the placed threads.
+	 *
+	 */
+	enum threadRole
+	{
+		MAIN,
+		CULL,
+		DRAW,
+		PAGER,
+		NUM_ROLES
+	};
+
+	/**
+	 * \brief This struct contains the placement of one thread role.
+	 *
+	 */
+	struct threadSettings
+	{
+		threadSettings() : priority(0) {};
+
+		/**
+		 * Processor cores the threads may run on, empty means no restriction.
+		 */
+		std::vector<unsigned int> cpus;
+
+		/**
+		 * SCHED_FIFO priority, 0 keeps the normal scheduling.
+		 */
+		int priority;
+	};
+
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	core_threadPlacement();
+
+	/**
+	 * \brief This function reads the configuration, places the DatabasePager threads and locks the memory. Call it before the viewer is realized.
+	 *
+	 * @param viewer_ : Viewer whose threads are placed.
+	 * @return : True if the placement is configured and enabled.
+	 */
+	bool init( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function places the main thread and the cull and draw threads of the viewer. Call it from the main thread after the viewer is realized.
+	 *
+	 * @param viewer_ : Realized viewer.
+	 */
+	void applyToViewerThreads( osgViewer::Viewer* viewer_ );
+
+	/**
+	 * \brief This function records the frame time of the elapsed frame. Call it once per frame after the rendering traversals.
+	 *
+	 */
+	void update();
+
+	/**
+	 * \brief This function writes the jitter report and the CSV file of the frame times.
+	 *
+	 */
+	void report();
+
+	/**
+	 * \brief This function applies a placement to the calling thread.
+	 *
+	 * @param name_ : Name of the thread for the log.
+	 * @param settings_ : Placement to apply.
+	 * @return : True if successful.
+	 */
+	static bool applyToCurrentThread( const std::string& name_, const threadSettings& settings_ );
+
+	/**
+	 * \brief This function parses a list of processor cores, e.g. "1,3-5".
+	 *
+	 * @param list_ : Comma separated cores or ranges.
+	 * @param cpus_ : Parsed cores.
+	 * @return : True if the list is valid.
+	 */
+	static bool parseCpuList( const std::string& list_, std::vector<unsigned int>& cpus_ );
+
+private:
+	/**
+	 * \brief This function locks all current and future pages of the process and pre-faults a heap reserve.
+	 *
+	 * @param prefaultMB_ : Size of the heap reserve in MB.
+	 * @return : True if successful.
+	 */
+	bool lockMemory( unsigned int prefaultMB_ );
+
+	/**
+	 * \brief This function writes the distribution and the spikes of frame times.
+	 *
+	 * @param statistics_ : Frame times.
+	 * @param title_ : Title of the distribution.
+	 * @param spikeThreshold_ : Frame time in ms above which a frame counts as spike.
+	 */
+	void writeDistribution( util_frameTimeStatistics* statistics_, const std::string& title_, double spikeThreshold_ );
+
+	/**
+	 * Placement of each thread role.
+	 */
+	threadSettings settings[NUM_ROLES];
+
+	/**
+	 * Flag if the placement is applied. If not, only the frame times are recorded, e.g. as baseline.
+	 */
+	bool apply;
+
+	/**
+	 * Flag if the memory is locked.
+	 */
+	bool lockAllMemory;
+
+	/**
+	 * Size of the pre-faulted heap reserve in MB.
+	 */
+	unsigned int prefaultHeapMB;
+
+	/**
+	 * Frames after start which are not recorded, e.g. while the first terrain tiles are compiled.
+	 */
+	unsigned int warmupFrames;
+
+	/**
+	 * Frame time in ms above which a frame counts as spike, 0 means twice the median.
+	 */
+	double spikeThreshold;
+
+	/**
+	 * CSV file for the frame times of this run, empty if not written.
+	 */
+	std::string jitterReportFilename;
+
+	/**
+	 * CSV file with the frame times of a run to compare with, empty if none.
+	 */
+	std::string baselineFilename;
+
+	/**
+	 * Wall clock frame times of this run.
+	 */
+	osg::ref_ptr<util_frameTimeStatistics> statistics;
+
+	/**
+	 * Start of the elapsed frame.
+	 */
+	osg::Timer_t lastTick;
+
+	/**
+	 * Number of processed frames.
+	 */
+	unsigned int numFrames;
+};
+
+}	// END NAMESPACE
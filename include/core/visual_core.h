@@ -29,6 +29,15 @@
 // Manipulator and eventhandler
 #include <core_manipulator.h>
 
+// Headless and benchmark mode
+#include <core_benchmark.h>
+#include <core_detailGovernor.h>
+#include <core_threadPlacement.h>
+
+// Parallel startup
+#include <core_startupTasks.h>
+#include <core_sceneryArchive.h>
+
 
 #ifdef USE_DISTORTION
 // Distortion
@@ -43,6 +52,7 @@
 // DataIO
 #include <visual_dataIO.h>
 #include <object_updater.h>
+#include <object_groundClamper.h>
 
 // visual_object
 #include <visual_object.h>
@@ -57,6 +67,15 @@
 
 // visual util
 #include <visual_util.h>
+#include <util_workerPool.h>
+#include <util_kdTreeBuilder.h>
+#include <util_terrainHeightGrid.h>
+#include <util_profiler.h>
+#include <util_allocTracker.h>
+#include <util_frameArena.h>
+#include <util_taskScheduler.h>
+#include <util_log.h>
+#include <util_modelCache.h>
 
 // visual_vista2D
 #ifdef USE_VISTA2D
@@ -85,12 +104,45 @@ public:
 	void initialize();
 	void shutdown();
 
-	void parseScenery(xmlNode * a_node);
-	bool loadTerrain(osg::ArgumentParser& arguments_);
+	/**
+	 * \brief This function creates the objects, the tracked model and the environment of the scenery section.
+	 * 
+	 * @param sceneryNode_ : <scenery> section of the configuration.
+	 */ 
+	void parseScenery(const util_config::node* sceneryNode_);
+
+	/**
+	 * \brief This function configures date, time, visibility, clouds and wind of the sky from the scenery section.
+	 * 
+	 * @param sceneryNode_ : <scenery> section of the configuration.
+	 */ 
+	void parseSceneryEnvironment(const util_config::node* sceneryNode_);
+
+	/**
+	 * \brief This function configures date, time, visibility, clouds and wind of the sky.
+	 * 
+	 * @param env_ : Environment parsed from the configuration or read from the scenery archive.
+	 */ 
+	void applySceneryEnvironment(const core_sceneryArchive::environment& env_);
+	void loadTerrain();
+	bool attachTerrain();
 	bool checkCommandlineArgumentsForFinalErrors();
 
 	void setupScenery();
 
+	/**
+	 * \brief This function creates the objects and the environment of the scenery from the compiled scenery archive, instead of parsing the configuration.
+	 * 
+	 */ 
+	void setupSceneryFromArchive();
+
+	/**
+	 * \brief This function returns the exit code of osgVisual, which is set during shutdown.
+	 *
+	 * @return : 0 on success, 1 if an allocation free path allocated (only with USE_ALLOCATION_TRACKING).
+	 */
+	int getExitCode() {return exitCode;};
+
 protected:
 	/**
 	 * \brief Destrcutor
@@ -105,6 +157,51 @@ private:
 	 */ 
 	void mainLoop();
 
+	/**
+	 * \brief This function loads the configured model files in advance. It is executed as startup task.
+	 * 
+	 */ 
+	void preloadModels();
+
+	/**
+	 * \brief This function maps the configured terrain height grid. It is executed as startup task.
+	 * 
+	 */ 
+	void loadHeightGrid();
+
+	/**
+	 * \brief This function establishes the cluster connection, which may take up to 25 s on a slave. It is executed as startup task.
+	 * 
+	 */ 
+	void connectCluster();
+
+	/**
+	 * \brief This function applies a changed scenery configuration: date, time, visibility, clouds and wind are reconfigured.
+	 * 
+	 * Models and terrain are not reloaded, changes of them require a restart.
+	 * 
+	 * @param sceneryNode_ : Changed <scenery> section, NULL if it was removed.
+	 */ 
+	void reloadSceneryEnvironment(const util_config::node* sceneryNode_);
+
+	/**
+	 * \brief This class forwards changes of the scenery configuration to visual_core.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class sceneryChangeListener : public util_config::changeListener
+	{
+	public:
+		sceneryChangeListener(visual_core* core_) : core(core_) {};
+		virtual void configChanged( const std::string&, const util_config::node* section_ ) {core->reloadSceneryEnvironment(section_);};
+	private:
+		/**
+		 * Pointer to visual_core. A Referenced Pointer is _NOT_ used to avoid a circular reference.
+		 */ 
+		visual_core* core;
+	};
+
 	/**
 	 * Argument object, with contains all commandline arguments, which where called during programm sstartup
 	 */ 
@@ -125,6 +222,32 @@ private:
 	 */
 	std::string configFilename;
 
+	/**
+	 * File to write the profiler trace to on shutdown, empty if profiling is disabled.
+	 */
+	std::string profileFilename;
+
+	/**
+	 * Listener for changes of the scenery configuration, NULL if the configuration is not watched.
+	 */
+	osg::ref_ptr<sceneryChangeListener> sceneryListener;
+
+	/**
+	 * Terrain files, model files and height grid file of the scenery configuration, loaded by the startup tasks.
+	 */
+	std::vector<std::string> terrainFiles, modelFiles;
+	std::string heightGridFile;
+
+	/**
+	 * Compiled scenery archive, NULL if none is configured or if it is stale. It is released after the scenery is set up.
+	 */
+	osg::ref_ptr<core_sceneryArchive> sceneryArchive;
+
+	/**
+	 * Terrain loaded by loadTerrain(), added to the scene by attachTerrain().
+	 */
+	osg::ref_ptr<osg::Node> loadedTerrain;
+
 
 
 #ifdef USE_SKY_SILVERLINING
@@ -132,8 +255,6 @@ private:
 	 * Silverlining Sky instance
 	 */ 
 	osg::ref_ptr<visual_skySilverLining> sky;
-
-	xmlNode* skySilverliningConfig;
 #endif
 
 #ifdef USE_DISTORTION
@@ -141,8 +262,6 @@ private:
 	 * Distortion instance.
 	 */ 
 	osg::ref_ptr<visual_distortion> distortion;
-
-	xmlNode* distortionConfig;
 #endif
 
 	osg::ref_ptr<visual_object> testObj;
@@ -150,6 +269,26 @@ private:
 	osg::ref_ptr<visual_debug_hud> hud;
 
 	osg::ref_ptr<core_manipulator> manipulators;
+
+	/**
+	 * Headless and benchmark mode, NULL if both are disabled.
+	 */
+	osg::ref_ptr<core_benchmark> benchmark;
+
+	/**
+	 * Automatic detail reduction under load, NULL if not configured.
+	 */
+	osg::ref_ptr<core_detailGovernor> detailGovernor;
+
+	/**
+	 * Thread placement, memory locking and jitter report, NULL if not configured.
+	 */
+	osg::ref_ptr<core_threadPlacement> threadPlacement;
+
+	/**
+	 * Exit code of osgVisual, see getExitCode().
+	 */
+	int exitCode;
 };
 
 }	// END NAMESPACE
\ No newline at end of file
@@ -0,0 +1,256 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Matrixd>
+#include <osg/Notify>
+#include <osg/Timer>
+
+#include <dataIO_slot.h>
+#include <dataIO_slotSnapshot.h>
+#include <dataIO_transportContainer.h>
+#include <util_appendFile.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual {
+
+/**
+ * \brief This class records the dataIO frame stream into a binary log, which is replayed by dataIO_extLinkReplay.
+ *
+ * Each frame, visual_dataIO passes the published slot snapshot, which contains the TO_OBJ values of the frame and the FROM_OBJ values
+ * computed in it, together with the view matrix, the frame ID and the executers of the transport container.
+ * The records are appended to a memory-mapped file (util_appendFile) without flushing it, so multi-hour recordings cost a memcpy per frame.
+ * The file is in host byte order:
+ * - fileHeader
+ * - Records, each starting with a recordHeader and padded to 8 bytes:
+ *   - SLOT_RECORD: slotRecord and the slot name. Written before the first frame which contains the slot.
+ *   - FRAME_RECORD: frameRecord, the slot values in the order of the slot indices (double, or unsigned int length and characters),
+ *     the number of executers as unsigned int and for each executer an executerRecord, its doubles and its string.
+ *   - INDEX_RECORD: indexHeader, copies of all slot records and an indexEntry per frame. Written when the recording is closed.
+ * - fileTrailer: Offset of the index record.
+ * Without index (e.g. after a crash) the replay scans the records up to the first invalid one.
+ *
+ * It is configured in the dataIO section of the XML configuration:
+ * <module name="dataio" enabled="yes">
+ *   <recorder filename="dataio.ovr"></recorder>
+ * </module>
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class dataIO_recorder : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * Version of the file format.
+	 */
+	static const unsigned int FILE_VERSION = 1;
+
+	/**
+	 * \brief Header at the begin of the file.
+	 *
+	 */
+	struct fileHeader
+	{
+		char magic[4];				// "OVRC"
+		unsigned int version;
+	};
+
+	/**
+	 * \brief This enum lists the record types.
+	 *
+	 */
+	enum recordType
+	{
+		SLOT_RECORD = 1,
+		FRAME_RECORD = 2,
+		INDEX_RECORD = 3
+	};
+
+	/**
+	 * \brief Header of each record.
+	 *
+	 */
+	struct recordHeader
+	{
+		unsigned int type;
+		unsigned int size;			// Size of the record including this header
+	};
+
+	/**
+	 * \brief Content of a slot record, followed by the name.
+	 *
+	 */
+	struct slotRecord
+	{
+		unsigned int index;
+		unsigned int direction;		// dataIO_slot::dataDirection
+		unsigned int variableType;	// dataIO_slot::varType
+		unsigned int nameLength;
+	};
+
+	/**
+	 * \brief Content of a frame record, followed by the slot values and the executers.
+	 *
+	 */
+	struct frameRecord
+	{
+		unsigned int frameID;
+		unsigned int numValues;
+		double time;				// Seconds since the start of the recording
+		double viewMatrix[16];
+	};
+
+	/**
+	 * \brief Executer in a frame record, followed by its doubles and its string.
+	 *
+	 */
+	struct executerRecord
+	{
+		unsigned int id;			// dataIO_executer::executerID
+		unsigned int numDoubles;
+		unsigned int stringLength;
+		unsigned int reserved;
+	};
+
+	/**
+	 * \brief Content of the index record, followed by the slot records and the index entries.
+	 *
+	 */
+	struct indexHeader
+	{
+		unsigned int numSlots;
+		unsigned int numFrames;
+	};
+
+	/**
+	 * \brief Index entry of one frame.
+	 *
+	 */
+	struct indexEntry
+	{
+		unsigned long long offset;	// File offset of the frame record
+		double time;
+		unsigned int frameID;
+		unsigned int reserved;
+	};
+
+	/**
+	 * \brief Trailer at the end of a closed file.
+	 *
+	 */
+	struct fileTrailer
+	{
+		unsigned long long indexOffset;
+		char magic[4];				// "OVRI"
+		unsigned int reserved;
+	};
+
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	dataIO_recorder();
+
+	/**
+	 * \brief This function creates the log file and starts the recording.
+	 *
+	 * @param filename_ : File to record into, an existing file is overwritten.
+	 * @return : True if successful.
+	 */
+	bool open( const std::string& filename_ );
+
+	/**
+	 * \brief This function appends a frame. Call it from the main thread.
+	 *
+	 * @param snapshot_ : Slot values of the frame.
+	 * @param viewMatrix_ : View matrix of the frame.
+	 * @param container_ : Transport container with the executers of the frame, may be NULL.
+	 */
+	void recordFrame( const dataIO_slotSnapshot* snapshot_, const osg::Matrixd& viewMatrix_, const dataIO_transportContainer* container_ );
+
+	/**
+	 * \brief This function writes the index and closes the log file.
+	 *
+	 */
+	void close();
+
+	/**
+	 * \brief This function returns if a recording is active.
+	 *
+	 * @return : True if recording.
+	 */
+	bool isRecording() const {return file.valid() && file->isOpen();};
+
+protected:
+	/**
+	 * \brief Protected destructor: Closes the recording.
+	 *
+	 */
+	virtual ~dataIO_recorder();
+
+private:
+	/**
+	 * \brief This function appends a slot record into the record buffer.
+	 *
+	 * @param index_ : Index of the slot.
+	 * @param slot_ : Slot value with name, direction and type.
+	 */
+	void addSlotRecord( unsigned int index_, const dataIO_slotSnapshot::slotValue& slot_ );
+
+	/**
+	 * \brief This function pads the record which starts at the specified buffer position to 8 bytes and sets its size.
+	 *
+	 * @param start_ : Position of the record header in the record buffer.
+	 */
+	void finishRecord( size_t start_ );
+
+	/**
+	 * Log file.
+	 */
+	osg::ref_ptr<util_appendFile> file;
+
+	/**
+	 * Buffer in which the records of a frame are assembled. It keeps its capacity, so recording does not allocate once it is warm.
+	 */
+	std::vector<unsigned char> buffer;
+
+	/**
+	 * Slot records written so far, copied into the index record.
+	 */
+	std::vector<unsigned char> slotRecords;
+
+	/**
+	 * Number of slots for which a slot record is written.
+	 */
+	unsigned int numSlots;
+
+	/**
+	 * Index of all recorded frames.
+	 */
+	std::vector<indexEntry> index;
+
+	/**
+	 * Start of the recording.
+	 */
+	osg::Timer_t startTick;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,122 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+
+#include <dataIO_slot.h>
+#include <util_allocTracker.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual {
+
+/**
+ * \brief This class is an immutable copy of all dataIO slots, taken at the end of the update traversal of one frame.
+ *
+ * The live slots are owned by the main thread (event and update traversal). Code running in the cull or draw threads
+ * must not access them, it uses the snapshot of the frame it is processing instead. A snapshot is never modified
+ * after it is published, so any number of threads may read it without locking.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class dataIO_slotSnapshot : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Value of one slot at the time the snapshot was taken.
+	 */
+	struct slotValue
+	{
+		std::string variableName;
+		osgVisual::dataIO_slot::dataDirection direction;
+		osgVisual::dataIO_slot::varType variableType;
+		double value;
+		std::string sValue;
+	};
+
+	/**
+	 * \brief Constructor: copies the values of the slots.
+	 *
+	 * The caller must ensure that the slots are not modified during the copy.
+	 *
+	 * @param dataSlots_ : Slots to copy.
+	 * @param frameNumber_ : Number of the frame the slot values belong to.
+	 */
+	dataIO_slotSnapshot(const std::vector<dataIO_slot*>& dataSlots_, unsigned int frameNumber_);
+
+	/**
+	 * \brief This function returns the number of the frame the snapshot was taken in.
+	 *
+	 * @return : Frame number.
+	 */
+	unsigned int getFrameNumber() const {return frameNumber;};
+
+	/**
+	 * \brief This function returns the value of a double slot.
+	 *
+	 * @param variableName_ : Name of the slot.
+	 * @param direction_ : Data direction of the slot.
+	 * @return : Value of the slot, 0 if the slot did not exist when the snapshot was taken.
+	 */
+	double getSlotDataAsDouble(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ ) const;
+
+	/**
+	 * \brief This function returns the value of a string slot.
+	 *
+	 * @param variableName_ : Name of the slot.
+	 * @param direction_ : Data direction of the slot.
+	 * @return : Value of the slot, empty if the slot did not exist when the snapshot was taken.
+	 */
+	std::string getSlotDataAsString(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ ) const;
+
+	/**
+	 * \brief This function returns the number of slots in the snapshot.
+	 *
+	 * @return : Number of slots.
+	 */
+	unsigned int getSlotNum() const {return slots.size();};
+
+	/**
+	 * \brief This function returns a slot of the snapshot.
+	 *
+	 * @param index_ : Index of the slot, must be smaller than getSlotNum().
+	 * @return : Slot value.
+	 */
+	const slotValue& getSlot( unsigned int index_ ) const {return slots[index_];};
+
+protected:
+	/**
+	 * \brief Protected destructor: snapshots are shared via osg::ref_ptr.
+	 *
+	 */
+	virtual ~dataIO_slotSnapshot() {};
+
+	/**
+	 * Number of the frame the snapshot was taken in.
+	 */
+	unsigned int frameNumber;
+
+	/**
+	 * Copied slot values, in the same order as dataIO's slot list.
+	 */
+	std::vector<slotValue> slots;
+};
+
+}	// END NAMESPACE
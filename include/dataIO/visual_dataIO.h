@@ -21,8 +21,14 @@
 
 #include <osgViewer/Viewer>
 
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
 // osgVisual specifiy includes
 #include <visual_util.h>
+#include <util_profiler.h>
+#include <util_allocTracker.h>
+#include <util_log.h>
 
 // Cluster
 #include <dataIO_clusterDummy.h>
@@ -38,6 +44,7 @@
 
 //ExtLink 
 #include <dataIO_extLinkDummy.h>
+#include <dataIO_extLinkReplay.h>
 #ifdef USE_EXTLINK_VCL
 	#include <dataIO_extLinkVCL.h>
 #endif
@@ -46,14 +53,12 @@
 // Slot and transportContainer definitions
 #include <dataIO_slot.h>
 #include <dataIO_transportContainer.h>
-
-// XML Parser
-#include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <dataIO_slotSnapshot.h>
+#include <dataIO_recorder.h>
 
 // C++ stl libraries
 #include <vector>
+#include <deque>
 
 
 
@@ -65,6 +70,11 @@ namespace osgVisual {
  * 
  * Damit nur eine Klasse instantiiert werden kann, ist diese Klasse als Singleton realisiert.
  * 
+ * Threading: The live slots are owned by the main thread (event and update traversal). At the end of the update traversal,
+ * dataIO publishes a dataIO_slotSnapshot of all slots. The cull and draw threads only use these snapshots, so the viewer
+ * can run in every threading model. The slot access functions lock the slot list and may be called from any thread,
+ * pointers returned by setSlotData() or getSlotPointer() must only be used in the main thread.
+ * 
  * 
  * @author Torben Dannhauer
  * @date  Nov 2009
@@ -93,6 +103,26 @@ private:
 	};
 	osg::ref_ptr<dataIO_eventCallback> eventCallback;
 
+	class dataIO_updateCallback : public osg::NodeCallback
+	{
+	public: 
+		/**
+		 * \brief Constructor, for setting the member variables.
+		 * 
+		 * @param dataIO_ : Pointer to the dataIO class.
+		 */ 
+		dataIO_updateCallback(visual_dataIO* dataIO_):dataIO(dataIO_){};
+
+		/**
+		 * \brief This function is executed as camera update callback after the scene's update traversal. It publishes the slot snapshot of the frame.
+		 * 
+		 */ 
+		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv);
+	private:
+		visual_dataIO* dataIO;
+	};
+	osg::ref_ptr<dataIO_updateCallback> updateCallback;
+
 	class dataIO_finalDrawCallback : public osg::Camera::DrawCallback
 	{
 	public:
@@ -103,10 +133,11 @@ private:
 		dataIO_finalDrawCallback(visual_dataIO* dataIO_):dataIO(dataIO_){};
 		
 		/**
-		 * \brief Operator executed at callback
+		 * \brief Operator executed at callback. It runs in the draw thread of the main camera's context.
 		 * 
+		 * @param renderInfo : RenderInfo of the frame being drawn, it provides the frame number to find the matching slot snapshot.
 		 */ 
-		virtual void operator () (const osg::Camera& camera) const;
+		virtual void operator () (osg::RenderInfo& renderInfo) const;
 	private:
 		visual_dataIO* dataIO;
 	};
@@ -134,12 +165,21 @@ private:
 	bool processXMLConfiguration(); 
 
 	/**
-	 * \brief Todo: required?
+	 * \brief This function returns the view matrix of the current frame, e.g. to send it to the slaves or to record it.
+	 * 
+	 * Without camera manipulator, e.g. while core_benchmark drives the camera along a recorded path, the view matrix of the camera is returned.
 	 * 
-	 * @return 
+	 * @return : View matrix.
 	 */ 
 	osg::Matrixd calcViewMatrix();
 
+	/**
+	 * \brief This function copies all slots into a new snapshot and publishes it for the cull and draw threads.
+	 * 
+	 * @param frameNumber_ : Number of the current frame.
+	 */ 
+	void publishSnapshot( unsigned int frameNumber_ );
+
 	/**
 	 * Pointer to the base class of the extLink implementation.
 	 */ 
@@ -150,6 +190,11 @@ private:
 	 */ 
 	osg::ref_ptr<dataIO_cluster> cluster;
 
+	/**
+	 * Recorder of the frame stream, NULL if not configured.
+	 */ 
+	osg::ref_ptr<dataIO_recorder> recorder;
+
 	/**
 	 * Referenced pointer to the applications viewer.
 	 */ 
@@ -165,11 +210,47 @@ private:
 	 */ 
 	std::vector<dataIO_slot*> dataSlots;
 
+	/**
+	 * Mutex to protect the slot list and the slot values during access via the slot access functions.
+	 */ 
+	OpenThreads::Mutex slotMutex;
+
+	/**
+	 * Published slot snapshots of the latest frames, the newest at the back.
+	 * Under the threaded models, the draw thread may still process an older frame while the main thread publishes the next one.
+	 */ 
+	std::deque< osg::ref_ptr<const dataIO_slotSnapshot> > snapshots;
+
+	/**
+	 * Mutex to protect the list of published snapshots.
+	 */ 
+	mutable OpenThreads::Mutex snapshotMutex;
+
+	/**
+	 * Mutex to serialize the extLink calls of the main thread (read) and the draw thread (writeback).
+	 */ 
+	OpenThreads::Mutex extLinkMutex;
+
+	/**
+	 * Mutex to serialize the cluster send/read calls of the main thread. It is not held during the swap barrier, which blocks until all nodes are ready.
+	 */ 
+	OpenThreads::Mutex clusterMutex;
+
+	/**
+	 * Mutex to serialize the swap barrier calls of the draw threads.
+	 */ 
+	OpenThreads::Mutex swapBarrierMutex;
+
 	/**
 	 * Flag to indicate if dataIO is initialized.
 	 */ 
 	bool initialized;
 
+	/**
+	 * Flag if the cluster connection is established later by connectCluster() instead of during init().
+	 */ 
+	bool clusterConnectDeferred;
+
 	/**
 	 * Curent clustermode of the application. Can be MASTER, SLAVE or STANDALONE.
 	 */ 
@@ -185,6 +266,11 @@ private:
 	 */ 
 	friend class dataIO_eventCallback;
 
+	/**
+	 * The updateCallback-class is friend to be able to work with all dataIO members without setters/getters.
+	 */ 
+	friend class dataIO_updateCallback;
+
 	/**
 	 *  The FinalDrawCallback-class is friend to be able to work with all dataIO members without setters/getters.
 	 */ 
@@ -206,7 +292,25 @@ public:
 	 */ 
 	static visual_dataIO* getInstance();
 
-	void init(osgViewer::Viewer* viewer_, std::string configFileName);
+	/**
+	 * \brief This function initializes dataIO: it parses the configuration, creates cluster and extLink and installs the per frame callbacks.
+	 * 
+	 * @param viewer_ : Viewer to install the callbacks into.
+	 * @param configFileName : XML configuration file.
+	 * @param deferClusterConnect_ : If true, the (possibly blocking) cluster connection is not established, call connectCluster() before the first frame.
+	 */ 
+	void init(osgViewer::Viewer* viewer_, std::string configFileName, bool deferClusterConnect_ = false);
+
+	/**
+	 * \brief This function establishes the cluster connection. If it fails, dataIO falls back to the cluster dummy.
+	 * 
+	 * It does not access the viewer or the scene graph, so it can run in a background thread while the startup continues.
+	 * It must be completed before the first frame.
+	 * 
+	 * @return : True if connected.
+	 */ 
+	bool connectCluster();
+
 	void shutdown();
 	bool isMaster(){if (clusterMode==osgVisual::dataIO_cluster::MASTER) return true; else return false;};
 	bool isSlave(){if (clusterMode==osgVisual::dataIO_cluster::SLAVE) return true; else return false;};
@@ -214,12 +318,35 @@ public:
 
 // SLOT Access functions
 	void* getSlotPointer(std::string slotName_, osgVisual::dataIO_slot::dataDirection direction_, osgVisual::dataIO_slot::varType variableTyp_ );
-	double getSlotDataAsDouble(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_ );
-	std::string getSlotDataAsString(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_ );
-	osgVisual::dataIO_slot* setSlotData(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_, std::string sValue_ );
-	osgVisual::dataIO_slot* setSlotData(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_, double value_ );
+	double getSlotDataAsDouble(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ );
+	std::string getSlotDataAsString(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ );
+	osgVisual::dataIO_slot* setSlotData(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_, const std::string& sValue_ );
+	osgVisual::dataIO_slot* setSlotData(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_, double value_ );
+
+	/**
+	 * \brief This function updates the value of a slot which was returned by setSlotData() or getSlotPointer(). It avoids the lookup by name.
+	 * 
+	 * @param slot_ : Slot to update.
+	 * @param value_ : New value.
+	 */ 
+	void setSlotValue(osgVisual::dataIO_slot* slot_, double value_ );
+
+	int getSlotNum() {OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex); return dataSlots.size();}
 
-	int getSlotNum() {return dataSlots.size();}
+	/**
+	 * \brief This function returns the slot snapshot of a frame. It is thread safe.
+	 * 
+	 * @param frameNumber_ : Number of the frame. If no snapshot of this frame exists, the newest older snapshot is returned.
+	 * @return : Snapshot, NULL if no snapshot was published yet.
+	 */ 
+	osg::ref_ptr<const dataIO_slotSnapshot> getSnapshot( unsigned int frameNumber_ ) const;
+
+	/**
+	 * \brief This function returns the newest published slot snapshot. It is thread safe.
+	 * 
+	 * @return : Snapshot, NULL if no snapshot was published yet.
+	 */ 
+	osg::ref_ptr<const dataIO_slotSnapshot> getLatestSnapshot() const;
 
 };
 
@@ -0,0 +1,189 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Image>
+#include <osg/OperationThread>
+#include <osg/Notify>
+
+#include <distortion_floatMap.h>
+#include <util_workerPool.h>
+
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define DISTORTION_CPUWARP_SSE2
+#endif
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class warps and blends channel images on the CPU, for nodes without GPU, e.g. for commissioning or recording.
+ *
+ * It implements the pipeline of shader.frag / shader_float.frag with the same distortion and blend maps as visual_distortion:
+ * Each target pixel looks up its source texcoord in the distortion map (nearest), samples the undistorted image bilinearly at
+ * this texcoord (clamped to edge) and multiplies the result with the blend map (nearest).
+ *
+ * Two kernels are available:
+ * - REFERENCE evaluates each pixel directly from the maps in double precision. It is slow and serves as reference for validation.
+ * - SIMD uses tables prepared once per image size and processes the four color channels of a pixel with SSE2 (if available at
+ *   compile time, otherwise with equivalent scalar code).
+ *
+ * Both kernels can process the image rows in parallel on the util_workerPool.
+ * Source and target images have to be GL_RGBA with GL_UNSIGNED_BYTE.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class distortion_cpuWarp : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * Available kernels.
+	 */
+	enum kernelType
+	{
+		REFERENCE,
+		SIMD
+	};
+
+	/**
+	 * \brief Constructor
+	 *
+	 * @param distortImage_ : Distortion map, legacy 8 bit or float map.
+	 * @param blendImage_ : Blend map, NULL for no blending.
+	 */
+	distortion_cpuWarp( osg::Image* distortImage_, osg::Image* blendImage_ );
+
+	/**
+	 * \brief This function warps and blends an image.
+	 *
+	 * @param source_ : Undistorted image, GL_RGBA / GL_UNSIGNED_BYTE.
+	 * @param target_ : Image to write into, GL_RGBA / GL_UNSIGNED_BYTE. Its size defines the output resolution.
+	 * @param kernel_ : Kernel to use.
+	 * @param parallel_ : True to process the rows in parallel on the worker pool.
+	 * @return : True if successful.
+	 */
+	bool apply( const osg::Image* source_, osg::Image* target_, kernelType kernel_ = SIMD, bool parallel_ = true );
+
+	/**
+	 * \brief This function compares two images.
+	 *
+	 * @param a_ : First image.
+	 * @param b_ : Second image of the same size and format.
+	 * @param maxDifference_ : Receives the largest difference of a color channel.
+	 * @param numDifferentPixels_ : Receives the number of pixels which differ in any channel.
+	 * @return : False if the images are not comparable.
+	 */
+	static bool compare( const osg::Image* a_, const osg::Image* b_, unsigned int& maxDifference_, unsigned int& numDifferentPixels_ );
+
+	/**
+	 * \brief This function returns if the SIMD kernel uses SSE2 instructions.
+	 *
+	 * @return : True if compiled with SSE2.
+	 */
+	static bool isSSE2Enabled();
+
+private:
+	/**
+	 * \brief This operation processes a range of rows.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class rowOperation : public osg::Operation
+	{
+	public:
+		rowOperation(distortion_cpuWarp* warp_, const osg::Image* source_, osg::Image* target_, kernelType kernel_, int beginRow_, int endRow_)
+			: osg::Operation("distortion_cpuWarp::rowOperation", false), warp(warp_), source(source_), target(target_), kernel(kernel_), beginRow(beginRow_), endRow(endRow_) {};
+
+		virtual void operator () (osg::Object*);
+	private:
+		distortion_cpuWarp* warp;
+		const osg::Image* source;
+		osg::Image* target;
+		kernelType kernel;
+		int beginRow;
+		int endRow;
+	};
+
+	/**
+	 * \brief This function prepares the tables of the SIMD kernel for a target and source size.
+	 *
+	 */
+	void prepare( int targetWidth_, int targetHeight_, int sourceWidth_, int sourceHeight_ );
+
+	/**
+	 * \brief This function processes rows with the reference kernel.
+	 *
+	 */
+	void processRowsReference( const osg::Image* source_, osg::Image* target_, int beginRow_, int endRow_ );
+
+	/**
+	 * \brief This function processes rows with the SIMD kernel.
+	 *
+	 */
+	void processRowsSIMD( const osg::Image* source_, osg::Image* target_, int beginRow_, int endRow_ );
+
+	/**
+	 * \brief This function returns the target texcoord of a pixel of the distortion map.
+	 *
+	 */
+	osg::Vec2 getWarp( int column_, int row_ ) const;
+
+	/**
+	 * \brief This function returns the blend color of a pixel of the blend map, like a texture lookup returns it.
+	 *
+	 */
+	osg::Vec4 getBlend( int column_, int row_ ) const;
+
+	/**
+	 * Distortion map
+	 */
+	osg::ref_ptr<osg::Image> distortImage;
+
+	/**
+	 * Blend map
+	 */
+	osg::ref_ptr<osg::Image> blendImage;
+
+	/**
+	 * Size the tables are prepared for: target width, target height, source width, source height.
+	 */
+	int preparedSize[4];
+
+	/**
+	 * Source position for each target pixel, in source texels relative to the texel centers.
+	 */
+	std::vector<float> sourcePositions;
+
+	/**
+	 * Blend map converted to four floats per pixel.
+	 */
+	std::vector<float> blendColors;
+
+	/**
+	 * Blend map column for each target column and blend map row for each target row.
+	 */
+	std::vector<int> blendColumns;
+	std::vector<int> blendRows;
+};
+
+}	// END NAMESPACE
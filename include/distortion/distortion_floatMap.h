@@ -0,0 +1,136 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Image>
+#include <osg/Texture>
+#include <osg/Vec2>
+#include <osg/Notify>
+
+#include <util_mappedFile.h>
+
+#include <string>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class reads and writes distortion and blend maps in the raw float format (*.fmap).
+ *
+ * The legacy 8 bit distortion maps of Projection Designer pack the target texcoord into a 16x16 tile index (red) and sub tile offsets
+ * (green, blue), which limits the precision to 1/4080 and requires decoding per texel. A float map stores the target texcoord
+ * directly as two float32 values per pixel, a blend map as one, three or four float32 values per pixel.
+ *
+ * The file is memory mapped and the image points directly into the mapping, so it is uploaded as texture without conversion:
+ * warp maps as GL_LUMINANCE_ALPHA32F_ARB (s in luminance, t in alpha), blend maps as GL_LUMINANCE32F_ARB, GL_RGB32F_ARB or GL_RGBA32F_ARB.
+ *
+ * File layout (native byte order): fileHeader, followed by width x height x numChannels float32 values, row by row, beginning with
+ * the bottom row (t=0) like osg::Image.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class distortion_floatMap
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This function returns if the filename denotes a float map.
+	 *
+	 * @param filename_ : Filename to check.
+	 * @return : True if the extension is "fmap".
+	 */
+	static bool isFloatMap( const std::string& filename_ );
+
+	/**
+	 * \brief This function maps a float map into memory and returns it as image, which references the mapping.
+	 *
+	 * @param filename_ : File to read.
+	 * @return : Image with GL_FLOAT data, NULL on error.
+	 */
+	static osg::Image* read( const std::string& filename_ );
+
+	/**
+	 * \brief This function writes an image with GL_FLOAT data as float map.
+	 *
+	 * @param filename_ : File to write.
+	 * @param image_ : Image to write, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB or GL_RGBA with GL_FLOAT data.
+	 * @return : True if successful.
+	 */
+	static bool write( const std::string& filename_, const osg::Image* image_ );
+
+	/**
+	 * \brief This function converts a legacy 8 bit distortion map into a float warp map.
+	 *
+	 * @param image_ : Legacy distortion map (RGB or RGBA, unsigned byte).
+	 * @return : Float image with two channels, NULL if the format is not supported.
+	 */
+	static osg::Image* convertLegacyWarpMap( const osg::Image* image_ );
+
+	/**
+	 * \brief This function converts an 8 bit blend map into a float blend map with the same number of channels.
+	 *
+	 * @param image_ : Blend map (luminance, RGB or RGBA, unsigned byte).
+	 * @return : Float image, NULL if the format is not supported.
+	 */
+	static osg::Image* convertBlendMap( const osg::Image* image_ );
+
+	/**
+	 * \brief This function decodes the texcoord of a pixel of a legacy 8 bit distortion map.
+	 *
+	 * @param pixel_ : Pointer to the RGB values of the pixel.
+	 * @return : Target texcoord.
+	 */
+	static inline osg::Vec2 decodeLegacyPixel( const unsigned char* pixel_ )
+	{
+		// High nibbles of the target texcoord in red, low bytes in blue (s) and green (t).
+		return osg::Vec2( ((float)pixel_[2] / 255.0f + (pixel_[0] % 16)) / 16.0f,
+						  1.0f - ((float)pixel_[1] / 255.0f + (pixel_[0] / 16)) / 16.0f );
+	}
+
+private:
+	/**
+	 * \brief Header at the begin of the file.
+	 *
+	 */
+	struct fileHeader
+	{
+		char magic[4];				// "OVFM"
+		unsigned int version;
+		unsigned int width;
+		unsigned int height;
+		unsigned int numChannels;	// 1, 2, 3 or 4
+		unsigned int reserved[3];
+	};
+
+	/**
+	 * \brief This image keeps the file mapping alive as long as the image data is referenced.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class mappedImage : public osg::Image
+	{
+	public:
+		mappedImage(util_mappedFile* file_) : file(file_) {};
+	private:
+		osg::ref_ptr<util_mappedFile> file;
+	};
+};
+
+}	// END NAMESPACE
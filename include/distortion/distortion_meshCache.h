@@ -0,0 +1,169 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Array>
+#include <osg/PrimitiveSet>
+#include <osg/Image>
+#include <osg/Notify>
+
+#include <util_mappedFile.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class stores the resolved distortion mesh, blend data and camera frustum of a channel in a binary cache file.
+ *
+ * Decoding the distortion map into the warp mesh and parsing the channel configuration takes seconds. The cache file is written
+ * next to the distortion map after the first start and memory mapped on later starts. It is rebuilt if one of its source files
+ * (channel configuration, distortion map, blend map) changed: a source is unchanged if its size and modification time are equal,
+ * or, if only the modification time differs, if its FNV-1a hash is equal.
+ *
+ * File layout (native byte order):
+ * - fileHeader
+ * - numSources x sourceHeader
+ * - numVertices x 2 floats vertex positions, numVertices x 2 floats warp texcoords, numVertices x 2 floats screen texcoords
+ * - numIndices x unsigned int triangle indices
+ * - numImages x (imageHeader, image data padded to 8 byte)
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class distortion_meshCache
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This struct contains the resolved data of one channel.
+	 *
+	 */
+	struct channelData
+	{
+		channelData() : frustumValid(false), rotation(3,0.0), translation(3,0.0) {};
+
+		bool frustumValid;
+		std::vector<double> frustum;					// left, right, bottom, top, near, far
+		std::vector<double> rotation;					// XYZ in degree
+		std::vector<double> translation;				// XYZ in meter
+		osg::ref_ptr<osg::Vec2Array> vertices;			// Vertex positions, normalized to [0..1] of the channel viewport
+		osg::ref_ptr<osg::Vec2Array> texcoords;			// Texcoords into the rendered scene, including the warp
+		osg::ref_ptr<osg::Vec2Array> texcoords2;		// Texcoords into the blend map
+		osg::ref_ptr<osg::DrawElementsUInt> indices;	// GL_TRIANGLES
+		osg::ref_ptr<osg::Image> distortImage;			// Distortion map, only required for shader distortion
+		osg::ref_ptr<osg::Image> blendImage;			// Blend map
+	};
+
+	/**
+	 * \brief This function returns the cache filename for a channel, which is located next to the distortion map.
+	 *
+	 * @param distortMapFileName_ : Filename of the channel's distortion map.
+	 * @return : Filename of the cache file.
+	 */
+	static std::string getCacheFilename( const std::string& distortMapFileName_ );
+
+	/**
+	 * \brief This function loads the channel data from the cache, if the cache is valid for the specified sources and build options.
+	 *
+	 * @param cacheFilename_ : Cache file to load.
+	 * @param sourceFiles_ : Files the cache was built from. Missing files are allowed, if they were missing while the cache was built.
+	 * @param buildOptions_ : Value which identifies the options used to build the mesh. A cache built with other options is outdated.
+	 * @param data_ : Channel data to fill.
+	 * @return : True if the cache is valid and was loaded, false if it has to be rebuilt.
+	 */
+	static bool load( const std::string& cacheFilename_, const std::vector<std::string>& sourceFiles_, unsigned int buildOptions_, channelData& data_ );
+
+	/**
+	 * \brief This function writes the channel data into the cache file.
+	 *
+	 * @param cacheFilename_ : Cache file to write.
+	 * @param sourceFiles_ : Files the channel data was built from.
+	 * @param buildOptions_ : Value which identifies the options used to build the mesh.
+	 * @param data_ : Channel data to write.
+	 * @return : True if successful.
+	 */
+	static bool write( const std::string& cacheFilename_, const std::vector<std::string>& sourceFiles_, unsigned int buildOptions_, const channelData& data_ );
+
+private:
+	/**
+	 * \brief Header at the begin of the file.
+	 *
+	 */
+	struct fileHeader
+	{
+		char magic[4];				// "OVDC"
+		unsigned int version;
+		unsigned int buildOptions;
+		unsigned int numSources;
+		unsigned int frustumValid;
+		unsigned int numVertices;
+		unsigned int numIndices;
+		unsigned int numImages;
+		double frustum[6];
+		double rotation[3];
+		double translation[3];
+	};
+
+	/**
+	 * \brief Identification of a source file.
+	 *
+	 */
+	struct sourceHeader
+	{
+		long long size;				// -1 if the file does not exist
+		long long modificationTime;
+		unsigned long long hash;
+	};
+
+	/**
+	 * \brief Header of an image, followed by the image data.
+	 *
+	 */
+	struct imageHeader
+	{
+		int s;
+		int t;
+		int internalTextureFormat;
+		unsigned int pixelFormat;
+		unsigned int dataType;
+		unsigned int packing;
+		unsigned long long dataSize;	// 0 if no image is stored
+	};
+
+	/**
+	 * \brief This function determines size and modification time of a file and optionally its hash.
+	 *
+	 * @param filename_ : File to examine.
+	 * @param source_ : Source header to fill.
+	 * @param computeHash_ : True to compute the hash of the file content.
+	 */
+	static void getSourceInfo( const std::string& filename_, sourceHeader& source_, bool computeHash_ );
+
+	/**
+	 * \brief This function computes the 64 bit FNV-1a hash of a file.
+	 *
+	 * @param filename_ : File to hash.
+	 * @return : Hash value, 0 if the file is not readable.
+	 */
+	static unsigned long long computeHash( const std::string& filename_ );
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,195 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Array>
+#include <osg/PrimitiveSet>
+#include <osg/Image>
+#include <osg/Vec2>
+#include <osg/Notify>
+
+#include <distortion_floatMap.h>
+
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class generates an adaptive warp mesh from a Projection Designer distortion map.
+ *
+ * The mesh is a restricted quadtree over the channel viewport: A cell is subdivided if the bilinear interpolation of its corners deviates
+ * from the distortion map by more than the tolerance, measured in texels of the rendered scene texture. This deviation grows with the
+ * second derivative of the warp, so strongly curved regions like dome edges are refined while the flat center stays coarse.
+ *
+ * Neighbouring leaf cells differ by at most one level (2:1 balance). A cell with a finer neighbour is triangulated as fan around its
+ * center which includes the midpoint of the shared edge, so the mesh is free of T-junctions and cracks.
+ * The whole mesh is emitted as one indexed GL_TRIANGLES list.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class distortion_meshGenerator
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This struct contains the deviation of a mesh from the distortion map.
+	 *
+	 */
+	struct errorReport
+	{
+		errorReport() : numVertices(0), numTriangles(0), maxError(0.0), meanError(0.0) {};
+
+		unsigned int numVertices;
+		unsigned int numTriangles;
+		double maxError;	// in texels of the scene texture
+		double meanError;	// in texels of the scene texture
+	};
+
+	/**
+	 * \brief Constructor
+	 *
+	 * @param distortImage_ : Distortion map to sample.
+	 * @param textureWidth_ : Width of the rendered scene texture, used to measure errors in texels.
+	 * @param textureHeight_ : Height of the rendered scene texture, used to measure errors in texels.
+	 */
+	distortion_meshGenerator( osg::Image* distortImage_, unsigned int textureWidth_, unsigned int textureHeight_ );
+
+	/**
+	 * \brief This function sets the maximal allowed deviation of the mesh from the distortion map.
+	 *
+	 * @param tolerance_ : Tolerance in texels of the scene texture.
+	 */
+	void setTolerance( double tolerance_ ) {tolerance = tolerance_;};
+
+	/**
+	 * \brief This function sets the coarsest and the finest quadtree level. Level n corresponds to a uniform grid of 2^n x 2^n cells.
+	 *
+	 * @param minLevel_ : Coarsest level, all cells are subdivided at least to this level.
+	 * @param maxLevel_ : Finest level, limited to 10.
+	 */
+	void setLevels( unsigned int minLevel_, unsigned int maxLevel_ );
+
+	/**
+	 * \brief This function generates the adaptive mesh.
+	 *
+	 * @param vertices_ : Receives the vertex positions, normalized to [0..1].
+	 * @param texcoords_ : Receives the warped texcoords into the scene texture.
+	 * @param indices_ : Receives the triangle indices.
+	 */
+	void generate( osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_, osg::DrawElementsUInt* indices_ );
+
+	/**
+	 * \brief This function generates a uniform grid mesh as it was used before the adaptive mesh, e.g. for comparison.
+	 *
+	 * @param steps_ : Number of vertices per row and column, at least 2.
+	 * @param vertices_ : Receives the vertex positions, normalized to [0..1].
+	 * @param texcoords_ : Receives the warped texcoords into the scene texture.
+	 * @param indices_ : Receives the triangle indices.
+	 */
+	void generateUniform( unsigned int steps_, osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_, osg::DrawElementsUInt* indices_ );
+
+	/**
+	 * \brief This function measures the deviation of a mesh from the distortion map on a regular grid of sample points.
+	 *
+	 * @param vertices_ : Normalized vertex positions of the mesh.
+	 * @param texcoords_ : Texcoords of the mesh.
+	 * @param indices_ : Triangle indices of the mesh.
+	 * @return : Error report.
+	 */
+	errorReport computeError( const osg::Vec2Array* vertices_, const osg::Vec2Array* texcoords_, const osg::DrawElementsUInt* indices_ ) const;
+
+	/**
+	 * \brief This function returns the texcoord into the scene texture at a position of the viewport as defined by the distortion map.
+	 *
+	 * The map is interpolated bilinearly between its pixels.
+	 *
+	 * @param u_ : Normalized horizontal position.
+	 * @param v_ : Normalized vertical position.
+	 * @return : Warped texcoord.
+	 */
+	osg::Vec2 getWarp( double u_, double v_ ) const;
+
+private:
+	/**
+	 * \brief This function returns if a quadtree cell is subdivided.
+	 *
+	 */
+	bool isSplit( unsigned int level_, int x_, int y_ ) const;
+
+	/**
+	 * \brief This function subdivides a quadtree cell and all its ancestors.
+	 *
+	 */
+	void forceSplit( unsigned int level_, int x_, int y_ );
+
+	/**
+	 * \brief This function returns the maximal deviation of the bilinear interpolation of a cell from the distortion map.
+	 *
+	 * @return : Deviation in texels of the scene texture.
+	 */
+	double computeCellError( unsigned int level_, int x_, int y_ ) const;
+
+	/**
+	 * \brief This function decodes the texcoord stored in a pixel of the distortion map, either a legacy 8 bit or a float warp map.
+	 *
+	 */
+	osg::Vec2 decodePixel( int s_, int t_ ) const;
+
+	/**
+	 * \brief This function returns the distance between two texcoords in texels of the scene texture.
+	 *
+	 */
+	double getTexelDistance( const osg::Vec2& a_, const osg::Vec2& b_ ) const;
+
+	/**
+	 * \brief This function returns the index of the vertex at a position of the finest grid and creates it if required.
+	 *
+	 */
+	unsigned int getVertex( int ix_, int iy_, std::vector<int>& vertexIndex_, osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_ );
+
+	/**
+	 * Distortion map
+	 */
+	osg::ref_ptr<osg::Image> distortImage;
+
+	/**
+	 * Size of the scene texture.
+	 */
+	unsigned int textureWidth;
+	unsigned int textureHeight;
+
+	/**
+	 * Tolerance in texels.
+	 */
+	double tolerance;
+
+	/**
+	 * Coarsest and finest quadtree level.
+	 */
+	unsigned int minLevel;
+	unsigned int maxLevel;
+
+	/**
+	 * Subdivision flags of the quadtree cells for each level below maxLevel, row by row.
+	 */
+	std::vector< std::vector<unsigned char> > split;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,145 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Math>
+#include <osg/Notify>
+
+#include <cmath>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class chooses the resolution scale of the distortion pre-render pass from the measured frame time.
+ *
+ * The frame time is smoothed by an exponential moving average. If the smoothed frame time exceeds the target frame time,
+ * the scale is reduced proportional to the overload (the rendered pixel count scales with the square of the scale factor).
+ * If there is headroom, the scale is raised again step by step. As a synchronized buffer swap hides the headroom
+ * (the frame time never drops below the refresh period), a higher scale is also probed periodically after the last reduction.
+ *
+ * Scale factors are quantized to 1/64 to avoid viewport changes on every frame.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class distortion_resolutionController : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 * @param targetFrameTime_ : Frame time to achieve in ms.
+	 * @param minScale_ : Lowest allowed scale factor of the pre-render resolution.
+	 * @param maxScale_ : Highest allowed scale factor of the pre-render resolution.
+	 */
+	distortion_resolutionController( double targetFrameTime_ = 16.6, double minScale_ = 0.5, double maxScale_ = 1.0 );
+
+	/**
+	 * \brief This function processes the frame time of the elapsed frame and returns the scale factor to use for the next frame.
+	 *
+	 * @param frameTime_ : Duration of the elapsed frame in ms.
+	 * @param time_ : Simulation time of the frame in s, used for the hold times between changes.
+	 * @return : Scale factor of the pre-render resolution.
+	 */
+	double update( double frameTime_, double time_ );
+
+	/**
+	 * \brief This function returns the actual scale factor.
+	 *
+	 * @return : Scale factor of the pre-render resolution.
+	 */
+	double getScale() {return scale;};
+
+	/**
+	 * \brief This function returns the smoothed frame time.
+	 *
+	 * @return : Smoothed frame time in ms, 0 before the first update.
+	 */
+	double getSmoothedFrameTime() {return smoothedFrameTime;};
+
+	/**
+	 * \brief This function sets the weight of the latest frame time in the moving average.
+	 *
+	 * @param smoothing_ : Weight in ]0..1], 1 means no smoothing. Default is 0.1.
+	 */
+	void setSmoothing( double smoothing_ ) {smoothing = osg::clampBetween( smoothing_, 0.001, 1.0 );};
+
+	/**
+	 * \brief This function sets the interval to probe a higher scale while the target frame time is met.
+	 *
+	 * @param probeInterval_ : Interval in s. Default is 5 s.
+	 */
+	void setProbeInterval( double probeInterval_ ) {probeInterval = probeInterval_;};
+
+private:
+	/**
+	 * \brief This function changes the scale factor.
+	 *
+	 * @param scale_ : New scale factor, clamped and quantized.
+	 * @param time_ : Time of the change in s.
+	 */
+	void setScale( double scale_, double time_ );
+
+	/**
+	 * Frame time to achieve in ms.
+	 */
+	double targetFrameTime;
+
+	/**
+	 * Lowest allowed scale factor.
+	 */
+	double minScale;
+
+	/**
+	 * Highest allowed scale factor.
+	 */
+	double maxScale;
+
+	/**
+	 * Actual scale factor.
+	 */
+	double scale;
+
+	/**
+	 * Smoothed frame time in ms.
+	 */
+	double smoothedFrameTime;
+
+	/**
+	 * Weight of the latest frame time in the moving average.
+	 */
+	double smoothing;
+
+	/**
+	 * Interval in s to probe a higher scale while the target frame time is met.
+	 */
+	double probeInterval;
+
+	/**
+	 * Time of the last scale change in s.
+	 */
+	double lastChangeTime;
+
+	/**
+	 * Number of processed frames.
+	 */
+	unsigned int numFrames;
+};
+
+}	// END NAMESPACE
@@ -23,6 +23,10 @@
 #include <osg/TextureRectangle>
 #include <osg/Notify>
 #include <osg/Referenced>
+#include <osg/Timer>
+#include <osg/TexMat>
+#include <osg/Viewport>
+#include <osg/Uniform>
 
 #include <osgViewer/Viewer>
 
@@ -33,6 +37,14 @@
 #include <osgGA/GUIActionAdapter>
 
 #include <visual_util.h>
+#include <util_profiler.h>
+#include <util_allocTracker.h>
+#include <util_log.h>
+#include <util_workerPool.h>
+#include <distortion_meshCache.h>
+#include <distortion_meshGenerator.h>
+#include <distortion_floatMap.h>
+#include <distortion_resolutionController.h>
 
 #include <string>
 #include <iostream>
@@ -102,11 +114,40 @@ public:
 	void toggleDistortion();
 
 	/**
-	 * \brief This functions returns a pointer to the scene camera, which renders the undistorted scene (PRE_RENDER).
+	 * \brief This functions returns a pointer to the scene camera of the first channel, which renders the undistorted scene (PRE_RENDER).
 	 * 
 	 * @return Pointer to the scene camera.
 	 */ 
-	osg::Camera* getSceneCamera() {return sceneCamera;};
+	osg::Camera* getSceneCamera() {return getSceneCamera(0);};
+
+	/**
+	 * \brief This functions returns a pointer to the scene camera of the specified channel.
+	 * 
+	 * @param channel_ : Index of the channel.
+	 * @return Pointer to the scene camera, NULL if the channel does not exist or the distortion is not initialized.
+	 */ 
+	osg::Camera* getSceneCamera(unsigned int channel_) {return channel_ < channels.size() ? channels[channel_].sceneCamera.get() : NULL;};
+
+	/**
+	 * \brief This function returns the number of channels rendered by this distortion.
+	 * 
+	 * @return : Number of channels.
+	 */ 
+	unsigned int getNumChannels() {return channels.size();};
+
+	/**
+	 * \brief This function sets the resolution of the scene cameras relative to the render texture size. The distortion meshes sample only the rendered area.
+	 * 
+	 * @param scale_ : Scale factor in ]0..1].
+	 */ 
+	void setResolutionScale( double scale_ );
+
+	/**
+	 * \brief This function returns the resolution of the scene cameras relative to the render texture size.
+	 * 
+	 * @return : Scale factor in ]0..1].
+	 */ 
+	double getResolutionScale() {return resolutionScale;};
 
 	/**
 	 * \brief This function returns the distortedSceneGraph if the distortion module is initialized.
@@ -116,25 +157,25 @@ public:
 	osg::Group* getDistortedSceneGraph() { if(initialized) return distortedGraph; else return NULL;};
 
 	/**
-	 * \brief The function returns the frustum values which are parsed by the nested cameraConfigParser class.
+	 * \brief The function returns the frustum values of the first channel which are parsed by the nested cameraConfigParser class.
 	 * 
 	 * @return : Vector of double values which represent the frustum dataset. The order is the standart glu order.
 	 */ 
-	std::vector<double> getFrustumDataset() {return parser->getFrustumDataset();};
+	std::vector<double> getFrustumDataset() {return channels.empty() ? std::vector<double>() : channels.front().parser->getFrustumDataset();};
 			
 	/**
-	 * \brief This function returns the retation values for the rendering camera for XYZ axis in degree.
+	 * \brief This function returns the retation values for the rendering camera of the first channel for XYZ axis in degree.
 	 * 
 	 * @return : Vector of double values which represent the rotation values for XYZ axis in degree.
 	 */ 
-	std::vector<double> getRotationDataset() {return parser->getRotationDataset();};
+	std::vector<double> getRotationDataset() {return channels.empty() ? std::vector<double>() : channels.front().parser->getRotationDataset();};
 
 	/**
-	 * \brief This function returns the translation values for the rendering camera along the XYZ axis in meter.
+	 * \brief This function returns the translation values for the rendering camera of the first channel along the XYZ axis in meter.
 	 * 
 	 * @return : Vector of double values which represent the translation values for XYZ axis in meter.
 	 */ 
-	std::vector<double> getTranslationDataset() {return parser->getTranslationDataset();};
+	std::vector<double> getTranslationDataset() {return channels.empty() ? std::vector<double>() : channels.front().parser->getTranslationDataset();};
 
 private:
 	/**
@@ -151,10 +192,10 @@ private:
 		 * \brief Constructor, for setting the member variables.
 		 * 
 		 * @param viewer_ : Pointer to the viewer.
-		 * @param sceneCamera_ : Pointer to the scene camera.
+		 * @param distortion_ : Pointer to the distortion class, which contains the channels to update.
 		 */ 
-		distortionUpdateCallback(osgViewer::Viewer* viewer_, osg::Camera* sceneCamera_)
-			: viewer(viewer_), sceneCamera(sceneCamera_) {};
+		distortionUpdateCallback(osgViewer::Viewer* viewer_, visual_distortion* distortion_)
+			: viewer(viewer_), distortion(distortion_), lastReferenceTime(-1.0) {};
 
 		/**
 		 * \brief This function is executed as callback during update traversal.
@@ -168,9 +209,14 @@ private:
 		osg::ref_ptr<osgViewer::Viewer> viewer;
 
 		/**
-		 * Referenced Pointer to the scene camera.
+		 * Pointer to the distortion class. A Referenced Pointer is _NOT_ used to avoid a circular reference (distortion->updateCallback, updateCallback->distortion).
+		 */ 
+		visual_distortion* distortion;
+
+		/**
+		 * Reference time of the last frame in s, used to measure the frame time for the dynamic resolution.
 		 */ 
-		osg::ref_ptr<osg::Camera> sceneCamera;
+		double lastReferenceTime;
 	};
 
 	/**
@@ -347,6 +393,21 @@ private:
 		std::vector<double> getTranslationDataset() {return(translationValues);}
 
 		bool isConfigParsed() {return configParsed;};
+
+		/**
+		 * \brief This function sets the datasets without parsing, e.g. from the distortion cache.
+		 * 
+		 * @param frustum_ : Frustum values, the config counts as parsed if it contains six values.
+		 * @param rotation_ : Rotation values for XYZ axis in degree.
+		 * @param translation_ : Translation values for XYZ axis in meter.
+		 */ 
+		void setDatasets(const std::vector<double>& frustum_, const std::vector<double>& rotation_, const std::vector<double>& translation_)
+		{
+			frustumValues = frustum_;
+			rotationValues = rotation_;
+			translationValues = translation_;
+			configParsed = (frustumValues.size() == 6);
+		}
 	private:
 		bool configParsed;
 		std::vector<double> frustumValues;
@@ -354,6 +415,64 @@ private:
 		std::vector<double> translationValues;
 	};
 
+	/**
+	 * \brief This struct contains the configuration and the render setup of one distortion channel.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	struct channelSetup
+	{
+		channelSetup() : cached(false), useChannelFrustum(false), x(0.0), y(0.0), width(1.0), height(1.0) {parser = new CameraConfigParser();};
+
+		std::string name;							// Channelname, empty if no channelname is configured
+		std::string cfgFileName;					// Channel configuration, empty if no channelname is configured
+		std::string distortMapFileName;
+		std::string blendMapFileName;
+		std::string cacheFileName;
+		distortion_meshCache::channelData data;		// Resolved distortion mesh, blend data and frustum
+		bool cached;								// Channel data was loaded from a valid distortion cache
+		osg::ref_ptr<CameraConfigParser> parser;	// Frustum, rotation and translation of the channel
+		osg::ref_ptr<osg::Camera> sceneCamera;		// PRE_RENDER camera which renders the undistorted scene of this channel
+		osg::Matrixd viewOffset;					// Applied to the main cameras view matrix
+		osg::ref_ptr<osg::TexMat> texMat;			// Restricts the mesh distortion to the rendered area of the scene texture
+		osg::ref_ptr<osg::Uniform> textureScale;	// Restricts the shader distortion to the rendered area of the scene texture
+		bool useChannelFrustum;						// Use the channels frustum instead of the main cameras projection
+		double x, y, width, height;					// Area of the window covered by the channel, normalized to [0..1]
+	};
+
+	/**
+	 * \brief This operation loads or builds one channel, so all channels can be prepared in parallel by util_workerPool.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class channelOperation : public osg::Operation
+	{
+	public:
+		channelOperation(visual_distortion* distortion_, channelSetup* channel_, bool build_)
+			: osg::Operation("visual_distortion::channelOperation", false), distortion(distortion_), channel(channel_), build(build_) {};
+
+		virtual void operator () (osg::Object*)
+		{
+			if( build )
+				distortion->buildChannel( *channel );
+			else
+				distortion->loadChannel( *channel );
+		}
+	private:
+		visual_distortion* distortion;
+		channelSetup* channel;
+		bool build;
+	};
+
+	/**
+	 * \brief This function loads or builds the channels in parallel. The channels are independent, each operation only touches its own channelSetup.
+	 * 
+	 * @param build_ : True to build the uncached channels, false to load all channels.
+	 */ 
+	void prepareChannels( bool build_ );
+
 
 
 	/**
@@ -376,6 +495,54 @@ private:
 	 */ 
 	osg::Group* createPreRenderSubGraph(osg::Group* subgraph, const osg::Vec4& clearColor );
 
+	/**
+	 * \brief This function creates the render to texture camera and the distortion mesh of one channel.
+	 * 
+	 * @param channel_ : Channel to create the cameras and the mesh for.
+	 * @param subgraph : Undistorted scene graph to render.
+	 * @param clearColor : OpenGL clear color for the scene camera.
+	 * @param distortionCamera : Camera which renders the distortion meshes of all channels.
+	 * @return : Scene camera of the channel (PRE_RENDER).
+	 */ 
+	osg::Camera* createChannelSubGraph( channelSetup& channel_, osg::Group* subgraph, const osg::Vec4& clearColor, osg::Camera* distortionCamera );
+
+	/**
+	 * \brief This function sets the file names of a channel from its channelname.
+	 * 
+	 * @param channel_ : Channel to configure.
+	 * @param channelname_ : Name of the channel, used to find view_<channelname>.cfg, distort_<channelname>.bmp and blend_<channelname>.bmp.
+	 */ 
+	void setChannelName( channelSetup& channel_, const std::string& channelname_ );
+
+	/**
+	 * \brief This function loads the channel from the distortion cache, or parses the channel configuration if the cache is outdated.
+	 * 
+	 * @param channel_ : Channel to load.
+	 */ 
+	void loadChannel( channelSetup& channel_ );
+
+	/**
+	 * \brief This function builds the distortion mesh from the distortion and blend map and writes the distortion cache.
+	 * 
+	 * @param channel_ : Channel to build.
+	 */ 
+	void buildChannel( channelSetup& channel_ );
+
+	/**
+	 * \brief This function returns the value which identifies the options used to build the distortion mesh.
+	 * 
+	 * @return : Build options for the distortion cache.
+	 */ 
+	unsigned int getMeshBuildOptions();
+
+	/**
+	 * \brief This function returns the files the channel is built from: channel configuration, distortion map and blend map.
+	 * 
+	 * @param channel_ : Channel to return the files for.
+	 * @return : List of source files.
+	 */ 
+	std::vector<std::string> getChannelSourceFiles( const channelSetup& channel_ );
+
 	/**
 	 * \brief This function loads a shader source file
 	 * 
@@ -386,24 +553,21 @@ private:
 	bool loadShaderSource( osg::Shader* shader, const std::string& fileName );
 
 	/**
-	 * \brief This function loads a shader Texture file
+	 * \brief This function reads a distortion or blend map, either a float map (*.fmap) or an image file.
 	 * 
-	 * @param fileName : Texture file to load.
-	 * @return : Returns the loaded Texture.
+	 * @param fileName : Map file to read.
+	 * @return : Image, NULL if the file is not readable.
 	 */ 
-	osg::Texture* loadTexture( const std::string& fileName );
-	
-	/**
-	 * Referenced Pointer to the loaded distortion Map
-	 */ 
-	osg::ref_ptr<osg::Texture> distortMapTexture;
+	osg::Image* readMapImage( const std::string& fileName );
 
 	/**
-	 * Referenced Pointer to the loaded blend map
+	 * \brief This function creates a distortion or blend texture from an image.
+	 * 
+	 * @param image : Image to use.
+	 * @return : Texture, NULL if no image is provided.
 	 */ 
-	osg::ref_ptr<osg::Texture> blendMapTexture;
-
-
+	osg::Texture* createTexture( osg::Image* image );
+	
 	/**
 	 * Flag which indicates the initialization status
 	 */ 
@@ -424,21 +588,11 @@ private:
 	 */ 
 	osg::ref_ptr<osg::Group> cleanGraph;
 
-	/**
-	 * Reference pointer to the scen camera (PRE_RENDER)
-	 */ 
-	osg::ref_ptr<osg::Camera> sceneCamera;
-
 	/**
 	 * Referenced pointer to the main applications viewer
 	 */ 
 	osg::ref_ptr<osgViewer::Viewer> viewer;
 
-	/**
-	 * Parser object for parsing the camera configuration file which controlls frustum and camera PAT
-	 */ 
-	osg::ref_ptr<CameraConfigParser> parser;
-
 	/**
 	 * Texture width for render to texture (RTT).
 	 */ 
@@ -465,20 +619,40 @@ private:
 	bool useHDR;
 
 	/**
-	 * Filename of the distorion map.
+	 * Maximal deviation of the adaptive distortion mesh from the distortion map in texels of the scene texture.
 	 */ 
-	std::string distortMapFileName;
+	double meshTolerance;
 
 	/**
-	 * Filename of the blend map.
+	 * Coarsest quadtree level of the adaptive distortion mesh.
 	 */ 
-	std::string blendMapFileName;
+	unsigned int meshMinLevel;
+
+	/**
+	 * Finest quadtree level of the adaptive distortion mesh.
+	 */ 
+	unsigned int meshMaxLevel;
+
+	/**
+	 * Channels rendered by this distortion. Without <channel> entries in the configuration it contains exactly one channel which covers the whole window.
+	 */ 
+	std::vector<channelSetup> channels;
 
 	/**
 	 * XML config filename
 	 */ 
 	std::string configFileName;
 
+	/**
+	 * Controller for the dynamic resolution of the scene cameras, NULL if the resolution is fixed.
+	 */ 
+	osg::ref_ptr<distortion_resolutionController> resolutionController;
+
+	/**
+	 * Resolution of the scene cameras relative to the render texture size.
+	 */ 
+	double resolutionScale;
+
 	/**
 	 * Reference to the global ArgumentParser. The arguments are required to add the help entry for the toggle distortion key. All other configuration is located in the XML file.
 	 */ 
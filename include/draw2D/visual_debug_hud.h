@@ -19,10 +19,12 @@
 #include <iostream>
 #include <iomanip>
 
-#include <osg/NodeCallback>
-
 #include <visual_draw2D.h>
 #include <visual_util.h>
+#include <util_profiler.h>
+#include <util_allocTracker.h>
+#include <util_frameArena.h>
+#include <util_taskScheduler.h>
 
 
 namespace osgVisual
@@ -31,6 +33,7 @@ namespace osgVisual
 /**
  * \brief This class prints debug information about LAT, LON, HAT, HOT on screen.
  * 
+ * The values are queried by a frame job of util_taskScheduler, the texts are updated by a main thread job.
  * 
  * @author Torben Dannhauer
  * @date  Jan 2010
@@ -83,25 +86,35 @@ private:
 
 
 
-	class HudUpdateCallback : public osg::NodeCallback
+	/**
+	 * \brief Frame job which queries the values to display from the camera position and the terrain.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class hudQueryJob : public util_taskScheduler::job
 	{
 	public:
 		/**
 		 * \brief Constructor
 		 * 
+		 * @param hud_ : HUD which receives the values.
 		 * @param csn_ : Pointer to the Coordinate System Node. Necessary to extract lat, lon and height of the camera position.
 		 * @param sceneCamera_ : Pointer to the scene camera (undistorted camera, type PRE_RENDER)
-		 * @param sky_ : Pointer to the sky system.
 		 */ 
-		HudUpdateCallback(osg::CoordinateSystemNode* csn_, osg::Camera* sceneCamera_)
-			: csn(csn_), sceneCamera(sceneCamera_) {};
+		hudQueryJob(visual_debug_hud* hud_, osg::CoordinateSystemNode* csn_, osg::Camera* sceneCamera_);
 
 		/**
-		 * \brief This function is executed as callback during traversal. It updates values to display.
+		 * \brief This function queries the values to display.
 		 * 
 		 */ 
-		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv);
+		virtual void run( unsigned int begin_, unsigned int end_ );
 	private:
+		/**
+		 * HUD which receives the values. It owns this job.
+		 */ 
+		visual_debug_hud* hud;
+
 		/**
 		 * Referenced pointer to the Coordinate System Node. Necessary to extract lat, lon and height of the camera position.
 		 */ 
@@ -115,16 +128,63 @@ private:
 	};	// Nested class END
 
 	/**
-	 * Referenced Pointer to the updatecallback, which is installed at this node. 
+	 * \brief Main thread job which updates the texts from the queried values.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class hudTextJob : public util_taskScheduler::job
+	{
+	public:
+		/**
+		 * \brief Constructor
+		 * 
+		 * @param hud_ : HUD whose texts are updated. It owns this job.
+		 */ 
+		hudTextJob(visual_debug_hud* hud_);
+
+		/**
+		 * \brief This function updates the texts.
+		 * 
+		 */ 
+		virtual void run( unsigned int begin_, unsigned int end_ );
+	private:
+		/**
+		 * \brief This function sets a new text if it differs from the displayed one.
+		 * 
+		 * @param text_ : Text drawable to update.
+		 * @param displayed_ : Currently displayed text, updated by this function.
+		 * @param value_ : New text.
+		 */ 
+		static void updateText( osgText::Text* text_, std::string& displayed_, const util_frameString& value_ );
+
+		visual_debug_hud* hud;
+
+	};	// Nested class END
+
+	/**
+	 * Frame jobs of the HUD, registered during initialization.
 	 */ 
-	osg::ref_ptr<HudUpdateCallback> updateCallback;
+	osg::ref_ptr<hudQueryJob> queryJob;
+	osg::ref_ptr<hudTextJob> textJob;
 
 	bool isInitialized;
 
 	osg::ref_ptr<osgText::Text> textLat, textLon, textAlt, textHat, textHot;
 
+	/**
+	 * Texts which are currently displayed, to skip the update of unchanged texts.
+	 */
+	std::string displayedLat, displayedLon, displayedAlt, displayedHat, displayedHot;
+
+	/**
+	 * Values queried by the query job, displayed by the text job.
+	 */
+	double lat, lon, alt, hat, hot;
+
 	// Friend classes
-	friend class HudUpdateCallback; // Damit der Callback auf alle Member zugreifen kann wie wenn er in der Klasse sitzen wrde.
+	friend class hudQueryJob; // Damit der Callback auf alle Member zugreifen kann wie wenn er in der Klasse sitzen wrde.
+	friend class hudTextJob;
 }; 
 
 }	// END NAMESPACE
\ No newline at end of file
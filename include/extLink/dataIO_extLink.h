@@ -18,11 +18,8 @@
 #include <osg/Referenced>
 #include <osg/Node>
 #include <dataIO_slot.h>
-
-// XML Parser
-#include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <dataIO_slotSnapshot.h>
+#include <util_config.h>
 
 
 namespace osgVisual
@@ -57,14 +54,15 @@ public:
 	/**
 	 * \brief Pure virtual function for initialization. Must be implemented in derived class.
 	 * 
+	 * @param configurationNode : extlink element of the dataIO configuration, NULL if not configured.
 	 */ 
-	virtual bool init( xmlNode* configurationNode) = 0;
+	virtual bool init( const util_config::node* configurationNode) = 0;
 
 	/**
 	 * \brief Pure virtual function for XML configuration. Must be implemented in derived class.
 	 * 
 	 */ 
-	virtual bool processXMLConfiguration(xmlNode* extLinkConfig_) = 0;
+	virtual bool processXMLConfiguration(const util_config::node* extLinkConfig_) = 0;
 
 	/**
 	 * \brief Pure virtual function for shutdown. Must be implemented in derived class.
@@ -82,9 +80,13 @@ public:
 	/**
 	 * \brief Pure virtual function for writing return values back to the external link. Must be implemented in derived class.
 	 * 
+	 * This function is called in the draw thread, which may run in parallel to the main thread.
+	 * Implementations must read the values from the snapshot and must not access dataIO's live slots.
+	 * 
+	 * @param snapshot_ : Slot values of the frame being drawn.
 	 * @return : See derived class.
 	 */ 
-	virtual bool writebackFROM_OBJvalues() = 0;
+	virtual bool writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ ) = 0;
 
 protected:
 	/**
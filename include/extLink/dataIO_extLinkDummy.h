@@ -36,12 +36,12 @@ public:
 	dataIO_extLinkDummy(std::vector<dataIO_slot *>& dataSlots_);
 	virtual ~dataIO_extLinkDummy(void);
 
-	bool processXMLConfiguration(xmlNode* extLinkConfig_);
-	bool init(xmlNode* configurationNode);
+	bool processXMLConfiguration(const util_config::node* extLinkConfig_);
+	bool init(const util_config::node* configurationNode);
 	void shutdown();
 
 	bool readTO_OBJvalues();
-	bool writebackFROM_OBJvalues();
+	bool writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ );
 	void provideSlots();
 };
 
@@ -0,0 +1,204 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <dataIO_extLink.h>
+#include <dataIO_recorder.h>
+#include <util_mappedFile.h>
+
+#include <osg/Matrixd>
+#include <osg/Notify>
+#include <osg/Timer>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class is an externalLink which replays a log of dataIO_recorder instead of connecting to a simulator.
+ *
+ * The recorded TO_OBJ values are written into dataIO's slots, so the scene follows the recording as it followed the simulator.
+ * The FROM_OBJ values and the executers are part of the log for analysis, they are not replayed.
+ * The log is mapped into memory (util_mappedFile). With the index of a closed recording, the replay seeks by binary search,
+ * without index (e.g. after a crash during the recording) the records are scanned once at initialization.
+ *
+ * It is configured in the dataIO section of the XML configuration:
+ * <extlink implementation="replay" filename="dataio.ovr" speed="1.0" starttime="0.0" loop="no"></extlink>
+ * speed is the replay rate relative to the recorded rate, e.g. 4.0 for accelerated replay. A speed of 0 replays exactly one recorded frame
+ * per frame, independent of the frame rate, which makes benchmarks deterministic. starttime is the recorded time in s to start at.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class dataIO_extLinkReplay : public dataIO_extLink
+{
+public:
+	dataIO_extLinkReplay(std::vector<dataIO_slot *>& dataSlots_);
+	virtual ~dataIO_extLinkReplay(void);
+
+	bool processXMLConfiguration(const util_config::node* extLinkConfig_);
+	bool init(const util_config::node* configurationNode);
+	void shutdown();
+
+	bool readTO_OBJvalues();
+	bool writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ );
+
+	/**
+	 * \brief This function continues the replay at a recorded time.
+	 *
+	 * @param time_ : Recorded time in s.
+	 * @return : True if the replay is initialized.
+	 */
+	bool seek( double time_ );
+
+	/**
+	 * \brief This function returns the number of recorded frames.
+	 *
+	 * @return : Number of frames.
+	 */
+	unsigned int getNumFrames() const {return index.size();};
+
+	/**
+	 * \brief This function returns the recorded view matrix of the last replayed frame.
+	 *
+	 * @return : View matrix.
+	 */
+	const osg::Matrixd& getViewMatrix() const {return viewMatrix;};
+
+private:
+	/**
+	 * \brief This struct contains a recorded slot and the dataIO slot its values are replayed into.
+	 *
+	 */
+	struct replaySlot
+	{
+		replaySlot() : direction(dataIO_slot::TO_OBJ), variableType(dataIO_slot::DOUBLE), slot(NULL), defined(false) {};
+
+		std::string variableName;
+		dataIO_slot::dataDirection direction;
+		dataIO_slot::varType variableType;
+
+		/**
+		 * dataIO slot, resolved with the first replayed value.
+		 */
+		dataIO_slot* slot;
+
+		/**
+		 * Last replayed string, to set only changed strings.
+		 */
+		std::string lastString;
+
+		/**
+		 * Flag if the slot record was found.
+		 */
+		bool defined;
+	};
+
+	/**
+	 * \brief This function reads the index of a closed recording.
+	 *
+	 * @return : True if the file has a valid index.
+	 */
+	bool readIndex();
+
+	/**
+	 * \brief This function builds the index by scanning all records, up to the first invalid one.
+	 *
+	 */
+	void scanRecords();
+
+	/**
+	 * \brief This function reads a slot record.
+	 *
+	 * @param record_ : Content of the record behind the record header.
+	 * @param size_ : Size of the content.
+	 * @return : True if the record is valid.
+	 */
+	bool readSlotRecord( const unsigned char* record_, size_t size_ );
+
+	/**
+	 * \brief This function writes the TO_OBJ values of a frame into dataIO's slots.
+	 *
+	 * @param frame_ : Index of the frame.
+	 * @return : True if the frame record is valid.
+	 */
+	bool applyFrame( unsigned int frame_ );
+
+	/**
+	 * Recorded file.
+	 */
+	std::string filename;
+
+	/**
+	 * Replay rate relative to the recorded rate, 0 replays one recorded frame per frame.
+	 */
+	double speed;
+
+	/**
+	 * Recorded time in s to start at.
+	 */
+	double startTime;
+
+	/**
+	 * Flag if the replay restarts at startTime after the last frame.
+	 */
+	bool loop;
+
+	/**
+	 * Mapped log.
+	 */
+	osg::ref_ptr<util_mappedFile> file;
+
+	/**
+	 * Recorded slots, by slot index.
+	 */
+	std::vector<replaySlot> slots;
+
+	/**
+	 * Index of all recorded frames.
+	 */
+	std::vector<dataIO_recorder::indexEntry> index;
+
+	/**
+	 * Index of the next frame to replay.
+	 */
+	unsigned int nextFrame;
+
+	/**
+	 * Flag if the replay clock is started. It starts with the first replayed frame, so the loading time does not skip frames.
+	 */
+	bool clockStarted;
+
+	/**
+	 * Start of the replay clock, and the recorded time it corresponds to.
+	 */
+	osg::Timer_t clockStartTick;
+	double clockStartTime;
+
+	/**
+	 * Flag if the end of the recording was reported.
+	 */
+	bool finished;
+
+	/**
+	 * Recorded view matrix of the last replayed frame.
+	 */
+	osg::Matrixd viewMatrix;
+};
+
+}	// END NAMESPACE
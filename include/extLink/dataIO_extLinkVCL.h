@@ -78,12 +78,12 @@ public:
 	dataIO_extLinkVCL(std::vector<dataIO_slot *>& dataSlots_);
 	virtual ~dataIO_extLinkVCL(void);
 
-	bool init(xmlNode* configurationNode);
-	bool processXMLConfiguration(xmlNode* extLinkConfig_);
+	bool init(const util_config::node* configurationNode);
+	bool processXMLConfiguration(const util_config::node* extLinkConfig_);
 	void shutdown();
 
 	bool readTO_OBJvalues();
-	bool writebackFROM_OBJvalues();
+	bool writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ );
 
 
 private:
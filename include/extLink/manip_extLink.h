@@ -16,6 +16,7 @@
 */
 
 #include <visual_object.h>
+#include <util_taskScheduler.h>
 
 
 
@@ -81,8 +82,12 @@ class extLinkManipulator : public osgGA::CameraManipulator
         /** Get the keyboard and mouse usage of this manipulator.*/
         virtual void getUsage(osg::ApplicationUsage& usage) const;
 
-		virtual void setAttachedObject( 
-			visual_object* object_ ) {attachedObject = object_;};
+		/**
+		 * \brief This function attaches the camera to an object. The camera follows the object's camera matrix each frame.
+		 * 
+		 * @param object_ : Object to attach to, NULL to detach.
+		 */ 
+		virtual void setAttachedObject( visual_object* object_ );
 
 		virtual osgVisual::visual_object* getAttachedObject() {return attachedObject.get();};
 
@@ -94,10 +99,35 @@ class extLinkManipulator : public osgGA::CameraManipulator
 		 */ 
         virtual ~extLinkManipulator();
 
+		/**
+		 * \brief Main thread job which takes the camera matrix of the attached object, after the object jobs calculated the matrices of this frame.
+		 * 
+		 * @author Torben Dannhauer
+		 * @date  Oct 2026
+		 */ 
+		class cameraMatrixJob : public util_taskScheduler::job
+		{
+		public:
+			cameraMatrixJob( extLinkManipulator* manipulator_ );
+			virtual void run( unsigned int begin_, unsigned int end_ );
+		private:
+			/**
+			 * Manipulator which owns this job.
+			 */ 
+			extLinkManipulator* manipulator;
+		};
+
 		osg::Matrixd manipMatrix;
 	
 
 		osg::ref_ptr<osgVisual::visual_object> attachedObject;
+
+		/**
+		 * Frame job, registered while an object is attached.
+		 */ 
+		osg::ref_ptr<cameraMatrixJob> matrixJob;
+
+		friend class cameraMatrixJob;
 };
 
 }	// END NAMESPACE
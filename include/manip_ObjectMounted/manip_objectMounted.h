@@ -21,6 +21,7 @@
 #include <osg/observer_ptr>
 
 #include <visual_object.h>
+#include <util_taskScheduler.h>
 
 
 namespace osgVisual
@@ -85,8 +86,12 @@ class objectMountedManipulator : public osgGA::CameraManipulator
         /** Get the keyboard and mouse usage of this manipulator.*/
         virtual void getUsage(osg::ApplicationUsage& usage) const;
 
-		virtual void setAttachedObject( 
-			osgVisual::visual_object* object_ ) {attachedObject = object_;};
+		/**
+		 * \brief This function attaches the camera to an object. The camera follows the object's camera matrix each frame.
+		 * 
+		 * @param object_ : Object to attach to, NULL to detach.
+		 */ 
+		virtual void setAttachedObject( osgVisual::visual_object* object_ );
 
 		virtual osgVisual::visual_object* getAttachedObject() {return attachedObject.get();};
 
@@ -98,10 +103,35 @@ class objectMountedManipulator : public osgGA::CameraManipulator
 		 */ 
         virtual ~objectMountedManipulator();
 
+		/**
+		 * \brief Main thread job which takes the camera matrix of the attached object, after the object jobs calculated the matrices of this frame.
+		 * 
+		 * @author Torben Dannhauer
+		 * @date  Oct 2026
+		 */ 
+		class cameraMatrixJob : public util_taskScheduler::job
+		{
+		public:
+			cameraMatrixJob( objectMountedManipulator* manipulator_ );
+			virtual void run( unsigned int begin_, unsigned int end_ );
+		private:
+			/**
+			 * Manipulator which owns this job.
+			 */ 
+			objectMountedManipulator* manipulator;
+		};
+
 		osg::Matrixd manipMatrix;
 	
 
 		osg::ref_ptr<osgVisual::visual_object> attachedObject;
+
+		/**
+		 * Frame job, registered while an object is attached.
+		 */ 
+		osg::ref_ptr<cameraMatrixJob> matrixJob;
+
+		friend class cameraMatrixJob;
 };
 
 }	// END NAMESPACE
@@ -0,0 +1,270 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/CoordinateSystemNode>
+#include <osg/observer_ptr>
+#include <osg/Timer>
+#include <osg/Notify>
+
+#include <osgViewer/Viewer>
+
+#include <visual_object.h>
+#include <terrainQuery.h>
+#include <util_terrainHeightGrid.h>
+#include <util_taskScheduler.h>
+
+#include <vector>
+
+namespace osgVisual
+{
+class visual_object;	// Forward declaration
+
+/**
+ * \brief This class places all ground clamped visual_objects on the terrain surface.
+ *
+ * Once per frame, after the objects calculated their matrices from the received position and attitude, the clamper samples
+ * the terrain at the footprint points of all clamped objects in one batch. The precompiled terrain height grid is used where available,
+ * all other points are intersected as one batch of vertical line of sight segments, using the currently loaded terrain tiles only.
+ * The segments are intersected with the osgTerrain::Terrain of the scene. Without one, the whole scene except the objects is intersected
+ * (see visual_object::NODEMASK_TERRAIN_QUERY).
+ *
+ * For each object a plane is fitted through the sampled terrain heights (least squares). The plane defines the object's altitude
+ * and, if enabled, pitch and bank. Afterwards the object's matrix is recalculated.
+ *
+ * The clamping runs as job of util_taskScheduler after the object transforms. Its terrain queries attach completed KD-trees to the terrain,
+ * so it does not run in parallel to other jobs which access the scene graph.
+ *
+ * The time taken per frame is written into the viewer stats as "Ground clamp time taken", together with "Ground clamp objects"
+ * and "Ground clamp points".
+ *
+ * Under load, core_detailGovernor reduces the terrain query frequency (setQueryInterval()). In the frames between two queries,
+ * the objects are clamped with the terrain heights of the last query.
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class object_groundClamper : public osg::Referenced
+{
+	#include <leakDetection.h>
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	object_groundClamper();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the clamper.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	object_groundClamper(const object_groundClamper& cc);
+
+	/**
+	 * \brief Frame job which executes the ground clamping after the object transforms.
+	 *
+	 * It queries the scene graph (terrain), which attaches completed KD-trees, reads the objects, and writes the altitude, attitude and matrices of the clamped objects.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class groundClampJob : public util_taskScheduler::job
+	{
+	public:
+		/**
+		 * \brief Constructor: declares the accessed data.
+		 *
+		 */
+		groundClampJob();
+
+		/**
+		 * \brief This function clamps all objects.
+		 *
+		 */
+		virtual void run( unsigned int begin_, unsigned int end_ );
+	};
+
+	/**
+	 * \brief This struct contains one footprint point of the current batch.
+	 *
+	 */
+	struct clampPoint
+	{
+		unsigned int object;	// Index into clampObjects
+		double x;				// Position in the heading aligned object frame: x to the right
+		double y;				// Position in the heading aligned object frame: y forward
+		double z;				// Height of the contact point over the object origin
+		double lat;				// Geodetic position of the sample
+		double lon;
+		double height;			// Sampled terrain height
+		bool valid;				// True if a terrain height was found
+		int segment;			// Index of the line of sight segment, -1 if the height grid was used
+	};
+
+	/**
+	 * \brief This function samples the terrain for all clamped objects and updates their altitude and attitude.
+	 *
+	 * @param frameNumber_ : Current frame number for the stats.
+	 */
+	void update( unsigned int frameNumber_ );
+
+	/**
+	 * \brief This function fits the terrain plane for one object and applies it.
+	 *
+	 * @param object_ : Object to clamp.
+	 * @param first_ : Index of the first footprint point of the object in the batch.
+	 * @param count_ : Number of footprint points of the object.
+	 */
+	void clampObject( visual_object* object_, unsigned int first_, unsigned int count_ );
+
+	/**
+	 * \brief This function fits the terrain plane for all objects of the batch and recalculates their matrices.
+	 *
+	 * @param ellipsoid_ : Ellipsoid model of the scene.
+	 */
+	void clampBatch( osg::EllipsoidModel* ellipsoid_ );
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~object_groundClamper();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static object_groundClamper* getInstance();
+
+	/**
+	 * \brief This function registers the clamping job.
+	 *
+	 * @param viewer_ : Viewer to write the stats into.
+	 * @param rootNode_ : Root node of the scene, providing the ellipsoid model and the terrain.
+	 */
+	void init( osgViewer::Viewer* viewer_, osg::CoordinateSystemNode* rootNode_ );
+
+	/**
+	 * \brief This function unregisters the clamping job and releases all objects.
+	 *
+	 */
+	void shutdown();
+
+	/**
+	 * \brief This function adds an object to the list of clamped objects. Called by visual_object::setGroundClamp().
+	 *
+	 * @param object_ : Object to clamp.
+	 */
+	void addObject( visual_object* object_ );
+
+	/**
+	 * \brief This function removes an object from the list of clamped objects. Called by visual_object::setGroundClamp().
+	 *
+	 * @param object_ : Object to remove.
+	 */
+	void removeObject( visual_object* object_ );
+
+	/**
+	 * \brief This function configures the vertical range which is searched for terrain, relative to the object's altitude.
+	 *
+	 * @param above_ : Search range above the object in meter.
+	 * @param below_ : Search range below the object in meter.
+	 */
+	void setSearchRange( double above_, double below_ ) {searchAbove = above_; searchBelow = below_;};
+
+	/**
+	 * \brief This function sets how often the terrain is queried.
+	 *
+	 * @param frames_ : The terrain is queried every frames_ frames, 1 means every frame.
+	 */
+	void setQueryInterval( unsigned int frames_ ) {queryInterval = frames_ > 0 ? frames_ : 1;};
+
+	/**
+	 * \brief This function returns how often the terrain is queried.
+	 *
+	 * @return : Interval in frames.
+	 */
+	unsigned int getQueryInterval() {return queryInterval;};
+
+private:
+	/**
+	 * Registered frame job.
+	 */
+	osg::ref_ptr<groundClampJob> clampJob;
+
+	/**
+	 * Viewer for the frame number and the stats.
+	 */
+	osg::observer_ptr<osgViewer::Viewer> viewer;
+
+	/**
+	 * Root node of the scene.
+	 */
+	osg::observer_ptr<osg::CoordinateSystemNode> rootNode;
+
+	/**
+	 * Terrain node, used as intersection root to prevent objects from hitting themselves. Searched lazily since the terrain is loaded after init().
+	 */
+	osg::observer_ptr<osg::Node> terrain;
+
+	/**
+	 * True if the last search found no terrain. The search is repeated only if the number of children of the root node changed.
+	 */
+	bool terrainSearchFailed;
+
+	/**
+	 * Number of children of the root node at the last failed search for the terrain.
+	 */
+	unsigned int terrainSearchNumChildren;
+
+	/**
+	 * List of all clamped objects.
+	 */
+	std::vector< osg::observer_ptr<visual_object> > clampObjects;
+
+	/**
+	 * Footprint points of the current batch. Kept as member to reuse the memory from frame to frame.
+	 */
+	std::vector<clampPoint> points;
+
+	/**
+	 * Line of sight query for all points not covered by the height grid.
+	 */
+	terrainQuery query;
+
+	/**
+	 * Search range above the object in meter.
+	 */
+	double searchAbove;
+
+	/**
+	 * Search range below the object in meter.
+	 */
+	double searchBelow;
+
+	/**
+	 * The terrain is queried every queryInterval frames.
+	 */
+	unsigned int queryInterval;
+};
+
+}	// END NAMESPACE
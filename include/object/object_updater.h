@@ -119,6 +119,11 @@ protected:
 	 */ 
 	std::string updater_lat_rad, updater_lon_rad, updater_alt, updater_rot_x_rad, updater_rot_y_rad, updater_rot_z_rad, updater_label;
 
+	/**
+	 * Label text which was applied last. The label is only updated if the slot value changes, as osgText rebuilds all glyphs on each setText().
+	 */
+	std::string appliedLabel;
+
 };
 
 }	// END NAMESPACE
@@ -24,6 +24,9 @@
 #include <osgDB/ReadFile>
 #include <osgDB/FileUtils>
 
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
 #include <osgText/Text>
 
 #include <osgGA/CameraManipulator>
@@ -31,19 +34,22 @@
 #include <object_updater.h>
 #include <visual_dataIO.h>
 #include <visual_util.h>
+#include <util_profiler.h>
+#include <util_allocTracker.h>
+#include <util_taskScheduler.h>
+#include <util_modelCache.h>
+#include <util_config.h>
 
 #include <string.h>
 #include <iostream>
-
-// XML Parser
-#include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <vector>
+#include <map>
 
 namespace osgVisual
 {
 class visual_objectPositionCallback;
 class object_updater;
+class object_groundClamper;
 }
 
 /**
@@ -97,8 +103,16 @@ public:
 			geometry(object_.geometry),
 			updater(object_.updater),
  			trackingId(object_.trackingId),
-			labels(object_.labels)		
-			{}
+			labels(object_.labels),
+			groundClamp(object_.groundClamp),
+			groundClampAttitude(object_.groundClampAttitude),
+			groundClampOffset(object_.groundClampOffset),
+			footprint(object_.footprint),
+			ellipsoid(object_.ellipsoid),
+			pendingMatrix(object_.pendingMatrix),
+			transformPending(false),
+			matrixPending(false)
+			{registerObject( this );}
 
 	/**
 	 * \brief Constuctor: Adds this object to the scenegraph,
@@ -108,6 +122,12 @@ public:
 	 * @param nodeName_ : Name of this object, is used for further identification.
 	 */ 
 	visual_object( osg::CoordinateSystemNode* sceneRoot_, std::string nodeName_ );
+
+	/**
+	 * Node mask bit which is cleared on all objects. Terrain queries which intersect the whole scene use it as traversal mask,
+	 * so the objects are not hit by their own ground clamping.
+	 */
+	static const osg::Node::NodeMask NODEMASK_TERRAIN_QUERY = 0x00000002;
 	
 	/**
 	 * \brief Empty destructor.
@@ -115,7 +135,58 @@ public:
 	 */ 
 	~visual_object();
 
-	static visual_object* createNodeFromXMLConfig(osg::CoordinateSystemNode* sceneRoot_, xmlNode* a_node);
+	/**
+	 * \brief This struct contains the configuration of an object as specified by a <model> node of the scenery configuration.
+	 * 
+	 * Angles are in radians, the updater members contain the slot names of the updater.
+	 */ 
+	struct objectConfig
+	{
+		objectConfig() : dynamic(false), trackingID(-1), lat(0.0), lon(0.0), alt(0.0), rot_x(0.0), rot_y(0.0), rot_z(0.0),
+			cam_trans_x(0.0), cam_trans_y(0.0), cam_trans_z(0.0), cam_rot_x(0.0), cam_rot_y(0.0), cam_rot_z(0.0),
+			geometry_rot_x(0.0), geometry_rot_y(0.0), geometry_rot_z(0.0), geometry_scale_x(1.0), geometry_scale_y(1.0), geometry_scale_z(1.0),
+			groundclamp(false), groundclamp_attitude(true), groundclamp_offset(0.0) {};
+
+		std::string objectname, filename, label;
+		bool dynamic;
+		int trackingID;
+		double lat, lon, alt, rot_x, rot_y, rot_z;
+		double cam_trans_x, cam_trans_y, cam_trans_z, cam_rot_x, cam_rot_y, cam_rot_z;
+		double geometry_rot_x, geometry_rot_y, geometry_rot_z;
+		double geometry_scale_x, geometry_scale_y, geometry_scale_z;
+		std::string updater_lat, updater_lon, updater_alt, updater_rot_x, updater_rot_y, updater_rot_z, updater_label;
+		bool groundclamp, groundclamp_attitude;
+		double groundclamp_offset;
+		std::vector<osg::Vec3d> footprint;
+	};
+
+	/**
+	 * \brief This function creates an object from a <model> node of the scenery configuration and adds it to the scene.
+	 * 
+	 * @param sceneRoot_ : Scenegraph to add the object to.
+	 * @param a_node : <model> node.
+	 * @return : Created object, NULL if a_node is NULL.
+	 */ 
+	static visual_object* createNodeFromXMLConfig(osg::CoordinateSystemNode* sceneRoot_, const util_config::node* a_node);
+
+	/**
+	 * \brief This function parses a <model> node of the scenery configuration.
+	 * 
+	 * @param a_node : <model> node.
+	 * @param config_ : Configuration to fill.
+	 * @return : False if a_node is NULL.
+	 */ 
+	static bool parseXMLConfig(const util_config::node* a_node, objectConfig& config_);
+
+	/**
+	 * \brief This function creates an object from its configuration and adds it to the scene. Call it from the main thread.
+	 * 
+	 * @param sceneRoot_ : Scenegraph to add the object to.
+	 * @param config_ : Configuration of the object.
+	 * @param geometry_ : Already loaded geometry to use instead of loading config_.filename, e.g. from core_sceneryArchive. It may be shared by several objects.
+	 * @return : Created object.
+	 */ 
+	static visual_object* createNodeFromConfig(osg::CoordinateSystemNode* sceneRoot_, const objectConfig& config_, osg::Node* geometry_ = NULL);
 
 	/**
 	 * \brief This functions searches in the scene graph for a node with a tracking ID
@@ -126,6 +197,23 @@ public:
 	 */ 
 	static osg::Node* findNodeByTrackingID(int trackingID, osg::Node* currNode_);
 
+	/**
+	 * \brief This function loads a model file in advance, the next loadGeometry() of this file uses the loaded model instead of reading the file.
+	 * 
+	 * Each preloaded model is used once, so preload a file once for every object which uses it. This function is thread safe and is used
+	 * to load the scenery models in parallel during startup.
+	 * 
+	 * @param filename_ : File to load.
+	 * @return : True if loading was successful.
+	 */ 
+	static bool preloadGeometry( const std::string& filename_ );
+
+	/**
+	 * \brief This function releases all preloaded models which are not used by loadGeometry().
+	 * 
+	 */ 
+	static void clearPreloadedGeometry();
+
 
 /** @name Position and attitude
  *  These functions control objects position and attitude
@@ -169,6 +257,75 @@ public:
 	 * \todo: Erklren welche Wirkung die drei Winkel haben.
 	 */ 
 	void setNewAttitude( double azimuthAngle_psi_, double pitchAngle_theta_, double bankAngle_phi_ );
+
+	/**
+	 * \brief This function calculates the objects matrix from its position, attitude, scale and geometry offset and applies it.
+	 * 
+	 * Each frame, the matrix is calculated by the object transform job (computeMatrix()) and applied by the object matrix job (applyMatrix()).
+	 * Call this function to apply a modified position or attitude immediately. Only call it from the main thread outside of the frame jobs.
+	 * 
+	 * @param ellipsoid_ : Ellipsoid model of the scene.
+	 */ 
+	void calculateMatrix( osg::EllipsoidModel* ellipsoid_ );
+
+	/**
+	 * \brief This function calculates the objects matrix and the camera matrix without modifying the scene graph, the matrix is applied by applyMatrix().
+	 * 
+	 * It is thread safe for different objects, e.g. in the object transform job.
+	 * 
+	 * @param ellipsoid_ : Ellipsoid model of the scene.
+	 */ 
+	void computeMatrix( osg::EllipsoidModel* ellipsoid_ );
+
+	/**
+	 * \brief This function sets the matrix calculated by computeMatrix() as matrix of this transform. Only call it from the main thread.
+	 * 
+	 */ 
+	void applyMatrix();
+/*@}*/
+/** @name Ground clamping
+ *  These functions control if the object follows the terrain surface.
+ */
+/*@{*/
+	/**
+	 * \brief This function enables or disables ground clamping for this object.
+	 * 
+	 * A clamped object is placed on the terrain by object_groundClamper each frame, independent of the altitude it receives.
+	 * The terrain is sampled at the footprint points of the object (e.g. the wheel contact points). If no footprint point is configured,
+	 * the object origin is used.
+	 * 
+	 * @param enabled_ : True to enable ground clamping.
+	 * @param clampAttitude_ : True to adjust pitch and bank to the terrain slope too. Requires at least two footprint points.
+	 * @param offset_ : Additional height of the object origin over the fitted terrain in meter.
+	 */ 
+	void setGroundClamp( bool enabled_, bool clampAttitude_ = true, double offset_ = 0.0 );
+
+	/**
+	 * \brief This function returns if the object is ground clamped.
+	 * 
+	 * @return : True if ground clamping is enabled.
+	 */ 
+	bool isGroundClamped() const {return groundClamp;};
+
+	/**
+	 * \brief This function adds a footprint point, at which the terrain is sampled for ground clamping.
+	 * 
+	 * @param point_ : Contact point in the object coordinate frame in meter: x to the right, y forward, z up.
+	 */ 
+	void addFootprintPoint( const osg::Vec3d& point_ ) {footprint.push_back( point_ );};
+
+	/**
+	 * \brief This function removes all footprint points.
+	 * 
+	 */ 
+	void clearFootprint() {footprint.clear();};
+
+	/**
+	 * \brief This function returns the footprint points of the object.
+	 * 
+	 * @return : Footprint points in the object coordinate frame.
+	 */ 
+	const std::vector<osg::Vec3d>& getFootprint() const {return footprint;};
 /*@}*/
 /** @name Geometry management
  *  These functions control which geometry visual_object should display.
@@ -242,7 +399,7 @@ public:
 	/**
 	 * \brief This function adds an Updater to this object.
 	 * 
-	 * The updaters postUpdate und preUpdate functions are executed during eventTraversal traversal.
+	 * The updaters postUpdate und preUpdate functions are executed by frame jobs of util_taskScheduler in the main thread, after the event traversal.
 	 * The preUdate is executed before the objects matrix is calculated from position, the postUpdate is executed after the matrix calculation. 
 	 * 
 	 * @param updater_ : Updater to add.
@@ -338,6 +495,20 @@ public:
 	 */ 
 	void clearLabels();
 
+	/**
+	 * \brief This function shows or hides the labels of all objects, e.g. to save render time under load (see core_detailGovernor).
+	 * 
+	 * @param visible_ : True to show the labels.
+	 */ 
+	static void setLabelsVisible( bool visible_ );
+
+	/**
+	 * \brief This function returns if the labels of all objects are shown.
+	 * 
+	 * @return : True if shown.
+	 */ 
+	static bool getLabelsVisible();
+
 	/**
 	 * \brief This function adds a label to the object.  
 	 * 
@@ -417,6 +588,60 @@ protected:
 		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv);
 	};
 
+	/**
+	 * \brief Main thread job which executes the preUpdate of the object updaters, after dataIO received the slot values of this frame.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class objectUpdaterJob : public util_taskScheduler::job
+	{
+	public:
+		objectUpdaterJob();
+		virtual void run( unsigned int begin_, unsigned int end_ );
+	};
+
+	/**
+	 * \brief Frame job which calculates the matrices of all objects in parallel, after their updaters received the new position.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class objectTransformJob : public util_taskScheduler::job
+	{
+	public:
+		objectTransformJob();
+		virtual unsigned int getNumItems();
+		virtual void run( unsigned int begin_, unsigned int end_ );
+	};
+
+	/**
+	 * \brief Main thread job which applies the calculated matrices to the scene graph and executes the postUpdate of the object updaters.
+	 * 
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */ 
+	class objectMatrixJob : public util_taskScheduler::job
+	{
+	public:
+		objectMatrixJob();
+		virtual void run( unsigned int begin_, unsigned int end_ );
+	};
+
+	/**
+	 * \brief This function adds an object to the list processed by the frame jobs. The jobs are registered with the first object.
+	 * 
+	 * @param object_ : Object to add.
+	 */ 
+	static void registerObject( visual_object* object_ );
+
+	/**
+	 * \brief This function removes an object from the list processed by the frame jobs. The jobs are unregistered with the last object.
+	 * 
+	 * @param object_ : Object to remove.
+	 */ 
+	static void unregisterObject( visual_object* object_ );
+
 	osg::Vec3 upVector;
 	
 // Position
@@ -509,9 +734,55 @@ protected:
 	 */ 
 	osg::ref_ptr<osg::Geode> labels;
 
+// Ground clamping
+	/**
+	 * Flag if the object is placed on the terrain by object_groundClamper.
+	 */ 
+	bool groundClamp;
+
+	/**
+	 * Flag if pitch and bank are adjusted to the terrain slope while ground clamping.
+	 */ 
+	bool groundClampAttitude;
+
+	/**
+	 * Height of the object origin over the fitted terrain in meter.
+	 */ 
+	double groundClampOffset;
+
+	/**
+	 * Footprint points in the object coordinate frame, at which the terrain is sampled for ground clamping.
+	 */ 
+	std::vector<osg::Vec3d> footprint;
+
+// Frame jobs
+	/**
+	 * Ellipsoid model found by the position callback, used by the object transform job.
+	 */ 
+	osg::ref_ptr<osg::EllipsoidModel> ellipsoid;
+
+	/**
+	 * Matrix calculated by computeMatrix(), not yet applied.
+	 */ 
+	osg::Matrixd pendingMatrix;
+
+	/**
+	 * Flag if the position callback requested a new matrix in this frame.
+	 */ 
+	bool transformPending;
+
+	/**
+	 * Flag if pendingMatrix is not yet applied.
+	 */ 
+	bool matrixPending;
+
 	// Friend classes
 	friend class visual_objectPositionCallback; // To allow the callback access to all member variables.
+	friend class objectUpdaterJob;
+	friend class objectTransformJob;
+	friend class objectMatrixJob;
 	friend class object_updater;	// To allow updater to modify all members.
+	friend class object_groundClamper;	// To allow the ground clamper to modify altitude and attitude.
 
 };
 
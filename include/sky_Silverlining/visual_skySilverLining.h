@@ -33,6 +33,7 @@
 #include <skySilverLining_cloudLayerSlot.h>
 
 #include <visual_util.h>
+#include <util_profiler.h>
 
 // XML Parser
 #include <stdio.h>
@@ -473,7 +474,21 @@ public:
  *  The following functions provide the XML functionality to configure sky via XML
  */
 //@{
-	void configureCloudlayerbyXML( xmlNode* cloudlayerNode_ );
+	/**
+	 * \brief This function adds the cloud layers of a <clouds> node of the scenery configuration.
+	 * 
+	 * @param cloudlayerNode_ : <clouds> node.
+	 */ 
+	void configureCloudlayerbyXML( const util_config::node* cloudlayerNode_ );
+
+	/**
+	 * \brief This function converts the name of a cloud type as used in the XML configuration, e.g. "CUMULUS_CONGESTUS", into the cloud type.
+	 * 
+	 * @param name_ : Name of the cloud type.
+	 * @param default_ : Cloud type to return for unknown names.
+	 * @return : Cloud type.
+	 */ 
+	static CloudTypes getCloudTypeByName( const std::string& name_, CloudTypes default_ = CUMULUS_CONGESTUS );
 //@}
 
 private:
@@ -22,6 +22,8 @@
 // include so we can get access to the DatabaseCacheReadCallback
 #include <osgSim/LineOfSight>
 
+#include <dataIO_slot.h>
+
 namespace osgVisual {
 
 /** Helper class for setting up and acquiring height above terrain intersections with terrain.
@@ -92,6 +94,45 @@ class terrainQuery
         static double computeHeightOfTerrain(osg::Node* scene, const osg::Vec3d& point, DataSource pagingBehaviour, osg::Node::NodeMask traversalMask=0xffffffff);
 
         
+        /** Clear the internal line of sight list so it contains no line of sight tests.*/
+        void clearSegments() { _LOSList.clear(); }
+
+        /** Add a line of sight test between two points in the CoordinateFrame.
+          * If resultSlotName is not empty, computeLineOfSight(..) writes the result into the FROM_OBJ slots
+          * <resultSlotName>_HIT (1.0 if the line of sight is blocked, else 0.0) and <resultSlotName>_HIT_X, _HIT_Y, _HIT_Z (first hit point).*/
+        unsigned int addSegment(const osg::Vec3d& start, const osg::Vec3d& end, const std::string& resultSlotName="");
+
+        /** Get the number of line of sight tests.*/
+        unsigned int getNumSegments() const { return _LOSList.size(); }
+
+        /** Set the end points of a single line of sight test. This allows to reuse the list from frame to frame.*/
+        void setSegment(unsigned int i, const osg::Vec3d& start, const osg::Vec3d& end) { _LOSList[i]._start = start; _LOSList[i]._end = end; }
+
+        /** Get the start point of a single line of sight test.*/
+        const osg::Vec3d& getSegmentStart(unsigned int i) const { return _LOSList[i]._start; }
+
+        /** Get the end point of a single line of sight test.*/
+        const osg::Vec3d& getSegmentEnd(unsigned int i) const { return _LOSList[i]._end; }
+
+        /** Get if the segment of a single line of sight test hits the scene, i.e. the line of sight is blocked.
+          * Note, you must call computeLineOfSight(..) before you can query the result. */
+        bool getSegmentHit(unsigned int i) const { return _LOSList[i]._hit; }
+
+        /** Get the first hit point of a single line of sight test, nearest to the start point. Only valid if getSegmentHit(..) returns true.*/
+        const osg::Vec3d& getSegmentHitPoint(unsigned int i) const { return _LOSList[i]._hitPoint; }
+
+        /** Set the minimum number of segments per worker thread. Batches with at least twice this number of segments are
+          * split into chunks which are intersected in parallel by the util_workerPool. Defaults to 64.*/
+        void setMinSegmentsPerThread(unsigned int minSegmentsPerThread) { _minSegmentsPerThread = minSegmentsPerThread>0 ? minSegmentsPerThread : 1; }
+
+        /** Get the minimum number of segments per worker thread.*/
+        unsigned int getMinSegmentsPerThread() const { return _minSegmentsPerThread; }
+
+        /** Compute the line of sight intersections of all segments with the specified scene graph.
+          * All segments are tested in one intersection traversal. Large batches are split and traversed in parallel.
+          * The segments are specified in world coordinates, independent of the topmost node. */
+        void computeLineOfSight(osg::Node* scene, osg::Node::NodeMask traversalMask=0xffffffff);
+
         /** Clear the database cache.*/
         void clearDatabaseCache() { if (_dcrc.valid()) _dcrc->clearDatabaseCache(); }
 
@@ -118,10 +159,46 @@ class terrainQuery
         };
         
         typedef std::vector<HAT> HATList;
-        
+
+        struct LOS
+        {
+            LOS(const osg::Vec3d& start, const osg::Vec3d& end, const std::string& slotName):
+                _start(start),
+                _end(end),
+                _hit(false),
+                _slotName(slotName),
+                _hitSlot(NULL),
+                _hitXSlot(NULL),
+                _hitYSlot(NULL),
+                _hitZSlot(NULL) {}
+
+            osg::Vec3d      _start;
+            osg::Vec3d      _end;
+            bool            _hit;
+            osg::Vec3d      _hitPoint;
+            std::string     _slotName;
+            dataIO_slot*    _hitSlot;
+            dataIO_slot*    _hitXSlot;
+            dataIO_slot*    _hitYSlot;
+            dataIO_slot*    _hitZSlot;
+        };
+
+        typedef std::vector<LOS> LOSList;
+
+        /** Intersect the segments [begin, end) of the line of sight list with the scene. Executed by the calling thread or a worker thread.*/
+        static void intersectSegments(osg::Node* scene, osg::Node::NodeMask traversalMask, osgUtil::IntersectionVisitor::ReadCallback* readCallback,
+                                      LOSList& losList, unsigned int begin, unsigned int end, std::vector< osg::ref_ptr<osg::Drawable> >& hitDrawables);
+
+        /** Write the line of sight results into the result slots.*/
+        void writeSegmentsToSlots();
+
+        friend class lineOfSightOperation;
+
 
         double                                  _lowestHeight;
         HATList                                 _HATList;
+        LOSList                                 _LOSList;
+        unsigned int                            _minSegmentsPerThread;
 
 		osg::ref_ptr<osgSim::DatabaseCacheReadCallback> _dcrc;
         osgUtil::IntersectionVisitor            _intersectionVisitor;
@@ -0,0 +1,274 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <string>
+#include <vector>
+
+/**
+ * \brief Instrumentation macros for the allocation tracking.
+ *
+ * OSGVISUAL_ALLOC_SCOPE(subsystem) accounts all heap allocations of the calling thread until the end of the enclosing scope to the subsystem, e.g. OSGVISUAL_ALLOC_SCOPE(DATAIO).
+ * OSGVISUAL_ALLOC_ZERO_SCOPE("name") designates the enclosing scope as allocation free path: each allocation in it is reported as violation.
+ * Without USE_ALLOCATION_TRACKING both macros expand to nothing.
+ */
+#ifdef USE_ALLOCATION_TRACKING
+	#define OSGVISUAL_ALLOC_CONCAT_(a_,b_) a_##b_
+	#define OSGVISUAL_ALLOC_CONCAT(a_,b_) OSGVISUAL_ALLOC_CONCAT_(a_,b_)
+	#define OSGVISUAL_ALLOC_SCOPE(subsystem_) osgVisual::util_allocTracker::scopedTag OSGVISUAL_ALLOC_CONCAT(allocScope_, __LINE__)(osgVisual::util_allocTracker::subsystem_)
+	#define OSGVISUAL_ALLOC_ZERO_SCOPE(name_) osgVisual::util_allocTracker::zeroAllocationScope OSGVISUAL_ALLOC_CONCAT(allocZeroScope_, __LINE__)(name_)
+#else
+	#define OSGVISUAL_ALLOC_SCOPE(subsystem_)
+	#define OSGVISUAL_ALLOC_ZERO_SCOPE(name_)
+#endif
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class accounts heap allocations per subsystem and frame.
+ *
+ * With USE_ALLOCATION_TRACKING, the global operator new and delete are replaced by versions which count each allocation for the
+ * subsystem tagged by the calling thread (see OSGVISUAL_ALLOC_SCOPE). Allocations outside of a tagged scope are accounted to OTHER.
+ * endFrame() takes the counters of the finished frame. After a warm-up, the frames are summed up to the steady-state allocation
+ * rate of each subsystem, which is printed by report().
+ *
+ * Allocations which bypass operator new (e.g. malloc in C libraries) are not counted.
+ * Without USE_ALLOCATION_TRACKING the class is available, but all counters stay zero.
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_allocTracker : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * Subsystems allocations are accounted to.
+	 */
+	enum subsystem {OTHER, DATAIO, CLUSTER, OBJECT, TERRAIN, HUD, DISTORTION, NUM_SUBSYSTEMS};
+
+	/**
+	 * \brief This class tags the allocations of the calling thread during its lifetime. Use it via OSGVISUAL_ALLOC_SCOPE.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class scopedTag
+	{
+	public:
+		scopedTag( subsystem subsystem_ ) {previous = util_allocTracker::setThreadSubsystem(subsystem_);};
+		~scopedTag() {util_allocTracker::setThreadSubsystem(previous);};
+	private:
+		subsystem previous;
+	};
+
+	/**
+	 * \brief This class reports allocations of the calling thread during its lifetime as violation. Use it via OSGVISUAL_ALLOC_ZERO_SCOPE.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class zeroAllocationScope
+	{
+	public:
+		zeroAllocationScope( const char* name_ ) : name(name_) {start = util_allocTracker::getThreadAllocations();};
+		~zeroAllocationScope()
+		{
+			unsigned long allocations = util_allocTracker::getThreadAllocations() - start;
+			if( allocations > 0 )
+				util_allocTracker::getInstance()->reportViolation( name, allocations );
+		}
+	private:
+		const char* name;
+		unsigned long start;
+	};
+
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_allocTracker();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the tracker.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_allocTracker(const util_allocTracker& cc);
+
+	/**
+	 * \brief This struct contains the accumulated statistics of one subsystem.
+	 *
+	 */
+	struct subsystemStatistics
+	{
+		unsigned long lastAllocations;		// Counter values at the end of the previous frame
+		unsigned long lastBytes;
+		double sumAllocations;				// Sum over the steady-state frames
+		double sumBytes;
+		unsigned long maxAllocations;		// Maximum of a steady-state frame
+		unsigned long maxBytes;
+		unsigned long frameAllocations;		// Values of the last frame
+		unsigned long frameBytes;
+	};
+
+	/**
+	 * \brief This struct contains the violations of one allocation free path.
+	 *
+	 */
+	struct violation
+	{
+		const char* name;
+		unsigned long count;				// Number of executions which allocated
+		unsigned long allocations;			// Total number of allocations
+	};
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_allocTracker();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the tracker.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_allocTracker* getInstance();
+
+	/**
+	 * \brief This function returns if the allocations are tracked, i.e. if osgVisual is compiled with USE_ALLOCATION_TRACKING.
+	 *
+	 * @return : True if tracked.
+	 */
+	static bool isTracking();
+
+	/**
+	 * \brief This function sets the subsystem the allocations of the calling thread are accounted to.
+	 *
+	 * @param subsystem_ : New subsystem.
+	 * @return : Previous subsystem.
+	 */
+	static subsystem setThreadSubsystem( subsystem subsystem_ );
+
+	/**
+	 * \brief This function returns the number of allocations of the calling thread since its start.
+	 *
+	 * @return : Number of allocations.
+	 */
+	static unsigned long getThreadAllocations();
+
+	/**
+	 * \brief This function returns the name of a subsystem.
+	 *
+	 * @param subsystem_ : Subsystem.
+	 * @return : Name.
+	 */
+	static const char* getSubsystemName( subsystem subsystem_ );
+
+	/**
+	 * \brief This function sets the number of frames at the beginning which are not part of the steady state, e.g. because of loading.
+	 *
+	 * @param numFrames_ : Number of warm-up frames. Default is 100.
+	 */
+	void setWarmupFrames( unsigned int numFrames_ ) {warmupFrames = numFrames_;};
+
+	/**
+	 * \brief This function finishes a frame: it takes the allocations since the last call as allocations of the frame.
+	 *
+	 * Call it once per frame after the rendering traversals.
+	 */
+	void endFrame();
+
+	/**
+	 * \brief This function returns the allocations of a subsystem in the last frame.
+	 *
+	 * @param subsystem_ : Subsystem.
+	 * @return : Number of allocations.
+	 */
+	unsigned long getFrameAllocations( subsystem subsystem_ ) {return statistics[subsystem_].frameAllocations;};
+
+	/**
+	 * \brief This function returns the allocated bytes of a subsystem in the last frame.
+	 *
+	 * @param subsystem_ : Subsystem.
+	 * @return : Allocated bytes.
+	 */
+	unsigned long getFrameBytes( subsystem subsystem_ ) {return statistics[subsystem_].frameBytes;};
+
+	/**
+	 * \brief This function records an allocation in an allocation free path. It is called by zeroAllocationScope.
+	 *
+	 * The first violation of each path is reported immediately.
+	 *
+	 * @param name_ : Name of the path. Only the pointer is stored, so it has to be a string literal.
+	 * @param allocations_ : Number of allocations in the path.
+	 */
+	void reportViolation( const char* name_, unsigned long allocations_ );
+
+	/**
+	 * \brief This function returns the number of executions of allocation free paths which allocated.
+	 *
+	 * @return : Number of violations.
+	 */
+	unsigned long getNumViolations();
+
+	/**
+	 * \brief This function prints the steady-state allocations per frame of each subsystem and the violations of allocation free paths.
+	 *
+	 * @return : True if no allocation free path allocated.
+	 */
+	bool report();
+
+private:
+	/**
+	 * Statistics of each subsystem.
+	 */
+	subsystemStatistics statistics[NUM_SUBSYSTEMS];
+
+	/**
+	 * Number of finished frames.
+	 */
+	unsigned int numFrames;
+
+	/**
+	 * Number of frames which are not part of the steady state.
+	 */
+	unsigned int warmupFrames;
+
+	/**
+	 * Violations of allocation free paths.
+	 */
+	std::vector<violation> violations;
+
+	/**
+	 * Mutex to protect the list of violations.
+	 */
+	OpenThreads::Mutex violationsMutex;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,168 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+
+#include <string>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class writes a file append-only through a memory-mapped window.
+ *
+ * The file is extended window by window, appended data is copied into the mapped window and written back by the operating system.
+ * The disk space of each window is reserved before it is mapped, so a full disk fails append() instead of the write into the mapping.
+ * The file is never flushed explicitly, so appending costs a memcpy and occasionally a page fault. After a crash, the data
+ * written so far is in the file, followed by zeros up to the end of the last window.
+ * On Windows the file is mapped with CreateFileMapping / MapViewOfFile, on all other systems with mmap.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_appendFile : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	util_appendFile();
+
+	/**
+	 * \brief Destructor: Closes the file if it is open.
+	 *
+	 */
+	~util_appendFile();
+
+	/**
+	 * \brief This function creates the specified file, an existing file is truncated. A previously opened file is closed.
+	 *
+	 * @param filename_ : File to create.
+	 * @param windowSize_ : Size of the mapped window in bytes, rounded up to 64 kB.
+	 * @return : True if successful.
+	 */
+	bool open( const std::string& filename_, size_t windowSize_ = 64*1024*1024 );
+
+	/**
+	 * \brief This function appends data at the end of the file.
+	 *
+	 * @param data_ : Data to append.
+	 * @param size_ : Size of the data in bytes.
+	 * @return : True if successful.
+	 */
+	bool append( const void* data_, size_t size_ );
+
+	/**
+	 * \brief This function unmaps the window, truncates the file to the appended data and closes it.
+	 *
+	 */
+	void close();
+
+	/**
+	 * \brief This function returns if a file is open.
+	 *
+	 * @return : True if a file is open.
+	 */
+	bool isOpen() const {return !filename.empty();};
+
+	/**
+	 * \brief This function returns the number of appended bytes, which is the offset of the next append.
+	 *
+	 * @return : Size in bytes.
+	 */
+	unsigned long long getSize() const {return size;};
+
+	/**
+	 * \brief This function returns the name of the open file.
+	 *
+	 * @return : Filename.
+	 */
+	const std::string& getFilename() const {return filename;};
+
+private:
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent copying the mapping.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_appendFile(const util_appendFile& cc);
+
+	/**
+	 * \brief This function extends the file and maps the window at the specified offset.
+	 *
+	 * @param offset_ : File offset of the window, a multiple of the window size.
+	 * @return : True if successful.
+	 */
+	bool mapWindow( unsigned long long offset_ );
+
+	/**
+	 * \brief This function unmaps the current window.
+	 *
+	 */
+	void unmapWindow();
+
+	/**
+	 * Pointer to the mapped window, NULL if no window is mapped.
+	 */
+	unsigned char* window;
+
+	/**
+	 * File offset of the mapped window.
+	 */
+	unsigned long long windowOffset;
+
+	/**
+	 * Size of the mapped window in bytes.
+	 */
+	size_t windowSize;
+
+	/**
+	 * Number of appended bytes.
+	 */
+	unsigned long long size;
+
+	/**
+	 * Name of the open file, empty if no file is open.
+	 */
+	std::string filename;
+
+#ifdef WIN32
+	/**
+	 * Handle of the file.
+	 */
+	HANDLE fileHandle;
+
+	/**
+	 * Handle of the file mapping of the current window.
+	 */
+	HANDLE mappingHandle;
+#else
+	/**
+	 * Descriptor of the file.
+	 */
+	int fileDescriptor;
+#endif
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,305 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Notify>
+#include <osg/Timer>
+
+// XML Parser
+#include <stdio.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class parses the XML configuration file once and shares it with all modules.
+ *
+ * The file is converted into an immutable tree of util_config::node objects with typed attribute access. A reload creates a new tree,
+ * so a module which holds a node keeps a consistent snapshot. The XML document is released after the conversion.
+ *
+ * Sections are the children of the root element: a module element is identified by its name attribute (e.g. "distortion"), every other
+ * element by its element name (e.g. "scenery"). checkForChanges() reloads a modified file and notifies the listeners of every changed section.
+ *
+ * This class is realized as singleton and must only be used by the main thread.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_config : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This class is an immutable element of the configuration tree.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class node : public osg::Referenced
+	{
+	public:
+		typedef std::vector< std::pair<std::string, std::string> > AttributeList;
+		typedef std::vector< osg::ref_ptr<const node> > NodeList;
+
+		/**
+		 * \brief Constructor: converts the XML element and all its child elements.
+		 *
+		 * @param xmlNode_ : XML element to convert.
+		 */
+		node( xmlNode* xmlNode_ );
+
+		/**
+		 * \brief This function returns the element name.
+		 *
+		 * @return : Element name.
+		 */
+		const std::string& getName() const {return name;};
+
+		/**
+		 * \brief This function returns all attributes in the order of the file.
+		 *
+		 * @return : List of name/value pairs.
+		 */
+		const AttributeList& getAttributes() const {return attributes;};
+
+		/**
+		 * \brief This function returns if the attribute is set.
+		 *
+		 * @param name_ : Attribute name.
+		 * @return : True if set.
+		 */
+		bool hasAttribute( const std::string& name_ ) const;
+
+		/**
+		 * \brief These functions return the value of an attribute.
+		 *
+		 * Booleans accept "yes"/"no", "true"/"false" and "1"/"0". A missing or not convertible attribute returns the default value.
+		 *
+		 * @param name_ : Attribute name.
+		 * @param default_ : Value to return if the attribute is missing or invalid.
+		 * @return : Attribute value.
+		 */
+		std::string getString( const std::string& name_, const std::string& default_ = "" ) const;
+		double getDouble( const std::string& name_, double default_ = 0.0 ) const;
+		int getInt( const std::string& name_, int default_ = 0 ) const;
+		bool getBool( const std::string& name_, bool default_ = false ) const;
+
+		/**
+		 * \brief This function returns all child elements.
+		 *
+		 * @return : List of child elements.
+		 */
+		const NodeList& getChildren() const {return children;};
+
+		/**
+		 * \brief This function returns all child elements with the given name.
+		 *
+		 * @param name_ : Element name.
+		 * @return : List of matching child elements.
+		 */
+		std::vector<const node*> getChildren( const std::string& name_ ) const;
+
+		/**
+		 * \brief This function returns the first child element with the given name.
+		 *
+		 * @param name_ : Element name.
+		 * @return : Child element, NULL if not found.
+		 */
+		const node* getChild( const std::string& name_ ) const;
+
+		/**
+		 * \brief This function compares this element and all its children with another element.
+		 *
+		 * @param other_ : Element to compare with.
+		 * @return : True if name, attributes, text and children are equal.
+		 */
+		bool equals( const node* other_ ) const;
+
+	private:
+		std::string name;
+		std::string text;
+		AttributeList attributes;
+		NodeList children;
+	};
+
+	/**
+	 * \brief Interface for modules which react on changes of their configuration section.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class changeListener : public osg::Referenced
+	{
+	public:
+		/**
+		 * \brief This function is called after the configuration was reloaded and the section has changed.
+		 *
+		 * @param sectionName_ : Name of the changed section.
+		 * @param section_ : New configuration of the section, NULL if the section was removed.
+		 */
+		virtual void configChanged( const std::string& sectionName_, const node* section_ ) = 0;
+	};
+
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_config();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the configuration.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_config(const util_config& cc);
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_config();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the configuration.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_config* getInstance();
+
+	/**
+	 * \brief This function parses the configuration file. If the file is already loaded, it is not parsed again.
+	 *
+	 * @param filename_ : XML configuration file.
+	 * @return : True if the file is a valid osgVisual configuration file.
+	 */
+	bool load( const std::string& filename_ );
+
+	/**
+	 * \brief This function releases the configuration and the XML parser.
+	 *
+	 */
+	void unload();
+
+	/**
+	 * \brief This function returns the loaded configuration file.
+	 *
+	 * @return : Filename, empty if no configuration is loaded.
+	 */
+	const std::string& getFilename() {return filename;};
+
+	/**
+	 * \brief This function returns the root element of the configuration tree.
+	 *
+	 * @return : Root element, NULL if no configuration is loaded.
+	 */
+	const node* getRoot() {return root.get();};
+
+	/**
+	 * \brief This function returns the configuration section with the given name.
+	 *
+	 * @param sectionName_ : Module name or element name of the section.
+	 * @return : Section, NULL if not configured.
+	 */
+	const node* getSection( const std::string& sectionName_ );
+
+	/**
+	 * \brief This function checks if the configuration file was modified. If so, it is reloaded and the listeners of all changed sections are notified.
+	 *
+	 * The modification time is checked at most once per second, so it can be called every frame.
+	 *
+	 * @return : True if the configuration was reloaded.
+	 */
+	bool checkForChanges();
+
+	/**
+	 * \brief This function registers a listener for changes of a section.
+	 *
+	 * @param sectionName_ : Module name or element name of the section.
+	 * @param listener_ : Listener to notify.
+	 */
+	void addChangeListener( const std::string& sectionName_, changeListener* listener_ );
+
+	/**
+	 * \brief This function unregisters a listener from all sections.
+	 *
+	 * @param listener_ : Listener to remove.
+	 */
+	void removeChangeListener( changeListener* listener_ );
+
+	/**
+	 * \brief This function returns the section name of an element: the name attribute for module elements, otherwise the element name.
+	 *
+	 * @param section_ : Element to name.
+	 * @return : Section name.
+	 */
+	static std::string getSectionName( const node* section_ );
+
+private:
+	/**
+	 * \brief This function parses the configuration file into a new tree.
+	 *
+	 * @param filename_ : XML configuration file.
+	 * @param root_ : Converted configuration tree, NULL on error.
+	 * @return : True if successful.
+	 */
+	static bool parse( const std::string& filename_, osg::ref_ptr<const node>& root_ );
+
+	/**
+	 * \brief This function returns the modification time of the configuration file.
+	 *
+	 * @return : Modification time, 0 if the file does not exist.
+	 */
+	long long getModificationTime();
+
+	typedef std::multimap< std::string, osg::ref_ptr<changeListener> > ListenerMap;
+
+	/**
+	 * Loaded configuration file.
+	 */
+	std::string filename;
+
+	/**
+	 * Modification time of the loaded configuration file.
+	 */
+	long long modificationTime;
+
+	/**
+	 * Time of the last modification check.
+	 */
+	osg::Timer_t lastCheckTick;
+
+	/**
+	 * Root element of the configuration tree.
+	 */
+	osg::ref_ptr<const node> root;
+
+	/**
+	 * Registered change listeners, by section name.
+	 */
+	ListenerMap listeners;
+};
+
+}	// END NAMESPACE
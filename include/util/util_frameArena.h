@@ -0,0 +1,268 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class is a bump allocator for transient objects which live at most until the end of the frame.
+ *
+ * Memory is taken from large blocks by advancing an offset, deallocation is a no-op. reset() releases all objects at once
+ * and is called by visual_core at the beginning of each frame. The blocks are kept, so after the first frames the arena
+ * does not allocate from the heap anymore.
+ *
+ * The arena is not thread safe: use it only in the update traversal (main thread), e.g. in update callbacks.
+ * Objects allocated in the arena must not be stored beyond the current frame, and their destructors are not called by reset().
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_frameArena : public osg::Referenced
+{
+	#include <leakDetection.h>
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_frameArena();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the arena.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_frameArena(const util_frameArena& cc);
+
+	/**
+	 * \brief This struct contains one memory block of the arena.
+	 *
+	 */
+	struct block
+	{
+		char* data;
+		size_t size;
+	};
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_frameArena();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the arena.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_frameArena* getInstance();
+
+	/**
+	 * \brief This function allocates memory which is valid until the next reset().
+	 *
+	 * @param size_ : Size in bytes.
+	 * @param alignment_ : Alignment in bytes, must be a power of two.
+	 * @return : Pointer to the memory.
+	 */
+	void* allocate( size_t size_, size_t alignment_ = 16 );
+
+	/**
+	 * \brief This function releases all allocations of the frame. The memory blocks are kept for the next frame.
+	 *
+	 */
+	void reset();
+
+	/**
+	 * \brief This function returns the number of bytes allocated since the last reset().
+	 *
+	 * @return : Allocated bytes.
+	 */
+	size_t getBytesUsed() {return bytesUsed;};
+
+	/**
+	 * \brief This function returns the maximum number of bytes allocated in one frame.
+	 *
+	 * @return : Maximum allocated bytes.
+	 */
+	size_t getPeakBytesUsed() {return peakBytesUsed;};
+
+	/**
+	 * \brief This function returns how often the arena allocated a memory block from the heap. It stops growing once the arena is warm.
+	 *
+	 * @return : Number of block allocations.
+	 */
+	unsigned int getNumBlockAllocations() {return numBlockAllocations;};
+
+private:
+	/**
+	 * Size of a regular memory block in bytes, larger allocations get a block of their own size.
+	 */
+	static const size_t blockSize = 64*1024;
+
+	/**
+	 * Memory blocks, the blocks before currentBlock are full.
+	 */
+	std::vector<block> blocks;
+
+	/**
+	 * Index of the block allocations are taken from.
+	 */
+	unsigned int currentBlock;
+
+	/**
+	 * Offset of the next free byte in the current block.
+	 */
+	size_t offset;
+
+	/**
+	 * Bytes allocated since the last reset().
+	 */
+	size_t bytesUsed;
+
+	/**
+	 * Maximum bytes allocated in one frame.
+	 */
+	size_t peakBytesUsed;
+
+	/**
+	 * Number of memory blocks allocated from the heap.
+	 */
+	unsigned int numBlockAllocations;
+};
+
+/**
+ * \brief STL allocator which takes its memory from util_frameArena, e.g. std::vector<int, util_frameArenaAllocator<int> >.
+ *
+ * Containers using it must not live longer than the current frame.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+template<class T>
+class util_frameArenaAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<class U> struct rebind {typedef util_frameArenaAllocator<U> other;};
+
+	util_frameArenaAllocator() {};
+	template<class U> util_frameArenaAllocator( const util_frameArenaAllocator<U>& ) {};
+
+	pointer address( reference x_ ) const {return &x_;};
+	const_pointer address( const_reference x_ ) const {return &x_;};
+
+	pointer allocate( size_type n_, const void* = 0 ) {return static_cast<pointer>( util_frameArena::getInstance()->allocate( n_*sizeof(T) ) );};
+	void deallocate( pointer, size_type ) {};
+	size_type max_size() const {return size_type(-1) / sizeof(T);};
+
+	void construct( pointer p_, const T& value_ ) {new(p_) T(value_);};
+	void destroy( pointer p_ ) {p_->~T();};
+};
+
+template<class T, class U>
+bool operator==( const util_frameArenaAllocator<T>&, const util_frameArenaAllocator<U>& ) {return true;}
+
+template<class T, class U>
+bool operator!=( const util_frameArenaAllocator<T>&, const util_frameArenaAllocator<U>& ) {return false;}
+
+/**
+ * \brief This class builds a string in util_frameArena, e.g. to format display texts in update callbacks without heap allocations.
+ *
+ * It must not live longer than the current frame.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_frameString
+{
+public:
+	/**
+	 * \brief Constructor: creates an empty string.
+	 *
+	 * @param capacity_ : Initial capacity in characters.
+	 */
+	util_frameString( unsigned int capacity_ = 64 );
+
+	/**
+	 * \brief This function appends a text.
+	 *
+	 * @param text_ : Text to append.
+	 * @return : Reference to this string.
+	 */
+	util_frameString& append( const char* text_ );
+
+	/**
+	 * \brief This function appends a text formatted like printf().
+	 *
+	 * @param format_ : printf() format string.
+	 * @return : Reference to this string.
+	 */
+	util_frameString& appendFormat( const char* format_, ... );
+
+	/**
+	 * \brief This function removes all characters.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * \brief This function returns the string as zero terminated C string.
+	 *
+	 * @return : C string.
+	 */
+	const char* c_str() const {return &buffer[0];};
+
+	/**
+	 * \brief This function returns the number of characters.
+	 *
+	 * @return : Length.
+	 */
+	unsigned int length() const {return buffer.size()-1;};
+
+	/**
+	 * \brief This function compares the string with a std::string.
+	 *
+	 * @param other_ : String to compare with.
+	 * @return : True if both strings are equal.
+	 */
+	bool equals( const std::string& other_ ) const {return other_.compare( c_str() ) == 0;};
+
+private:
+	/**
+	 * Characters including the terminating zero.
+	 */
+	std::vector<char, util_frameArenaAllocator<char> > buffer;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,165 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class collects frame times and evaluates their distribution (mean, percentiles, standard deviation).
+ *
+ * Percentiles use the nearest rank method on the sorted frame times.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_frameTimeStatistics : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	util_frameTimeStatistics();
+
+	/**
+	 * \brief This function reserves memory for the expected number of frames, so adding frame times does not allocate.
+	 *
+	 * @param numFrames_ : Expected number of frames.
+	 */
+	void reserve( unsigned int numFrames_ ) {frameTimes.reserve( numFrames_ );};
+
+	/**
+	 * \brief This function adds the duration of a frame.
+	 *
+	 * @param frameTime_ : Frame time in ms.
+	 */
+	void add( double frameTime_ );
+
+	/**
+	 * \brief This function discards all frame times.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * \brief This function returns the number of collected frame times.
+	 *
+	 * @return : Number of frames.
+	 */
+	unsigned int getNumFrames() {return frameTimes.size();};
+
+	/**
+	 * \brief This function returns the collected frame times in the order they were added.
+	 *
+	 * @return : Frame times in ms.
+	 */
+	const std::vector<double>& getFrameTimes() {return frameTimes;};
+
+	/**
+	 * \brief This function returns the percentile of the frame times.
+	 *
+	 * @param percentile_ : Percentile in [0..100].
+	 * @return : Frame time in ms, 0 if no frame time was added.
+	 */
+	double getPercentile( double percentile_ );
+
+	/**
+	 * \brief This function returns the shortest frame time.
+	 *
+	 * @return : Frame time in ms, 0 if no frame time was added.
+	 */
+	double getMin() {return getPercentile(0.0);};
+
+	/**
+	 * \brief This function returns the longest frame time.
+	 *
+	 * @return : Frame time in ms, 0 if no frame time was added.
+	 */
+	double getMax() {return getPercentile(100.0);};
+
+	/**
+	 * \brief This function returns the mean frame time.
+	 *
+	 * @return : Mean frame time in ms, 0 if no frame time was added.
+	 */
+	double getMean();
+
+	/**
+	 * \brief This function returns the standard deviation of the frame times.
+	 *
+	 * @return : Standard deviation in ms, 0 if less than two frame times were added.
+	 */
+	double getStandardDeviation();
+
+	/**
+	 * \brief This function returns the number of frames which took longer than a threshold, e.g. to count spikes.
+	 *
+	 * @param frameTime_ : Threshold in ms.
+	 * @return : Number of frames above the threshold.
+	 */
+	unsigned int getNumFramesAbove( double frameTime_ );
+
+	/**
+	 * \brief This function writes a summary: number of frames, mean, standard deviation, min, P50, P90, P95, P99 and max.
+	 *
+	 * @param out_ : Stream to write to.
+	 * @param title_ : Title of the summary.
+	 */
+	void writeReport( std::ostream& out_, const std::string& title_ );
+
+	/**
+	 * \brief This function writes all frame times as CSV: frame index and frame time in ms.
+	 *
+	 * @param filename_ : File to write.
+	 * @return : True if successful.
+	 */
+	bool writeCSV( const std::string& filename_ );
+
+	/**
+	 * \brief This function adds the frame times of a CSV file written by writeCSV(), e.g. to compare with a previous run.
+	 *
+	 * @param filename_ : File to read.
+	 * @return : True if successful.
+	 */
+	bool readCSV( const std::string& filename_ );
+
+private:
+	/**
+	 * Frame times in ms in the order they were added.
+	 */
+	std::vector<double> frameTimes;
+
+	/**
+	 * Sorted copy of the frame times, updated on demand.
+	 */
+	std::vector<double> sortedFrameTimes;
+
+	/**
+	 * Indicates if sortedFrameTimes matches frameTimes.
+	 */
+	bool sorted;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,270 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Drawable>
+#include <osg/Geometry>
+#include <osg/KdTree>
+#include <osg/Stats>
+#include <osg/Timer>
+#include <osg/observer_ptr>
+#include <osg/Notify>
+
+#include <osgUtil/LineSegmentIntersector>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <util_workerPool.h>
+
+#include <map>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class builds KD-trees for intersected drawables on demand in the background.
+ *
+ * Instead of building KD-trees for every loaded terrain tile and model during loading, a drawable is
+ * scheduled for KD-tree construction when it is hit by a terrain query for the first time.
+ * The construction runs on the util_workerPool. Until the tree is ready, intersections with this
+ * drawable fall back to the brute force test of osgUtil::LineSegmentIntersector.
+ *
+ * Completed trees are attached to their drawables by installCompletedKdTrees(), which is called by the
+ * intersection functions on the querying thread, so a tree never appears in the middle of its own traversal.
+ * Several threads may query the terrain at the same time. Attaching a tree modifies the scene graph, so the
+ * jobs of util_taskScheduler which query the terrain declare that they write "scene graph".
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_kdTreeBuilder : public osg::Referenced
+{
+	#include <leakDetection.h>
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_kdTreeBuilder();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the builder.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_kdTreeBuilder(const util_kdTreeBuilder& cc);
+
+	/**
+	 * \brief This operation builds the KD-tree for one geometry on a worker thread.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class buildOperation : public util_workerPool::discardableOperation
+	{
+	public:
+		/**
+		 * \brief Constructor
+		 *
+		 * @param builder_ : Pointer to the builder to report the result to.
+		 * @param geometry_ : Geometry to build the KD-tree for.
+		 */
+		buildOperation(util_kdTreeBuilder* builder_, osg::Geometry* geometry_)
+			: util_workerPool::discardableOperation("util_kdTreeBuilder::buildOperation", false), builder(builder_), geometry(geometry_) {};
+
+		/**
+		 * \brief This function is executed by the worker thread.
+		 *
+		 */
+		virtual void operator () (osg::Object*);
+
+		/**
+		 * \brief This function is called if the pool does not execute the build, it reports the tree as failed.
+		 *
+		 */
+		virtual void discard() {builder->reportCompletedTree( NULL, NULL, 0.0 );};
+	private:
+		/**
+		 * Pointer to the builder singleton.
+		 */
+		util_kdTreeBuilder* builder;
+
+		/**
+		 * Geometry to build the tree for. Observed only, so a tile unloaded by the pager is not kept alive.
+		 */
+		osg::observer_ptr<osg::Geometry> geometry;
+	};
+
+	/**
+	 * \brief This struct contains a KD-tree which was built but not yet attached to its geometry.
+	 *
+	 */
+	struct completedTree
+	{
+		osg::observer_ptr<osg::Geometry> geometry;
+		osg::ref_ptr<osg::KdTree> kdTree;
+	};
+
+	/**
+	 * \brief This function is called by the build operations to hand over a completed tree.
+	 *
+	 * @param geometry_ : Geometry the tree belongs to.
+	 * @param kdTree_ : Completed tree, NULL if the build failed.
+	 * @param buildTime_ : Time taken to build the tree in ms.
+	 */
+	void reportCompletedTree( osg::Geometry* geometry_, osg::KdTree* kdTree_, double buildTime_ );
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_kdTreeBuilder();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_kdTreeBuilder* getInstance();
+
+	/**
+	 * \brief This function schedules the KD-tree construction for the specified drawable, if it has no tree yet.
+	 *
+	 * Drawables which are not osg::Geometry or which are already scheduled are ignored.
+	 *
+	 * @param drawable_ : Drawable which was hit by a terrain query.
+	 */
+	void requestKdTree( osg::Drawable* drawable_ );
+
+	/**
+	 * \brief This function schedules the KD-tree construction for all drawables contained in the intersections.
+	 *
+	 * @param intersections_ : Intersections of a LineSegmentIntersector.
+	 */
+	void requestKdTrees( const osgUtil::LineSegmentIntersector::Intersections& intersections_ );
+
+	/**
+	 * \brief This function attaches all completed KD-trees to their drawables. Call it only while no other thread traverses the scene graph.
+	 *
+	 */
+	void installCompletedKdTrees();
+
+	/**
+	 * \brief This function writes the KD-tree statistics of the elapsed frame into the viewer stats.
+	 *
+	 * The attributes are "KdTree build time taken" (ms spent building since the last call), "KdTrees built" and "KdTrees pending".
+	 *
+	 * @param stats_ : Stats to write into, e.g. viewer->getViewerStats().
+	 * @param frameNumber_ : Framenumber to write the attributes for.
+	 */
+	void updateStats( osg::Stats* stats_, unsigned int frameNumber_ );
+
+	/**
+	 * \brief This function enables or disables the on-demand KD-tree construction.
+	 *
+	 * @param enabled_ : True to enable construction.
+	 */
+	void setEnabled( bool enabled_ ) {enabled = enabled_;};
+
+	/**
+	 * \brief This function returns if on-demand KD-tree construction is enabled.
+	 *
+	 * @return : True if enabled.
+	 */
+	bool isEnabled() {return enabled;};
+
+	/**
+	 * \brief This function returns the accumulated time spent for building KD-trees.
+	 *
+	 * @return : Build time in ms.
+	 */
+	double getTotalBuildTime();
+
+	/**
+	 * \brief This function returns the number of KD-trees built so far.
+	 *
+	 * @return : Number of built KD-trees.
+	 */
+	unsigned int getNumBuiltTrees();
+
+	/**
+	 * \brief This function returns the number of KD-trees which are scheduled but not yet installed.
+	 *
+	 * @return : Number of pending KD-trees.
+	 */
+	unsigned int getNumPendingTrees();
+
+private:
+	typedef std::map<const osg::Drawable*, osg::observer_ptr<osg::Drawable> > ScheduledMap;
+
+	/**
+	 * Drawables which are scheduled or already have a tree. The observer is used to detect recycled addresses of deleted drawables.
+	 */
+	ScheduledMap scheduled;
+
+	/**
+	 * Trees which are built, but not attached to their geometry yet.
+	 */
+	std::vector<completedTree> completedTrees;
+
+	/**
+	 * Options used for KD-tree construction.
+	 */
+	osg::KdTree::BuildOptions buildOptions;
+
+	/**
+	 * Mutex to protect the scheduled drawables, the completed trees and the statistics, which are accessed by the querying and the worker threads.
+	 */
+	OpenThreads::Mutex mutex;
+
+	/**
+	 * Flag if the on-demand construction is enabled.
+	 */
+	bool enabled;
+
+	/**
+	 * Number of scheduled trees whose build has not finished yet.
+	 */
+	unsigned int numPending;
+
+	/**
+	 * Number of built trees.
+	 */
+	unsigned int numBuilt;
+
+	/**
+	 * Accumulated build time in ms.
+	 */
+	double totalBuildTime;
+
+	/**
+	 * Build time in ms since the last call of updateStats().
+	 */
+	double frameBuildTime;
+
+	/**
+	 * The build operation reports its result via reportCompletedTree().
+	 */
+	friend class buildOperation;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,354 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Timer>
+#include <osg/Notify>
+
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Atomic>
+
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Highest severity level which is compiled in. Messages of less important levels are removed by the compiler.
+ *
+ * It is set by CMake (LOG_MAX_LEVEL), default is osg::INFO.
+ */
+#ifndef OSGVISUAL_LOG_MAX_LEVEL
+	#define OSGVISUAL_LOG_MAX_LEVEL osg::INFO
+#endif
+
+/**
+ * \brief Logging macros, used like OSG_NOTIFY: OSGVISUAL_LOG( osg::WARN ) << "text" << std::endl;
+ *
+ * The message is formatted into a buffer of the calling thread and written to osg::notify() by a background thread,
+ * so the calling thread never blocks on terminal or file I/O. Messages of disabled levels are not formatted.
+ * OSGVISUAL_LOG_RATE limits the messages of the call site to the given number per second, suppressed messages are counted.
+ */
+#define OSGVISUAL_LOG_RATE( level_, maxPerSecond_ ) \
+	if( (level_) > OSGVISUAL_LOG_MAX_LEVEL || !osg::isNotifyEnabled(level_) || !osgVisual::util_log::isAllowed( osgVisual::util_logSite<osgVisual::util_logTranslationUnit, __LINE__>(), maxPerSecond_ ) ) {} \
+	else osgVisual::util_log::messageStream( level_, __FILE__, __LINE__, osgVisual::util_logSite<osgVisual::util_logTranslationUnit, __LINE__>() ).stream()
+
+#define OSGVISUAL_LOG( level_ ) \
+	if( (level_) > OSGVISUAL_LOG_MAX_LEVEL || !osg::isNotifyEnabled(level_) ) {} \
+	else osgVisual::util_log::messageStream( level_, __FILE__, __LINE__, NULL ).stream()
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class is an asynchronous logger for code which runs every frame.
+ *
+ * Each thread formats its messages into its own ring buffer. The buffers are lock free (one writing and one reading thread),
+ * a background thread drains them and forwards the messages to osg::notify(), so the configured NotifyHandler is still used.
+ * If a ring buffer is full, the message is dropped and counted instead of blocking the frame.
+ * As long as the logger is not started, messages are written synchronously, which is suitable for the tools and the startup.
+ *
+ * Use it via OSGVISUAL_LOG and OSGVISUAL_LOG_RATE. This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_log : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Rate limiting state of one call site. It is created by util_logSite() once per OSGVISUAL_LOG_RATE statement.
+	 *
+	 */
+	struct site
+	{
+		OpenThreads::Atomic second;			// Second of the current rate limiting window
+		OpenThreads::Atomic count;			// Messages in the current window
+		OpenThreads::Atomic suppressed;		// Messages suppressed since the last written message
+	};
+
+private:
+	/**
+	 * Maximum length of one message, longer messages are truncated.
+	 */
+	static const unsigned int maxMessageLength = 256;
+
+	/**
+	 * Number of messages each thread buffer can hold, must be a power of two.
+	 */
+	static const unsigned int bufferCapacity = 512;
+
+	/**
+	 * \brief This struct contains one message and its origin.
+	 *
+	 */
+	struct record
+	{
+		osg::Timer_t tick;
+		osg::NotifySeverity level;
+		const char* file;
+		int line;
+		unsigned int suppressed;
+		unsigned int length;
+		char text[maxMessageLength];
+	};
+
+	/**
+	 * \brief Stream buffer which formats into the fixed size text of a record and truncates on overflow.
+	 *
+	 */
+	class recordStreambuf : public std::streambuf
+	{
+	public:
+		void reset( char* buffer_, unsigned int size_ ) {setp(buffer_, buffer_+size_);};
+		unsigned int length() const {return pptr()-pbase();};
+	protected:
+		virtual int_type overflow( int_type c ) {return traits_type::not_eof(c);};
+	};
+
+	/**
+	 * \brief This struct contains the ring buffer of one thread.
+	 *
+	 * Only the owning thread writes records and increments writeCount, only the flusher increments readCount.
+	 */
+	struct threadBuffer
+	{
+		threadBuffer() : stream(&streambuf) {};
+
+		unsigned int id;
+		std::vector<record> records;
+		OpenThreads::Atomic writeCount;
+		OpenThreads::Atomic readCount;
+		OpenThreads::Atomic dropped;
+		unsigned int reportedDropped;	// Dropped messages which were already reported by the flusher
+		recordStreambuf streambuf;
+		std::ostream stream;
+		bool formatting;				// A message is being formatted, nested messages are written synchronously
+	};
+
+	/**
+	 * \brief This thread periodically writes the buffered messages.
+	 *
+	 */
+	class flushThread : public OpenThreads::Thread
+	{
+	public:
+		flushThread( util_log* log_ ) : log(log_) {};
+		virtual void run();
+	private:
+		util_log* log;
+	};
+
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_log();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the logger.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_log(const util_log& cc);
+
+	/**
+	 * \brief This function returns the buffer of the calling thread and creates it on first usage.
+	 *
+	 * @return : Buffer of the calling thread.
+	 */
+	threadBuffer* getThreadBuffer();
+
+	/**
+	 * \brief This function writes a record to osg::notify().
+	 *
+	 * @param record_ : Record to write.
+	 * @param threadId_ : Id of the thread which created the record.
+	 */
+	void write( const record& record_, unsigned int threadId_ );
+
+	/**
+	 * \brief This function reads an atomic value which is modified by another thread.
+	 *
+	 * It uses an atomic read-modify-write, because the plain read of OpenThreads::Atomic is reported as data race by ThreadSanitizer.
+	 *
+	 * @param value_ : Value to read.
+	 * @return : Current value.
+	 */
+	static unsigned int load( OpenThreads::Atomic& value_ ) {return value_.OR(0);};
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_log();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the logger.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_log* getInstance();
+
+	/**
+	 * \brief This class formats one message. Its destructor commits the message. Use it via OSGVISUAL_LOG.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class messageStream
+	{
+	public:
+		messageStream( osg::NotifySeverity level_, const char* file_, int line_, site* site_ );
+		~messageStream();
+
+		std::ostream& stream() {return *out;};
+	private:
+		osg::NotifySeverity level;
+		threadBuffer* buffer;
+		record* rec;
+		std::ostringstream* nested;		// Used if a message is formatted while formatting another one, e.g. by an operator<<
+		std::ostream* out;
+	};
+
+	/**
+	 * \brief This function checks the rate limit of a call site and counts the message.
+	 *
+	 * @param site_ : Call site.
+	 * @param maxPerSecond_ : Maximum number of messages per second, 0 means unlimited.
+	 * @return : True if the message may be written.
+	 */
+	static bool isAllowed( site* site_, unsigned int maxPerSecond_ );
+
+	/**
+	 * \brief This function starts the background thread. Afterwards, messages are written asynchronously.
+	 *
+	 * @param flushInterval_ : Interval between two writes in milliseconds.
+	 */
+	void start( unsigned int flushInterval_ = 20 );
+
+	/**
+	 * \brief This function writes all pending messages and stops the background thread. Afterwards, messages are written synchronously.
+	 *
+	 */
+	void stop();
+
+	/**
+	 * \brief This function writes all pending messages of all threads. It is called by the background thread.
+	 *
+	 */
+	void flush();
+
+	/**
+	 * \brief This function returns if the background thread is running.
+	 *
+	 * @return : True if messages are written asynchronously.
+	 */
+	bool isRunning() {return load(running) != 0;};
+
+	/**
+	 * \brief This function enables a prefix with time, thread and source location in front of each message.
+	 *
+	 * @param enabled_ : True to write the prefix.
+	 */
+	void setPrefixEnabled( bool enabled_ ) {prefixEnabled = enabled_;};
+
+	/**
+	 * \brief This function returns the number of messages which were dropped because a thread buffer was full.
+	 *
+	 * @return : Number of dropped messages.
+	 */
+	unsigned int getNumDroppedMessages();
+
+private:
+	/**
+	 * Buffers of all threads which logged messages. Buffers are kept until the logger is destroyed, even if their thread ends.
+	 */
+	std::vector<threadBuffer*> buffers;
+
+	/**
+	 * Mutex to protect the list of buffers.
+	 */
+	OpenThreads::Mutex buffersMutex;
+
+	/**
+	 * Mutex to serialize the writing of the flusher and of synchronous messages.
+	 */
+	OpenThreads::Mutex writeMutex;
+
+	/**
+	 * Mutex to allow only one thread at a time to drain the buffers.
+	 */
+	OpenThreads::Mutex flushMutex;
+
+	/**
+	 * Flag if the singleton is already destroyed. Messages of later static destructors are written synchronously.
+	 */
+	static bool destroyed;
+
+	/**
+	 * Background thread, NULL if not started.
+	 */
+	flushThread* thread;
+
+	/**
+	 * Flag if the background thread is running (1) or should stop (0).
+	 */
+	OpenThreads::Atomic running;
+
+	/**
+	 * Interval between two writes of the background thread in milliseconds.
+	 */
+	unsigned int flushInterval;
+
+	/**
+	 * Flag if a prefix is written in front of each message.
+	 */
+	bool prefixEnabled;
+
+	/**
+	 * Tick the time in the prefix refers to.
+	 */
+	osg::Timer_t startTick;
+};
+
+/**
+ * \brief Tag type which is unique for each translation unit, so util_logSite() creates one site per file and line.
+ */
+namespace
+{
+	struct util_logTranslationUnit {};
+}
+
+/**
+ * \brief This function returns the rate limiting state of a call site.
+ *
+ * @return : State of the call site identified by the template parameters.
+ */
+template<class TranslationUnit, int Line>
+util_log::site* util_logSite()
+{
+	static util_log::site instance;
+	return &instance;
+}
+
+}	// END NAMESPACE
@@ -0,0 +1,133 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Notify>
+
+#include <string>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class maps a file read-only into memory.
+ *
+ * The operating system pages the file in on demand, so only the parts which are accessed occupy memory.
+ * On Windows the file is mapped with CreateFileMapping / MapViewOfFile, on all other systems with mmap.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_mappedFile : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief Constructor
+	 *
+	 */
+	util_mappedFile();
+
+	/**
+	 * \brief Destructor: Unmaps the file if it is mapped.
+	 *
+	 */
+	~util_mappedFile();
+
+	/**
+	 * \brief This function maps the specified file into memory. A previously mapped file is unmapped.
+	 *
+	 * @param filename_ : File to map.
+	 * @return : True if successful.
+	 */
+	bool open( const std::string& filename_ );
+
+	/**
+	 * \brief This function unmaps the file.
+	 *
+	 */
+	void close();
+
+	/**
+	 * \brief This function returns if a file is mapped.
+	 *
+	 * @return : True if a file is mapped.
+	 */
+	bool isOpen() const {return data != NULL;};
+
+	/**
+	 * \brief This function returns the pointer to the begin of the mapped file.
+	 *
+	 * @return : Pointer to the file content, NULL if no file is mapped.
+	 */
+	const unsigned char* getData() const {return data;};
+
+	/**
+	 * \brief This function returns the size of the mapped file.
+	 *
+	 * @return : Size in bytes.
+	 */
+	size_t getSize() const {return size;};
+
+	/**
+	 * \brief This function returns the name of the mapped file.
+	 *
+	 * @return : Filename.
+	 */
+	const std::string& getFilename() const {return filename;};
+
+private:
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent copying the mapping.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_mappedFile(const util_mappedFile& cc);
+
+	/**
+	 * Pointer to the mapped file content.
+	 */
+	const unsigned char* data;
+
+	/**
+	 * Size of the mapped file in bytes.
+	 */
+	size_t size;
+
+	/**
+	 * Name of the mapped file.
+	 */
+	std::string filename;
+
+#ifdef WIN32
+	/**
+	 * Handle of the mapped file.
+	 */
+	HANDLE fileHandle;
+
+	/**
+	 * Handle of the file mapping.
+	 */
+	HANDLE mappingHandle;
+#endif
+};
+
+}	// END NAMESPACE
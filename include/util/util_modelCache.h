@@ -0,0 +1,288 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Node>
+#include <osg/Notify>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <util_config.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class loads model files through an optimizer chain and caches the optimized models as .osgb files.
+ *
+ * On the first load of a model file, it is read with its osgDB plugin (e.g. OpenFlight), optimized and written into the cache directory.
+ * Later loads read the cached .osgb file directly. The cache file is named by a hash of the resolved model file path, its modification time
+ * and size and the optimizer settings, so a changed model or changed settings create a new cache entry. Outdated entries are not deleted.
+ * The cached model embeds the images and external references of the model file. They are listed with their modification time and size
+ * in a .deps file next to the cache file, an entry whose dependencies were changed is rebuilt.
+ *
+ * The optimizer chain always removes redundant nodes and checks the geometry. Configurable steps are:
+ * - sharestate: Share duplicate state sets and state attributes.
+ * - merge: Merge geodes and geometries with the same state.
+ * - tristrip: Convert the triangles into triangle strips. It conflicts with vertexcache, which expects indexed triangles, and is disabled by default.
+ * - vertexcache: Reorder the triangles for the post-transform vertex cache and the vertices in access order.
+ * - texturecompression: Internal format of the textures: "none" (as loaded), "arb" (compressed by the driver)
+ *   or "dxt" (S3TC DXT1 for opaque, DXT5 for translucent images). The textures are compressed when they are uploaded.
+ *
+ * Each load is reported with its load time and the triangle, drawable and state set count, cache misses also with the count before optimization.
+ * Models can be compiled in advance by osgVisualModelCache.
+ *
+ * It is configured in the scenery section of the XML configuration. Without this node, models are loaded unoptimized and uncached:
+ * <scenery>
+ *   <modelcache directory="modelcache" sharestate="yes" merge="yes" tristrip="no" vertexcache="yes" texturecompression="none"></modelcache>
+ * </scenery>
+ *
+ * This class is realized as singleton, readNode() is thread safe.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_modelCache : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This enum lists the texture compression modes.
+	 *
+	 */
+	enum textureCompression
+	{
+		COMPRESSION_NONE,
+		COMPRESSION_ARB,
+		COMPRESSION_DXT
+	};
+
+	/**
+	 * \brief This struct contains the configurable steps of the optimizer chain.
+	 *
+	 */
+	struct optimizerSettings
+	{
+		optimizerSettings() : shareState(true), mergeGeometry(true), triStrip(false), vertexCache(true), compression(COMPRESSION_NONE) {};
+
+		bool shareState;
+		bool mergeGeometry;
+		bool triStrip;
+		bool vertexCache;
+		textureCompression compression;
+	};
+
+	/**
+	 * \brief This struct contains the statistics of a model.
+	 *
+	 */
+	struct modelStatistics
+	{
+		modelStatistics() : numTriangles(0), numDrawables(0), numStateSets(0), numTextures(0) {};
+
+		unsigned int numTriangles;
+		unsigned int numDrawables;
+		unsigned int numStateSets;		// Unique state sets
+		unsigned int numTextures;		// Unique textures
+	};
+
+	/**
+	 * \brief This struct describes a file which is embedded into an optimized model: an image or an external reference of the model file.
+	 *
+	 */
+	struct dependency
+	{
+		std::string filename;			// Resolved path
+		long long modificationTime;		// -1 if the file was not found
+		unsigned long long fileSize;
+	};
+	typedef std::vector<dependency> DependencyList;
+
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_modelCache();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the cache.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_modelCache(const util_modelCache& cc);
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_modelCache();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_modelCache* getInstance();
+
+	/**
+	 * \brief This function configures the cache by the <modelcache> node of the scenery section. Call it before models are loaded.
+	 *
+	 * @param config_ : <modelcache> node, NULL disables optimizing and caching.
+	 */
+	void configure( const util_config::node* config_ );
+
+	/**
+	 * \brief This function sets the cache directory and enables the cache. Call it before models are loaded.
+	 *
+	 * @param directory_ : Directory to store the optimized models in, it is created if required. An empty string disables optimizing and caching.
+	 */
+	void setCacheDirectory( const std::string& directory_ ) {cacheDirectory = directory_;};
+
+	/**
+	 * \brief This function returns the cache directory.
+	 *
+	 * @return : Cache directory, empty if the cache is disabled.
+	 */
+	const std::string& getCacheDirectory() const {return cacheDirectory;};
+
+	/**
+	 * \brief This function sets the optimizer chain. Call it before models are loaded.
+	 *
+	 * @param settings_ : Optimizer settings.
+	 */
+	void setSettings( const optimizerSettings& settings_ ) {settings = settings_;};
+
+	/**
+	 * \brief This function returns the optimizer chain.
+	 *
+	 * @return : Optimizer settings.
+	 */
+	const optimizerSettings& getSettings() const {return settings;};
+
+	/**
+	 * \brief This function loads a model file, from the cache if possible. Otherwise it is read, optimized and written into the cache.
+	 *
+	 * @param filename_ : Model file to load.
+	 * @param rebuild_ : True to ignore an existing cache entry and rebuild it.
+	 * @return : Loaded model, NULL if the file could not be read. Each call returns a new model.
+	 */
+	osg::Node* readNode( const std::string& filename_, bool rebuild_ = false );
+
+	/**
+	 * \brief This function applies the optimizer chain to a model.
+	 *
+	 * @param node_ : Model to optimize.
+	 */
+	void optimize( osg::Node* node_ ) const;
+
+	/**
+	 * \brief This function returns the cache file of a model file.
+	 *
+	 * @param filename_ : Model file.
+	 * @return : Cache file, empty if the cache is disabled or the model file is not found.
+	 */
+	std::string getCacheFilename( const std::string& filename_ ) const;
+
+	/**
+	 * \brief This function collects the images and the loaded external references of a model. Call it before optimize(), which removes the proxy nodes.
+	 *
+	 * @param node_ : Model as loaded from its file.
+	 * @param filename_ : Model file, relative references are searched in its directory first.
+	 * @return : Referenced files with their current modification time and size.
+	 */
+	static DependencyList collectDependencies( osg::Node* node_, const std::string& filename_ );
+
+	/**
+	 * \brief This function checks if the referenced files still have the recorded modification time and size.
+	 *
+	 * @param dependencies_ : Files to check.
+	 * @return : True if no file was changed.
+	 */
+	static bool isUpToDate( const DependencyList& dependencies_ );
+
+	/**
+	 * \brief This function counts the triangles, drawables, state sets and textures of a model.
+	 *
+	 * @param node_ : Model to analyze.
+	 * @return : Statistics of the model.
+	 */
+	static modelStatistics computeStatistics( osg::Node* node_ );
+
+	/**
+	 * \brief This function prints the number of loaded models, the cache hits and the total load time, if models were loaded.
+	 *
+	 */
+	void printReport();
+
+private:
+	/**
+	 * \brief This function reads the dependency file of a cache entry.
+	 *
+	 * @param filename_ : Dependency file.
+	 * @param dependencies_ : Dependencies to fill.
+	 * @return : True if successful.
+	 */
+	static bool readDependencies( const std::string& filename_, DependencyList& dependencies_ );
+
+	/**
+	 * \brief This function writes the dependency file of a cache entry.
+	 *
+	 * @param filename_ : Dependency file.
+	 * @param dependencies_ : Dependencies to write.
+	 * @return : True if successful.
+	 */
+	static bool writeDependencies( const std::string& filename_, const DependencyList& dependencies_ );
+
+	/**
+	 * Directory of the cache files, empty if the cache is disabled.
+	 */
+	std::string cacheDirectory;
+
+	/**
+	 * Optimizer chain.
+	 */
+	optimizerSettings settings;
+
+	/**
+	 * Mutex to protect the statistics and the creation of the cache files.
+	 */
+	OpenThreads::Mutex mutex;
+
+	/**
+	 * Number of loaded models and of cache hits.
+	 */
+	unsigned int numLoads;
+	unsigned int numCacheHits;
+
+	/**
+	 * Sum of the load times, including optimization, in s.
+	 */
+	double totalLoadTime;
+
+	/**
+	 * Counter to create unique temporary files.
+	 */
+	unsigned int numTemporaryFiles;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,268 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/Timer>
+#include <osg/Notify>
+
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <string>
+#include <vector>
+
+/**
+ * \brief Instrumentation macro: measures the time until the end of the enclosing scope and records it as event of the calling thread.
+ *
+ * The name has to be a string literal (or another string with static lifetime), only the pointer is stored.
+ * Without USE_PROFILER the macro expands to nothing, with USE_PROFILER a disabled profiler costs one branch.
+ */
+#ifdef USE_PROFILER
+	#define OSGVISUAL_PROFILE_CONCAT_(a_,b_) a_##b_
+	#define OSGVISUAL_PROFILE_CONCAT(a_,b_) OSGVISUAL_PROFILE_CONCAT_(a_,b_)
+	#define OSGVISUAL_PROFILE_SCOPE(name_) osgVisual::util_profiler::scopedTimer OSGVISUAL_PROFILE_CONCAT(profileScope_, __LINE__)(name_)
+#else
+	#define OSGVISUAL_PROFILE_SCOPE(name_)
+#endif
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class records the durations of instrumented code sections to analyze where the frame time goes.
+ *
+ * Sections are instrumented by OSGVISUAL_PROFILE_SCOPE("name"). Each thread records into its own ring buffer,
+ * so the threads do not block each other. If a buffer is full, the oldest events are overwritten.
+ * The recorded events can be exported as Chrome trace (chrome://tracing, Perfetto) or as CSV.
+ *
+ * The profiler is disabled by default and enabled by visual_core with the command line option --profile.
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_profiler : public osg::Referenced
+{
+	#include <leakDetection.h>
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_profiler();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the profiler.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_profiler(const util_profiler& cc);
+
+	/**
+	 * \brief This struct contains one recorded section.
+	 *
+	 */
+	struct event
+	{
+		const char* name;
+		osg::Timer_t start;
+		osg::Timer_t end;
+		unsigned int frameNumber;
+	};
+
+	/**
+	 * \brief This struct contains the ring buffer of one thread.
+	 *
+	 */
+	struct threadBuffer
+	{
+		unsigned int id;
+		std::string name;
+		std::vector<event> events;
+		unsigned int next;				// Position to write the next event to
+		bool wrapped;					// Older events were overwritten
+		OpenThreads::Mutex mutex;		// Protects the buffer against concurrent export
+	};
+
+	/**
+	 * \brief This function returns the buffer of the calling thread and creates it on first usage.
+	 *
+	 * @return : Buffer of the calling thread.
+	 */
+	threadBuffer* getThreadBuffer();
+
+	/**
+	 * \brief This function returns a copy of the recorded events of a buffer in chronological order.
+	 *
+	 * @param buffer_ : Buffer to copy.
+	 * @param events_ : Vector to copy the events into.
+	 */
+	void copyEvents( threadBuffer* buffer_, std::vector<event>& events_ );
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_profiler();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the profiler.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_profiler* getInstance();
+
+	/**
+	 * \brief This class measures the lifetime of its instance and records it as event. Use it via OSGVISUAL_PROFILE_SCOPE.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class scopedTimer
+	{
+	public:
+		scopedTimer( const char* name_ ) : name(NULL)
+		{
+			if( util_profiler::isEnabled() )
+			{
+				name = name_;
+				start = osg::Timer::instance()->tick();
+			}
+		}
+
+		~scopedTimer()
+		{
+			if( name )
+				util_profiler::getInstance()->record( name, start, osg::Timer::instance()->tick() );
+		}
+	private:
+		const char* name;
+		osg::Timer_t start;
+	};
+
+	/**
+	 * \brief This function enables or disables the recording.
+	 *
+	 * @param enabled_ : True to enable recording.
+	 */
+	void setEnabled( bool enabled_ ) {enabled.exchange( enabled_ ? 1 : 0 );};
+
+	/**
+	 * \brief This function returns if the recording is enabled.
+	 *
+	 * It uses an atomic read-modify-write, because the plain read of OpenThreads::Atomic is reported as data race by ThreadSanitizer.
+	 *
+	 * @return : True if enabled.
+	 */
+	static bool isEnabled() {return enabled.OR(0) != 0;};
+
+	/**
+	 * \brief This function sets the number of events each thread can hold. It applies to threads which record their first event afterwards.
+	 *
+	 * @param numEvents_ : Capacity of the ring buffer of each thread. Default is 65536.
+	 */
+	void setBufferSize( unsigned int numEvents_ ) {bufferSize = numEvents_ > 0 ? numEvents_ : 1;};
+
+	/**
+	 * \brief This function sets the frame number which is assigned to the following events of all threads.
+	 *
+	 * @param frameNumber_ : Actual frame number.
+	 */
+	void setFrameNumber( unsigned int frameNumber_ ) {frameNumber.exchange( frameNumber_ );};
+
+	/**
+	 * \brief This function sets the name of the calling thread, which is shown in the exported trace.
+	 *
+	 * @param name_ : Name of the thread.
+	 */
+	void setThreadName( const std::string& name_ );
+
+	/**
+	 * \brief This function records an event for the calling thread.
+	 *
+	 * @param name_ : Name of the section. Only the pointer is stored, so it has to stay valid until export.
+	 * @param start_ : Tick at the begin of the section.
+	 * @param end_ : Tick at the end of the section.
+	 */
+	void record( const char* name_, osg::Timer_t start_, osg::Timer_t end_ );
+
+	/**
+	 * \brief This function discards all recorded events.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * \brief This function writes the recorded events in the Chrome trace event format (JSON).
+	 *
+	 * @param filename_ : File to write.
+	 * @return : True if successful.
+	 */
+	bool writeChromeTrace( const std::string& filename_ );
+
+	/**
+	 * \brief This function writes the recorded events as CSV: thread, frame, name, start and duration in ms.
+	 *
+	 * @param filename_ : File to write.
+	 * @return : True if successful.
+	 */
+	bool writeCSV( const std::string& filename_ );
+
+	/**
+	 * \brief This function writes the recorded events as CSV if the filename ends with .csv, otherwise as Chrome trace.
+	 *
+	 * @param filename_ : File to write.
+	 * @return : True if successful.
+	 */
+	bool write( const std::string& filename_ );
+
+private:
+	/**
+	 * 1 if recording is enabled. Static to make the check in scopedTimer as cheap as possible, atomic because the worker threads read it while the main thread toggles it.
+	 */
+	static OpenThreads::Atomic enabled;
+
+	/**
+	 * Buffers of all threads which recorded events. Buffers are kept until the profiler is destroyed, even if their thread ends.
+	 */
+	std::vector<threadBuffer*> buffers;
+
+	/**
+	 * Mutex to protect the list of buffers.
+	 */
+	OpenThreads::Mutex buffersMutex;
+
+	/**
+	 * Capacity of newly created ring buffers.
+	 */
+	unsigned int bufferSize;
+
+	/**
+	 * Frame number which is assigned to recorded events, atomic because the worker threads read it while the main thread advances it.
+	 */
+	OpenThreads::Atomic frameNumber;
+
+	/**
+	 * Tick the exported timestamps refer to.
+	 */
+	osg::Timer_t startTick;
+};
+
+}	// END NAMESPACE
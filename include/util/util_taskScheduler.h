@@ -0,0 +1,402 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Notify>
+
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class executes the per-frame jobs of the modules in parallel on all cores, in the order required by their data dependencies.
+ *
+ * Modules register their jobs once with addJob() and declare which data each job reads and writes, by resource names like "objects" or "scene graph".
+ * visual_core calls runFrame() between the event and the update traversal, so all jobs are completed before cull. A job depends on each job
+ * before it which writes data it reads or writes, or which reads data it writes. The jobs are ordered by their order key (see job::order),
+ * which reproduces the sequence of the former serial update callbacks, and by registration for equal keys. Independent jobs run in parallel.
+ *
+ * A job with several items (e.g. one per object) is split into tasks of grain size items. Each thread pushes the tasks of the jobs it releases
+ * into its own queue and executes them from the back, idle threads steal tasks from the front of the other queues.
+ * Jobs which modify the scene graph or other objects which are not thread safe (e.g. osgText) are main thread jobs: they are executed
+ * by the thread which calls runFrame(), all other jobs by any thread. Jobs must not use util_frameArena unless they are main thread jobs.
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_taskScheduler : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This class is the base class of all per-frame jobs.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class job : public osg::Referenced
+	{
+	public:
+		/**
+		 * \brief This enum contains the order keys of the jobs of osgVisual. Jobs with the same key and no common data may run in any order.
+		 *
+		 */
+		enum order
+		{
+			ORDER_OBJECTS = 100,			// Object updaters and transforms from the received positions
+			ORDER_GROUND_CLAMPING = 200,	// Terrain queries of the clamped objects
+			ORDER_DISPLAY = 300,			// Values for the HUD and the sky, from the camera of the last frame
+			ORDER_APPLY = 400				// Main thread jobs which write the results into the scene graph
+		};
+
+		/**
+		 * \brief Constructor
+		 *
+		 * @param name_ : Name of the job for the profiler. The profiler stores only the pointer, so it has to be a string literal.
+		 * @param order_ : Order key, see enum order.
+		 * @param mainThread_ : True if the job must be executed by the main thread.
+		 */
+		job( const char* name_, int order_, bool mainThread_ = false );
+
+		/**
+		 * \brief This function declares a resource which the job reads.
+		 *
+		 * @param resource_ : Name of the resource.
+		 */
+		void reads( const std::string& resource_ ) {readResources.push_back( resource_ );};
+
+		/**
+		 * \brief This function declares a resource which the job writes.
+		 *
+		 * @param resource_ : Name of the resource.
+		 */
+		void writes( const std::string& resource_ ) {writeResources.push_back( resource_ );};
+
+		/**
+		 * \brief This function returns the number of items to process in this frame. It is called when the job is released.
+		 *
+		 * @return : Number of items, 0 skips the job.
+		 */
+		virtual unsigned int getNumItems() {return 1;};
+
+		/**
+		 * \brief This function processes a range of items. Ranges of the same job may be processed in parallel.
+		 *
+		 * @param begin_ : First item.
+		 * @param end_ : Item after the last one.
+		 */
+		virtual void run( unsigned int begin_, unsigned int end_ ) = 0;
+
+		/**
+		 * \brief This function sets the number of items which are processed by one task.
+		 *
+		 * @param grainSize_ : Items per task, at least 1.
+		 */
+		void setGrainSize( unsigned int grainSize_ ) {grainSize = grainSize_ > 0 ? grainSize_ : 1;};
+
+		const char* getName() const {return name;};
+		int getOrder() const {return orderKey;};
+		bool isMainThreadJob() const {return mainThread;};
+		unsigned int getGrainSize() const {return grainSize;};
+
+	protected:
+		virtual ~job() {};
+
+	private:
+		/**
+		 * \brief This function checks if this job must wait for a job which is ordered before.
+		 *
+		 * @param other_ : Job before this one.
+		 * @return : True if the jobs access common data and at least one of them writes it.
+		 */
+		bool dependsOn( const job* other_ ) const;
+
+		const char* name;
+		int orderKey;
+		bool mainThread;
+		unsigned int grainSize;
+		std::vector<std::string> readResources;
+		std::vector<std::string> writeResources;
+
+		/**
+		 * Indices of the jobs which depend on this job, managed by the scheduler.
+		 */
+		std::vector<unsigned int> successors;
+
+		/**
+		 * Number of jobs this job depends on.
+		 */
+		unsigned int numDependencies;
+
+		/**
+		 * Jobs this job still waits for in the current frame.
+		 */
+		OpenThreads::Atomic pendingDependencies;
+
+		/**
+		 * Tasks of this job which are not completed in the current frame.
+		 */
+		OpenThreads::Atomic pendingTasks;
+
+		friend class util_taskScheduler;
+	};
+
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_taskScheduler();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the scheduler.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_taskScheduler(const util_taskScheduler& cc);
+
+	/**
+	 * \brief This struct contains a range of items of a job.
+	 *
+	 */
+	struct task
+	{
+		unsigned int job;
+		unsigned int begin;
+		unsigned int end;
+	};
+
+	/**
+	 * \brief This class is the task queue of one thread. The owner takes tasks from the back, other threads steal from the front.
+	 *
+	 * The tasks are kept in a vector which is only cleared when empty, so the queue does not allocate once it is warm.
+	 */
+	class taskQueue
+	{
+	public:
+		taskQueue() : head(0) {};
+		void push( const task& task_ );
+		bool pop( task& task_ );
+		bool steal( task& task_ );
+	private:
+		OpenThreads::Mutex mutex;
+		std::vector<task> tasks;
+		unsigned int head;
+	};
+
+	/**
+	 * \brief This thread executes tasks until the scheduler is shut down.
+	 *
+	 */
+	class workerThread : public OpenThreads::Thread
+	{
+	public:
+		workerThread( util_taskScheduler* scheduler_, unsigned int index_ ) : scheduler(scheduler_), index(index_) {};
+		virtual void run();
+	private:
+		util_taskScheduler* scheduler;
+		unsigned int index;
+	};
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_taskScheduler();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the scheduler.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_taskScheduler* getInstance();
+
+	/**
+	 * \brief This function registers a job which is executed each frame. Do not call it during runFrame().
+	 *
+	 * @param job_ : Job to register.
+	 */
+	void addJob( job* job_ );
+
+	/**
+	 * \brief This function unregisters a job. Do not call it during runFrame().
+	 *
+	 * @param job_ : Job to unregister.
+	 */
+	void removeJob( job* job_ );
+
+	/**
+	 * \brief This function executes all registered jobs and returns when all of them are completed. Call it from the main thread.
+	 *
+	 */
+	void runFrame();
+
+	/**
+	 * \brief This function starts the worker threads. Without worker threads, runFrame() executes all jobs in the calling thread.
+	 *
+	 * @param numThreads_ : Number of worker threads. 0 means: number of processors minus one.
+	 */
+	void start( unsigned int numThreads_ = 0 );
+
+	/**
+	 * \brief This function stops and joins all worker threads.
+	 *
+	 */
+	void shutdown();
+
+	/**
+	 * \brief This function returns the number of worker threads.
+	 *
+	 * @return : Number of worker threads, the main thread is not counted.
+	 */
+	unsigned int getNumThreads() {return threads.size();};
+
+	/**
+	 * \brief This function returns the number of registered jobs.
+	 *
+	 * @return : Number of jobs.
+	 */
+	unsigned int getNumJobs() {return jobs.size();};
+
+private:
+	/**
+	 * \brief This function computes the dependencies between the registered jobs.
+	 *
+	 */
+	void buildGraph();
+
+	/**
+	 * \brief This function splits a job whose dependencies are completed into tasks and queues them.
+	 *
+	 * @param job_ : Index of the job.
+	 * @param queue_ : Index of the queue of the calling thread.
+	 */
+	void release( unsigned int job_, unsigned int queue_ );
+
+	/**
+	 * \brief This function marks a job as completed and releases the jobs which waited for it.
+	 *
+	 * @param job_ : Index of the job.
+	 * @param queue_ : Index of the queue of the calling thread.
+	 */
+	void complete( unsigned int job_, unsigned int queue_ );
+
+	/**
+	 * \brief This function executes a task and completes its job after the last task.
+	 *
+	 * @param task_ : Task to execute.
+	 * @param queue_ : Index of the queue of the calling thread.
+	 */
+	void execute( const task& task_, unsigned int queue_ );
+
+	/**
+	 * \brief This function takes a task from the own queue or steals one from another queue.
+	 *
+	 * @param queue_ : Index of the queue of the calling thread.
+	 * @param task_ : Found task.
+	 * @return : True if a task was found.
+	 */
+	bool findTask( unsigned int queue_, task& task_ );
+
+	/**
+	 * \brief This function executes tasks in a worker thread until the scheduler is shut down.
+	 *
+	 * @param queue_ : Index of the queue of the worker thread.
+	 */
+	void workerLoop( unsigned int queue_ );
+
+	/**
+	 * \brief This function wakes all waiting threads.
+	 *
+	 */
+	void wake();
+
+	/**
+	 * \brief This function reads an atomic value which is modified by another thread.
+	 *
+	 * It uses an atomic read-modify-write, because the plain read of OpenThreads::Atomic is reported as data race by ThreadSanitizer.
+	 *
+	 * @param value_ : Value to read.
+	 * @return : Current value.
+	 */
+	static unsigned int load( OpenThreads::Atomic& value_ ) {return value_.OR(0);};
+
+	/**
+	 * Registered jobs, sorted by their order key.
+	 */
+	std::vector< osg::ref_ptr<job> > jobs;
+
+	/**
+	 * Flag if the dependencies must be computed again.
+	 */
+	bool graphDirty;
+
+	/**
+	 * Task queues of the threads, index 0 belongs to the thread which calls runFrame().
+	 */
+	std::vector<taskQueue*> queues;
+
+	/**
+	 * Tasks of the main thread jobs.
+	 */
+	taskQueue mainQueue;
+
+	/**
+	 * Worker threads, worker i uses queue i+1.
+	 */
+	std::vector<workerThread*> threads;
+
+	/**
+	 * Number of tasks in the thread queues.
+	 */
+	OpenThreads::Atomic queuedTasks;
+
+	/**
+	 * Number of tasks in the main queue.
+	 */
+	OpenThreads::Atomic queuedMainTasks;
+
+	/**
+	 * Jobs which are not completed in the current frame.
+	 */
+	OpenThreads::Atomic pendingJobs;
+
+	/**
+	 * 1 while the worker threads are running.
+	 */
+	OpenThreads::Atomic running;
+
+	/**
+	 * Mutex and condition to wait for tasks or for the completion of the frame.
+	 */
+	OpenThreads::Mutex wakeMutex;
+	OpenThreads::Condition wakeCondition;
+};
+
+}	// END NAMESPACE
@@ -0,0 +1,229 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Notify>
+#include <osg/CoordinateSystemNode>
+
+#include <util_mappedFile.h>
+
+#include <string>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class provides height of terrain lookups from a precompiled, memory mapped height grid.
+ *
+ * The height grid file is created offline by osgVisualHeightGridCompiler, which samples the terrain database at its
+ * highest level of detail. A lookup takes constant time and does not traverse the scene graph, so the result does
+ * not depend on which tiles are currently loaded by the pager.
+ *
+ * The file contains several levels, each a regular geodetic grid with its own extent and spacing. A lookup uses the finest
+ * level which covers the position and interpolates bilinearly between the four surrounding samples.
+ * The samples of each level are stored in square tiles to keep neighbouring samples on the same memory pages.
+ *
+ * File layout (native byte order, little endian on all supported platforms):
+ * - fileHeader
+ * - numLevels x levelHeader, ordered from the coarsest to the finest level
+ * - per level: numTilesLat x numTilesLon tiles of tileSize x tileSize float samples in meter, row by row.
+ *
+ * This class is realized as singleton.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_terrainHeightGrid : public osg::Referenced
+{
+	#include <leakDetection.h>
+public:
+	/**
+	 * \brief This struct describes one level of the height grid. All angles are in radians.
+	 *
+	 */
+	struct gridLevel
+	{
+		gridLevel() : latMin(0.0), lonMin(0.0), latMax(0.0), lonMax(0.0), numLat(0), numLon(0) {};
+
+		double latMin;
+		double lonMin;
+		double latMax;
+		double lonMax;
+		unsigned int numLat;	// Number of samples in latitude direction, at least 2
+		unsigned int numLon;	// Number of samples in longitude direction, at least 2
+	};
+
+	/**
+	 * Sample value for positions without terrain. Lookups touching such a sample fall back to the next coarser level.
+	 */
+	static const float NO_DATA;
+
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_terrainHeightGrid();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the height grid.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_terrainHeightGrid(const util_terrainHeightGrid& cc);
+
+	/**
+	 * \brief Header at the begin of the file.
+	 *
+	 */
+	struct fileHeader
+	{
+		char magic[4];				// "OVHG"
+		unsigned int version;
+		unsigned int numLevels;
+		unsigned int tileSize;
+	};
+
+	/**
+	 * \brief Header of each level in the file.
+	 *
+	 */
+	struct levelHeader
+	{
+		double latMin;
+		double lonMin;
+		double latMax;
+		double lonMax;
+		unsigned int numLat;
+		unsigned int numLon;
+		unsigned int numTilesLat;
+		unsigned int numTilesLon;
+	};
+
+	/**
+	 * \brief Runtime information of each level, pointing into the mapped file.
+	 *
+	 */
+	struct mappedLevel
+	{
+		levelHeader header;
+		double latScale;		// Samples per radian latitude
+		double lonScale;		// Samples per radian longitude
+		const float* samples;
+	};
+
+	/**
+	 * \brief This function returns the sample of a level at the specified grid index.
+	 *
+	 * @param level_ : Level to read from.
+	 * @param iLat_ : Sample index in latitude direction.
+	 * @param iLon_ : Sample index in longitude direction.
+	 * @return : Height in meter or NO_DATA.
+	 */
+	inline float getSample( const mappedLevel& level_, unsigned int iLat_, unsigned int iLon_ ) const
+	{
+		unsigned int tile = (iLat_ / tileSize) * level_.header.numTilesLon + (iLon_ / tileSize);
+		return level_.samples[ tile*tileSize*tileSize + (iLat_ % tileSize)*tileSize + (iLon_ % tileSize) ];
+	}
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_terrainHeightGrid();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_terrainHeightGrid* getInstance();
+
+	/**
+	 * \brief This function maps the specified height grid file. A previously loaded grid is unloaded.
+	 *
+	 * @param filename_ : Height grid file created by osgVisualHeightGridCompiler.
+	 * @return : True if successful.
+	 */
+	bool load( const std::string& filename_ );
+
+	/**
+	 * \brief This function unloads the height grid.
+	 *
+	 */
+	void unload();
+
+	/**
+	 * \brief This function returns if a height grid is loaded.
+	 *
+	 * @return : True if loaded.
+	 */
+	bool isLoaded() const {return !levels.empty();};
+
+	/**
+	 * \brief This function queries the height of terrain (hot) at the specified location.
+	 *
+	 * @param hot_ : Reference to write the hot into.
+	 * @param lat_ : Latitude of the position in radians.
+	 * @param lon_ : Longitude of the position in radians.
+	 * @return : True if the position is covered by the grid. If false, hot_ is unchanged.
+	 */
+	bool queryHeightOfTerrain( double& hot_, double lat_, double lon_ ) const;
+
+	/**
+	 * \brief This function queries the height above terrain (hat) at the specified location.
+	 *
+	 * @param hat_ : Reference to write the hat into.
+	 * @param lat_ : Latitude of the position in radians.
+	 * @param lon_ : Longitude of the position in radians.
+	 * @param height_ : Height of the position in meter.
+	 * @return : True if the position is covered by the grid. If false, hat_ is unchanged.
+	 */
+	bool queryHeightAboveTerrain( double& hat_, double lat_, double lon_, double height_ ) const;
+
+	/**
+	 * \brief This function writes a height grid file. It is used by osgVisualHeightGridCompiler.
+	 *
+	 * @param filename_ : File to write.
+	 * @param levels_ : Levels to write, ordered from the coarsest to the finest level.
+	 * @param heights_ : Samples of each level, row by row: heights_[level][iLat*numLon + iLon].
+	 * @param tileSize_ : Edge length of the square tiles in samples.
+	 * @return : True if successful.
+	 */
+	static bool write( const std::string& filename_, const std::vector<gridLevel>& levels_, const std::vector< std::vector<float> >& heights_, unsigned int tileSize_ );
+
+private:
+	/**
+	 * Mapped height grid file.
+	 */
+	osg::ref_ptr<util_mappedFile> file;
+
+	/**
+	 * Levels of the loaded grid, ordered from the coarsest to the finest level.
+	 */
+	std::vector<mappedLevel> levels;
+
+	/**
+	 * Edge length of the square tiles in samples.
+	 */
+	unsigned int tileSize;
+};
+
+}	// END NAMESPACE
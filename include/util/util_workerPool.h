@@ -0,0 +1,235 @@
+#pragma once
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/Referenced>
+#include <osg/OperationThread>
+#include <osg/Notify>
+
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
+#include <deque>
+#include <vector>
+
+namespace osgVisual
+{
+
+/**
+ * \brief This class provides a pool of worker threads to execute background operations.
+ *
+ * The pool has two queues: The operations of runAndWait() are executed before all background operations queued by add(),
+ * so a caller which waits for its result is never delayed by queued background work. The calling thread of runAndWait()
+ * executes queued runAndWait() operations itself while it waits, so the call completes even if all worker threads are busy
+ * with long running background operations.
+ *
+ * The threads are started on first usage. After shutdown() the pool rejects new operations until it is started again explicitly.
+ * Operations which are discarded by the pool are informed if they derive from util_workerPool::discardableOperation.
+ * This class is realized as singleton to allow all modules to share the same worker threads.
+ *
+ * @author Torben Dannhauer
+ * @date  Oct 2026
+ */
+class util_workerPool : public osg::Referenced
+{
+	#include <leakDetection.h>
+private:
+	/**
+	 * \brief Constructor: It is private to prevent creating instances via ptr* = new ..().
+	 *
+	 */
+	util_workerPool();
+
+	/**
+	 * \brief Copy-Constuctor: It is private to prevent getting instances via copying the pool.
+	 *
+	 * @param cc : Instance to copy from.
+	 */
+	util_workerPool(const util_workerPool& cc);
+
+public:
+	/**
+	 * \brief Public destructor to allow singleton cleanup from extern
+	 *
+	 */
+	~util_workerPool();
+
+	/**
+	 * \brief This function returns an pointer to the singleton instance of the worker pool.
+	 *
+	 * @return : Pointer to the instance.
+	 */
+	static util_workerPool* getInstance();
+
+	/**
+	 * \brief Base class for operations which must not get lost silently, e.g. because somebody waits for their result.
+	 *
+	 * If the pool does not execute such an operation, because it was shut down, discard() is called instead.
+	 *
+	 * @author Torben Dannhauer
+	 * @date  Oct 2026
+	 */
+	class discardableOperation : public osg::Operation
+	{
+	public:
+		discardableOperation(const std::string& name_, bool keep_) : osg::Operation(name_, keep_) {};
+
+		/**
+		 * \brief This function is called instead of the operation if the pool discards it.
+		 *
+		 */
+		virtual void discard() = 0;
+	};
+
+	/**
+	 * \brief This function adds a background operation to the queue. The operation is executed by the next idle worker thread.
+	 *
+	 * If the pool is not started, it is started with the default number of threads.
+	 * After shutdown() the operation is rejected and discarded immediately.
+	 *
+	 * @param operation_ : Operation to execute.
+	 * @return : True if the operation was queued, false if it was rejected.
+	 */
+	bool add( osg::Operation* operation_ );
+
+	/**
+	 * \brief This function executes the operations in parallel and returns when all of them are completed.
+	 *
+	 * The operations are queued before all background operations. The last operation is executed by the calling thread,
+	 * which afterwards helps to execute the queued runAndWait() operations. Therefore the function may also be called
+	 * from an operation executed by the pool, and it completes all operations even if the pool is not started or shut down.
+	 *
+	 * @param operations_ : Operations to execute.
+	 */
+	void runAndWait( std::vector< osg::ref_ptr<osg::Operation> >& operations_ );
+
+	/**
+	 * \brief This function starts the worker threads. Calling it on a running pool has no effect. A pool which was shut down accepts operations again.
+	 *
+	 * @param numThreads_ : Number of worker threads. 0 means: number of processors minus one, at least one.
+	 */
+	void start( unsigned int numThreads_ = 0 );
+
+	/**
+	 * \brief This function stops and joins all worker threads.
+	 *
+	 * Pending background operations are discarded, see discardableOperation. Pending runAndWait() operations are completed by their callers.
+	 *
+	 */
+	void shutdown();
+
+	/**
+	 * \brief This function returns the number of running worker threads.
+	 *
+	 * @return : Number of worker threads, 0 if the pool is not started.
+	 */
+	unsigned int getNumThreads();
+
+	/**
+	 * \brief This function returns the number of operations waiting for execution.
+	 *
+	 * @return : Number of queued operations of both queues.
+	 */
+	unsigned int getNumPendingOperations();
+
+private:
+	/**
+	 * \brief This struct contains a queued operation of runAndWait() and the counter of its call.
+	 *
+	 */
+	struct batchEntry
+	{
+		batchEntry( osg::Operation* operation_, unsigned int* pending_ ) : operation(operation_), pending(pending_) {};
+		osg::ref_ptr<osg::Operation> operation;
+		unsigned int* pending;
+	};
+
+	/**
+	 * \brief This thread executes operations until the pool is shut down.
+	 *
+	 */
+	class workerThread : public OpenThreads::Thread
+	{
+	public:
+		workerThread( util_workerPool* pool_, unsigned int generation_ ) : pool(pool_), generation(generation_) {};
+		virtual void run();
+	private:
+		util_workerPool* pool;
+		unsigned int generation;
+	};
+
+	/**
+	 * \brief This function is executed by the worker threads.
+	 *
+	 * @param generation_ : Generation of the thread, it leaves the loop when the pool is shut down and the generation changes.
+	 */
+	void workerLoop( unsigned int generation_ );
+
+	/**
+	 * \brief This function executes a queued runAndWait() operation and signals its completion. The mutex has to be locked by the caller.
+	 *
+	 */
+	void executeBatchEntry();
+
+	/**
+	 * \brief This function starts the worker threads. The mutex has to be locked by the caller.
+	 *
+	 * @param numThreads_ : Number of worker threads. 0 means: number of processors minus one, at least one.
+	 */
+	void startThreads( unsigned int numThreads_ );
+
+	/**
+	 * \brief This function informs an operation that it will not be executed.
+	 *
+	 * @param operation_ : Discarded operation.
+	 */
+	static void discardOperation( osg::Operation* operation_ );
+
+	/**
+	 * Operations of runAndWait(), they are executed before the background operations.
+	 */
+	std::deque<batchEntry> batchOperations;
+
+	/**
+	 * Background operations queued by add().
+	 */
+	std::deque< osg::ref_ptr<osg::Operation> > backgroundOperations;
+
+	/**
+	 * List of the worker threads.
+	 */
+	std::vector<workerThread*> threads;
+
+	/**
+	 * Mutex to protect the queues and the thread list, and condition to wait for operations or for their completion.
+	 */
+	OpenThreads::Mutex mutex;
+	OpenThreads::Condition condition;
+
+	/**
+	 * Generation of the running worker threads, incremented by shutdown().
+	 */
+	unsigned int generation;
+
+	/**
+	 * Flag if the pool was shut down and rejects new operations.
+	 */
+	bool stopped;
+};
+
+}	// END NAMESPACE
@@ -33,6 +33,8 @@
 
 #include <osgUtil/LineSegmentIntersector>
 
+#include <util_config.h>
+
 
 
 #ifdef FUNFUNCTIONS_ENABLED
@@ -223,37 +225,14 @@ public:
 	static bool setTransparentWindowBackground(osgViewer::Viewer* viewer_);
 
 	/**
-	 * \brief Parses for the XML node of the specified module. The caller has to clean up the xmlDoc and the parser, beside it returns NULL because the queried modules is not configured.
-	 * 
-	 * To clean up, call this two functions:
-	 *  xmlFreeDoc(doc);
-	 *  xmlCleanupParser();
-	 * 
-	 * Example to use this function: 
-	 *	xmlDoc* tmpDoc;
-	 *  xmlNode* yourNode = util::getModuleXMLConfig( configFilename, "core", tmpDoc );
-	 *  // use yourNode
-	 *  if(yourNode)
-	 *  {
-	 *     xmlFreeDoc(tmpDoc); xmlCleanupParser();
-	 *  }
+	 * \brief Returns the typed configuration of the specified module from util_config.
 	 * 
 	 * @param configFilename : Config Filename to parse.
 	 * @param moduleName : Module name to search for.
-	 * @param doc : xmlDoc to use. Must be created outside that the caller can clean it up.
 	 * @param disabled : Contains after return if the module was disabled. Only true if valid configuration and definitely disabled.
-	 * @return : NULL on error, otherwise pointer to the xmlNode of the queried module.
-	 */ 
-	static xmlNode* getModuleXMLConfig(std::string configFilename, std::string moduleName, xmlDoc*& doc, bool& disabled);
-
-	/**
-	 * \brief Parses for the XML node of the scenery configuration. The caller has to clean up the xmlDoc and the parser, beside it returns NULL because the queried modules is not configured.
-	 * 
-	 * @param configFilename : Config Filename to parse.
-	 * @param doc : xmlDoc to use. Must be created outside that the caller can clean it up.
-	 * @return : NULL on error, otherwise pointer to the xmlNode of the scenery configuration.
+	 * @return : NULL on error or if the module is not enabled, otherwise the <module> section.
 	 */ 
-	static xmlNode* getSceneryXMLConfig(std::string configFilename, xmlDoc*& doc);
+	static const util_config::node* getModuleConfig(std::string configFilename, std::string moduleName, bool& disabled);
 
 	/**
 	 * \brief This function returns the path of the terrainfile specified in the configuration file.
@@ -271,6 +250,40 @@ public:
 	 */ 
 	static std::string getAnimationPathFromXMLConfig(std::string configFilename);
 
+	/**
+	 * \brief This function returns the path of the terrain height grid file specified in the configuration file.
+	 * 
+	 * @param configFilename : Filename of the XML configuration file.
+	 * @return : On error or if no height grid is configured an empty string, otherwise the path of the height grid file.
+	 */ 
+	static std::string getHeightGridFromXMLConfig(std::string configFilename);
+
+	/**
+	 * \brief This function returns the path of the compiled scenery archive specified in the configuration file.
+	 * 
+	 * @param configFilename : Filename of the XML configuration file.
+	 * @return : On error or if no scenery archive is configured an empty string, otherwise the path of the scenery archive.
+	 */ 
+	static std::string getSceneryArchiveFromXMLConfig(std::string configFilename);
+
+	/**
+	 * \brief This function returns the geometry files of all models specified in the scenery section of the configuration file.
+	 * 
+	 * A file is listed once for every model which uses it.
+	 * 
+	 * @param configFilename : Filename of the XML configuration file.
+	 * @return : List of model files, empty on error or if no models are configured.
+	 */ 
+	static std::vector<std::string> getModelFilesFromXMLConfig(std::string configFilename);
+
+	/**
+	 * \brief This function returns the typed scenery configuration.
+	 * 
+	 * @param configFilename : Filename of the XML configuration file.
+	 * @return : Scenery section, NULL on error or if no scenery is configured.
+	 */ 
+	static const util_config::node* getSceneryConfig(std::string configFilename);
+
 	/**
 	 * \brief This function converts a string into a double.
 	 * 
@@ -342,27 +355,6 @@ public:
 		return fnotv._foundNode;
 	}
 
-private: 
-	/**
-	 * \brief This functions checks a list of nodes and all of its children for the specified module configuration.
-	 * 
-	 * This function is used by getModuleXMLConfig() and works recursive
-	 * 
-	 * @param node : Node to search in
-	 * @param moduleName :Module name to search for.
-	 * @param disabled : Contains after return if the module was disabled. Only true if valid configuration and definitely disabled.
-	 * @return : NULL if the module configuration was not found, otherwise pointer to the XML Node with the configuration for the specified module. 
-	 */ 
-	static xmlNode* checkXMLNodeChildrenForModule(xmlNode* node, std::string moduleName, bool& disabled);
-
-	/**
-	 * \brief This functions checks a list of nodes and all of its children for the scenery configuration.
-	 * 
-	 * @param node : Node to search in
-	 * @return : NULL if the module configuration was not found, otherwise pointer to the XML Node with the configuration for the specified module. 
-	 */ 
-	static xmlNode* checkXMLNodeChildrenForScenery(xmlNode* node);
-
 };
 
 } //END NAMESPACE
\ No newline at end of file
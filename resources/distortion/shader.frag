@@ -1,6 +1,8 @@
 uniform sampler2D textureImage;
 uniform sampler2D textureDistort;
 uniform sampler2D textureBlend;
+// Part of textureImage which is rendered (dynamic resolution)
+uniform vec2 textureScale;
 
 void main()
 {
@@ -19,7 +21,7 @@ void main()
 texCoord.s = (distortColor.b + mod(floor(distortColor.r * 255.5), 16.0)) / 16.0;
 texCoord.t = 1.0 - (distortColor.g + floor(distortColor.r * 255.5 / 16.0)) / 16.0;
 
-    gl_FragColor = texture2D(textureImage, texCoord.st) * blendColor;
+    gl_FragColor = texture2D(textureImage, texCoord.st * textureScale) * blendColor;
 }
 
 
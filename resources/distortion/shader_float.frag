@@ -0,0 +1,14 @@
+uniform sampler2D textureImage;
+uniform sampler2D textureDistort;
+uniform sampler2D textureBlend;
+// Part of textureImage which is rendered (dynamic resolution)
+uniform vec2 textureScale;
+
+// Float warp map: the target texcoord is stored directly, s in luminance, t in alpha.
+void main()
+{
+    vec2 texCoord = texture2D(textureDistort, gl_TexCoord[0].st).ra;
+    vec4 blendColor = texture2D(textureBlend, gl_TexCoord[0].st);
+
+    gl_FragColor = texture2D(textureImage, texCoord * textureScale) * blendColor;
+}
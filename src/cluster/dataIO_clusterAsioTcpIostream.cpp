@@ -15,6 +15,7 @@
 */
 
 #include "dataIO_clusterAsioTcpIostream.h"
+#include <util_log.h>
 
 using namespace osgVisual;
 
@@ -79,40 +80,40 @@ void dataIO_clusterAsioTcpIostream::shutdown()
 
 bool dataIO_clusterAsioTcpIostream::sendTO_OBJvaluesToSlaves()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::sendTO_OBJvaluesToSlaves()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::sendTO_OBJvaluesToSlaves()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterAsioTcpIostream::readTO_OBJvaluesFromMaster()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::readTO_OBJvaluesFromMaster()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::readTO_OBJvaluesFromMaster()" << std::endl;
 
 	return true;
 }
 
 void dataIO_clusterAsioTcpIostream::reportAsReadyToSwap()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::reportAsReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::reportAsReadyToSwap()" << std::endl;
 }
 
 bool dataIO_clusterAsioTcpIostream::waitForSwap()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::waitForAllReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::waitForAllReadyToSwap()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterAsioTcpIostream::waitForAllReadyToSwap()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::waitForAllReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::waitForAllReadyToSwap()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterAsioTcpIostream::sendSwapCommand()
 {
-	OSG_NOTIFY(osg::INFO) << "dataIO_clusterAsioTcpIostream::sendSwapCommand()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "dataIO_clusterAsioTcpIostream::sendSwapCommand()" << std::endl;
 
 	return true;
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 */
 
 #include "dataIO_clusterDummy.h"
+#include <util_log.h>
 
 using namespace osgVisual;
 
@@ -28,14 +29,14 @@ dataIO_clusterDummy::~dataIO_clusterDummy(void)
 	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy destructed" << std::endl;
 }
 
-bool dataIO_clusterDummy::init(xmlNode* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_)
+bool dataIO_clusterDummy::init(const util_config::node* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_)
 {
 	sendContainer = sendContainer_;
 	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy init()" << std::endl;
 	return true;
 }
 
-bool dataIO_clusterDummy::processXMLConfiguration(xmlNode* clusterConfig_)
+bool dataIO_clusterDummy::processXMLConfiguration(const util_config::node* clusterConfig_)
 {
 	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy processXMLConfiguration()" << std::endl;
 	return true;
@@ -48,40 +49,40 @@ void dataIO_clusterDummy::shutdown()
 
 bool dataIO_clusterDummy::sendTO_OBJvaluesToSlaves(osg::Matrixd viewMatrix_)
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy sendTO_OBJvaluesToSlaves()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy sendTO_OBJvaluesToSlaves()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterDummy::readTO_OBJvaluesFromMaster()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy readTO_OBJvaluesFromMaster()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy readTO_OBJvaluesFromMaster()" << std::endl;
 
 	return true;
 }
 
 void dataIO_clusterDummy::reportAsReadyToSwap()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy reportAsReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy reportAsReadyToSwap()" << std::endl;
 }
 
 bool dataIO_clusterDummy::waitForSwap()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy waitForSwap()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy waitForSwap()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterDummy::waitForAllReadyToSwap()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy waitForAllReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy waitForAllReadyToSwap()" << std::endl;
 
 	return true;
 }
 
 bool dataIO_clusterDummy::sendSwapCommand()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterDummy sendSwapCommand()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "clusterDummy sendSwapCommand()" << std::endl;
 
 	return true;
 }
\ No newline at end of file
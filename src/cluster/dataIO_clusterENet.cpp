@@ -15,6 +15,7 @@
 */
 
 #include "dataIO_clusterENet.h"
+#include <util_log.h>
 
 using namespace osgVisual;
 
@@ -34,7 +35,7 @@ dataIO_clusterENet::~dataIO_clusterENet(void)
 }
 
 
-bool dataIO_clusterENet::init(xmlNode* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_)
+bool dataIO_clusterENet::init(const util_config::node* configurationNode, osgViewer::Viewer* viewer_, clustermode clusterMode_, osgVisual::dataIO_transportContainer* sendContainer_, bool asAscii_)
 {
 	if (!configurationNode || !processXMLConfiguration(configurationNode))
 		return false;
@@ -79,78 +80,57 @@ bool dataIO_clusterENet::init(xmlNode* configurationNode, osgViewer::Viewer* vie
 	}
 	if(clusterMode == SLAVE)
 	{
-		// Init ENet
+		// Init ENet, the connection to the server is established in connect()
 		enet_impl->init(dataIO_clusterENet_implementation::CLIENT, port);
-
-		// Connect to server with 5 retries:
-		bool connected = false;
-		for(int i=0; i<5; i++)
-		{
-			std::cout << "Try to connect to server " << serverToConnect << std::endl;
-			if( enet_impl->connectTo( serverToConnect.c_str(), 5000 ) )
-			{
-				// Connect successful.
-				initialized = true;
-				connected = true;
-				break;
-			}
-		}	// For END
-		if(!connected)
-		{
-			initialized = false;
-			std::cout << "Finally failed to establish connection to server " << serverToConnect << std::endl;
-			return false;
-		}
+		initialized = false;
 	}	// IF SLAVE END
 
 	return true;
 }
 
-bool dataIO_clusterENet::processXMLConfiguration(xmlNode* clusterConfig_)
+bool dataIO_clusterENet::connect()
 {
-	// Extract cluster role
-	xmlAttr  *attr = clusterConfig_->properties;
-	while ( attr ) 
-	{ 
-		std::string attr_name=reinterpret_cast<const char*>(attr->name);
-		std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-		if( attr_name == "implementation" )
-		{
-			if(attr_value != "enet")
-			{
-				OSG_NOTIFY( osg::ALWAYS ) << "WARNING: Cluster configuration does not match the currently used 'enet' implementation, falling back to clusterDummy" << std::endl;
-				return false;
-			}
-		}
-		if( attr_name == "hardsync" )
-		{
-			if(attr_value == "yes")
-				hardSync = true;
-			else
-				hardSync = false;
-		}
-		if( attr_name == "master_ip" )
-		{
-			serverToConnect = attr_value;
-		}
-		if( attr_name == "port" )
+	if(clusterMode != SLAVE)
+		return true;
+
+	// Connect to server with 5 retries:
+	for(int i=0; i<5; i++)
+	{
+		std::cout << "Try to connect to server " << serverToConnect << std::endl;
+		if( enet_impl->connectTo( serverToConnect.c_str(), 5000 ) )
 		{
-			std::istringstream i(attr_value);
-			if (!(i >> port))
-			{
-				OSG_NOTIFY( osg::ALWAYS ) << "WARNING: Cluster configuration : Invalid port number '" << attr_value << "', falling back to clusterDummy" << std::endl;
-				return false;
-			}
+			// Connect successful.
+			initialized = true;
+			return true;
 		}
-		if( attr_name == "use_zlib_compressor" )
+	}	// For END
+
+	initialized = false;
+	std::cout << "Finally failed to establish connection to server " << serverToConnect << std::endl;
+	return false;
+}
+
+bool dataIO_clusterENet::processXMLConfiguration(const util_config::node* clusterConfig_)
+{
+	// Extract cluster configuration
+	if( clusterConfig_->hasAttribute("implementation") && clusterConfig_->getString("implementation") != "enet" )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "WARNING: Cluster configuration does not match the currently used 'enet' implementation, falling back to clusterDummy" << std::endl;
+		return false;
+	}
+	hardSync = clusterConfig_->getBool( "hardsync", hardSync );
+	serverToConnect = clusterConfig_->getString( "master_ip", serverToConnect );
+	if( clusterConfig_->hasAttribute("port") )
+	{
+		std::string portString = clusterConfig_->getString("port");
+		std::istringstream i(portString);
+		if (!(i >> port))
 		{
-			if(attr_value == "yes")
-				compressionEnabled = true;
-			else
-				compressionEnabled = false;
+			OSG_NOTIFY( osg::ALWAYS ) << "WARNING: Cluster configuration : Invalid port number '" << portString << "', falling back to clusterDummy" << std::endl;
+			return false;
 		}
-		attr = attr->next; 
-	}	// WHILE attrib END
+	}
+	compressionEnabled = clusterConfig_->getBool( "use_zlib_compressor", compressionEnabled );
 
 	return true;
 }
@@ -225,7 +205,7 @@ bool dataIO_clusterENet::readTO_OBJvaluesFromMaster()
 				sendContainer = dynamic_cast<osgVisual::dataIO_transportContainer*>(rr.takeObject());
 				if (sendContainer)
 				{
-					OSG_NOTIFY( osg::ALWAYS ) << "Received:: Settings Viewmatrix...FrameID is: " << sendContainer->getFrameID() << std::endl;
+					OSGVISUAL_LOG( osg::DEBUG_INFO ) << "Received:: Settings Viewmatrix...FrameID is: " << sendContainer->getFrameID() << std::endl;
 					// Restore Viewmatrix 
 					viewer->getCamera()->setViewMatrix(sendContainer->getViewMatrix());
 				}
@@ -250,7 +230,7 @@ void dataIO_clusterENet::reportAsReadyToSwap()
 	if(!hardSync)
 		return;
 
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterENet reportAsReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "clusterENet reportAsReadyToSwap()" << std::endl;
 }
 
 bool dataIO_clusterENet::waitForSwap()
@@ -258,7 +238,7 @@ bool dataIO_clusterENet::waitForSwap()
 	if(!hardSync)
 		return true;
 
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterENet waitForSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "clusterENet waitForSwap()" << std::endl;
 
 	return true;
 }
@@ -269,7 +249,7 @@ bool dataIO_clusterENet::waitForAllReadyToSwap()
 	if(!hardSync)
 		return true;
 
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterENet waitForAllReadyToSwap()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "clusterENet waitForAllReadyToSwap()" << std::endl;
 
 	return true;
 }
@@ -280,7 +260,7 @@ bool dataIO_clusterENet::sendSwapCommand()
 	if(!hardSync)
 		return true;
 
-	OSG_NOTIFY( osg::ALWAYS ) << "clusterENet sendSwapCommand()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "clusterENet sendSwapCommand()" << std::endl;
 
 	return true;
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 */
 
 #include "dataIO_clusterENet_implementation.h"
+#include <util_log.h>
 
 using namespace osgVisual;
 
@@ -23,7 +24,7 @@ int dataIO_clusterENet_implementation::activeENetInstances = 0;
 dataIO_clusterENet_implementation::dataIO_clusterENet_implementation(std::string& receivedTransportContainer_)
 : receivedTransportContainer(receivedTransportContainer_)
 {
-	std::cout << "Instantiated server class# "<< activeENetInstances << std::endl;
+	OSGVISUAL_LOG( osg::NOTICE ) << "Instantiated server class# "<< activeENetInstances << std::endl;
 
 	enetInitialized = false;
 	host = NULL;
@@ -32,11 +33,11 @@ dataIO_clusterENet_implementation::dataIO_clusterENet_implementation(std::string
 	{
 		if( enet_initialize() != 0)
 		{
-			std::cout <<  "An error occurred while initializing ENet." << std::endl;
+			OSGVISUAL_LOG( osg::WARN ) <<  "An error occurred while initializing ENet." << std::endl;
 		}
 		else
 		{
-			std::cout << "Starting ENet subsystem successful" << std::endl;
+			OSGVISUAL_LOG( osg::NOTICE ) << "Starting ENet subsystem successful" << std::endl;
 		}
 	}
 }
@@ -50,10 +51,10 @@ dataIO_clusterENet_implementation::~dataIO_clusterENet_implementation()
 	// Stop ENet if it is the last element.
 	if(--activeENetInstances == 0)
 	{
-		std::cout << "Close ENet subsystem" << std::endl;
+		OSGVISUAL_LOG( osg::NOTICE ) << "Close ENet subsystem" << std::endl;
 		enet_deinitialize();
 	}
-	std::cout << "Destroyed server class# "<< activeENetInstances << std::endl;
+	OSGVISUAL_LOG( osg::NOTICE ) << "Destroyed server class# "<< activeENetInstances << std::endl;
 }
 
 bool dataIO_clusterENet_implementation::init(dataIO_clusterENet_implementation::role role_, unsigned short port_, int maxClients_, int maxChannels_, int maxInBandwidth_, int maxOutBandwidth_)
@@ -78,7 +79,7 @@ bool dataIO_clusterENet_implementation::init(dataIO_clusterENet_implementation::
 									 maxOutBandwidth_      /* assume any amount of outgoing bandwidth */);
 		if (host == NULL)
 		{
-			std::cout <<  "An error occurred while trying to create an ENet server." << std::endl;
+			OSGVISUAL_LOG( osg::WARN ) <<  "An error occurred while trying to create an ENet server." << std::endl;
 			return false;
 		}
 	}	// IF SERVER END
@@ -92,7 +93,7 @@ bool dataIO_clusterENet_implementation::init(dataIO_clusterENet_implementation::
 									 maxOutBandwidth_      /* assume any amount of outgoing bandwidth */);
 		 if (host == NULL)
 		{
-			std::cout <<  "An error occurred while trying to create an ENet client." << std::endl;
+			OSGVISUAL_LOG( osg::WARN ) <<  "An error occurred while trying to create an ENet client." << std::endl;
 			return false;
 		}
 
@@ -132,7 +133,7 @@ void dataIO_clusterENet_implementation::processEvents(int timeout_ms_)
 				break;
 
 			default: 
-				std::cout << "Unknown Eventtype" << std::endl;
+				OSGVISUAL_LOG_RATE( osg::WARN, 1 ) << "Unknown Eventtype" << std::endl;
 		}	// SWITCH CASE END
 	}	// WHILE EVENT END
 
@@ -163,7 +164,7 @@ void dataIO_clusterENet_implementation::sendPacket( ENetPacket* packet_, enet_ui
 		if(peerID_ < peerList.size())
 			enet_peer_send (peerList[peerID_], channelID_, packet_);
 		else
-			std::cout << "dataIO_clusterENet_implementation::sendPacket() - ERROR: Peer #"<<peerID_<<" is not available, only peers 0-"<<(peerList.size()-1)<<" are connected!" << std::endl;
+			OSGVISUAL_LOG_RATE( osg::WARN, 1 ) << "dataIO_clusterENet_implementation::sendPacket() - ERROR: Peer #"<<peerID_<<" is not available, only peers 0-"<<(peerList.size()-1)<<" are connected!" << std::endl;
 	}
 
 	if(autoFlush_)
@@ -175,7 +176,7 @@ void dataIO_clusterENet_implementation::sendPacket( ENetPacket* packet_, enet_ui
 		// are connected peers available?
 	if( peerList.size() == 0 )
 	{
-		std::cout << "dataIO_clusterENet_implementation::sendPacket() - ERROR: No connected peer available!" << std::endl;
+		OSGVISUAL_LOG_RATE( osg::WARN, 1 ) << "dataIO_clusterENet_implementation::sendPacket() - ERROR: No connected peer available!" << std::endl;
 		return;
 	}
 
@@ -200,7 +201,7 @@ void dataIO_clusterENet_implementation::sendPacket( ENetPacket* packet_, enet_ui
 		if( peerID_ >= 0 && peerID_ < (int)peerList.size())
 			enet_peer_send (peerList[peerID_], channelID_, packet_);
 		else
-			std::cout << "dataIO_clusterENet_implementation::sendPacket() - ERROR: Peer #"<<peerID_<<" is not available, only peers 0-"<<(peerList.size()-1)<<" are connected!" << std::endl;
+			OSGVISUAL_LOG_RATE( osg::WARN, 1 ) << "dataIO_clusterENet_implementation::sendPacket() - ERROR: Peer #"<<peerID_<<" is not available, only peers 0-"<<(peerList.size()-1)<<" are connected!" << std::endl;
 	}
 
 	if(autoFlush_)
@@ -221,7 +222,7 @@ bool dataIO_clusterENet_implementation::connectTo( const char* remoteAddr_, int
 {
 	if(currentRole != dataIO_clusterENet_implementation::CLIENT)
 	{
-		std::cout << "dataIO_clusterENet_implementation::connectTo() : ERROR: ENet does not work as client - ignoring to connect!" << std::endl;
+		OSGVISUAL_LOG( osg::WARN ) << "dataIO_clusterENet_implementation::connectTo() : ERROR: ENet does not work as client - ignoring to connect!" << std::endl;
 		return false;
 	}
 
@@ -234,7 +235,7 @@ bool dataIO_clusterENet_implementation::connectTo( const char* remoteAddr_, int
    
     if (tmpPeer == NULL)
     {
-		std::cout << "No available peers for initiating an ENet connection." << std::endl;
+		OSGVISUAL_LOG( osg::WARN ) << "No available peers for initiating an ENet connection." << std::endl;
        return false;
     }
     
@@ -243,7 +244,7 @@ bool dataIO_clusterENet_implementation::connectTo( const char* remoteAddr_, int
 		&& event.type == ENET_EVENT_TYPE_CONNECT)
     {
 		peerList.push_back( tmpPeer );
-		std::cout << "Connection to " << remoteAddr_ << ":"<<port<<" succeeded." << std::endl;
+		OSGVISUAL_LOG( osg::NOTICE ) << "Connection to " << remoteAddr_ << ":"<<port<<" succeeded." << std::endl;
 		// Note down peers remote IP.
 		char *hostIP = new char[20];
 		enet_address_get_host_ip( &address, hostIP, 20 );
@@ -258,7 +259,7 @@ bool dataIO_clusterENet_implementation::connectTo( const char* remoteAddr_, int
         /* had run out without any significant event.            */
         enet_peer_reset (tmpPeer);
 
-		std::cout << "Connection to " << remoteAddr_ << ":"<<port<<" failed." << std::endl;
+		OSGVISUAL_LOG( osg::WARN ) << "Connection to " << remoteAddr_ << ":"<<port<<" failed." << std::endl;
 		return false;
     }
 }
@@ -277,7 +278,7 @@ void dataIO_clusterENet_implementation::onConnect(ENetEvent* event_)
 	enet_address_get_host_ip(&(event_->peer->address), hostIP, 20);
 
 	/* debug output */
-	std::cout << "A new client connected from "<<hostIP<<"." << std::endl; 
+	OSGVISUAL_LOG( osg::NOTICE ) << "A new client connected from "<<hostIP<<"." << std::endl; 
 		
 	/* Store any relevant client information here. */
 	event_->peer ->data = hostIP;	
@@ -302,12 +303,12 @@ void dataIO_clusterENet_implementation::onDisconnect(ENetEvent* event_)
 
 	if(currentRole == dataIO_clusterENet_implementation::SERVER)
 	{
-		std::cout << "Client " << (char*)event_->peer->data << " disconnected." << std::endl;
+		OSGVISUAL_LOG( osg::NOTICE ) << "Client " << (char*)event_->peer->data << " disconnected." << std::endl;
 	}
 
 	if(currentRole == dataIO_clusterENet_implementation::CLIENT)
 	{
-		std::cout << "Server "<< (char*)event_->peer->data<<"disconnected." << std::endl;
+		OSGVISUAL_LOG( osg::NOTICE ) << "Server "<< (char*)event_->peer->data<<"disconnected." << std::endl;
 	}
 
 	// Reset the peer information
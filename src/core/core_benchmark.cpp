@@ -0,0 +1,260 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <core_benchmark.h>
+
+#include <osgDB/FileUtils>
+
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+using namespace osgVisual;
+
+core_benchmark::core_benchmark()
+{
+	headless = false;
+	benchmark = false;
+	width = 1280;
+	height = 720;
+	timeStep = 1.0/60.0;
+	numFrames = 0;
+	numWarmupFrames = 0;
+	frameNumber = 0;
+	nextSlotLine = 0;
+	frameStartTick = 0;
+	statistics = new util_frameTimeStatistics();
+}
+
+void core_benchmark::addUsage( osg::ApplicationUsage* usage_ )
+{
+	usage_->addCommandLineOption("--headless","Render into an offscreen pbuffer instead of a window");
+	usage_->addCommandLineOption("--headless-size <w> <h>","Size of the offscreen pbuffer (default 1280 720)");
+	usage_->addCommandLineOption("--benchmark <pathfile>","Deterministic benchmark: camera follows the animation path with a fixed time step");
+	usage_->addCommandLineOption("--benchmark-data <csvfile>","Recorded TO_OBJ slot values to replay during the benchmark");
+	usage_->addCommandLineOption("--benchmark-frames <n>","Number of benchmark frames (default: duration of the animation path)");
+	usage_->addCommandLineOption("--benchmark-fps <fps>","Simulation frames per second of the benchmark (default 60)");
+	usage_->addCommandLineOption("--benchmark-warmup <n>","Number of frames excluded from the statistics (default 0)");
+	usage_->addCommandLineOption("--benchmark-report <csvfile>","Write the frame time of each frame");
+}
+
+bool core_benchmark::init( osg::ArgumentParser& arguments_ )
+{
+	while( arguments_.read("--headless") )
+		headless = true;
+	arguments_.read("--headless-size", width, height);
+
+	std::string pathFilename, dataFilename;
+	if( arguments_.read("--benchmark", pathFilename) )
+		benchmark = true;
+	arguments_.read("--benchmark-data", dataFilename);
+	arguments_.read("--benchmark-report", reportFilename);
+	arguments_.read("--benchmark-warmup", numWarmupFrames);
+	double fps = 0.0;
+	if( arguments_.read("--benchmark-fps", fps) && fps > 0.0 )
+		timeStep = 1.0/fps;
+	bool framesConfigured = arguments_.read("--benchmark-frames", numFrames);
+
+	if( !benchmark )
+		return headless;
+
+	// Camera path
+	std::ifstream pathFile( pathFilename.c_str() );
+	if( !pathFile )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "ERROR: core_benchmark: Unable to read animation path '" << pathFilename << "'." << std::endl;
+		benchmark = false;
+		return headless;
+	}
+	cameraPath = new osg::AnimationPath();
+	cameraPath->read( pathFile );
+	cameraPath->setLoopMode( osg::AnimationPath::NO_LOOPING );
+	if( cameraPath->empty() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "WARNING: core_benchmark: Animation path '" << pathFilename << "' contains no control points, the camera is not moved." << std::endl;
+		cameraPath = NULL;
+	}
+
+	if( !framesConfigured )
+		numFrames = cameraPath.valid() ? static_cast<unsigned int>( ceil( cameraPath->getPeriod() / timeStep ) ) + 1 : 1000;
+
+	// Recorded slot data
+	if( !dataFilename.empty() && !loadSlotData( dataFilename ) )
+		OSG_NOTIFY( osg::WARN ) << "WARNING: core_benchmark: Unable to load slot data '" << dataFilename << "', continue without." << std::endl;
+
+	statistics->reserve( numFrames );
+
+	OSG_NOTIFY( osg::ALWAYS ) << "core_benchmark: " << numFrames << " frames with " << timeStep*1000.0 << " ms time step, camera path '" << pathFilename << "'";
+	if( !slotNames.empty() )
+		OSG_NOTIFY( osg::ALWAYS ) << ", " << slotNames.size() << " slots from '" << dataFilename << "'";
+	OSG_NOTIFY( osg::ALWAYS ) << "." << std::endl;
+
+	return true;
+}
+
+bool core_benchmark::setupViewer( osgViewer::Viewer* viewer_ )
+{
+	osg::Camera* camera = viewer_->getCamera();
+
+	if( headless && !camera->getGraphicsContext() )
+	{
+		osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+		traits->x = 0;
+		traits->y = 0;
+		traits->width = width;
+		traits->height = height;
+		traits->red = 8;
+		traits->green = 8;
+		traits->blue = 8;
+		traits->alpha = 8;
+		traits->depth = 24;
+		traits->windowDecoration = false;
+		traits->doubleBuffer = false;
+		traits->sharedContext = 0;
+		traits->pbuffer = true;
+
+		osg::ref_ptr<osg::GraphicsContext> gc = osg::GraphicsContext::createGraphicsContext( traits.get() );
+		if( !gc.valid() )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "ERROR: core_benchmark: Unable to create a " << width << "x" << height << " pbuffer for headless rendering." << std::endl;
+			return false;
+		}
+
+		camera->setGraphicsContext( gc.get() );
+		camera->setViewport( new osg::Viewport(0, 0, width, height) );
+		camera->setProjectionMatrixAsPerspective( 30.0, static_cast<double>(width)/static_cast<double>(height), 1.0, 10000.0 );
+		camera->setDrawBuffer( GL_FRONT );
+		camera->setReadBuffer( GL_FRONT );
+		OSG_NOTIFY( osg::ALWAYS ) << "core_benchmark: Rendering headless into a " << width << "x" << height << " pbuffer." << std::endl;
+	}
+
+	if( benchmark )
+	{
+		// Threads would make the frame order of update and rendering nondeterministic.
+		// A threading model selected explicitly on the command line (e.g. --DrawThreadPerContext) is kept to allow stress tests of the threaded models.
+		if( viewer_->getThreadingModel() == osgViewer::Viewer::AutomaticSelection )
+			viewer_->setThreadingModel( osgViewer::Viewer::SingleThreaded );
+		// The camera is driven by the recorded path.
+		if( cameraPath.valid() )
+			viewer_->setCameraManipulator( NULL );
+	}
+
+	return true;
+}
+
+void core_benchmark::beginFrame( osgViewer::Viewer* viewer_ )
+{
+	frameStartTick = osg::Timer::instance()->tick();
+
+	if( cameraPath.valid() )
+	{
+		osg::Matrixd cameraMatrix;
+		cameraPath->getMatrix( cameraPath->getFirstTime() + getSimulationTime(), cameraMatrix );
+		viewer_->getCamera()->setViewMatrix( osg::Matrixd::inverse( cameraMatrix ) );
+	}
+
+	applySlotData();
+}
+
+void core_benchmark::endFrame( osgViewer::Viewer* viewer_ )
+{
+	// Include the time the GPU needs to finish the frame. Rendering is single threaded, so the context is current on this thread.
+	osg::GraphicsContext* gc = viewer_->getCamera()->getGraphicsContext();
+	if( gc && gc->makeCurrent() )
+		glFinish();
+
+	double frameTime = osg::Timer::instance()->delta_m( frameStartTick, osg::Timer::instance()->tick() );
+	if( frameNumber >= numWarmupFrames )
+		statistics->add( frameTime );
+
+	frameNumber++;
+}
+
+void core_benchmark::report()
+{
+	if( !benchmark )
+		return;
+
+	std::stringstream title;
+	title << "core_benchmark: frame times (" << numWarmupFrames << " warmup frames excluded)";
+	statistics->writeReport( osg::notify( osg::ALWAYS ), title.str() );
+
+	if( !reportFilename.empty() && statistics->writeCSV( reportFilename ) )
+		OSG_NOTIFY( osg::ALWAYS ) << "core_benchmark: Frame times written to '" << reportFilename << "'." << std::endl;
+}
+
+bool core_benchmark::loadSlotData( const std::string& filename_ )
+{
+	std::ifstream file( filename_.c_str() );
+	if( !file )
+		return false;
+
+	std::string line;
+	std::getline( file, line );
+	std::stringstream header( line );
+	std::string name;
+	std::getline( header, name, ',' );	// time column
+	while( std::getline( header, name, ',' ) )
+	{
+		if( !name.empty() && name[name.size()-1] == '\r' )
+			name.erase( name.size()-1 );
+		slotNames.push_back( name );
+	}
+
+	while( std::getline( file, line ) )
+	{
+		if( !line.empty() && line[line.size()-1] == '\r' )
+			line.erase( line.size()-1 );
+		if( line.empty() )
+			continue;
+
+		std::stringstream values( line );
+		std::string value;
+		std::getline( values, value, ',' );
+		slotTimes.push_back( atof( value.c_str() ) );
+
+		std::vector<std::string> lineValues( slotNames.size() );
+		for(unsigned int i=0; i<slotNames.size() && std::getline( values, value, ',' ); i++)
+			lineValues[i] = value;
+		slotValues.push_back( lineValues );
+	}
+
+	return !slotNames.empty();
+}
+
+void core_benchmark::applySlotData()
+{
+	// Apply all lines which became valid since the last frame, so no value change is skipped.
+	double time = getSimulationTime();
+	while( nextSlotLine < slotTimes.size() && slotTimes[nextSlotLine] <= time + timeStep*0.5 )
+	{
+		const std::vector<std::string>& values = slotValues[nextSlotLine];
+		for(unsigned int i=0; i<values.size(); i++)
+		{
+			if( values[i].empty() )
+				continue;
+
+			char* end = NULL;
+			double value = strtod( values[i].c_str(), &end );
+			if( end && *end == '\0' )
+				visual_dataIO::getInstance()->setSlotData( slotNames[i], osgVisual::dataIO_slot::TO_OBJ, value );
+			else
+				visual_dataIO::getInstance()->setSlotData( slotNames[i], osgVisual::dataIO_slot::TO_OBJ, values[i] );
+		}
+		nextSlotLine++;
+	}
+}
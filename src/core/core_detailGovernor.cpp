@@ -0,0 +1,200 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <core_detailGovernor.h>
+
+#include <osg/Math>
+
+#include <util_config.h>
+#include <util_log.h>
+#include <visual_object.h>
+#include <object_groundClamper.h>
+
+using namespace osgVisual;
+
+// Smoothed frame time above target*OVERLOAD raises the detail level, below target*HEADROOM lowers it.
+static const double OVERLOAD = 1.05;
+static const double HEADROOM = 0.8;
+// Minimal hold times in s after a level change. The smoothed frame time needs some frames to follow the change.
+static const double RAISE_HOLD = 0.5;
+static const double LOWER_HOLD = 2.0;
+// Time in s at the target frame time until a lower level is probed. A failed probe doubles it up to the maximum.
+static const double PROBE_INTERVAL = 10.0;
+static const double MAX_PROBE_INTERVAL = 160.0;
+// Time in s after a probe: an overload within this time counts as failed probe.
+static const double PROBE_CHECK = 3.0;
+// Frames to settle after start, e.g. while the first terrain tiles are compiled.
+static const unsigned int SETTLE_FRAMES = 30;
+// Level from which the terrain query frequency is reduced, and from which the labels are hidden.
+static const unsigned int TERRAIN_QUERY_LEVEL = 2;
+static const unsigned int LABEL_LEVEL = 3;
+// Longest interval between two terrain queries in frames.
+static const unsigned int MAX_QUERY_INTERVAL = 8;
+// Highest configurable detail level: setLevel() shifts unsigned ints by the level, which must stay below their bit width.
+static const int MAX_LEVEL = 31;
+
+core_detailGovernor::core_detailGovernor()
+{
+	targetFrameTime = 15.0;
+	maxLevel = 4;
+	maxLODScale = 2.5;
+	level = 0;
+	baseLODScale = 1.0;
+	appliedLODScale = 1.0;
+	baseObjectsToCompile = 0;
+	smoothedFrameTime = 0.0;
+	smoothing = 0.1;
+	lastTick = 0;
+	lastChangeTime = 0.0;
+	probeInterval = PROBE_INTERVAL;
+	probing = false;
+	numFrames = 0;
+}
+
+bool core_detailGovernor::init( osgViewer::Viewer* viewer_ )
+{
+	const util_config::node* section = util_config::getInstance()->getSection("detailgovernor");
+	if( !section || !section->getBool("enabled", true) )
+		return false;
+
+	const util_config::node* config = section->getChild("detailgovernor");
+	if( config )
+	{
+		targetFrameTime = config->getDouble("targetframetime", targetFrameTime);
+		int configuredLevel = osg::maximum( config->getInt("maxlevel", maxLevel), 1 );
+		if( configuredLevel > MAX_LEVEL )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_detailGovernor: maxlevel " << configuredLevel << " is too high, using " << MAX_LEVEL << "." << std::endl;
+			configuredLevel = MAX_LEVEL;
+		}
+		maxLevel = configuredLevel;
+		maxLODScale = config->getDouble("maxlodscale", maxLODScale);
+	}
+	if( targetFrameTime <= 0.0 )
+		targetFrameTime = 15.0;
+	maxLODScale = osg::maximum( maxLODScale, 1.0 );
+
+	// The page-in rate of the DatabasePager is limited by the incremental compile operation, which compiles the paged tiles before they are merged.
+	if( !viewer_->getIncrementalCompileOperation() )
+		viewer_->setIncrementalCompileOperation( new osgUtil::IncrementalCompileOperation() );
+	baseObjectsToCompile = viewer_->getIncrementalCompileOperation()->getMaximumNumOfObjectsToCompilePerFrame();
+
+	baseLODScale = viewer_->getCamera()->getLODScale();
+	appliedLODScale = baseLODScale;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "core_detailGovernor: Target frame time " << targetFrameTime << " ms, " << maxLevel << " detail levels, LOD scale up to " << maxLODScale << "." << std::endl;
+	return true;
+}
+
+void core_detailGovernor::update( osgViewer::Viewer* viewer_ )
+{
+	osg::Timer_t now = osg::Timer::instance()->tick();
+	double time = osg::Timer::instance()->time_s();
+	if( numFrames++ == 0 )
+	{
+		lastTick = now;
+		lastChangeTime = time;
+		return;
+	}
+
+	double frameTime = osg::Timer::instance()->delta_m( lastTick, now );
+	lastTick = now;
+	if( numFrames == 2 )
+		smoothedFrameTime = frameTime;
+	else
+		smoothedFrameTime += smoothing * (frameTime - smoothedFrameTime);
+
+	if( viewer_->getViewerStats() )
+		viewer_->getViewerStats()->setAttribute( viewer_->getFrameStamp()->getFrameNumber(), "Detail level", level );
+
+	if( numFrames < SETTLE_FRAMES )
+	{
+		lastChangeTime = time;
+		return;
+	}
+
+	// Adopt a LOD scale which was changed by the user as new full detail scale.
+	double lodScale = viewer_->getCamera()->getLODScale();
+	if( lodScale != appliedLODScale )
+	{
+		baseLODScale = lodScale / (1.0 + (maxLODScale-1.0) * level / maxLevel);
+		appliedLODScale = lodScale;
+	}
+
+	double timeSinceChange = time - lastChangeTime;
+	bool overload = smoothedFrameTime > targetFrameTime*OVERLOAD;
+
+	// A probe which held the target frame time resets the probe interval.
+	if( probing && !overload && timeSinceChange > PROBE_CHECK )
+	{
+		probing = false;
+		probeInterval = PROBE_INTERVAL;
+	}
+
+	if( overload )
+	{
+		if( level < maxLevel && timeSinceChange > RAISE_HOLD )
+		{
+			if( probing && timeSinceChange < PROBE_CHECK )
+				probeInterval = osg::minimum( probeInterval*2.0, MAX_PROBE_INTERVAL );
+			setLevel( viewer_, level+1, "Frame time above target" );
+		}
+	}
+	else if( level > 0 )
+	{
+		if( smoothedFrameTime < targetFrameTime*HEADROOM && timeSinceChange > LOWER_HOLD )
+			setLevel( viewer_, level-1, "Headroom" );
+		else if( timeSinceChange > probeInterval )
+		{
+			setLevel( viewer_, level-1, "Probing" );
+			probing = true;
+		}
+	}
+}
+
+void core_detailGovernor::shutdown( osgViewer::Viewer* viewer_ )
+{
+	if( level > 0 )
+		setLevel( viewer_, 0, "Shutdown" );
+}
+
+void core_detailGovernor::setLevel( osgViewer::Viewer* viewer_, unsigned int level_, const char* reason_ )
+{
+	unsigned int previousLevel = level;
+	level = osg::minimum( level_, maxLevel );
+	lastChangeTime = osg::Timer::instance()->time_s();
+	probing = false;
+
+	// LOD scale: rises linearly up to maxLODScale at the highest level.
+	appliedLODScale = baseLODScale * (1.0 + (maxLODScale-1.0) * level / maxLevel);
+	viewer_->getCamera()->setLODScale( appliedLODScale );
+
+	// Page-in rate: halved with each level.
+	unsigned int objectsToCompile = osg::maximum( baseObjectsToCompile >> level, 1u );
+	if( viewer_->getIncrementalCompileOperation() )
+		viewer_->getIncrementalCompileOperation()->setMaximumNumOfObjectsToCompilePerFrame( objectsToCompile );
+
+	// Terrain query frequency: halved with each level from TERRAIN_QUERY_LEVEL.
+	unsigned int queryInterval = level >= TERRAIN_QUERY_LEVEL ? osg::minimum( 2u << (level-TERRAIN_QUERY_LEVEL), MAX_QUERY_INTERVAL ) : 1u;
+	object_groundClamper::getInstance()->setQueryInterval( queryInterval );
+
+	// Labels
+	visual_object::setLabelsVisible( level < LABEL_LEVEL );
+
+	OSGVISUAL_LOG( osg::NOTICE ) << "core_detailGovernor: " << reason_ << " (smoothed frame time " << smoothedFrameTime << " ms, target " << targetFrameTime << " ms): detail level "
+		<< previousLevel << " -> " << level << ", LOD scale " << appliedLODScale << ", objects compiled per frame " << objectsToCompile
+		<< ", terrain query every " << queryInterval << " frames, labels " << (level < LABEL_LEVEL ? "visible" : "hidden") << std::endl;
+}
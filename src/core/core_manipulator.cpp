@@ -81,7 +81,11 @@ bool core_manipulator::init(osgViewer::Viewer* viewer, osg::ArgumentParser& argu
     viewer->addEventHandler( new osgGA::StateSetManipulator(_rootNode->getOrCreateStateSet()) );		// add the state manipulator
     viewer->addEventHandler(new osgViewer::ThreadingHandler);				// add the thread model handler
     viewer->addEventHandler(new osgViewer::WindowSizeHandler);				// add the window size toggle handler
-    viewer->addEventHandler(new osgViewer::StatsHandler);					// add the stats handler
+    osg::ref_ptr<osgViewer::StatsHandler> statsHandler = new osgViewer::StatsHandler;
+    statsHandler->addUserStatsLine("KdTree build", osg::Vec4(0.7f,0.7f,0.7f,1.0f), osg::Vec4(0.7f,0.7f,0.7f,1.0f), "KdTree build time taken", 1.0, true, false, "", "", 0.0);	// time spent in background KdTree construction (util_kdTreeBuilder)
+    statsHandler->addUserStatsLine("KdTrees pending", osg::Vec4(0.7f,0.7f,0.7f,1.0f), osg::Vec4(0.7f,0.7f,0.7f,1.0f), "KdTrees pending", 1.0, false, false, "", "", 0.0);
+    statsHandler->addUserStatsLine("Ground clamp", osg::Vec4(0.7f,0.7f,0.7f,1.0f), osg::Vec4(0.7f,0.7f,0.7f,1.0f), "Ground clamp time taken", 1.0, true, false, "", "", 0.0);	// batch cost of object_groundClamper
+    viewer->addEventHandler(statsHandler.get());							// add the stats handler
     viewer->addEventHandler(new osgViewer::HelpHandler(arguments.getApplicationUsage()));			// add the help handler
     viewer->addEventHandler(new osgViewer::RecordCameraPathHandler);		// add the record camera path handler
     viewer->addEventHandler(new osgViewer::LODScaleHandler);				// add the LOD Scale handler
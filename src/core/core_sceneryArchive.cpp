@@ -0,0 +1,717 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <core_sceneryArchive.h>
+#include <visual_util.h>
+#include <util_modelCache.h>
+
+#include <osgDB/Registry>
+#include <osgDB/ReadFile>
+#include <osgDB/FileUtils>
+
+#include <sys/stat.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+using namespace osgVisual;
+
+static const char FILE_MAGIC[4] = {'O','V','S','C'};
+
+// Stream buffer which reads the .osgb data directly from the mapped archive, without copying it.
+class memoryStreamBuffer : public std::streambuf
+{
+public:
+	memoryStreamBuffer( const char* data_, size_t size_ )
+	{
+		char* data = const_cast<char*>( data_ );
+		setg( data, data, data+size_ );
+	}
+
+protected:
+	virtual pos_type seekoff( off_type offset_, std::ios_base::seekdir dir_, std::ios_base::openmode which_ )
+	{
+		char* position = egptr() + offset_;
+		if( dir_ == std::ios_base::beg )
+			position = eback() + offset_;
+		else if( dir_ == std::ios_base::cur )
+			position = gptr() + offset_;
+
+		if( !(which_ & std::ios_base::in) || position < eback() || position > egptr() )
+			return pos_type( off_type(-1) );
+		setg( eback(), position, egptr() );
+		return pos_type( position - eback() );
+	}
+
+	virtual pos_type seekpos( pos_type position_, std::ios_base::openmode which_ )
+	{
+		return seekoff( off_type(position_), std::ios_base::beg, which_ );
+	}
+};
+
+// Returns modification time and size of a model file, searched in the data file path list like osgDB::readNodeFile() does.
+static bool getFileInfo( const std::string& filename_, long long& modificationTime_, unsigned long long& size_ )
+{
+	std::string path = osgDB::findDataFile( filename_ );
+	struct stat info;
+	if( path.empty() || stat( path.c_str(), &info ) != 0 )
+		return false;
+
+	modificationTime_ = static_cast<long long>( info.st_mtime );
+	size_ = static_cast<unsigned long long>( info.st_size );
+	return true;
+}
+
+static void hashString( unsigned long long& hash_, const std::string& string_ )
+{
+	// FNV-1a, including the terminating zero to separate the strings.
+	const unsigned char* c = reinterpret_cast<const unsigned char*>( string_.c_str() );
+	do
+	{
+		hash_ ^= *c;
+		hash_ *= 1099511628211ULL;
+	} while( *c++ );
+}
+
+static void hashElement( unsigned long long& hash_, const util_config::node* node_ )
+{
+	hashString( hash_, node_->getName() );
+	const util_config::node::AttributeList& attributes = node_->getAttributes();
+	for(unsigned int i=0; i<attributes.size(); i++)
+	{
+		hashString( hash_, attributes[i].first );
+		hashString( hash_, attributes[i].second );
+	}
+
+	const util_config::node::NodeList& children = node_->getChildren();
+	for(unsigned int i=0; i<children.size(); i++)
+		hashElement( hash_, children[i].get() );
+
+	// Mark the end of the children, so the nesting is part of the hash.
+	hashString( hash_, "/" );
+}
+
+static core_sceneryArchive::stringRef addString( std::string& strings_, const std::string& string_ )
+{
+	core_sceneryArchive::stringRef ref;
+	ref.offset = strings_.size();
+	ref.length = string_.size();
+	strings_ += string_;
+	return ref;
+}
+
+static unsigned long long alignTo8( unsigned long long size_ )
+{
+	return (size_ + 7) / 8 * 8;
+}
+
+static void writePadding( std::ofstream& out_, unsigned long long size_ )
+{
+	static const char zeros[8] = {0,0,0,0,0,0,0,0};
+	out_.write( zeros, alignTo8(size_) - size_ );
+}
+
+core_sceneryArchive::core_sceneryArchive()
+{
+	header = NULL;
+	sources = NULL;
+}
+
+core_sceneryArchive::~core_sceneryArchive()
+{
+	close();
+}
+
+bool core_sceneryArchive::open( const std::string& filename_, const util_config::node* sceneryNode_ )
+{
+	close();
+	if( !sceneryNode_ )
+		return false;
+
+	file = new util_mappedFile();
+	if( !file->open( filename_ ) )
+	{
+		close();
+		return false;
+	}
+
+	// Validate the header and the table sizes.
+	const unsigned char* data = file->getData();
+	unsigned long long size = file->getSize();
+	header = reinterpret_cast<const fileHeader*>( data );
+	if( size < sizeof(fileHeader) || memcmp( header->magic, FILE_MAGIC, 4 ) != 0 || header->version != FILE_VERSION )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::open() :: " << filename_ << " is no scenery archive of version " << FILE_VERSION << ", recompile it." << std::endl;
+		close();
+		return false;
+	}
+
+	unsigned long long tablesEnd = sizeof(fileHeader) + header->numSources*sizeof(sourceRecord) + header->numDependencies*sizeof(dependencyRecord) + header->numObjects*sizeof(objectRecord)
+		+ header->numFootprintPoints*3*sizeof(double) + header->numCloudLayers*sizeof(cloudLayerRecord) + header->numWindLayers*sizeof(windLayerRecord);
+	if( tablesEnd > header->stringTableOffset || header->stringTableOffset + header->stringTableSize > size )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::open() :: " << filename_ << " is truncated or corrupt." << std::endl;
+		close();
+		return false;
+	}
+
+	// Check if the archive is up to date.
+	if( header->sceneryHash != hashScenery( sceneryNode_ ) )
+	{
+		OSG_NOTIFY( osg::NOTICE ) << "Scenery archive " << filename_ << " is stale: The scenery configuration was changed. Using the XML configuration." << std::endl;
+		close();
+		return false;
+	}
+
+	sources = reinterpret_cast<const sourceRecord*>( data + sizeof(fileHeader) );
+	const dependencyRecord* dependencies = reinterpret_cast<const dependencyRecord*>( sources + header->numSources );
+	for(unsigned int i=0; i<header->numSources; i++)
+	{
+		std::string sourceFilename = getString( sources[i].filename );
+		long long modificationTime = -1;
+		unsigned long long fileSize = 0;
+		bool found = getFileInfo( sourceFilename, modificationTime, fileSize );
+		if( modificationTime != sources[i].modificationTime || (found && fileSize != sources[i].fileSize) )
+		{
+			OSG_NOTIFY( osg::NOTICE ) << "Scenery archive " << filename_ << " is stale: " << sourceFilename << " was changed. Using the XML configuration." << std::endl;
+			close();
+			return false;
+		}
+		if( sources[i].geometryOffset + sources[i].geometrySize > size
+			|| static_cast<unsigned long long>(sources[i].firstDependency) + sources[i].numDependencies > header->numDependencies )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::open() :: " << filename_ << " is truncated or corrupt." << std::endl;
+			close();
+			return false;
+		}
+
+		// The images and external references are embedded into the geometry, so their changes are not seen by the model file.
+		util_modelCache::DependencyList sourceDependencies( sources[i].numDependencies );
+		for(unsigned int j=0; j<sources[i].numDependencies; j++)
+		{
+			const dependencyRecord& record = dependencies[sources[i].firstDependency+j];
+			sourceDependencies[j].filename = getString( record.filename );
+			sourceDependencies[j].modificationTime = record.modificationTime;
+			sourceDependencies[j].fileSize = record.fileSize;
+		}
+		if( !util_modelCache::isUpToDate( sourceDependencies ) )
+		{
+			OSG_NOTIFY( osg::NOTICE ) << "Scenery archive " << filename_ << " is stale: A file referenced by " << sourceFilename << " was changed. Using the XML configuration." << std::endl;
+			close();
+			return false;
+		}
+	}
+
+	// Decode the object table.
+	const objectRecord* objects = reinterpret_cast<const objectRecord*>( dependencies + header->numDependencies );
+	const double* footprint = reinterpret_cast<const double*>( objects + header->numObjects );
+	content.objects.resize( header->numObjects );
+	objectSources.resize( header->numObjects );
+	for(unsigned int i=0; i<header->numObjects; i++)
+	{
+		const objectRecord& record = objects[i];
+		visual_object::objectConfig& config = content.objects[i];
+		if( record.source >= static_cast<int>(header->numSources) || record.firstFootprintPoint + record.numFootprintPoints > header->numFootprintPoints )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::open() :: " << filename_ << " is truncated or corrupt." << std::endl;
+			close();
+			return false;
+		}
+
+		config.objectname = getString( record.objectname );
+		config.filename = record.source >= 0 ? getString( sources[record.source].filename ) : "";
+		config.label = getString( record.label );
+		config.dynamic = (record.flags & OBJECT_DYNAMIC) != 0;
+		config.trackingID = record.trackingID;
+		config.lat = record.lat;
+		config.lon = record.lon;
+		config.alt = record.alt;
+		config.rot_x = record.rot_x;
+		config.rot_y = record.rot_y;
+		config.rot_z = record.rot_z;
+		config.cam_trans_x = record.cam_trans_x;
+		config.cam_trans_y = record.cam_trans_y;
+		config.cam_trans_z = record.cam_trans_z;
+		config.cam_rot_x = record.cam_rot_x;
+		config.cam_rot_y = record.cam_rot_y;
+		config.cam_rot_z = record.cam_rot_z;
+		config.geometry_rot_x = record.geometry_rot_x;
+		config.geometry_rot_y = record.geometry_rot_y;
+		config.geometry_rot_z = record.geometry_rot_z;
+		config.geometry_scale_x = record.geometry_scale_x;
+		config.geometry_scale_y = record.geometry_scale_y;
+		config.geometry_scale_z = record.geometry_scale_z;
+		config.updater_lat = getString( record.updater_lat );
+		config.updater_lon = getString( record.updater_lon );
+		config.updater_alt = getString( record.updater_alt );
+		config.updater_rot_x = getString( record.updater_rot_x );
+		config.updater_rot_y = getString( record.updater_rot_y );
+		config.updater_rot_z = getString( record.updater_rot_z );
+		config.updater_label = getString( record.updater_label );
+		config.groundclamp = (record.flags & OBJECT_GROUNDCLAMP) != 0;
+		config.groundclamp_attitude = (record.flags & OBJECT_GROUNDCLAMP_ATTITUDE) != 0;
+		config.groundclamp_offset = record.groundclamp_offset;
+		for(unsigned int j=0; j<record.numFootprintPoints; j++)
+		{
+			const double* point = footprint + 3*(record.firstFootprintPoint+j);
+			config.footprint.push_back( osg::Vec3d(point[0], point[1], point[2]) );
+		}
+		objectSources[i] = record.source;
+	}
+
+	// Decode tracking and environment.
+	content.trackModel = (header->flags & FLAG_TRACKMODEL) != 0;
+	content.trackingID = header->trackingID;
+	content.trackingIdUpdaterSlot = getString( header->trackingIdUpdaterSlot );
+	content.env.dateTime = (header->flags & FLAG_DATETIME) != 0;
+	content.env.day = header->day;
+	content.env.month = header->month;
+	content.env.year = header->year;
+	content.env.hour = header->hour;
+	content.env.minute = header->minute;
+	content.env.visibility = (header->flags & FLAG_VISIBILITY) != 0;
+	content.env.range = header->range;
+	content.env.turbidity = header->turbidity;
+
+	const cloudLayerRecord* clouds = reinterpret_cast<const cloudLayerRecord*>( footprint + 3*header->numFootprintPoints );
+	for(unsigned int i=0; i<header->numCloudLayers; i++)
+	{
+		cloudLayer layer;
+		layer.slot = clouds[i].slot;
+		layer.baseLength = clouds[i].baseLength;
+		layer.baseWidth = clouds[i].baseWidth;
+		layer.thickness = clouds[i].thickness;
+		layer.baseHeight = clouds[i].baseHeight;
+		layer.density = clouds[i].density;
+		layer.type = getString( clouds[i].type );
+		layer.rate_mmPerHour_rain = clouds[i].rate_mmPerHour_rain;
+		layer.rate_mmPerHour_drySnow = clouds[i].rate_mmPerHour_drySnow;
+		layer.rate_mmPerHour_wetSnow = clouds[i].rate_mmPerHour_wetSnow;
+		layer.rate_mmPerHour_sleet = clouds[i].rate_mmPerHour_sleet;
+		content.env.cloudLayers.push_back( layer );
+	}
+
+	const windLayerRecord* winds = reinterpret_cast<const windLayerRecord*>( clouds + header->numCloudLayers );
+	for(unsigned int i=0; i<header->numWindLayers; i++)
+	{
+		windLayer layer;
+		layer.bottom = winds[i].bottom;
+		layer.top = winds[i].top;
+		layer.speed = winds[i].speed;
+		layer.direction = winds[i].direction;
+		content.env.windLayers.push_back( layer );
+	}
+
+	geometries.resize( header->numSources );
+	OSG_NOTIFY( osg::NOTICE ) << "Scenery archive " << filename_ << ": " << header->numObjects << " objects, " << header->numSources << " model files." << std::endl;
+	return true;
+}
+
+void core_sceneryArchive::loadGeometry( unsigned int part_, unsigned int numParts_ )
+{
+	if( !header || numParts_ == 0 )
+		return;
+
+	osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+	if( !rw )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::loadGeometry() :: No .osgb plugin, the models are loaded from their files." << std::endl;
+		return;
+	}
+
+	for(unsigned int i=part_; i<geometries.size(); i+=numParts_)
+	{
+		if( sources[i].geometrySize == 0 )
+			continue;
+
+		memoryStreamBuffer buffer( reinterpret_cast<const char*>(file->getData()) + sources[i].geometryOffset, static_cast<size_t>(sources[i].geometrySize) );
+		std::istream stream( &buffer );
+		osgDB::ReaderWriter::ReadResult result = rw->readNode( stream, NULL );
+		if( result.validNode() )
+			geometries[i] = result.getNode();
+		else
+			OSG_NOTIFY( osg::WARN ) << "core_sceneryArchive::loadGeometry() :: Unable to read the geometry of " << getString( sources[i].filename ) << ", it is loaded from its file." << std::endl;
+	}
+}
+
+osg::Node* core_sceneryArchive::getGeometry( int source_ ) const
+{
+	if( source_ < 0 || source_ >= static_cast<int>(geometries.size()) )
+		return NULL;
+	return geometries[source_].get();
+}
+
+void core_sceneryArchive::close()
+{
+	file = NULL;
+	header = NULL;
+	sources = NULL;
+	content = scenery();
+	objectSources.clear();
+	geometries.clear();
+}
+
+std::string core_sceneryArchive::getString( const stringRef& ref_ ) const
+{
+	if( !header || static_cast<unsigned long long>(ref_.offset) + ref_.length > header->stringTableSize )
+		return "";
+	return std::string( reinterpret_cast<const char*>(file->getData() + header->stringTableOffset + ref_.offset), ref_.length );
+}
+
+void core_sceneryArchive::parseEnvironment( const util_config::node* sceneryNode_, environment& env_ )
+{
+	if( !sceneryNode_ )
+		return;
+
+	const util_config::node::NodeList& children = sceneryNode_->getChildren();
+	for(unsigned int i=0; i<children.size(); i++)
+	{
+		const util_config::node* cur_node = children[i].get();
+		const std::string& node_name = cur_node->getName();
+
+		if(node_name == "datetime")
+		{
+			env_.dateTime = true;
+			env_.day = cur_node->getInt("day", env_.day);
+			env_.month = cur_node->getInt("month", env_.month);
+			env_.year = cur_node->getInt("year", env_.year);
+			env_.hour = cur_node->getInt("hour", env_.hour);
+			env_.minute = cur_node->getInt("minute", env_.minute);
+		}
+
+		if(node_name == "visibility")
+		{
+			env_.visibility = true;
+			env_.range = cur_node->getDouble("range", env_.range);
+			env_.turbidity = cur_node->getDouble("turbidity", env_.turbidity);
+		}
+
+		if(node_name == "clouds")
+		{
+			std::vector<const util_config::node*> layerNodes = cur_node->getChildren("cloudlayer");
+			for(unsigned int j=0; j<layerNodes.size(); j++)
+			{
+				cloudLayer layer;
+				layer.slot = layerNodes[j]->getInt("slot", layer.slot);
+				layer.type = layerNodes[j]->getString("type", layer.type);
+
+				const util_config::node* geometry = layerNodes[j]->getChild("geometry");
+				if( geometry )
+				{
+					layer.baseLength = geometry->getInt("baselength", layer.baseLength);
+					layer.baseWidth = geometry->getInt("basewidth", layer.baseWidth);
+					layer.thickness = geometry->getInt("thickness", layer.thickness);
+					layer.baseHeight = geometry->getInt("baseHeight", layer.baseHeight);
+					layer.density = geometry->getDouble("density", layer.density);
+				}
+
+				const util_config::node* precipitation = layerNodes[j]->getChild("precipitation");
+				if( precipitation )
+				{
+					layer.rate_mmPerHour_rain = precipitation->getDouble("rate_mmPerHour_rain", layer.rate_mmPerHour_rain);
+					layer.rate_mmPerHour_drySnow = precipitation->getDouble("rate_mmPerHour_drySnow", layer.rate_mmPerHour_drySnow);
+					layer.rate_mmPerHour_wetSnow = precipitation->getDouble("rate_mmPerHour_wetSnow", layer.rate_mmPerHour_wetSnow);
+					layer.rate_mmPerHour_sleet = precipitation->getDouble("rate_mmPerHour_sleet", layer.rate_mmPerHour_sleet);
+				}
+
+				env_.cloudLayers.push_back( layer );
+			}
+		}
+
+		if(node_name == "windlayer")
+		{
+			windLayer layer;
+			layer.bottom = cur_node->getDouble("bottom", layer.bottom);
+			layer.top = cur_node->getDouble("top", layer.top);
+			layer.speed = cur_node->getDouble("speed", layer.speed);
+			layer.direction = cur_node->getDouble("direction", layer.direction);
+			env_.windLayers.push_back( layer );
+		}
+	}// FOR all nodes END
+}
+
+void core_sceneryArchive::parseScenery( const util_config::node* sceneryNode_, scenery& scenery_ )
+{
+	if( !sceneryNode_ )
+		return;
+
+	std::vector<const util_config::node*> modelLists = sceneryNode_->getChildren("models");
+	for(unsigned int i=0; i<modelLists.size(); i++)
+	{
+		const util_config::node::NodeList& modelNodes = modelLists[i]->getChildren();
+		for(unsigned int j=0; j<modelNodes.size(); j++)
+		{
+			const util_config::node* modelNode = modelNodes[j].get();
+			if(modelNode->getName() == "model")
+			{
+				visual_object::objectConfig config;
+				if( visual_object::parseXMLConfig(modelNode, config) )
+					scenery_.objects.push_back( config );
+			}
+			if(modelNode->getName() == "trackmodel")
+			{
+				if( modelNode->hasAttribute("id") )
+				{
+					scenery_.trackModel = true;
+					scenery_.trackingID = modelNode->getInt("id");
+				}
+				scenery_.trackingIdUpdaterSlot = modelNode->getString("updater_slot", scenery_.trackingIdUpdaterSlot);
+			}
+		}
+	}
+
+	parseEnvironment( sceneryNode_, scenery_.env );
+}
+
+unsigned long long core_sceneryArchive::hashScenery( const util_config::node* sceneryNode_ )
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	if( !sceneryNode_ )
+		return hash;
+
+	// The archive node itself does not change the compiled scenery.
+	const util_config::node::NodeList& children = sceneryNode_->getChildren();
+	for(unsigned int i=0; i<children.size(); i++)
+	{
+		if(children[i]->getName() != "sceneryarchive")
+			hashElement( hash, children[i].get() );
+	}
+	return hash;
+}
+
+bool core_sceneryArchive::write( const std::string& filename_, const util_config::node* sceneryNode_, bool optimize_ )
+{
+	if( !sceneryNode_ )
+		return false;
+
+	osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+	if( !rw )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "core_sceneryArchive::write() :: No .osgb plugin available." << std::endl;
+		return false;
+	}
+	// Embed the textures, so the archive does not depend on the image files.
+	osg::ref_ptr<osgDB::Options> writeOptions = new osgDB::Options("WriteImageHint=IncludeData");
+
+	scenery content;
+	parseScenery( sceneryNode_, content );
+
+	std::string strings;
+	std::vector<sourceRecord> sources;
+	std::vector<dependencyRecord> dependencies;
+	std::vector<std::string> geometryData;
+	std::map<std::string, int> sourceIndices;
+	std::vector<objectRecord> objects( content.objects.size() );
+	std::vector<double> footprint;
+
+	// Object table, with the geometry of each model file compiled once.
+	for(unsigned int i=0; i<content.objects.size(); i++)
+	{
+		const visual_object::objectConfig& config = content.objects[i];
+		objectRecord& record = objects[i];
+		memset( &record, 0, sizeof(objectRecord) );
+
+		record.source = -1;
+		if( !config.filename.empty() )
+		{
+			std::map<std::string, int>::iterator itr = sourceIndices.find( config.filename );
+			if( itr != sourceIndices.end() )
+				record.source = itr->second;
+			else
+			{
+				sourceRecord source;
+				memset( &source, 0, sizeof(sourceRecord) );
+				source.filename = addString( strings, config.filename );
+				source.modificationTime = -1;
+				getFileInfo( config.filename, source.modificationTime, source.fileSize );
+
+				std::string data;
+				osg::ref_ptr<osg::Node> model = osgDB::readNodeFile( config.filename );
+				if( model.valid() )
+				{
+					util_modelCache::DependencyList modelDependencies = util_modelCache::collectDependencies( model.get(), config.filename );
+					source.firstDependency = dependencies.size();
+					source.numDependencies = modelDependencies.size();
+					for(unsigned int j=0; j<modelDependencies.size(); j++)
+					{
+						dependencyRecord dependency;
+						memset( &dependency, 0, sizeof(dependencyRecord) );
+						dependency.filename = addString( strings, modelDependencies[j].filename );
+						dependency.modificationTime = modelDependencies[j].modificationTime;
+						dependency.fileSize = modelDependencies[j].fileSize;
+						dependencies.push_back( dependency );
+					}
+
+					if( optimize_ )
+						util_modelCache::getInstance()->optimize( model.get() );
+					std::ostringstream stream;
+					if( rw->writeNode( *model, stream, writeOptions.get() ).success() )
+						data = stream.str();
+				}
+				if( data.empty() )
+					OSG_NOTIFY( osg::WARN ) << "Unable to compile " << config.filename << ", it is loaded from its file at startup." << std::endl;
+				else
+					OSG_NOTIFY( osg::ALWAYS ) << "Compiled " << config.filename << ": " << data.size() << " bytes." << std::endl;
+
+				record.source = sources.size();
+				sourceIndices[config.filename] = record.source;
+				sources.push_back( source );
+				geometryData.push_back( data );
+			}
+		}
+
+		record.objectname = addString( strings, config.objectname );
+		record.label = addString( strings, config.label );
+		record.updater_lat = addString( strings, config.updater_lat );
+		record.updater_lon = addString( strings, config.updater_lon );
+		record.updater_alt = addString( strings, config.updater_alt );
+		record.updater_rot_x = addString( strings, config.updater_rot_x );
+		record.updater_rot_y = addString( strings, config.updater_rot_y );
+		record.updater_rot_z = addString( strings, config.updater_rot_z );
+		record.updater_label = addString( strings, config.updater_label );
+		record.trackingID = config.trackingID;
+		record.flags = (config.dynamic ? OBJECT_DYNAMIC : 0) | (config.groundclamp ? OBJECT_GROUNDCLAMP : 0) | (config.groundclamp_attitude ? OBJECT_GROUNDCLAMP_ATTITUDE : 0);
+		record.firstFootprintPoint = footprint.size() / 3;
+		record.numFootprintPoints = config.footprint.size();
+		record.lat = config.lat;
+		record.lon = config.lon;
+		record.alt = config.alt;
+		record.rot_x = config.rot_x;
+		record.rot_y = config.rot_y;
+		record.rot_z = config.rot_z;
+		record.cam_trans_x = config.cam_trans_x;
+		record.cam_trans_y = config.cam_trans_y;
+		record.cam_trans_z = config.cam_trans_z;
+		record.cam_rot_x = config.cam_rot_x;
+		record.cam_rot_y = config.cam_rot_y;
+		record.cam_rot_z = config.cam_rot_z;
+		record.geometry_rot_x = config.geometry_rot_x;
+		record.geometry_rot_y = config.geometry_rot_y;
+		record.geometry_rot_z = config.geometry_rot_z;
+		record.geometry_scale_x = config.geometry_scale_x;
+		record.geometry_scale_y = config.geometry_scale_y;
+		record.geometry_scale_z = config.geometry_scale_z;
+		record.groundclamp_offset = config.groundclamp_offset;
+		for(unsigned int j=0; j<config.footprint.size(); j++)
+		{
+			footprint.push_back( config.footprint[j].x() );
+			footprint.push_back( config.footprint[j].y() );
+			footprint.push_back( config.footprint[j].z() );
+		}
+	}
+
+	// Environment
+	std::vector<cloudLayerRecord> clouds( content.env.cloudLayers.size() );
+	for(unsigned int i=0; i<clouds.size(); i++)
+	{
+		const cloudLayer& layer = content.env.cloudLayers[i];
+		memset( &clouds[i], 0, sizeof(cloudLayerRecord) );
+		clouds[i].slot = layer.slot;
+		clouds[i].baseLength = layer.baseLength;
+		clouds[i].baseWidth = layer.baseWidth;
+		clouds[i].thickness = layer.thickness;
+		clouds[i].baseHeight = layer.baseHeight;
+		clouds[i].type = addString( strings, layer.type );
+		clouds[i].density = layer.density;
+		clouds[i].rate_mmPerHour_rain = layer.rate_mmPerHour_rain;
+		clouds[i].rate_mmPerHour_drySnow = layer.rate_mmPerHour_drySnow;
+		clouds[i].rate_mmPerHour_wetSnow = layer.rate_mmPerHour_wetSnow;
+		clouds[i].rate_mmPerHour_sleet = layer.rate_mmPerHour_sleet;
+	}
+
+	std::vector<windLayerRecord> winds( content.env.windLayers.size() );
+	for(unsigned int i=0; i<winds.size(); i++)
+	{
+		winds[i].bottom = content.env.windLayers[i].bottom;
+		winds[i].top = content.env.windLayers[i].top;
+		winds[i].speed = content.env.windLayers[i].speed;
+		winds[i].direction = content.env.windLayers[i].direction;
+	}
+
+	fileHeader header;
+	memset( &header, 0, sizeof(fileHeader) );
+	memcpy( header.magic, FILE_MAGIC, 4 );
+	header.version = FILE_VERSION;
+	header.sceneryHash = hashScenery( sceneryNode_ );
+	header.numSources = sources.size();
+	header.numDependencies = dependencies.size();
+	header.numObjects = objects.size();
+	header.numFootprintPoints = footprint.size() / 3;
+	header.numCloudLayers = clouds.size();
+	header.numWindLayers = winds.size();
+	header.flags = (content.env.dateTime ? FLAG_DATETIME : 0) | (content.env.visibility ? FLAG_VISIBILITY : 0) | (content.trackModel ? FLAG_TRACKMODEL : 0);
+	header.day = content.env.day;
+	header.month = content.env.month;
+	header.year = content.env.year;
+	header.hour = content.env.hour;
+	header.minute = content.env.minute;
+	header.trackingID = content.trackingID;
+	header.trackingIdUpdaterSlot = addString( strings, content.trackingIdUpdaterSlot );
+	header.range = content.env.range;
+	header.turbidity = content.env.turbidity;
+	header.stringTableOffset = sizeof(fileHeader) + sources.size()*sizeof(sourceRecord) + dependencies.size()*sizeof(dependencyRecord) + objects.size()*sizeof(objectRecord)
+		+ footprint.size()*sizeof(double) + clouds.size()*sizeof(cloudLayerRecord) + winds.size()*sizeof(windLayerRecord);
+	header.stringTableSize = strings.size();
+
+	// Place the geometries behind the string table.
+	unsigned long long offset = alignTo8( header.stringTableOffset + header.stringTableSize );
+	for(unsigned int i=0; i<sources.size(); i++)
+	{
+		if( geometryData[i].empty() )
+			continue;
+		sources[i].geometryOffset = offset;
+		sources[i].geometrySize = geometryData[i].size();
+		offset += alignTo8( geometryData[i].size() );
+	}
+
+	std::ofstream out( filename_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if( !out )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "core_sceneryArchive::write() :: Unable to create " << filename_ << std::endl;
+		return false;
+	}
+
+	out.write( reinterpret_cast<const char*>(&header), sizeof(fileHeader) );
+	if( !sources.empty() )
+		out.write( reinterpret_cast<const char*>(&sources[0]), sources.size()*sizeof(sourceRecord) );
+	if( !dependencies.empty() )
+		out.write( reinterpret_cast<const char*>(&dependencies[0]), dependencies.size()*sizeof(dependencyRecord) );
+	if( !objects.empty() )
+		out.write( reinterpret_cast<const char*>(&objects[0]), objects.size()*sizeof(objectRecord) );
+	if( !footprint.empty() )
+		out.write( reinterpret_cast<const char*>(&footprint[0]), footprint.size()*sizeof(double) );
+	if( !clouds.empty() )
+		out.write( reinterpret_cast<const char*>(&clouds[0]), clouds.size()*sizeof(cloudLayerRecord) );
+	if( !winds.empty() )
+		out.write( reinterpret_cast<const char*>(&winds[0]), winds.size()*sizeof(windLayerRecord) );
+	out.write( strings.data(), strings.size() );
+	writePadding( out, header.stringTableOffset + header.stringTableSize );
+	for(unsigned int i=0; i<geometryData.size(); i++)
+	{
+		out.write( geometryData[i].data(), geometryData[i].size() );
+		writePadding( out, geometryData[i].size() );
+	}
+
+	if( !out.good() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "core_sceneryArchive::write() :: Unable to write " << filename_ << std::endl;
+		return false;
+	}
+
+	OSG_NOTIFY( osg::ALWAYS ) << "Scenery archive written to " << filename_ << ": " << objects.size() << " objects, " << sources.size() << " model files, " << offset << " bytes." << std::endl;
+	return true;
+}
@@ -0,0 +1,143 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <core_startupTasks.h>
+
+#include <iomanip>
+
+using namespace osgVisual;
+
+core_startupTasks::core_startupTasks()
+{
+	startTick = osg::Timer::instance()->tick();
+}
+
+core_startupTasks::~core_startupTasks()
+{
+	waitForAll();
+}
+
+void core_startupTasks::addTask( const std::string& name_, osg::Operation* operation_ )
+{
+	osg::ref_ptr<entry> task = new entry();
+	task->name = name_;
+	task->background = true;
+	taskThread* thread = new taskThread(this, task.get(), operation_);
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		entries.push_back( task );
+		threads.push_back( thread );
+	}
+
+	thread->startThread();
+}
+
+void core_startupTasks::taskThread::run()
+{
+	osg::Timer_t start = osg::Timer::instance()->tick();
+	(*operation)(NULL);
+	osg::Timer_t end = osg::Timer::instance()->tick();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(tasks->mutex);
+	task->startTick = start;
+	task->endTick = end;
+	task->done = true;
+	tasks->completed.broadcast();
+}
+
+void core_startupTasks::wait( const std::string& name_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	for(unsigned int i=0; i<entries.size(); i++)
+	{
+		if( entries[i]->background && entries[i]->name == name_ )
+		{
+			while( !entries[i]->done )
+				completed.wait( &mutex );
+		}
+	}
+}
+
+void core_startupTasks::waitForAll()
+{
+	std::vector<taskThread*> finishedThreads;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		for(unsigned int i=0; i<entries.size(); i++)
+		{
+			while( entries[i]->background && !entries[i]->done )
+				completed.wait( &mutex );
+		}
+		finishedThreads.swap( threads );
+	}
+
+	// The tasks are done, so the threads are about to leave run().
+	for(unsigned int i=0; i<finishedThreads.size(); i++)
+	{
+		finishedThreads[i]->join();
+		delete finishedThreads[i];
+	}
+}
+
+void core_startupTasks::beginStep( const std::string& name_ )
+{
+	endStep();
+
+	actualStep = new entry();
+	actualStep->name = name_;
+	actualStep->startTick = osg::Timer::instance()->tick();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	entries.push_back( actualStep );
+}
+
+void core_startupTasks::endStep()
+{
+	if( !actualStep.valid() )
+		return;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	actualStep->endTick = osg::Timer::instance()->tick();
+	actualStep->done = true;
+	actualStep = NULL;
+}
+
+void core_startupTasks::printReport()
+{
+	osg::Timer_t endTick = osg::Timer::instance()->tick();
+	osg::Timer* timer = osg::Timer::instance();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+
+	double mainThreadTime = 0.0, backgroundTime = 0.0;
+	OSG_NOTIFY( osg::ALWAYS ) << "Startup timing (start / duration in ms):" << std::endl;
+	for(unsigned int i=0; i<entries.size(); i++)
+	{
+		const entry& e = *entries[i];
+		OSG_NOTIFY( osg::ALWAYS ) << "  " << std::left << std::setw(28) << e.name << std::right << (e.background ? " [task]   " : " [main]   ");
+		if( !e.done )
+		{
+			OSG_NOTIFY( osg::ALWAYS ) << "running" << std::endl;
+			continue;
+		}
+
+		double duration = timer->delta_m( e.startTick, e.endTick );
+		(e.background ? backgroundTime : mainThreadTime) += duration;
+		OSG_NOTIFY( osg::ALWAYS ) << std::fixed << std::setprecision(1) << std::setw(9) << timer->delta_m( startTick, e.startTick ) << " / " << std::setw(9) << duration << std::endl;
+	}
+	OSG_NOTIFY( osg::ALWAYS ) << "  Total: " << timer->delta_m( startTick, endTick ) << " ms, main thread steps " << mainThreadTime << " ms, background tasks " << backgroundTime << " ms." << std::endl;
+	OSG_NOTIFY( osg::ALWAYS ) << std::resetiosflags( std::ios::fixed ) << std::setprecision(6);
+}
@@ -0,0 +1,385 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <core_threadPlacement.h>
+
+#include <osg/Math>
+#include <osgDB/DatabasePager>
+#include <OpenThreads/Thread>
+
+#include <util_config.h>
+
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#elif defined(WIN32)
+#include <windows.h>
+#endif
+
+using namespace osgVisual;
+
+// Frames for which memory is reserved at start, so recording the frame times does not reallocate (one hour at 60 Hz).
+static const unsigned int RESERVED_FRAMES = 216000;
+
+static const char* roleNames[core_threadPlacement::NUM_ROLES] = {"main", "cull", "draw", "pager"};
+
+/**
+ * \brief This operation applies a placement to the thread which executes it, e.g. to a cull or draw thread of the viewer.
+ *
+ */
+class placementOperation : public osg::Operation
+{
+public:
+	placementOperation( const std::string& name_, const core_threadPlacement::threadSettings& settings_ )
+		: osg::Operation("placementOperation", false), name(name_), settings(settings_) {};
+
+	virtual void operator () ( osg::Object* )
+	{
+		core_threadPlacement::applyToCurrentThread( name, settings );
+	}
+
+private:
+	std::string name;
+	core_threadPlacement::threadSettings settings;
+};
+
+static std::string cpuListToString( const std::vector<unsigned int>& cpus_ )
+{
+	std::stringstream list;
+	for(unsigned int i=0; i<cpus_.size(); i++)
+		list << (i>0 ? "," : "") << cpus_[i];
+	return list.str();
+}
+
+core_threadPlacement::core_threadPlacement()
+{
+	apply = true;
+	lockAllMemory = false;
+	prefaultHeapMB = 0;
+	warmupFrames = 100;
+	spikeThreshold = 0.0;
+	lastTick = 0;
+	numFrames = 0;
+	statistics = new util_frameTimeStatistics();
+}
+
+bool core_threadPlacement::init( osgViewer::Viewer* viewer_ )
+{
+	const util_config::node* section = util_config::getInstance()->getSection("threadplacement");
+	if( !section || !section->getBool("enabled", true) )
+		return false;
+
+	const util_config::node* config = section->getChild("threadplacement");
+	if( !config )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Missing <threadplacement> element, thread placement disabled." << std::endl;
+		return false;
+	}
+
+	apply = config->getBool("apply", apply);
+	lockAllMemory = config->getBool("mlockall", lockAllMemory);
+	prefaultHeapMB = osg::maximum( config->getInt("prefaultheap", prefaultHeapMB), 0 );
+	warmupFrames = osg::maximum( config->getInt("warmupframes", warmupFrames), 0 );
+	spikeThreshold = osg::maximum( config->getDouble("spikethreshold", spikeThreshold), 0.0 );
+	jitterReportFilename = config->getString("jitterreport");
+	baselineFilename = config->getString("baseline");
+
+	std::vector<const util_config::node*> threads = config->getChildren("thread");
+	for(unsigned int i=0; i<threads.size(); i++)
+	{
+		std::string name = threads[i]->getString("name");
+		unsigned int role = 0;
+		while( role < NUM_ROLES && name != roleNames[role] )
+			role++;
+		if( role == NUM_ROLES )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unknown thread '" << name << "', valid are main, cull, draw and pager." << std::endl;
+			continue;
+		}
+
+		if( !parseCpuList( threads[i]->getString("cpus"), settings[role].cpus ) )
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Invalid cpus '" << threads[i]->getString("cpus") << "' of thread '" << name << "', no affinity applied." << std::endl;
+
+		settings[role].priority = osg::maximum( threads[i]->getInt("priority", 0), 0 );
+		if( role == PAGER && settings[role].priority > 0 )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: The pager threads keep the normal scheduling, priority ignored." << std::endl;
+			settings[role].priority = 0;
+		}
+	}
+
+	statistics->reserve( RESERVED_FRAMES );
+
+	if( !apply )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "core_threadPlacement: Placement not applied, recording the frame times only." << std::endl;
+		return true;
+	}
+
+	// The pager threads are created with the scene but started later: a stored affinity is applied by the thread on start.
+	osgDB::DatabasePager* pager = viewer_->getDatabasePager();
+	const std::vector<unsigned int>& pagerCpus = settings[PAGER].cpus;
+	if( pager && !pagerCpus.empty() )
+	{
+		for(unsigned int i=0; i<pager->getNumDatabaseThreads(); i++)
+		{
+			OpenThreads::Thread* thread = pager->getDatabaseThread(i);
+			if( thread->isRunning() )
+				OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Pager thread " << i << " is already running, affinity not applied." << std::endl;
+			else
+				thread->setProcessorAffinity( pagerCpus[i % pagerCpus.size()] );
+		}
+		OSG_NOTIFY( osg::NOTICE ) << "core_threadPlacement: " << pager->getNumDatabaseThreads() << " pager threads on cores " << cpuListToString( pagerCpus ) << "." << std::endl;
+	}
+
+	if( lockAllMemory )
+		lockMemory( prefaultHeapMB );
+
+	return true;
+}
+
+void core_threadPlacement::applyToViewerThreads( osgViewer::Viewer* viewer_ )
+{
+	if( !apply )
+		return;
+
+	// Main thread: event, update, dataIO and cluster I/O. The realized viewer may have set its own affinity, which is replaced.
+	if( !settings[MAIN].cpus.empty() || settings[MAIN].priority > 0 )
+		applyToCurrentThread( roleNames[MAIN], settings[MAIN] );
+
+	// Cull threads only exist in the threading model CullThreadPerCameraDrawThreadPerContext, otherwise the main or draw thread culls.
+	if( !settings[CULL].cpus.empty() || settings[CULL].priority > 0 )
+	{
+		osgViewer::ViewerBase::Cameras cameras;
+		viewer_->getCameras( cameras );
+		for(unsigned int i=0; i<cameras.size(); i++)
+		{
+			if( cameras[i]->getCameraThread() )
+				cameras[i]->getCameraThread()->add( new placementOperation( roleNames[CULL], settings[CULL] ) );
+		}
+	}
+
+	// Draw threads exist in all multi threaded models.
+	if( !settings[DRAW].cpus.empty() || settings[DRAW].priority > 0 )
+	{
+		osgViewer::ViewerBase::Contexts contexts;
+		viewer_->getContexts( contexts );
+		for(unsigned int i=0; i<contexts.size(); i++)
+		{
+			if( contexts[i]->getGraphicsThread() )
+				contexts[i]->getGraphicsThread()->add( new placementOperation( roleNames[DRAW], settings[DRAW] ) );
+		}
+	}
+}
+
+void core_threadPlacement::update()
+{
+	osg::Timer_t now = osg::Timer::instance()->tick();
+	if( numFrames++ > warmupFrames )
+		statistics->add( osg::Timer::instance()->delta_m( lastTick, now ) );
+	lastTick = now;
+}
+
+void core_threadPlacement::report()
+{
+	if( statistics->getNumFrames() == 0 )
+		return;
+
+	// Both runs are compared with the same threshold.
+	double threshold = spikeThreshold > 0.0 ? spikeThreshold : 2.0 * statistics->getPercentile(50.0);
+	writeDistribution( statistics.get(), apply ? "with thread placement" : "without thread placement", threshold );
+
+	if( !baselineFilename.empty() )
+	{
+		osg::ref_ptr<util_frameTimeStatistics> baseline = new util_frameTimeStatistics();
+		if( baseline->readCSV( baselineFilename ) && baseline->getNumFrames() > 0 )
+		{
+			writeDistribution( baseline.get(), "of baseline '"+baselineFilename+"'", threshold );
+
+			double spikeRate = 1000.0 * statistics->getNumFramesAbove( threshold ) / statistics->getNumFrames();
+			double baselineSpikeRate = 1000.0 * baseline->getNumFramesAbove( threshold ) / baseline->getNumFrames();
+			OSG_NOTIFY( osg::ALWAYS ) << "core_threadPlacement: Baseline -> this run: P99 " << baseline->getPercentile(99.0) << " -> " << statistics->getPercentile(99.0)
+				<< " ms, max " << baseline->getMax() << " -> " << statistics->getMax() << " ms, stddev " << baseline->getStandardDeviation() << " -> " << statistics->getStandardDeviation()
+				<< " ms, spikes per 1000 frames " << baselineSpikeRate << " -> " << spikeRate << std::endl;
+		}
+	}
+
+	if( !jitterReportFilename.empty() && statistics->writeCSV( jitterReportFilename ) )
+		OSG_NOTIFY( osg::ALWAYS ) << "core_threadPlacement: Frame times written to '" << jitterReportFilename << "'." << std::endl;
+}
+
+void core_threadPlacement::writeDistribution( util_frameTimeStatistics* statistics_, const std::string& title_, double spikeThreshold_ )
+{
+	statistics_->writeReport( osg::notify( osg::ALWAYS ), "core_threadPlacement: frame times " + title_ );
+	unsigned int spikes = statistics_->getNumFramesAbove( spikeThreshold_ );
+	OSG_NOTIFY( osg::ALWAYS ) << "  " << spikes << " spikes above " << spikeThreshold_ << " ms (" << 1000.0 * spikes / statistics_->getNumFrames() << " per 1000 frames)" << std::endl;
+}
+
+bool core_threadPlacement::applyToCurrentThread( const std::string& name_, const threadSettings& settings_ )
+{
+	bool success = true;
+
+#if defined(__linux__)
+	if( !settings_.cpus.empty() )
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO( &cpuSet );
+		for(unsigned int i=0; i<settings_.cpus.size(); i++)
+		{
+			if( settings_.cpus[i] < CPU_SETSIZE )
+				CPU_SET( settings_.cpus[i], &cpuSet );
+		}
+		int result = pthread_setaffinity_np( pthread_self(), sizeof(cpuSet), &cpuSet );
+		if( result != 0 )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to set the affinity of the " << name_ << " thread: " << strerror(result) << std::endl;
+			success = false;
+		}
+	}
+
+	if( settings_.priority > 0 )
+	{
+		sched_param param;
+		param.sched_priority = osg::clampBetween( settings_.priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO) );
+		int result = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+		if( result != 0 )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to set SCHED_FIFO for the " << name_ << " thread: " << strerror(result) << " (requires CAP_SYS_NICE or an rtprio limit)" << std::endl;
+			success = false;
+		}
+	}
+#elif defined(WIN32)
+	if( !settings_.cpus.empty() )
+	{
+		DWORD_PTR mask = 0;
+		for(unsigned int i=0; i<settings_.cpus.size(); i++)
+		{
+			if( settings_.cpus[i] < sizeof(DWORD_PTR)*8 )
+				mask |= static_cast<DWORD_PTR>(1) << settings_.cpus[i];
+		}
+		if( !SetThreadAffinityMask( GetCurrentThread(), mask ) )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to set the affinity of the " << name_ << " thread, error " << GetLastError() << std::endl;
+			success = false;
+		}
+	}
+
+	if( settings_.priority > 0 && !SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to raise the priority of the " << name_ << " thread, error " << GetLastError() << std::endl;
+		success = false;
+	}
+#else
+	if( !settings_.cpus.empty() && OpenThreads::SetProcessorAffinityOfCurrentThread( settings_.cpus[0] ) != 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to set the affinity of the " << name_ << " thread." << std::endl;
+		success = false;
+	}
+
+	if( settings_.priority > 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Thread priorities are not supported on this platform." << std::endl;
+		success = false;
+	}
+#endif
+
+	if( success )
+	{
+		OSG_NOTIFY( osg::NOTICE ) << "core_threadPlacement: " << name_ << " thread on cores " << (settings_.cpus.empty() ? std::string("all") : cpuListToString( settings_.cpus ))
+			<< ", " << (settings_.priority > 0 ? "realtime priority" : "normal priority") << "." << std::endl;
+	}
+	return success;
+}
+
+bool core_threadPlacement::parseCpuList( const std::string& list_, std::vector<unsigned int>& cpus_ )
+{
+	cpus_.clear();
+
+	std::stringstream stream( list_ );
+	std::string item;
+	while( std::getline( stream, item, ',' ) )
+	{
+		unsigned int first, last;
+		char dash;
+		std::stringstream range( item );
+		if( !(range >> first) )
+		{
+			cpus_.clear();
+			return false;
+		}
+		if( range >> dash )
+		{
+			if( dash != '-' || !(range >> last) || last < first )
+			{
+				cpus_.clear();
+				return false;
+			}
+		}
+		else
+			last = first;
+
+		for(unsigned int cpu=first; cpu<=last; cpu++)
+			cpus_.push_back( cpu );
+	}
+	return true;
+}
+
+bool core_threadPlacement::lockMemory( unsigned int prefaultMB_ )
+{
+#if defined(__linux__)
+	// Freed memory must stay in the heap, returned pages would be faulted in again. Large blocks are taken from the heap as well,
+	// as blocks allocated by mmap() are returned on free().
+	mallopt( M_TRIM_THRESHOLD, -1 );
+	mallopt( M_MMAP_MAX, 0 );
+
+	if( mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: mlockall() failed: " << strerror(errno) << " (check the memlock limit, ulimit -l)" << std::endl;
+		return false;
+	}
+
+	// Touch each page of the reserve once, so later allocations of the main thread are served without page faults.
+	if( prefaultMB_ > 0 )
+	{
+		size_t size = static_cast<size_t>(prefaultMB_) << 20;
+		char* reserve = static_cast<char*>( malloc( size ) );
+		if( !reserve )
+		{
+			OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Unable to allocate the heap reserve of " << prefaultMB_ << " MB." << std::endl;
+			return false;
+		}
+		volatile char* page = reserve;
+		long pageSize = sysconf( _SC_PAGESIZE );
+		for(size_t i=0; i<size; i+=pageSize)
+			page[i] = 0;
+		free( reserve );
+	}
+
+	OSG_NOTIFY( osg::NOTICE ) << "core_threadPlacement: Memory locked, " << prefaultMB_ << " MB heap reserve pre-faulted." << std::endl;
+	return true;
+#else
+	OSG_NOTIFY( osg::WARN ) << "core_threadPlacement: Memory locking is only supported on Linux." << std::endl;
+	return false;
+#endif
+}
@@ -79,9 +79,10 @@ int main(int argc, char** argv)
 
 	// Shut osgVisual down
 	core->shutdown();
+	int exitCode = core->getExitCode();
 
 	// Set Pointer to null to destroy the objects before this function ends
 	core = NULL;
 
-	return 0;
+	return exitCode;
 }
\ No newline at end of file
@@ -24,6 +24,7 @@ using namespace osgVisual;
 
 visual_core::visual_core(osg::ArgumentParser& arguments_) : arguments(arguments_)
 {
+	exitCode = 0;
 	OSG_NOTIFY( osg::ALWAYS ) << "visual_core instantiated." << std::endl;
 }
 
@@ -45,8 +46,33 @@ void visual_core::initialize()
 			OSG_ALWAYS << "Using configuration file: " << configFilename << std::endl;
 	}
 
-	// Configure osg to use KdTrees
-	osgDB::Registry::instance()->setBuildKdTreesHint(osgDB::ReaderWriter::Options::BUILD_KDTREES);
+	// Write per-frame log messages asynchronously, so a slow terminal or log file does not delay frames.
+	util_log::getInstance()->start();
+	if( arguments.read("--log-prefix") )
+		util_log::getInstance()->setPrefixEnabled(true);
+
+	// Enable the frame profiler, the recorded trace is written on shutdown (*.csv as CSV, otherwise as Chrome trace).
+	if( arguments.read("--profile", profileFilename) )
+	{
+#ifdef USE_PROFILER
+		util_profiler::getInstance()->setEnabled(true);
+		util_profiler::getInstance()->setThreadName("main");
+		OSG_ALWAYS << "Profiling enabled, trace is written to: " << profileFilename << std::endl;
+#else
+		OSG_WARN << "WARNING: osgVisual is compiled without USE_PROFILER, --profile is ignored." << std::endl;
+		profileFilename = "";
+#endif
+	}
+
+	// Watch the configuration file and apply changes of the scenery environment while running.
+	if( arguments.read("--watch-config") )
+	{
+		sceneryListener = new sceneryChangeListener(this);
+		util_config::getInstance()->addChangeListener("scenery", sceneryListener.get());
+	}
+
+	// Configure osg not to build KdTrees while loading: they are built on demand by util_kdTreeBuilder when a drawable is hit by a terrain query.
+	osgDB::Registry::instance()->setBuildKdTreesHint(osgDB::ReaderWriter::Options::DO_NOT_BUILD_KDTREES);
 
 	// Configure Multisampling
 	osg::DisplaySettings::instance()->setNumMultiSamples(4);
@@ -55,10 +81,59 @@ void visual_core::initialize()
 	osgDB::Registry::instance()->getDataFilePathList().push_front("H:\AllInOnDB");
 	osgDB::Registry::instance()->getDataFilePathList().push_back( "D:\\DA\\osgVisual\\models" );
 
-	
+	// Start loading the scenery in the background while the modules are initialized.
+	// The XML configuration is parsed once here and shared by all modules.
+	osg::ref_ptr<core_startupTasks> startup = new core_startupTasks();
+	startup->beginStep("parse configuration");
+	if( !configFilename.empty() )
+		util_config::getInstance()->load(configFilename);
+	terrainFiles = util::getTerrainFromXMLConfig(configFilename);
+	modelFiles = util::getModelFilesFromXMLConfig(configFilename);
+	heightGridFile = util::getHeightGridFromXMLConfig(configFilename);
+	// Add each terrain path to the FilePath list to help OSG to find the subtiles. Done before loading, the list is not thread safe.
+	for(unsigned int i=0;i<terrainFiles.size();i++)
+		osgDB::Registry::instance()->getDataFilePathList().push_back(osgDB::getFilePath(terrainFiles[i]));
+	// Use the compiled scenery archive instead of parsing the scenery and reading the model files, if it is up to date.
+	std::string sceneryArchiveFile = util::getSceneryArchiveFromXMLConfig(configFilename);
+	if( !sceneryArchiveFile.empty() )
+	{
+		sceneryArchive = new core_sceneryArchive();
+		if( !sceneryArchive->open(sceneryArchiveFile, util::getSceneryConfig(configFilename)) )
+			sceneryArchive = NULL;
+	}
+	// Optimize the models and cache them as .osgb, if configured. Done before loading, the models are read by the worker threads.
+	const util_config::node* scenery = util::getSceneryConfig(configFilename);
+	util_modelCache::getInstance()->configure( scenery ? scenery->getChild("modelcache") : NULL );
+	util_workerPool::getInstance()->start();
+	util_taskScheduler::getInstance()->start();
+	startup->addTask("load terrain", new core_startupTasks::methodOperation<visual_core>(this, &visual_core::loadTerrain));
+	if( sceneryArchive.valid() )
+	{
+		// Deserialize the archived geometries in parallel, as many parts as the pool has worker threads (number of processors minus one).
+		unsigned int numParts = util_workerPool::getInstance()->getNumThreads();
+		for(unsigned int i=0;i<numParts;i++)
+			startup->addTask("load scenery archive", new core_sceneryArchive::loadOperation(sceneryArchive.get(), i, numParts));
+	}
+	else if( !modelFiles.empty() )
+		startup->addTask("load models", new core_startupTasks::methodOperation<visual_core>(this, &visual_core::preloadModels));
+	// Map the precompiled terrain height grid, if configured. It answers HOT/HAT queries without scene graph traversal.
+	if( !heightGridFile.empty() )
+		startup->addTask("map height grid", new core_startupTasks::methodOperation<visual_core>(this, &visual_core::loadHeightGrid));
+
 	// Setup viewer
+	startup->beginStep("setup viewer");
 	viewer = new osgViewer::Viewer(arguments);
 
+	// Setup headless and benchmark mode: the offscreen context must exist before the distortion uses the main camera.
+	benchmark = new core_benchmark();
+	if( benchmark->init(arguments) )
+	{
+		if( !benchmark->setupViewer(viewer) )
+			benchmark = NULL;
+	}
+	else
+		benchmark = NULL;
+
 	// Setup coordinate system node
 	rootNode = new osg::CoordinateSystemNode;	// todo memleakf
 	rootNode->setEllipsoidModel(new osg::EllipsoidModel());
@@ -74,12 +149,14 @@ void visual_core::initialize()
 	osg::Group* distortedSceneGraph = NULL;
 #ifdef USE_DISTORTION
 	// Initialize distortion
+	startup->beginStep("distortion");
 	distortion = new visual_distortion( viewer, arguments, configFilename );
 	distortedSceneGraph = distortion->initialize( rootNode, viewer->getCamera()->getClearColor() );
 #endif
 
 #ifdef USE_SKY_SILVERLINING
 	// Initialize sky
+	startup->beginStep("sky");
 	bool disabled = false;	// to ask if the skyp is disabled or enabled
 	sky = new visual_skySilverLining( viewer, configFilename, disabled );
 	if(disabled)
@@ -88,37 +165,107 @@ void visual_core::initialize()
 		sky->init(distortedSceneGraph, rootNode);	// Without distortion: distortedSceneGraph=NULL
 #endif
 
-	// Initialize DataIO interface
-	visual_dataIO::getInstance()->init(viewer, configFilename);
+	// Initialize DataIO interface, the cluster connect does not need the viewer and runs in the background.
+	startup->beginStep("dataIO");
+	visual_dataIO::getInstance()->init(viewer, configFilename, true);
+	startup->addTask("connect cluster", new core_startupTasks::methodOperation<visual_core>(this, &visual_core::connectCluster));
+
+	// Install ground clamping for objects which follow the terrain
+	startup->beginStep("ground clamper and manipulators");
+	object_groundClamper::getInstance()->init(viewer, rootNode);
 
 	// Add manipulators for user interaction - after dataIO to be able to skip it in slaves rendering machines.
 	manipulators = new core_manipulator();
 	manipulators->init( viewer, arguments, configFilename, rootNode);
 
+	// In benchmark mode, the camera follows the recorded path instead of the manipulators.
+	if( benchmark.valid() )
+		benchmark->setupViewer(viewer);
+
+	// Reduce the scene detail automatically under load, if configured. Not in benchmark mode, as it depends on the wall clock.
+	if( !benchmark.valid() || !benchmark->isBenchmark() )
+	{
+		detailGovernor = new core_detailGovernor();
+		if( !detailGovernor->init(viewer) )
+			detailGovernor = NULL;
+	}
+
+	// Place the pager threads and lock the memory, if configured. The pager threads must be placed before they are started.
+	threadPlacement = new core_threadPlacement();
+	if( !threadPlacement->init(viewer) )
+		threadPlacement = NULL;
+
 	// create the windows and run the threads.
+	startup->beginStep("realize viewer");
 	viewer->realize();
 
-	loadTerrain(arguments);
+	// Place the threads started by the viewer
+	if( threadPlacement.valid() )
+		threadPlacement->applyToViewerThreads( viewer );
+
+	startup->beginStep("wait for terrain");
+	startup->wait("load terrain");
+	attachTerrain();
+
+	// Models, height grid and cluster connection must be available in the first frame.
+	startup->beginStep("wait for background tasks");
+	startup->waitForAll();
+	startup->endStep();
+	startup->printReport();
+	util_modelCache::getInstance()->printReport();
 
 	// All modules are initialized - now check arguments for any unused parameter.
 	checkCommandlineArgumentsForFinalErrors();
 
 	// Run visual main loop
 	mainLoop();
+
+	// Print the benchmark results
+	if( benchmark.valid() )
+		benchmark->report();
+
+	// Print the jitter report
+	if( threadPlacement.valid() )
+		threadPlacement->report();
 }
 
 void visual_core::mainLoop()
 {
 	int framestoScenerySetup = 5;
+	bool benchmarkMode = benchmark.valid() && benchmark->isBenchmark();
 	// run main loop
 	while( !viewer->done() )
     {
+		if( benchmarkMode && benchmark->isFinished() )
+			break;
+
+		// Apply configuration changes
+		if( sceneryListener.valid() )
+			util_config::getInstance()->checkForChanges();
+
+		OSGVISUAL_PROFILE_SCOPE("frame");
+
+		// Release the transient allocations of the previous frame
+		util_frameArena::getInstance()->reset();
+
 		// setup scenery
 		if(framestoScenerySetup-- == 0)
 			setupScenery();
 
 		// next frame please....
-        viewer->advance();
+		{
+			OSGVISUAL_PROFILE_SCOPE("advance");
+			// The benchmark uses a fixed time step instead of the wall clock to get reproducible frames.
+			if( benchmarkMode )
+				viewer->advance( benchmark->getSimulationTime() );
+			else
+				viewer->advance();
+		}
+		util_profiler::getInstance()->setFrameNumber( viewer->getFrameStamp()->getFrameNumber() );
+
+		// Apply the recorded camera and slot values of this frame
+		if( benchmarkMode )
+			benchmark->beginFrame( viewer );
 
 		/*double hat, hot, lat, lon, height;
 		util::getWGS84ofCamera( viewer->getCamera(), rootNode, lat, lon, height);
@@ -126,14 +273,52 @@ void visual_core::mainLoop()
 			OSG_NOTIFY( osg::ALWAYS ) << "HOT is: " << hot << ", HAT is: " << hat << std::endl;*/
 	
 		// perform all queued events
-		viewer->eventTraversal();
+		{
+			OSGVISUAL_PROFILE_SCOPE("eventTraversal");
+			viewer->eventTraversal();
+		}
+
+		// Execute the frame jobs of the modules (object transforms, ground clamping, HUD) in parallel.
+		{
+			OSGVISUAL_PROFILE_SCOPE("frameJobs");
+			// Compute the dirty bounds first, so the terrain queries of the jobs do not update them.
+			rootNode->getBound();
+			util_taskScheduler::getInstance()->runFrame();
+		}
 
 		// update the scene by traversing it with the the update visitor which will
         // call all node update callbacks and animations.
-        viewer->updateTraversal();
+		{
+			OSGVISUAL_PROFILE_SCOPE("updateTraversal");
+			viewer->updateTraversal();
+		}
 		
         // Render the Frame.
-        viewer->renderingTraversals();
+		{
+			OSGVISUAL_PROFILE_SCOPE("renderingTraversals");
+			viewer->renderingTraversals();
+		}
+
+		// Adjust the scene detail to the frame time
+		if( detailGovernor.valid() )
+			detailGovernor->update( viewer );
+
+		// Record the frame time for the jitter report
+		if( threadPlacement.valid() )
+			threadPlacement->update();
+
+		// Publish KdTree construction statistics
+		if( viewer->getViewerStats() )
+			util_kdTreeBuilder::getInstance()->updateStats( viewer->getViewerStats(), viewer->getFrameStamp()->getFrameNumber() );
+
+		// Record the benchmark frame time
+		if( benchmarkMode )
+			benchmark->endFrame( viewer );
+
+#ifdef USE_ALLOCATION_TRACKING
+		// Take the allocations of this frame per subsystem
+		util_allocTracker::getInstance()->endFrame();
+#endif
 
     }	// END WHILE
 }
@@ -160,29 +345,87 @@ void visual_core::shutdown()
 		distortion->shutdown();
 #endif
 
+	// Shutdown ground clamping
+	object_groundClamper::getInstance()->shutdown();
+
 	// Shutdown data
 	rootNode = NULL;
+	visual_object::clearPreloadedGeometry();
 
 	// Shutdown dataIO
 	visual_dataIO::getInstance()->shutdown();
 
+	// Write the profiler trace
+	if( !profileFilename.empty() )
+	{
+		util_profiler::getInstance()->setEnabled(false);
+		util_profiler::getInstance()->write( profileFilename );
+	}
+
+#ifdef USE_ALLOCATION_TRACKING
+	// Report the steady-state allocations, an allocating allocation free path fails the run (e.g. a benchmark in a test script)
+	if( !util_allocTracker::getInstance()->report() )
+		exitCode = 1;
+#endif
+
+	// Release the configuration
+	if( sceneryListener.valid() )
+		util_config::getInstance()->removeChangeListener(sceneryListener.get());
+	sceneryListener = NULL;
+	util_config::getInstance()->unload();
+
+	// Stop background worker threads (e.g. KdTree construction)
+	util_workerPool::getInstance()->shutdown();
+
+	// Stop the frame job threads, the modules removed their jobs during their shutdown
+	util_taskScheduler::getInstance()->shutdown();
+
+	// Unmap terrain height grid
+	util_terrainHeightGrid::getInstance()->unload();
+
 	// Shutdown manipulators
 	if(manipulators.valid())
 		manipulators->shutdown();
 
+	// Restore the full detail
+	if( detailGovernor.valid() )
+		detailGovernor->shutdown( viewer );
+	detailGovernor = NULL;
+	threadPlacement = NULL;
+
 	// Destroy osgViewer
 	viewer = NULL;
+
+	// Write the pending log messages, further messages are written synchronously
+	util_log::getInstance()->stop();
 }
 
-bool visual_core::loadTerrain(osg::ArgumentParser& arguments_)
+void visual_core::loadTerrain()
 {
-	std::vector<std::string> terrainFile = util::getTerrainFromXMLConfig(configFilename);
+	if( !terrainFiles.empty() )
+		loadedTerrain = osgDB::readNodeFiles(terrainFiles);
+}
 
-	// Add each terrain path to the FilePath list to help OSG to find the subtiles. 
-	for(unsigned int i=0;i<terrainFile.size();i++)
-		osgDB::Registry::instance()->getDataFilePathList().push_back(osgDB::getFilePath(terrainFile[i]));
+void visual_core::preloadModels()
+{
+	for(unsigned int i=0;i<modelFiles.size();i++)
+		visual_object::preloadGeometry( modelFiles[i] );
+}
 
-	osg::ref_ptr<osg::Node> model = osgDB::readNodeFiles(terrainFile);
+void visual_core::loadHeightGrid()
+{
+	util_terrainHeightGrid::getInstance()->load( heightGridFile );
+}
+
+void visual_core::connectCluster()
+{
+	visual_dataIO::getInstance()->connectCluster();
+}
+
+bool visual_core::attachTerrain()
+{
+	osg::ref_ptr<osg::Node> model = loadedTerrain;
+	loadedTerrain = NULL;
 	if( model.valid() )
 	{
         osgTerrain::Terrain* terrain = util::findTopMostNodeOfType<osgTerrain::Terrain>(model.get());
@@ -205,124 +448,90 @@ bool visual_core::loadTerrain(osg::ArgumentParser& arguments_)
 	return false;
 }
 
-void visual_core::parseScenery(xmlNode* a_node)
+void visual_core::parseScenery(const util_config::node* sceneryNode_)
 {
 	OSG_ALWAYS << "parseScenery()" << std::endl;
 
-	a_node = a_node->children;
+	// terrain is parsend seperately
+	// animationpath is parsend seperately in util::getAnimationPathFromXMLConfig(..) which invokes this function.
 
-	for (xmlNode *cur_node = a_node; cur_node; cur_node = cur_node->next)
+	std::vector<const util_config::node*> modelLists = sceneryNode_->getChildren("models");
+	for(unsigned int i=0; i<modelLists.size(); i++)
 	{
-		std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-
-		// terrain is parsend seperately
-		// animationpath is parsend seperately in util::getAnimationPathFromXMLConfig(..) which invokes this function.
-
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "models")
+		const util_config::node::NodeList& modelNodes = modelLists[i]->getChildren();
+		for(unsigned int j=0; j<modelNodes.size(); j++)
 		{
-			for (xmlNode *modelNode = cur_node->children; modelNode; modelNode = modelNode->next)
+			const util_config::node* modelNode = modelNodes[j].get();
+			if(modelNode->getName() == "model")
 			{
-				std::string name=reinterpret_cast<const char*>(modelNode->name);
-				if(modelNode->type == XML_ELEMENT_NODE && name == "model")
-				{
-					visual_object::createNodeFromXMLConfig(rootNode, modelNode);
-				}
-				if(modelNode->type == XML_ELEMENT_NODE && name == "trackmodel")
-				{
-					// Extract track-ID and track the model
-					xmlAttr  *attr = modelNode->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "id" ) manipulators->trackNode( util::strToInt(attr_value) );
-						if( attr_name == "updater_slot" ) manipulators->setTrackingIdUpdaterSlot(attr_value);
-						attr = attr->next; 
-					}
-					
-				}
+				visual_object::createNodeFromXMLConfig(rootNode, modelNode);
 			}
-		}
-
-#ifdef USE_SKY_SILVERLINING
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "datetime")
-		{
-			int day=-1, month=-1, year=-1, hour=-1, minute=-1;
-
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "day" ) day = util::strToInt(attr_value);
-				if( attr_name == "month" ) month = util::strToInt(attr_value);
-				if( attr_name == "year" ) year = util::strToInt(attr_value);
-				if( attr_name == "hour" ) hour = util::strToInt(attr_value);
-				if( attr_name == "minute" ) minute = util::strToInt(attr_value);
-
-				attr = attr->next; 
-			}
-			if(sky.valid())
+			if(modelNode->getName() == "trackmodel")
 			{
-				if(day!=0 && month!=0 && year!=0)
-					sky->setDate(year, month, day);
-				sky->setTime(hour,minute,00);
+				// Extract track-ID and track the model
+				if( modelNode->hasAttribute("id") )
+					manipulators->trackNode( modelNode->getInt("id") );
+				if( modelNode->hasAttribute("updater_slot") )
+					manipulators->setTrackingIdUpdaterSlot( modelNode->getString("updater_slot") );
 			}
 		}
+	}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "visibility")
-		{
-			float range = 50000, turbidity=2.2;
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "range" ) range = util::strToDouble(attr_value);
-				if( attr_name == "turbidity" ) turbidity = util::strToDouble(attr_value);
-
-				attr = attr->next; 
-			}
+	parseSceneryEnvironment(sceneryNode_);
+}
 
-			if(sky.valid())
-			{
-				sky->setVisibility( range );
-				sky->setTurbidity( turbidity );
-			}
-		}
+void visual_core::parseSceneryEnvironment(const util_config::node* sceneryNode_)
+{
+	core_sceneryArchive::environment env;
+	core_sceneryArchive::parseEnvironment(sceneryNode_, env);
+	applySceneryEnvironment(env);
+}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "clouds")
-		{
-			if(sky.valid())
-				sky->configureCloudlayerbyXML( cur_node );
-		}
+void visual_core::applySceneryEnvironment(const core_sceneryArchive::environment& env_)
+{
+#ifdef USE_SKY_SILVERLINING
+	if(!sky.valid())
+		return;
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "windlayer")
-		{
-			float bottom = 0.0, top=5000.0, speed=25.0, direction=0.0;
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "bottom" ) bottom = util::strToDouble(attr_value);
-				if( attr_name == "top" ) top = util::strToDouble(attr_value);
-				if( attr_name == "speed" ) speed = util::strToDouble(attr_value);
-				if( attr_name == "direction" ) direction = util::strToDouble(attr_value);
-
-				attr = attr->next; 
-			}
-			if(sky.valid())
-			{
-				sky->addWindVolume( bottom, top, speed, direction );
-			}
-		}
+	if(env_.dateTime)
+	{
+		if(env_.day!=0 && env_.month!=0 && env_.year!=0)
+			sky->setDate(env_.year, env_.month, env_.day);
+		sky->setTime(env_.hour,env_.minute,00);
+	}
 
-		// Track Node
+	if(env_.visibility)
+	{
+		sky->setVisibility( env_.range );
+		sky->setTurbidity( env_.turbidity );
+	}
 
+	for(unsigned int i=0; i<env_.cloudLayers.size(); i++)
+	{
+		const core_sceneryArchive::cloudLayer& layer = env_.cloudLayers[i];
+		if(layer.slot!=-1 && layer.baseLength!=-1 && layer.baseWidth!=-1 && layer.thickness!=-1 && layer.baseHeight!=-1 && layer.density!=-1 )
+			sky->addCloudLayer( layer.slot, layer.baseLength, layer.baseWidth, layer.thickness, layer.baseHeight, layer.density, visual_skySilverLining::getCloudTypeByName(layer.type) );
+
+		if(layer.slot!=-1 && layer.rate_mmPerHour_rain!=-1 && layer.rate_mmPerHour_drySnow!=-1 && layer.thickness!=-1 && layer.baseHeight!=-1 && layer.density!=-1 )
+			sky->setSlotPrecipitation( layer.slot, layer.rate_mmPerHour_rain, layer.rate_mmPerHour_drySnow, layer.rate_mmPerHour_wetSnow, layer.rate_mmPerHour_sleet );
+	}
+
+	for(unsigned int i=0; i<env_.windLayers.size(); i++)
+		sky->addWindVolume( env_.windLayers[i].bottom, env_.windLayers[i].top, env_.windLayers[i].speed, env_.windLayers[i].direction );
 #endif
-	}// FOR all nodes END
+}
 
+void visual_core::reloadSceneryEnvironment(const util_config::node* sceneryNode_)
+{
+#ifdef USE_SKY_SILVERLINING
+	if(!sceneryNode_ || !sky.valid())
+		return;
+
+	sky->clearAllSlots();
+	sky->clearAllWindVolumes();
+	parseSceneryEnvironment(sceneryNode_);
+#endif
+	OSG_NOTIFY( osg::ALWAYS ) << "Scenery environment reloaded. Changes of models and terrain require a restart." << std::endl;
 }
 
 bool visual_core::checkCommandlineArgumentsForFinalErrors()
@@ -333,6 +542,10 @@ bool visual_core::checkCommandlineArgumentsForFinalErrors()
     arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [OSG options] -c XML-Configurationfile");
 	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information");
 	arguments.getApplicationUsage()->addCommandLineOption("-c or --config","XML configuration filename");
+	arguments.getApplicationUsage()->addCommandLineOption("--profile <file>","Record a frame profile and write it on exit (*.csv as CSV, otherwise as Chrome trace JSON)");
+	arguments.getApplicationUsage()->addCommandLineOption("--log-prefix","Prefix the per-frame log messages with time, thread and source location");
+	arguments.getApplicationUsage()->addCommandLineOption("--watch-config","Reload the configuration file when it is modified and apply changes of date, time, visibility, clouds and wind");
+	core_benchmark::addUsage( arguments.getApplicationUsage() );
 
 
     // if user request help write it out to cout.
@@ -363,15 +576,35 @@ bool visual_core::checkCommandlineArgumentsForFinalErrors()
 	return true;
 }
 
+void visual_core::setupSceneryFromArchive()
+{
+	OSG_ALWAYS << "setupSceneryFromArchive()" << std::endl;
+
+	const core_sceneryArchive::scenery& scenery = sceneryArchive->getScenery();
+	for(unsigned int i=0; i<scenery.objects.size(); i++)
+		visual_object::createNodeFromConfig(rootNode, scenery.objects[i], sceneryArchive->getGeometry( sceneryArchive->getSource(i) ));
+
+	if( scenery.trackModel )
+		manipulators->trackNode( scenery.trackingID );
+	if( !scenery.trackingIdUpdaterSlot.empty() )
+		manipulators->setTrackingIdUpdaterSlot( scenery.trackingIdUpdaterSlot );
+
+	applySceneryEnvironment( scenery.env );
+
+	// The objects reference their geometries, the mapped archive is not required anymore.
+	sceneryArchive = NULL;
+}
+
 void visual_core::setupScenery()
 {
-	// Parse Scenery from Configuration file
-	xmlDoc* tmpDoc;
-	xmlNode* sceneryNode = util::getSceneryXMLConfig(configFilename, tmpDoc);
-	parseScenery(sceneryNode);
-	if(sceneryNode)
+	// Parse Scenery from the compiled archive or from the configuration file
+	if( sceneryArchive.valid() )
+		setupSceneryFromArchive();
+	else
 	{
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
+		const util_config::node* sceneryNode = util::getSceneryConfig(configFilename);
+		if(sceneryNode)
+			parseScenery(sceneryNode);
 	}
 
 	osgTerrain::Terrain* terrain = util::findTopMostNodeOfType<osgTerrain::Terrain>(rootNode);
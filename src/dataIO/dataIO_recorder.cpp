@@ -0,0 +1,219 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <dataIO_recorder.h>
+#include <util_log.h>
+
+#include <string.h>
+
+using namespace osgVisual;
+
+// Appends raw bytes to a record buffer.
+static void appendBytes( std::vector<unsigned char>& buffer_, const void* data_, size_t size_ )
+{
+	const unsigned char* data = static_cast<const unsigned char*>( data_ );
+	buffer_.insert( buffer_.end(), data, data+size_ );
+}
+
+dataIO_recorder::dataIO_recorder()
+{
+	numSlots = 0;
+	startTick = 0;
+}
+
+dataIO_recorder::~dataIO_recorder()
+{
+	close();
+}
+
+bool dataIO_recorder::open( const std::string& filename_ )
+{
+	close();
+
+	file = new util_appendFile();
+	if( !file->open( filename_ ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "dataIO_recorder::open() :: Unable to record into " << filename_ << std::endl;
+		file = NULL;
+		return false;
+	}
+
+	fileHeader header;
+	memcpy( header.magic, "OVRC", 4 );
+	header.version = FILE_VERSION;
+	if( !file->append( &header, sizeof(fileHeader) ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "dataIO_recorder::open() :: Unable to write the header into " << filename_ << std::endl;
+		file->close();
+		file = NULL;
+		return false;
+	}
+
+	numSlots = 0;
+	slotRecords.clear();
+	index.clear();
+	startTick = osg::Timer::instance()->tick();
+
+	OSG_NOTIFY( osg::ALWAYS ) << "dataIO_recorder: Recording the dataIO frames into " << filename_ << std::endl;
+	return true;
+}
+
+void dataIO_recorder::recordFrame( const dataIO_slotSnapshot* snapshot_, const osg::Matrixd& viewMatrix_, const dataIO_transportContainer* container_ )
+{
+	if( !isRecording() || !snapshot_ )
+		return;
+
+	buffer.clear();
+
+	// Slots are only appended to dataIO's slot list, so the new slots are at the end.
+	for(unsigned int i=numSlots; i<snapshot_->getSlotNum(); i++)
+		addSlotRecord( i, snapshot_->getSlot(i) );
+	if( snapshot_->getSlotNum() > numSlots )
+		numSlots = snapshot_->getSlotNum();
+
+	size_t frameStart = buffer.size();
+	recordHeader header;
+	header.type = FRAME_RECORD;
+	header.size = 0;
+	appendBytes( buffer, &header, sizeof(recordHeader) );
+
+	frameRecord frame;
+	frame.frameID = snapshot_->getFrameNumber();
+	frame.numValues = snapshot_->getSlotNum();
+	frame.time = osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() );
+	memcpy( frame.viewMatrix, viewMatrix_.ptr(), sizeof(frame.viewMatrix) );
+	appendBytes( buffer, &frame, sizeof(frameRecord) );
+
+	// Slot values
+	for(unsigned int i=0; i<snapshot_->getSlotNum(); i++)
+	{
+		const dataIO_slotSnapshot::slotValue& slot = snapshot_->getSlot(i);
+		if( slot.variableType == dataIO_slot::DOUBLE )
+			appendBytes( buffer, &slot.value, sizeof(double) );
+		else
+		{
+			unsigned int length = slot.sValue.size();
+			appendBytes( buffer, &length, sizeof(unsigned int) );
+			appendBytes( buffer, slot.sValue.data(), length );
+		}
+	}
+
+	// Executers
+	unsigned int numExecuters = container_ ? container_->getExecuter().size() : 0;
+	appendBytes( buffer, &numExecuters, sizeof(unsigned int) );
+	for(unsigned int i=0; i<numExecuters; i++)
+	{
+		const dataIO_executer* executer = container_->getExecuter()[i].get();
+		executerRecord record;
+		record.id = executer->getexecuterID();
+		record.numDoubles = executer->getDoubleParameter().size();
+		record.stringLength = executer->getStringParameter().size();
+		record.reserved = 0;
+		appendBytes( buffer, &record, sizeof(executerRecord) );
+		if( record.numDoubles > 0 )
+			appendBytes( buffer, &executer->getDoubleParameter()[0], record.numDoubles*sizeof(double) );
+		appendBytes( buffer, executer->getStringParameter().data(), record.stringLength );
+	}
+	finishRecord( frameStart );
+
+	indexEntry entry;
+	entry.offset = file->getSize() + frameStart;
+	entry.time = frame.time;
+	entry.frameID = frame.frameID;
+	entry.reserved = 0;
+
+	if( !file->append( &buffer[0], buffer.size() ) )
+	{
+		OSGVISUAL_LOG( osg::WARN ) << "dataIO_recorder: Unable to append to " << file->getFilename() << ", recording stopped." << std::endl;
+		file->close();
+		file = NULL;
+		return;
+	}
+	index.push_back( entry );
+}
+
+void dataIO_recorder::close()
+{
+	if( !isRecording() )
+		return;
+
+	// Index record
+	buffer.clear();
+	recordHeader header;
+	header.type = INDEX_RECORD;
+	header.size = 0;
+	appendBytes( buffer, &header, sizeof(recordHeader) );
+
+	indexHeader indexInfo;
+	indexInfo.numSlots = numSlots;
+	indexInfo.numFrames = index.size();
+	appendBytes( buffer, &indexInfo, sizeof(indexHeader) );
+	if( !slotRecords.empty() )
+		appendBytes( buffer, &slotRecords[0], slotRecords.size() );
+	if( !index.empty() )
+		appendBytes( buffer, &index[0], index.size()*sizeof(indexEntry) );
+	finishRecord( 0 );
+
+	// Trailer
+	fileTrailer trailer;
+	trailer.indexOffset = file->getSize();
+	memcpy( trailer.magic, "OVRI", 4 );
+	trailer.reserved = 0;
+	appendBytes( buffer, &trailer, sizeof(fileTrailer) );
+
+	if( !file->append( &buffer[0], buffer.size() ) )
+		OSG_NOTIFY( osg::WARN ) << "dataIO_recorder::close() :: Unable to write the index, the replay has to scan the records." << std::endl;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "dataIO_recorder: Recorded " << index.size() << " frames (" << file->getSize() << " bytes) into " << file->getFilename() << std::endl;
+	file->close();
+	file = NULL;
+
+	// Release the memory of a long recording.
+	std::vector<indexEntry>().swap( index );
+	std::vector<unsigned char>().swap( slotRecords );
+}
+
+void dataIO_recorder::addSlotRecord( unsigned int index_, const dataIO_slotSnapshot::slotValue& slot_ )
+{
+	size_t start = buffer.size();
+	recordHeader header;
+	header.type = SLOT_RECORD;
+	header.size = 0;
+	appendBytes( buffer, &header, sizeof(recordHeader) );
+
+	slotRecord record;
+	record.index = index_;
+	record.direction = slot_.direction;
+	record.variableType = slot_.variableType;
+	record.nameLength = slot_.variableName.size();
+	appendBytes( buffer, &record, sizeof(slotRecord) );
+	appendBytes( buffer, slot_.variableName.data(), record.nameLength );
+	finishRecord( start );
+
+	slotRecords.insert( slotRecords.end(), buffer.begin()+start, buffer.end() );
+}
+
+void dataIO_recorder::finishRecord( size_t start_ )
+{
+	// Pad the record, so all records start at multiples of 8 bytes.
+	while( (buffer.size()-start_) % 8 != 0 )
+		buffer.push_back( 0 );
+
+	recordHeader header;
+	memcpy( &header, &buffer[start_], sizeof(recordHeader) );
+	header.size = buffer.size() - start_;
+	memcpy( &buffer[start_], &header, sizeof(recordHeader) );
+}
@@ -0,0 +1,55 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <dataIO_slotSnapshot.h>
+
+using namespace osgVisual;
+
+dataIO_slotSnapshot::dataIO_slotSnapshot(const std::vector<dataIO_slot*>& dataSlots_, unsigned int frameNumber_)
+{
+	frameNumber = frameNumber_;
+
+	slots.resize( dataSlots_.size() );
+	for(unsigned int i=0; i<dataSlots_.size(); i++)
+	{
+		slots[i].variableName = dataSlots_[i]->variableName;
+		slots[i].direction = dataSlots_[i]->direction;
+		slots[i].variableType = dataSlots_[i]->variableType;
+		slots[i].value = dataSlots_[i]->value;
+		slots[i].sValue = dataSlots_[i]->sValue;
+	}
+}
+
+double dataIO_slotSnapshot::getSlotDataAsDouble(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ ) const
+{
+	OSGVISUAL_ALLOC_ZERO_SCOPE("dataIO_slotSnapshot getSlotDataAsDouble");
+	for(unsigned int i=0; i<slots.size(); i++)
+	{
+		if( slots[i].variableName == variableName_ && slots[i].direction == direction_ && slots[i].variableType == osgVisual::dataIO_slot::DOUBLE )
+			return slots[i].value;
+	}
+	return 0;
+}
+
+std::string dataIO_slotSnapshot::getSlotDataAsString(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ ) const
+{
+	for(unsigned int i=0; i<slots.size(); i++)
+	{
+		if( slots[i].variableName == variableName_ && slots[i].direction == direction_ && slots[i].variableType == osgVisual::dataIO_slot::STRING )
+			return slots[i].sValue;
+	}
+	return "";
+}
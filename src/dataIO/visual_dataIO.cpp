@@ -18,11 +18,17 @@
 
 using namespace osgVisual;
 
+/**
+ * Number of published slot snapshots which are kept. The draw thread lags at most one frame behind the main thread.
+ */
+static const unsigned int maxSnapshots = 3;
+
 visual_dataIO::visual_dataIO()
 {
 	OSG_NOTIFY( osg::ALWAYS ) << "visual_dataIO constructed" << std::endl;
 
 	initialized = false;
+	clusterConnectDeferred = false;
 	clusterMode = osgVisual::dataIO_cluster::STANDALONE;
 	// Create Transport-Container:
 	slotContainer = new osgVisual::dataIO_transportContainer();
@@ -46,12 +52,13 @@ visual_dataIO* visual_dataIO::getInstance()
 	return &instance; 
 };
 
-void visual_dataIO::init(osgViewer::Viewer* viewer_, std::string configFileName)
+void visual_dataIO::init(osgViewer::Viewer* viewer_, std::string configFileName, bool deferClusterConnect_)
 {
 	OSG_NOTIFY( osg::ALWAYS ) << "visual_dataIO initialize..";
 
 	// Init variables
 	viewer = viewer_;
+	clusterConnectDeferred = deferClusterConnect_;
 
 	// Process XML configuration - all XML dependen initializations are performed in processXMLConfiguration()
 	this->configFileName = configFileName;
@@ -62,6 +69,9 @@ void visual_dataIO::init(osgViewer::Viewer* viewer_, std::string configFileName)
 	//// EventCallback at the absolute beginning of the frame
 	eventCallback = new dataIO_eventCallback(this);
 	viewer->getCamera()->addEventCallback( eventCallback );
+	//// UpdateCallback at the end of the update traversal to publish the slot snapshot for cull and draw
+	updateCallback = new dataIO_updateCallback(this);
+	viewer->getCamera()->addUpdateCallback( updateCallback );
 	//// FinalDrawCallback at the end of event and update handling, but BEFORE rendering the frame
 	finalDrawCallback = new dataIO_finalDrawCallback(this);
 	viewer->getCamera()->setFinalDrawCallback( finalDrawCallback );
@@ -72,10 +82,8 @@ void visual_dataIO::init(osgViewer::Viewer* viewer_, std::string configFileName)
 bool visual_dataIO::processXMLConfiguration()
 {
 	// Init XML
-	xmlDoc* tmpDoc;
 	bool disabled;
-	xmlNode* config = util::getModuleXMLConfig( configFileName, "dataio", tmpDoc, disabled );
-	xmlNode* clusterConfig = NULL, *extLinkConfig = NULL;
+	const util_config::node* config = util::getModuleConfig( configFileName, "dataio", disabled );
 
 	if( disabled)
 		OSG_NOTIFY( osg::ALWAYS ) << "..disabled by XML configuration file. dataIO can't be disabled. Ignoring." << std::endl;
@@ -85,63 +93,39 @@ bool visual_dataIO::processXMLConfiguration()
 	// extract configuration values
 	if(config)
 	{
-		xmlNode* a_node = config->children;
-
-		for (xmlNode *cur_node = a_node; cur_node; cur_node = cur_node->next)
+		// Extract cluster role
+		const util_config::node* dataIOConfig = config->getChild("dataio");
+		std::string clusterRole = dataIOConfig ? dataIOConfig->getString("clusterrole") : "";
+		if(clusterRole == "master")
 		{
-			std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-			//OSG_ALWAYS << "----visual_distortion::processXMLConfiguration() - node type="<< cur_node->type <<", name=" << cur_node->name << std::endl;
-
-			// Check for dataio node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "dataio")
-			{
-				// Extract cluster role
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "clusterrole" )
-					{
-						if(attr_value == "master")
-						{
-							OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as MASTER" << std::endl;
-							clusterMode = osgVisual::dataIO_cluster::MASTER;
-						}
-						else if(attr_value == "slave")
-						{
-							OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as SLAVE" << std::endl;
-							clusterMode = osgVisual::dataIO_cluster::SLAVE;
-							slotContainer = NULL;	// Slave only recieves container, therefor set this Pointer NULL (created instance will be deleted because it is an auto pointer).
-						}
-						else if(attr_value == "standalone")
-						{
-							OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as STANDALONE" << std::endl;
-							clusterMode = osgVisual::dataIO_cluster::STANDALONE;
-						}
-					}
-					attr = attr->next; 
-				}	// WHILE attrib END
-			}
-
-			// Check for cluster node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "cluster")
-			{
-				// Pass cluster configuration to the used cluster implementation. 
-				// The implementation will use the configuration if it matches, otherwise falls back to dummy cluster
-				clusterConfig = cur_node;
-			}
-
-			// Check for extLink node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "extlink")
-			{
-				// Pass extLink configuration to the used extLink implementation. 
-				// The implementation will use the configuration if it matches, otherwise falls back to dummy extLink
-				extLinkConfig = cur_node;
-			}
+			OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as MASTER" << std::endl;
+			clusterMode = osgVisual::dataIO_cluster::MASTER;
+		}
+		else if(clusterRole == "slave")
+		{
+			OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as SLAVE" << std::endl;
+			clusterMode = osgVisual::dataIO_cluster::SLAVE;
+			slotContainer = NULL;	// Slave only recieves container, therefor set this Pointer NULL (created instance will be deleted because it is an auto pointer).
+		}
+		else if(clusterRole == "standalone")
+		{
+			OSG_NOTIFY( osg::ALWAYS ) << "Configure osgVisual as STANDALONE" << std::endl;
+			clusterMode = osgVisual::dataIO_cluster::STANDALONE;
+		}
 
-		}	// FOR all nodes END
+		// Pass cluster and extLink configuration to the used implementations.
+		// The implementation will use the configuration if it matches, otherwise falls back to the dummy implementation
+		const util_config::node* clusterConfig = config->getChild("cluster");
+		const util_config::node* extLinkConfig = config->getChild("extlink");
 
+		// Open the recorder
+		const util_config::node* recorderConfig = config->getChild("recorder");
+		if( recorderConfig && recorderConfig->hasAttribute("filename") )
+		{
+			recorder = new dataIO_recorder();
+			if( !recorder->open( recorderConfig->getString("filename") ) )
+				recorder = NULL;
+		}
 
 		// Create Cluster.
 		#ifdef USE_CLUSTER_ASIO_TCP_IOSTREAM
@@ -155,20 +139,26 @@ bool visual_dataIO::processXMLConfiguration()
 			cluster = new dataIO_clusterDummy();
 			cluster->init(clusterConfig, viewer, clusterMode, slotContainer, false);
 		}
-
-		// Create extLink.
-		#ifdef USE_EXTLINK_VCL
-			extLink = new dataIO_extLinkVCL( dataSlots );
-		#endif
-		if( !extLink.valid() || !extLinkConfig || !extLink->init(extLinkConfig) )
+		if( !clusterConnectDeferred )
+			connectCluster();
+
+		// Create extLink. The replay of a recording needs no external library, it is selected by its configuration.
+		osg::ref_ptr<dataIO_extLink> replay = new dataIO_extLinkReplay( dataSlots );
+		if( extLinkConfig && replay->init(extLinkConfig) )
+			extLink = replay;
+		else
 		{
-			extLink = new dataIO_extLinkDummy( dataSlots );
-			extLink->init(extLinkConfig);
+			#ifdef USE_EXTLINK_VCL
+				extLink = new dataIO_extLinkVCL( dataSlots );
+			#endif
+			if( !extLink.valid() || !extLinkConfig || !extLink->init(extLinkConfig) )
+			{
+				extLink = new dataIO_extLinkDummy( dataSlots );
+				extLink->init(extLinkConfig);
+			}
 		}
 
 
-		// clean up
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
 		return true;
 	}	// IF Config valid END
 	else
@@ -179,6 +169,17 @@ bool visual_dataIO::processXMLConfiguration()
 	return true;
 }
 
+bool visual_dataIO::connectCluster()
+{
+	if( !cluster.valid() || cluster->connect() )
+		return true;
+
+	// Same fallback as for a cluster which fails to initialize. The configuration is already released, the dummy does not use it.
+	cluster = new dataIO_clusterDummy();
+	cluster->init(NULL, viewer, clusterMode, slotContainer, false);
+	return false;
+}
+
 void visual_dataIO::shutdown()
 {
 	if(initialized)
@@ -187,39 +188,64 @@ void visual_dataIO::shutdown()
 
 		viewer->getCamera()->removeEventCallback( eventCallback );
 		eventCallback = NULL;
+		viewer->getCamera()->removeUpdateCallback( updateCallback );
+		updateCallback = NULL;
 		viewer->getCamera()->setFinalDrawCallback( NULL );
 		finalDrawCallback = NULL;
 		
 		viewer = NULL;
+
+		{
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(snapshotMutex);
+			snapshots.clear();
+		}
 		
 
 		if(cluster.valid())
 			cluster->shutdown();
 		if(extLink.valid())
 		extLink->shutdown();
+
+		if(recorder.valid())
+			recorder->close();
+		recorder = NULL;
 	}
 }
 
 void visual_dataIO::dataIO_eventCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
 {
 	// perform all actions for the eventDrawCallback.
-	OSG_NOTIFY( osg::INFO ) << "---- Executing EventCallback.." <<  std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "---- Executing EventCallback.." <<  std::endl;
+	OSGVISUAL_PROFILE_SCOPE("dataIO event");
+	OSGVISUAL_ALLOC_SCOPE(DATAIO);
 
 	switch( dataIO->clusterMode )
 	{
 		case osgVisual::dataIO_cluster::MASTER : 
 			{
-				dataIO->extLink->readTO_OBJvalues();
+				{
+					OSGVISUAL_PROFILE_SCOPE("extLink readTO_OBJvalues");
+					OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->extLinkMutex);
+					dataIO->extLink->readTO_OBJvalues();
+				}
+				OSGVISUAL_PROFILE_SCOPE("cluster sendTO_OBJvaluesToSlaves");
+				OSGVISUAL_ALLOC_SCOPE(CLUSTER);
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->clusterMutex);
 				dataIO->cluster->sendTO_OBJvaluesToSlaves(dataIO->calcViewMatrix());
 			}
 			break;
 		case osgVisual::dataIO_cluster::SLAVE : 
 			{
+				OSGVISUAL_PROFILE_SCOPE("cluster readTO_OBJvaluesFromMaster");
+				OSGVISUAL_ALLOC_SCOPE(CLUSTER);
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->clusterMutex);
 				dataIO->cluster->readTO_OBJvaluesFromMaster();
 			}
 			break;
 		case osgVisual::dataIO_cluster::STANDALONE : 
 			{
+				OSGVISUAL_PROFILE_SCOPE("extLink readTO_OBJvalues");
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->extLinkMutex);
 				dataIO->extLink->readTO_OBJvalues();
 			}
 			break;
@@ -230,29 +256,61 @@ void visual_dataIO::dataIO_eventCallback::operator()(osg::Node* node, osg::NodeV
 	traverse(node, nv);
 }
 
-void visual_dataIO::dataIO_finalDrawCallback::operator() (const osg::Camera& camera) const
+void visual_dataIO::dataIO_updateCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
+{
+	// Run the nested camera update callbacks first, so their slot changes are part of the snapshot.
+	traverse(node, nv);
+
+	OSGVISUAL_PROFILE_SCOPE("dataIO publishSnapshot");
+	OSGVISUAL_ALLOC_SCOPE(DATAIO);
+	const osg::FrameStamp* frameStamp = nv->getFrameStamp();
+	dataIO->publishSnapshot( frameStamp ? frameStamp->getFrameNumber() : 0 );
+}
+
+void visual_dataIO::dataIO_finalDrawCallback::operator() (osg::RenderInfo& renderInfo) const
 {
 	// perform all actions for the initialDrawCallback.
-	OSG_NOTIFY( osg::INFO ) << "---- Executing InitialDrawCallback.." << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "---- Executing InitialDrawCallback.." << std::endl;
+	OSGVISUAL_PROFILE_SCOPE("dataIO finalDraw");
+	OSGVISUAL_ALLOC_SCOPE(DATAIO);
+
+	// This callback runs in the draw thread: use the snapshot of the drawn frame instead of the live slots.
+	const osg::FrameStamp* frameStamp = renderInfo.getState() ? renderInfo.getState()->getFrameStamp() : NULL;
+	osg::ref_ptr<const dataIO_slotSnapshot> snapshot = frameStamp ? dataIO->getSnapshot( frameStamp->getFrameNumber() ) : dataIO->getLatestSnapshot();
 
 	switch( dataIO->clusterMode )
 	{
 		case osgVisual::dataIO_cluster::MASTER : 
 			{
-				dataIO->extLink->writebackFROM_OBJvalues();
+				if( snapshot.valid() )
+				{
+					OSGVISUAL_PROFILE_SCOPE("extLink writebackFROM_OBJvalues");
+					OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->extLinkMutex);
+					dataIO->extLink->writebackFROM_OBJvalues( snapshot.get() );
+				}
+				// The barrier blocks until all slaves are ready, holding clusterMutex here would stall the main thread of the next frame.
+				OSGVISUAL_PROFILE_SCOPE("cluster swap barrier");
+				OSGVISUAL_ALLOC_SCOPE(CLUSTER);
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->swapBarrierMutex);
 				dataIO->cluster->waitForAllReadyToSwap();
 				dataIO->cluster->sendSwapCommand();
 			}
 			break;
 		case osgVisual::dataIO_cluster::SLAVE : 
 			{
+				OSGVISUAL_PROFILE_SCOPE("cluster swap barrier");
+				OSGVISUAL_ALLOC_SCOPE(CLUSTER);
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->swapBarrierMutex);
 				dataIO->cluster->reportAsReadyToSwap();
 				dataIO->cluster->waitForSwap();
 			}
 			break;
 		case osgVisual::dataIO_cluster::STANDALONE : 
+			if( snapshot.valid() )
 			{
-				dataIO->extLink->writebackFROM_OBJvalues();
+				OSGVISUAL_PROFILE_SCOPE("extLink writebackFROM_OBJvalues");
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(dataIO->extLinkMutex);
+				dataIO->extLink->writebackFROM_OBJvalues( snapshot.get() );
 			}
 			break;
 		default:
@@ -261,8 +319,56 @@ void visual_dataIO::dataIO_finalDrawCallback::operator() (const osg::Camera& cam
 	};
 }
 
+void visual_dataIO::publishSnapshot( unsigned int frameNumber_ )
+{
+	osg::ref_ptr<const dataIO_slotSnapshot> snapshot;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+		snapshot = new dataIO_slotSnapshot( dataSlots, frameNumber_ );
+	}
+
+	// Record the frame: the snapshot contains the TO_OBJ values of the frame and the FROM_OBJ values computed in it.
+	if( recorder.valid() )
+	{
+		OSGVISUAL_PROFILE_SCOPE("dataIO record");
+		recorder->recordFrame( snapshot.get(), calcViewMatrix(), slotContainer.get() );
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(snapshotMutex);
+	snapshots.push_back( snapshot );
+	while( snapshots.size() > maxSnapshots )
+		snapshots.pop_front();
+}
+
+osg::ref_ptr<const dataIO_slotSnapshot> visual_dataIO::getSnapshot( unsigned int frameNumber_ ) const
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(snapshotMutex);
+
+	// Newest first: the drawn frame is usually the latest published one.
+	for( std::deque< osg::ref_ptr<const dataIO_slotSnapshot> >::const_reverse_iterator itr = snapshots.rbegin(); itr != snapshots.rend(); ++itr )
+	{
+		if( (*itr)->getFrameNumber() <= frameNumber_ )
+			return *itr;
+	}
+
+	// All kept snapshots are newer than the requested frame, the oldest one is the closest.
+	if( snapshots.empty() )
+		return NULL;
+	return snapshots.front();
+}
+
+osg::ref_ptr<const dataIO_slotSnapshot> visual_dataIO::getLatestSnapshot() const
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(snapshotMutex);
+	if( snapshots.empty() )
+		return NULL;
+	return snapshots.back();
+}
+
 void* visual_dataIO::getSlotPointer(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_, osgVisual::dataIO_slot::varType variableTyp_ )
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+
 	// iterate through slotlist. If found, return pointer, else add slot to list and return pointer
 	for (unsigned int i=0; i<dataSlots.size(); i++)
 	{
@@ -279,6 +385,7 @@ void* visual_dataIO::getSlotPointer(std::string variableName_, osgVisual::dataIO
 	//OSG_NOTIFY( osg::INFO ) << "visual_dataIO::getSlotPointer() - Slot not found, will add as new slot " << std::endl;
 	dataIO_slot* newSlot = new dataIO_slot();
 	newSlot->variableName = variableName_;
+	newSlot->direction = direction_;
 	newSlot->variableType = variableTyp_;
 	newSlot->value = 0;
 	newSlot->sValue = "";
@@ -286,8 +393,10 @@ void* visual_dataIO::getSlotPointer(std::string variableName_, osgVisual::dataIO
 	return dataSlots.back();
 }
 
-double visual_dataIO::getSlotDataAsDouble(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_ )
+double visual_dataIO::getSlotDataAsDouble(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ )
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+
 	// iterate through slotlist. If found, return value
 	for (unsigned int i=0; i<dataSlots.size(); i++)
 	{
@@ -301,8 +410,10 @@ double visual_dataIO::getSlotDataAsDouble(std::string variableName_, osgVisual::
 	return 0;
 }
 
-std::string visual_dataIO::getSlotDataAsString(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_ )
+std::string visual_dataIO::getSlotDataAsString(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_ )
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+
 	// iterate through slotlist. If found, return value
 	for (unsigned int i=0; i<dataSlots.size(); i++)
 	{
@@ -316,8 +427,10 @@ std::string visual_dataIO::getSlotDataAsString(std::string variableName_, osgVis
 	return "";
 }
 
-osgVisual::dataIO_slot* visual_dataIO::setSlotData(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_, std::string sValue_ )
+osgVisual::dataIO_slot* visual_dataIO::setSlotData(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_, const std::string& sValue_ )
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+
 	bool slotFound = false;
 	// iterate through slotlist. If found, return pointer, else add slot to list
 	for (unsigned int i=0; i<dataSlots.size(); i++)
@@ -349,8 +462,10 @@ osgVisual::dataIO_slot* visual_dataIO::setSlotData(std::string variableName_, os
 	return NULL;
 }
 
-osgVisual::dataIO_slot* visual_dataIO::setSlotData(std::string variableName_, osgVisual::dataIO_slot::dataDirection direction_, double value_ )
+osgVisual::dataIO_slot* visual_dataIO::setSlotData(const std::string& variableName_, osgVisual::dataIO_slot::dataDirection direction_, double value_ )
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+
 	// iterate through slotlist. If found, return pointer, else add slot to list
 	bool slotFound = false;
 	for (unsigned int i=0; i<dataSlots.size(); i++)
@@ -382,7 +497,16 @@ osgVisual::dataIO_slot* visual_dataIO::setSlotData(std::string variableName_, os
 	return NULL;
 }
 
+void visual_dataIO::setSlotValue(osgVisual::dataIO_slot* slot_, double value_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(slotMutex);
+	slot_->value = value_;
+}
+
 osg::Matrixd visual_dataIO::calcViewMatrix()
 {
+	// core_benchmark removes the manipulator and sets the view matrix of the camera directly.
+	if( !viewer->getCameraManipulator() )
+		return viewer->getCamera()->getViewMatrix();
 	return viewer->getCameraManipulator()->getInverseMatrix();
 }
\ No newline at end of file
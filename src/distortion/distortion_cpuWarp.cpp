@@ -0,0 +1,298 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <distortion_cpuWarp.h>
+
+#include <osg/Math>
+
+#include <cmath>
+#include <cstring>
+
+#ifdef DISTORTION_CPUWARP_SSE2
+	#include <emmintrin.h>
+#endif
+
+using namespace osgVisual;
+
+distortion_cpuWarp::distortion_cpuWarp( osg::Image* distortImage_, osg::Image* blendImage_ )
+	: distortImage(distortImage_), blendImage(blendImage_)
+{
+	for(int i=0; i<4; i++)
+		preparedSize[i] = 0;
+}
+
+bool distortion_cpuWarp::isSSE2Enabled()
+{
+#ifdef DISTORTION_CPUWARP_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+osg::Vec2 distortion_cpuWarp::getWarp( int column_, int row_ ) const
+{
+	if( distortImage->getDataType() == GL_FLOAT )
+	{
+		const float* pPixel = reinterpret_cast<const float*>( distortImage->data( column_, row_ ) );
+		return osg::Vec2( pPixel[0], pPixel[1] );
+	}
+
+	return distortion_floatMap::decodeLegacyPixel( distortImage->data( column_, row_ ) );
+}
+
+osg::Vec4 distortion_cpuWarp::getBlend( int column_, int row_ ) const
+{
+	if( !blendImage.valid() )
+		return osg::Vec4( 1.0f, 1.0f, 1.0f, 1.0f );
+
+	return blendImage->getColor( column_, row_ );
+}
+
+bool distortion_cpuWarp::apply( const osg::Image* source_, osg::Image* target_, kernelType kernel_, bool parallel_ )
+{
+	if( !distortImage.valid() || !distortImage->data() || (blendImage.valid() && !blendImage->data()) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_cpuWarp::apply() :: Distortion or blend map not available." << std::endl;
+		return false;
+	}
+
+	if( !source_ || !target_ || !source_->data() || !target_->data()
+		|| source_->getPixelFormat() != GL_RGBA || source_->getDataType() != GL_UNSIGNED_BYTE
+		|| target_->getPixelFormat() != GL_RGBA || target_->getDataType() != GL_UNSIGNED_BYTE )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_cpuWarp::apply() :: Source and target have to be GL_RGBA images with GL_UNSIGNED_BYTE data." << std::endl;
+		return false;
+	}
+
+	if( kernel_ == SIMD )
+		prepare( target_->s(), target_->t(), source_->s(), source_->t() );
+
+	int numRows = target_->t();
+	if( !parallel_ )
+	{
+		rowOperation operation( this, source_, target_, kernel_, 0, numRows );
+		operation( NULL );
+		return true;
+	}
+
+	// One chunk per worker thread plus one for the calling thread, but not less than 16 rows per chunk.
+	util_workerPool::getInstance()->start();
+	int numChunks = osg::clampBetween( numRows / 16, 1, (int)util_workerPool::getInstance()->getNumThreads() + 1 );
+	std::vector< osg::ref_ptr<osg::Operation> > operations;
+	for(int i=0; i<numChunks; i++)
+		operations.push_back( new rowOperation( this, source_, target_, kernel_, numRows*i/numChunks, numRows*(i+1)/numChunks ) );
+	util_workerPool::getInstance()->runAndWait( operations );
+
+	return true;
+}
+
+void distortion_cpuWarp::rowOperation::operator () (osg::Object*)
+{
+	if( kernel == REFERENCE )
+		warp->processRowsReference( source, target, beginRow, endRow );
+	else
+		warp->processRowsSIMD( source, target, beginRow, endRow );
+}
+
+void distortion_cpuWarp::prepare( int targetWidth_, int targetHeight_, int sourceWidth_, int sourceHeight_ )
+{
+	if( preparedSize[0] == targetWidth_ && preparedSize[1] == targetHeight_ && preparedSize[2] == sourceWidth_ && preparedSize[3] == sourceHeight_ )
+		return;
+
+	// Source position of each target pixel
+	sourcePositions.resize( targetWidth_ * targetHeight_ * 2 );
+	for(int y=0; y<targetHeight_; y++)
+	{
+		int distortRow = osg::minimum( (int)((y+0.5) / targetHeight_ * distortImage->t()), distortImage->t()-1 );
+		for(int x=0; x<targetWidth_; x++)
+		{
+			int distortColumn = osg::minimum( (int)((x+0.5) / targetWidth_ * distortImage->s()), distortImage->s()-1 );
+			osg::Vec2 texcoord = getWarp( distortColumn, distortRow );
+			sourcePositions[(y*targetWidth_ + x)*2] = texcoord.x() * sourceWidth_ - 0.5f;
+			sourcePositions[(y*targetWidth_ + x)*2 + 1] = texcoord.y() * sourceHeight_ - 0.5f;
+		}
+	}
+
+	// Blend map as four floats per pixel
+	int blendWidth = blendImage.valid() ? blendImage->s() : 1;
+	int blendHeight = blendImage.valid() ? blendImage->t() : 1;
+	blendColors.resize( blendWidth * blendHeight * 4 );
+	for(int y=0; y<blendHeight; y++)
+	{
+		for(int x=0; x<blendWidth; x++)
+		{
+			osg::Vec4 blend = getBlend( x, y );
+			for(int i=0; i<4; i++)
+				blendColors[(y*blendWidth + x)*4 + i] = blend[i];
+		}
+	}
+
+	blendColumns.resize( targetWidth_ );
+	for(int x=0; x<targetWidth_; x++)
+		blendColumns[x] = osg::minimum( (int)((x+0.5) / targetWidth_ * blendWidth), blendWidth-1 );
+	blendRows.resize( targetHeight_ );
+	for(int y=0; y<targetHeight_; y++)
+		blendRows[y] = osg::minimum( (int)((y+0.5) / targetHeight_ * blendHeight), blendHeight-1 ) * blendWidth;
+
+	preparedSize[0] = targetWidth_;
+	preparedSize[1] = targetHeight_;
+	preparedSize[2] = sourceWidth_;
+	preparedSize[3] = sourceHeight_;
+}
+
+void distortion_cpuWarp::processRowsReference( const osg::Image* source_, osg::Image* target_, int beginRow_, int endRow_ )
+{
+	int targetWidth = target_->s();
+	int targetHeight = target_->t();
+	int sourceWidth = source_->s();
+	int sourceHeight = source_->t();
+
+	for(int y=beginRow_; y<endRow_; y++)
+	{
+		double v = (y+0.5) / targetHeight;
+		unsigned char* targetPixel = target_->data( 0, y );
+		for(int x=0; x<targetWidth; x++, targetPixel+=4)
+		{
+			double u = (x+0.5) / targetWidth;
+
+			// Distortion map lookup (nearest)
+			osg::Vec2 texcoord = getWarp( osg::minimum( (int)(u * distortImage->s()), distortImage->s()-1 ), osg::minimum( (int)(v * distortImage->t()), distortImage->t()-1 ) );
+
+			// Source lookup (bilinear, clamped to edge)
+			double sx = texcoord.x() * sourceWidth - 0.5;
+			double sy = texcoord.y() * sourceHeight - 0.5;
+			double fx = sx - floor(sx);
+			double fy = sy - floor(sy);
+			int x0 = osg::clampBetween( (int)floor(sx), 0, sourceWidth-1 );
+			int x1 = osg::clampBetween( (int)floor(sx)+1, 0, sourceWidth-1 );
+			int y0 = osg::clampBetween( (int)floor(sy), 0, sourceHeight-1 );
+			int y1 = osg::clampBetween( (int)floor(sy)+1, 0, sourceHeight-1 );
+
+			// Blend map lookup (nearest)
+			osg::Vec4 blend( 1.0f, 1.0f, 1.0f, 1.0f );
+			if( blendImage.valid() )
+				blend = getBlend( osg::minimum( (int)(u * blendImage->s()), blendImage->s()-1 ), osg::minimum( (int)(v * blendImage->t()), blendImage->t()-1 ) );
+
+			for(int i=0; i<4; i++)
+			{
+				double color = (source_->data(x0, y0)[i] * (1.0-fx) + source_->data(x1, y0)[i] * fx) * (1.0-fy)
+							 + (source_->data(x0, y1)[i] * (1.0-fx) + source_->data(x1, y1)[i] * fx) * fy;
+				targetPixel[i] = (unsigned char)osg::clampBetween( floor( color * blend[i] + 0.5 ), 0.0, 255.0 );
+			}
+		}
+	}
+}
+
+void distortion_cpuWarp::processRowsSIMD( const osg::Image* source_, osg::Image* target_, int beginRow_, int endRow_ )
+{
+	int targetWidth = target_->s();
+	int sourceWidth = source_->s();
+	int sourceHeight = source_->t();
+
+#ifdef DISTORTION_CPUWARP_SSE2
+	const __m128i zero = _mm_setzero_si128();
+#endif
+
+	for(int y=beginRow_; y<endRow_; y++)
+	{
+		const float* position = &sourcePositions[y*targetWidth*2];
+		const float* blendRow = &blendColors[blendRows[y]*4];
+		unsigned char* targetPixel = target_->data( 0, y );
+
+		for(int x=0; x<targetWidth; x++, position+=2, targetPixel+=4)
+		{
+			float sx = position[0];
+			float sy = position[1];
+			float floorX = floorf(sx);
+			float floorY = floorf(sy);
+			float fx = sx - floorX;
+			float fy = sy - floorY;
+			int x0 = osg::clampBetween( (int)floorX, 0, sourceWidth-1 );
+			int x1 = osg::clampBetween( (int)floorX+1, 0, sourceWidth-1 );
+			int y0 = osg::clampBetween( (int)floorY, 0, sourceHeight-1 );
+			int y1 = osg::clampBetween( (int)floorY+1, 0, sourceHeight-1 );
+
+			const unsigned char* row0 = source_->data( 0, y0 );
+			const unsigned char* row1 = source_->data( 0, y1 );
+			const float* blend = blendRow + blendColumns[x]*4;
+
+#ifdef DISTORTION_CPUWARP_SSE2
+			// One pixel per iteration, the four color channels in one register.
+			int p00, p10, p01, p11;
+			memcpy( &p00, row0 + x0*4, 4 );
+			memcpy( &p10, row0 + x1*4, 4 );
+			memcpy( &p01, row1 + x0*4, 4 );
+			memcpy( &p11, row1 + x1*4, 4 );
+
+			__m128 c00 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(p00), zero ), zero ) );
+			__m128 c10 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(p10), zero ), zero ) );
+			__m128 c01 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(p01), zero ), zero ) );
+			__m128 c11 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(p11), zero ), zero ) );
+
+			__m128 color = _mm_add_ps( _mm_add_ps( _mm_mul_ps( c00, _mm_set1_ps( (1.0f-fx)*(1.0f-fy) ) ), _mm_mul_ps( c10, _mm_set1_ps( fx*(1.0f-fy) ) ) ),
+									   _mm_add_ps( _mm_mul_ps( c01, _mm_set1_ps( (1.0f-fx)*fy ) ), _mm_mul_ps( c11, _mm_set1_ps( fx*fy ) ) ) );
+			color = _mm_mul_ps( color, _mm_loadu_ps( blend ) );
+
+			// Round, saturate to 0..255 and store
+			__m128i result = _mm_cvtps_epi32( color );
+			result = _mm_packs_epi32( result, result );
+			result = _mm_packus_epi16( result, result );
+			int packed = _mm_cvtsi128_si32( result );
+			memcpy( targetPixel, &packed, 4 );
+#else
+			float w00 = (1.0f-fx)*(1.0f-fy);
+			float w10 = fx*(1.0f-fy);
+			float w01 = (1.0f-fx)*fy;
+			float w11 = fx*fy;
+			for(int i=0; i<4; i++)
+			{
+				float color = row0[x0*4+i]*w00 + row0[x1*4+i]*w10 + row1[x0*4+i]*w01 + row1[x1*4+i]*w11;
+				targetPixel[i] = (unsigned char)osg::clampBetween( color * blend[i] + 0.5f, 0.0f, 255.0f );
+			}
+#endif
+		}
+	}
+}
+
+bool distortion_cpuWarp::compare( const osg::Image* a_, const osg::Image* b_, unsigned int& maxDifference_, unsigned int& numDifferentPixels_ )
+{
+	maxDifference_ = 0;
+	numDifferentPixels_ = 0;
+	if( !a_ || !b_ || a_->s() != b_->s() || a_->t() != b_->t() || a_->getPixelFormat() != GL_RGBA || b_->getPixelFormat() != GL_RGBA
+		|| a_->getDataType() != GL_UNSIGNED_BYTE || b_->getDataType() != GL_UNSIGNED_BYTE )
+		return false;
+
+	for(int y=0; y<a_->t(); y++)
+	{
+		const unsigned char* pixelA = a_->data( 0, y );
+		const unsigned char* pixelB = b_->data( 0, y );
+		for(int x=0; x<a_->s(); x++, pixelA+=4, pixelB+=4)
+		{
+			bool different = false;
+			for(int i=0; i<4; i++)
+			{
+				unsigned int difference = pixelA[i] > pixelB[i] ? pixelA[i] - pixelB[i] : pixelB[i] - pixelA[i];
+				if( difference > 0 )
+					different = true;
+				maxDifference_ = osg::maximum( maxDifference_, difference );
+			}
+			if( different )
+				numDifferentPixels_++;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,180 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <distortion_floatMap.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <fstream>
+#include <cstring>
+
+using namespace osgVisual;
+
+static const unsigned int FLOATMAP_VERSION = 1;
+
+/**
+ * \brief This function returns the pixel format and the float internal texture format for a number of channels.
+ *
+ */
+static bool getFormats( unsigned int numChannels_, GLenum& pixelFormat_, GLint& internalFormat_ )
+{
+	switch( numChannels_ )
+	{
+		case 1: pixelFormat_ = GL_LUMINANCE;		internalFormat_ = GL_LUMINANCE32F_ARB;			return true;
+		case 2: pixelFormat_ = GL_LUMINANCE_ALPHA;	internalFormat_ = GL_LUMINANCE_ALPHA32F_ARB;	return true;
+		case 3: pixelFormat_ = GL_RGB;				internalFormat_ = GL_RGB32F_ARB;				return true;
+		case 4: pixelFormat_ = GL_RGBA;				internalFormat_ = GL_RGBA32F_ARB;				return true;
+		default: return false;
+	};
+}
+
+bool distortion_floatMap::isFloatMap( const std::string& filename_ )
+{
+	return osgDB::getLowerCaseFileExtension( filename_ ) == "fmap";
+}
+
+osg::Image* distortion_floatMap::read( const std::string& filename_ )
+{
+	osg::ref_ptr<util_mappedFile> file = new util_mappedFile();
+	if( !file->open( filename_ ) )
+		return NULL;
+
+	fileHeader header;
+	if( file->getSize() < sizeof(fileHeader) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::read() :: File too small: " << filename_ << std::endl;
+		return NULL;
+	}
+	memcpy( &header, file->getData(), sizeof(fileHeader) );
+
+	GLenum pixelFormat;
+	GLint internalFormat;
+	if( strncmp( header.magic, "OVFM", 4 ) != 0 || header.version != FLOATMAP_VERSION || header.width == 0 || header.height == 0
+		|| !getFormats( header.numChannels, pixelFormat, internalFormat ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::read() :: Invalid header or unsupported version: " << filename_ << std::endl;
+		return NULL;
+	}
+
+	size_t dataSize = static_cast<size_t>(header.width) * header.height * header.numChannels * sizeof(float);
+	if( file->getSize() < sizeof(fileHeader) + dataSize )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::read() :: File truncated: " << filename_ << std::endl;
+		return NULL;
+	}
+
+	// The image points into the mapping, the data is neither copied nor converted.
+	unsigned char* data = const_cast<unsigned char*>( file->getData() ) + sizeof(fileHeader);
+	osg::Image* image = new mappedImage( file.get() );
+	image->setFileName( filename_ );
+	image->setImage( header.width, header.height, 1, internalFormat, pixelFormat, GL_FLOAT, data, osg::Image::NO_DELETE, 4 );
+	return image;
+}
+
+bool distortion_floatMap::write( const std::string& filename_, const osg::Image* image_ )
+{
+	unsigned int numChannels;
+	switch( image_ ? image_->getPixelFormat() : 0 )
+	{
+		case GL_LUMINANCE:			numChannels = 1; break;
+		case GL_LUMINANCE_ALPHA:	numChannels = 2; break;
+		case GL_RGB:				numChannels = 3; break;
+		case GL_RGBA:				numChannels = 4; break;
+		default:					numChannels = 0; break;
+	};
+	if( numChannels == 0 || image_->getDataType() != GL_FLOAT || image_->r() != 1 || !image_->data() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::write() :: Unsupported image format." << std::endl;
+		return false;
+	}
+
+	std::ofstream out( filename_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if( !out )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::write() :: Unable to open " << filename_ << std::endl;
+		return false;
+	}
+
+	fileHeader header;
+	memset( &header, 0, sizeof(fileHeader) );
+	memcpy( header.magic, "OVFM", 4 );
+	header.version = FLOATMAP_VERSION;
+	header.width = image_->s();
+	header.height = image_->t();
+	header.numChannels = numChannels;
+	out.write( reinterpret_cast<const char*>(&header), sizeof(fileHeader) );
+
+	// Write row by row, the image rows may be padded.
+	for(int row=0; row<image_->t(); row++)
+		out.write( reinterpret_cast<const char*>(image_->data(0, row)), image_->s() * numChannels * sizeof(float) );
+
+	return out.good();
+}
+
+osg::Image* distortion_floatMap::convertLegacyWarpMap( const osg::Image* image_ )
+{
+	if( !image_ || image_->getDataType() != GL_UNSIGNED_BYTE || (image_->getPixelFormat() != GL_RGB && image_->getPixelFormat() != GL_RGBA) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::convertLegacyWarpMap() :: Unsupported image format, RGB or RGBA with 8 bit per channel required." << std::endl;
+		return NULL;
+	}
+
+	unsigned int pixelSize = image_->getPixelSizeInBits() / 8;
+	osg::Image* warpMap = new osg::Image();
+	warpMap->allocateImage( image_->s(), image_->t(), 1, GL_LUMINANCE_ALPHA, GL_FLOAT, 4 );
+	warpMap->setInternalTextureFormat( GL_LUMINANCE_ALPHA32F_ARB );
+
+	for(int row=0; row<image_->t(); row++)
+	{
+		const unsigned char* source = image_->data(0, row);
+		float* target = reinterpret_cast<float*>( warpMap->data(0, row) );
+		for(int column=0; column<image_->s(); column++)
+		{
+			osg::Vec2 texcoord = decodeLegacyPixel( source + column*pixelSize );
+			target[column*2] = texcoord.x();
+			target[column*2+1] = texcoord.y();
+		}
+	}
+
+	return warpMap;
+}
+
+osg::Image* distortion_floatMap::convertBlendMap( const osg::Image* image_ )
+{
+	unsigned int numChannels;
+	GLenum pixelFormat;
+	GLint internalFormat;
+	numChannels = image_ ? osg::Image::computeNumComponents( image_->getPixelFormat() ) : 0;
+	if( !image_ || image_->getDataType() != GL_UNSIGNED_BYTE || !getFormats( numChannels, pixelFormat, internalFormat ) || pixelFormat != image_->getPixelFormat() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_floatMap::convertBlendMap() :: Unsupported image format, luminance, RGB or RGBA with 8 bit per channel required." << std::endl;
+		return NULL;
+	}
+
+	osg::Image* blendMap = new osg::Image();
+	blendMap->allocateImage( image_->s(), image_->t(), 1, pixelFormat, GL_FLOAT, 4 );
+	blendMap->setInternalTextureFormat( internalFormat );
+
+	for(int row=0; row<image_->t(); row++)
+	{
+		const unsigned char* source = image_->data(0, row);
+		float* target = reinterpret_cast<float*>( blendMap->data(0, row) );
+		for(unsigned int i=0; i<image_->s()*numChannels; i++)
+			target[i] = source[i] / 255.0f;
+	}
+
+	return blendMap;
+}
@@ -0,0 +1,292 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <distortion_meshCache.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+using namespace osgVisual;
+
+static const unsigned int DISTORTIONCACHE_VERSION = 2;
+
+std::string distortion_meshCache::getCacheFilename( const std::string& distortMapFileName_ )
+{
+	return osgDB::getNameLessExtension( distortMapFileName_ ) + ".distcache";
+}
+
+void distortion_meshCache::getSourceInfo( const std::string& filename_, sourceHeader& source_, bool computeHash_ )
+{
+	memset( &source_, 0, sizeof(sourceHeader) );
+
+	struct stat fileStat;
+	if( filename_.empty() || stat( filename_.c_str(), &fileStat ) != 0 )
+	{
+		source_.size = -1;
+		return;
+	}
+
+	source_.size = fileStat.st_size;
+	source_.modificationTime = fileStat.st_mtime;
+	if( computeHash_ )
+		source_.hash = computeHash( filename_ );
+}
+
+unsigned long long distortion_meshCache::computeHash( const std::string& filename_ )
+{
+	osg::ref_ptr<util_mappedFile> file = new util_mappedFile();
+	if( !file->open( filename_ ) )
+		return 0;
+
+	unsigned long long hash = 14695981039346656037ULL;
+	const unsigned char* data = file->getData();
+	for(size_t i=0; i<file->getSize(); i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool distortion_meshCache::load( const std::string& cacheFilename_, const std::vector<std::string>& sourceFiles_, unsigned int buildOptions_, channelData& data_ )
+{
+	osg::ref_ptr<util_mappedFile> file = new util_mappedFile();
+	if( !file->open( cacheFilename_ ) )
+		return false;
+
+	const unsigned char* data = file->getData();
+	size_t size = file->getSize();
+
+	// Check header
+	fileHeader header;
+	if( size < sizeof(fileHeader) )
+		return false;
+	memcpy( &header, data, sizeof(fileHeader) );
+	if( strncmp( header.magic, "OVDC", 4 ) != 0 || header.version != DISTORTIONCACHE_VERSION )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::load() :: Invalid header or outdated version, rebuilding " << cacheFilename_ << std::endl;
+		return false;
+	}
+	if( header.buildOptions != buildOptions_ || header.numSources != sourceFiles_.size() )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "distortion_meshCache: Build options changed, rebuilding " << cacheFilename_ << std::endl;
+		return false;
+	}
+
+	// Check sources
+	size_t offset = sizeof(fileHeader);
+	if( size < offset + header.numSources*sizeof(sourceHeader) )
+		return false;
+	for(unsigned int i=0; i<header.numSources; i++)
+	{
+		sourceHeader cached, current;
+		memcpy( &cached, data + offset, sizeof(sourceHeader) );
+		offset += sizeof(sourceHeader);
+
+		getSourceInfo( sourceFiles_[i], current, false );
+		if( cached.size == current.size && cached.modificationTime == current.modificationTime )
+			continue;
+
+		// Only touched? Then the content is unchanged.
+		if( cached.size == current.size && current.size >= 0 && computeHash( sourceFiles_[i] ) == cached.hash )
+			continue;
+
+		OSG_NOTIFY( osg::ALWAYS ) << "distortion_meshCache: " << sourceFiles_[i] << " changed, rebuilding " << cacheFilename_ << std::endl;
+		return false;
+	}
+
+	// Mesh
+	size_t meshSize = header.numVertices*6*sizeof(float) + header.numIndices*sizeof(unsigned int);
+	if( size < offset + meshSize )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::load() :: File truncated: " << cacheFilename_ << std::endl;
+		return false;
+	}
+
+	channelData tmpData;
+	tmpData.frustumValid = header.frustumValid != 0;
+	if( tmpData.frustumValid )
+		tmpData.frustum.assign( header.frustum, header.frustum+6 );
+	tmpData.rotation.assign( header.rotation, header.rotation+3 );
+	tmpData.translation.assign( header.translation, header.translation+3 );
+
+	tmpData.vertices = new osg::Vec2Array( header.numVertices );
+	tmpData.texcoords = new osg::Vec2Array( header.numVertices );
+	tmpData.texcoords2 = new osg::Vec2Array( header.numVertices );
+	tmpData.indices = new osg::DrawElementsUInt( GL_TRIANGLES, header.numIndices );
+	if( header.numVertices > 0 )
+	{
+		memcpy( &(*tmpData.vertices)[0], data + offset, header.numVertices*2*sizeof(float) );
+		offset += header.numVertices*2*sizeof(float);
+		memcpy( &(*tmpData.texcoords)[0], data + offset, header.numVertices*2*sizeof(float) );
+		offset += header.numVertices*2*sizeof(float);
+		memcpy( &(*tmpData.texcoords2)[0], data + offset, header.numVertices*2*sizeof(float) );
+		offset += header.numVertices*2*sizeof(float);
+	}
+	if( header.numIndices > 0 )
+	{
+		memcpy( &(*tmpData.indices)[0], data + offset, header.numIndices*sizeof(unsigned int) );
+		offset += header.numIndices*sizeof(unsigned int);
+	}
+
+	// Images: distortion map, blend map
+	for(unsigned int i=0; i<header.numImages; i++)
+	{
+		imageHeader ih;
+		if( size < offset + sizeof(imageHeader) )
+			return false;
+		memcpy( &ih, data + offset, sizeof(imageHeader) );
+		offset += sizeof(imageHeader);
+		if( ih.dataSize == 0 )
+			continue;
+
+		if( size < offset + ih.dataSize )
+		{
+			OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::load() :: File truncated: " << cacheFilename_ << std::endl;
+			return false;
+		}
+
+		osg::ref_ptr<osg::Image> image = new osg::Image();
+		image->allocateImage( ih.s, ih.t, 1, ih.pixelFormat, ih.dataType, ih.packing );
+		if( image->getTotalSizeInBytes() != ih.dataSize )
+			return false;
+		image->setInternalTextureFormat( ih.internalTextureFormat );
+		memcpy( image->data(), data + offset, ih.dataSize );
+		offset += (ih.dataSize + 7) & ~7ULL;
+
+		if( i == 0 )
+			tmpData.distortImage = image;
+		else
+			tmpData.blendImage = image;
+	}
+
+	data_ = tmpData;
+	return true;
+}
+
+bool distortion_meshCache::write( const std::string& cacheFilename_, const std::vector<std::string>& sourceFiles_, unsigned int buildOptions_, const channelData& data_ )
+{
+	if( !data_.vertices.valid() || !data_.texcoords.valid() || !data_.texcoords2.valid() || !data_.indices.valid()
+		|| data_.texcoords->size() != data_.vertices->size() || data_.texcoords2->size() != data_.vertices->size() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::write() :: Incomplete channel data." << std::endl;
+		return false;
+	}
+
+	// Write into a temporary file and rename it, so a concurrently starting channel never maps a half written cache.
+	std::string tmpFilename = cacheFilename_ + ".tmp";
+	std::ofstream out( tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if( !out )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::write() :: Unable to open " << tmpFilename << std::endl;
+		return false;
+	}
+
+	// File header
+	fileHeader header;
+	memset( &header, 0, sizeof(fileHeader) );
+	memcpy( header.magic, "OVDC", 4 );
+	header.version = DISTORTIONCACHE_VERSION;
+	header.buildOptions = buildOptions_;
+	header.numSources = sourceFiles_.size();
+	header.frustumValid = (data_.frustumValid && data_.frustum.size() == 6) ? 1 : 0;
+	header.numVertices = data_.vertices->size();
+	header.numIndices = data_.indices->size();
+	header.numImages = 2;
+	for(unsigned int i=0; i<6 && header.frustumValid; i++)
+		header.frustum[i] = data_.frustum[i];
+	for(unsigned int i=0; i<3 && i<data_.rotation.size(); i++)
+		header.rotation[i] = data_.rotation[i];
+	for(unsigned int i=0; i<3 && i<data_.translation.size(); i++)
+		header.translation[i] = data_.translation[i];
+	out.write( reinterpret_cast<const char*>(&header), sizeof(fileHeader) );
+
+	// Sources
+	for(unsigned int i=0; i<sourceFiles_.size(); i++)
+	{
+		sourceHeader source;
+		getSourceInfo( sourceFiles_[i], source, true );
+		out.write( reinterpret_cast<const char*>(&source), sizeof(sourceHeader) );
+	}
+
+	// Mesh
+	if( header.numVertices > 0 )
+	{
+		out.write( reinterpret_cast<const char*>(&(*data_.vertices)[0]), header.numVertices*2*sizeof(float) );
+		out.write( reinterpret_cast<const char*>(&(*data_.texcoords)[0]), header.numVertices*2*sizeof(float) );
+		out.write( reinterpret_cast<const char*>(&(*data_.texcoords2)[0]), header.numVertices*2*sizeof(float) );
+	}
+	if( header.numIndices > 0 )
+		out.write( reinterpret_cast<const char*>(&(*data_.indices)[0]), header.numIndices*sizeof(unsigned int) );
+
+	// Images
+	const osg::Image* images[2] = { data_.distortImage.get(), data_.blendImage.get() };
+	for(unsigned int i=0; i<2; i++)
+	{
+		imageHeader ih;
+		memset( &ih, 0, sizeof(imageHeader) );
+		if( images[i] && images[i]->data() && images[i]->r() == 1 )
+		{
+			ih.s = images[i]->s();
+			ih.t = images[i]->t();
+			ih.internalTextureFormat = images[i]->getInternalTextureFormat();
+			ih.pixelFormat = images[i]->getPixelFormat();
+			ih.dataType = images[i]->getDataType();
+			ih.packing = images[i]->getPacking();
+			ih.dataSize = images[i]->getTotalSizeInBytes();
+		}
+		out.write( reinterpret_cast<const char*>(&ih), sizeof(imageHeader) );
+		if( ih.dataSize > 0 )
+		{
+			static const char padding[8] = {0,0,0,0,0,0,0,0};
+			out.write( reinterpret_cast<const char*>(images[i]->data()), ih.dataSize );
+			out.write( padding, ((ih.dataSize + 7) & ~7ULL) - ih.dataSize );
+		}
+	}
+
+	out.close();
+	if( !out )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::write() :: Unable to write " << tmpFilename << std::endl;
+		remove( tmpFilename.c_str() );
+		return false;
+	}
+
+	// rename() replaces an existing cache file atomically, so a concurrent reader sees either the old or the new file.
+	// Only Windows refuses to rename onto an existing file, there the old file has to be removed first.
+	bool renamed = rename( tmpFilename.c_str(), cacheFilename_.c_str() ) == 0;
+#ifdef WIN32
+	if( !renamed )
+	{
+		remove( cacheFilename_.c_str() );
+		renamed = rename( tmpFilename.c_str(), cacheFilename_.c_str() ) == 0;
+	}
+#endif
+	if( !renamed )
+	{
+		OSG_NOTIFY( osg::WARN ) << "distortion_meshCache::write() :: Unable to rename " << tmpFilename << std::endl;
+		remove( tmpFilename.c_str() );
+		return false;
+	}
+
+	return true;
+}
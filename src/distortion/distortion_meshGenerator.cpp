@@ -0,0 +1,338 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <distortion_meshGenerator.h>
+
+#include <osg/Math>
+
+#include <cmath>
+
+using namespace osgVisual;
+
+distortion_meshGenerator::distortion_meshGenerator( osg::Image* distortImage_, unsigned int textureWidth_, unsigned int textureHeight_ )
+	: distortImage(distortImage_), textureWidth(textureWidth_), textureHeight(textureHeight_)
+{
+	tolerance = 0.5;
+	minLevel = 3;
+	maxLevel = 8;
+}
+
+void distortion_meshGenerator::setLevels( unsigned int minLevel_, unsigned int maxLevel_ )
+{
+	maxLevel = osg::minimum( maxLevel_, 10u );
+	minLevel = osg::minimum( minLevel_, maxLevel );
+}
+
+osg::Vec2 distortion_meshGenerator::getWarp( double u_, double v_ ) const
+{
+	if( !distortImage.valid() || !distortImage->data() )
+		return osg::Vec2( u_, v_ );
+
+	// Interpolate bilinearly between the pixels, otherwise the mesh error would be dominated by the steps of the map.
+	double s = osg::clampBetween( u_, 0.0, 1.0 ) * (distortImage->s()-1);
+	double t = osg::clampBetween( v_, 0.0, 1.0 ) * (distortImage->t()-1);
+	int s0 = osg::minimum( (int)s, distortImage->s()-2 );
+	int t0 = osg::minimum( (int)t, distortImage->t()-2 );
+	if( s0 < 0 || t0 < 0 )
+		return decodePixel( 0, 0 );
+
+	float fs = s - s0;
+	float ft = t - t0;
+	return (decodePixel( s0, t0 )*(1.0f-fs) + decodePixel( s0+1, t0 )*fs) * (1.0f-ft)
+		 + (decodePixel( s0, t0+1 )*(1.0f-fs) + decodePixel( s0+1, t0+1 )*fs) * ft;
+}
+
+osg::Vec2 distortion_meshGenerator::decodePixel( int s_, int t_ ) const
+{
+	// Float warp maps contain the texcoord itself.
+	if( distortImage->getDataType() == GL_FLOAT )
+	{
+		const float* pPixel = reinterpret_cast<const float*>( distortImage->data( s_, t_ ) );
+		return osg::Vec2( pPixel[0], pPixel[1] );
+	}
+
+	return distortion_floatMap::decodeLegacyPixel( distortImage->data( s_, t_ ) );
+}
+
+double distortion_meshGenerator::getTexelDistance( const osg::Vec2& a_, const osg::Vec2& b_ ) const
+{
+	double dx = (a_.x() - b_.x()) * textureWidth;
+	double dy = (a_.y() - b_.y()) * textureHeight;
+	return sqrt( dx*dx + dy*dy );
+}
+
+bool distortion_meshGenerator::isSplit( unsigned int level_, int x_, int y_ ) const
+{
+	int size = 1 << level_;
+	if( level_ >= maxLevel || x_ < 0 || y_ < 0 || x_ >= size || y_ >= size )
+		return false;
+	return split[level_][y_*size + x_] != 0;
+}
+
+void distortion_meshGenerator::forceSplit( unsigned int level_, int x_, int y_ )
+{
+	if( level_ >= maxLevel )
+		return;
+
+	unsigned char& flag = split[level_][y_*(1 << level_) + x_];
+	if( flag )
+		return;
+	flag = 1;
+
+	if( level_ > 0 )
+		forceSplit( level_-1, x_/2, y_/2 );
+}
+
+double distortion_meshGenerator::computeCellError( unsigned int level_, int x_, int y_ ) const
+{
+	double size = 1.0 / (1 << level_);
+	double u0 = x_ * size;
+	double v0 = y_ * size;
+
+	osg::Vec2 w00 = getWarp( u0, v0 );
+	osg::Vec2 w10 = getWarp( u0+size, v0 );
+	osg::Vec2 w01 = getWarp( u0, v0+size );
+	osg::Vec2 w11 = getWarp( u0+size, v0+size );
+
+	// Compare the bilinear interpolation with the map at the interior quarter points.
+	double maxError = 0.0;
+	for(int i=1; i<4; i++)
+	{
+		for(int j=1; j<4; j++)
+		{
+			float fu = j * 0.25f;
+			float fv = i * 0.25f;
+			osg::Vec2 interpolated = (w00*(1.0f-fu) + w10*fu) * (1.0f-fv) + (w01*(1.0f-fu) + w11*fu) * fv;
+			maxError = osg::maximum( maxError, getTexelDistance( interpolated, getWarp( u0 + fu*size, v0 + fv*size ) ) );
+		}
+	}
+	return maxError;
+}
+
+unsigned int distortion_meshGenerator::getVertex( int ix_, int iy_, std::vector<int>& vertexIndex_, osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_ )
+{
+	int numFine = 1 << maxLevel;
+	int& index = vertexIndex_[iy_*(numFine+1) + ix_];
+	if( index < 0 )
+	{
+		double u = (double)ix_ / numFine;
+		double v = (double)iy_ / numFine;
+		index = vertices_->size();
+		vertices_->push_back( osg::Vec2( u, v ) );
+		texcoords_->push_back( getWarp( u, v ) );
+	}
+	return index;
+}
+
+void distortion_meshGenerator::generate( osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_, osg::DrawElementsUInt* indices_ )
+{
+	vertices_->clear();
+	texcoords_->clear();
+	indices_->clear();
+
+	split.clear();
+	split.resize( maxLevel );
+	for(unsigned int l=0; l<maxLevel; l++)
+		split[l].assign( (1 << l) * (1 << l), 0 );
+
+	// Refine top down: a cell exists if its parent is split.
+	for(unsigned int l=0; l<maxLevel; l++)
+	{
+		int size = 1 << l;
+		for(int y=0; y<size; y++)
+		{
+			for(int x=0; x<size; x++)
+			{
+				if( l > 0 && !isSplit( l-1, x/2, y/2 ) )
+					continue;
+				if( l < minLevel || computeCellError( l, x, y ) > tolerance )
+					split[l][y*size + x] = 1;
+			}
+		}
+	}
+
+	// 2:1 balance bottom up: the edge neighbours of a split cell must exist on the same level.
+	for(unsigned int l=maxLevel; l-- > 1; )
+	{
+		int size = 1 << l;
+		for(int y=0; y<size; y++)
+		{
+			for(int x=0; x<size; x++)
+			{
+				if( !isSplit( l, x, y ) )
+					continue;
+
+				const int dx[4] = { -1, 1, 0, 0 };
+				const int dy[4] = { 0, 0, -1, 1 };
+				for(int n=0; n<4; n++)
+				{
+					int nx = x + dx[n];
+					int ny = y + dy[n];
+					if( nx >= 0 && ny >= 0 && nx < size && ny < size )
+						forceSplit( l-1, nx/2, ny/2 );
+				}
+			}
+		}
+	}
+
+	// Triangulate the leaf cells
+	int numFine = 1 << maxLevel;
+	std::vector<int> vertexIndex( (numFine+1)*(numFine+1), -1 );
+	for(unsigned int l=0; l<=maxLevel; l++)
+	{
+		int size = 1 << l;
+		int step = numFine / size;
+		for(int y=0; y<size; y++)
+		{
+			for(int x=0; x<size; x++)
+			{
+				if( (l > 0 && !isSplit( l-1, x/2, y/2 )) || isSplit( l, x, y ) )
+					continue;
+
+				int x0 = x*step, x1 = x0+step, y0 = y*step, y1 = y0+step;
+				int xm = x0+step/2, ym = y0+step/2;
+
+				// A split neighbour means a vertex at the midpoint of the shared edge.
+				bool midBottom = isSplit( l, x, y-1 );
+				bool midRight = isSplit( l, x+1, y );
+				bool midTop = isSplit( l, x, y+1 );
+				bool midLeft = isSplit( l, x-1, y );
+
+				unsigned int v00 = getVertex( x0, y0, vertexIndex, vertices_, texcoords_ );
+				unsigned int v10 = getVertex( x1, y0, vertexIndex, vertices_, texcoords_ );
+				unsigned int v11 = getVertex( x1, y1, vertexIndex, vertices_, texcoords_ );
+				unsigned int v01 = getVertex( x0, y1, vertexIndex, vertices_, texcoords_ );
+
+				if( !midBottom && !midRight && !midTop && !midLeft )
+				{
+					indices_->push_back( v00 );	indices_->push_back( v10 );	indices_->push_back( v11 );
+					indices_->push_back( v00 );	indices_->push_back( v11 );	indices_->push_back( v01 );
+					continue;
+				}
+
+				// Fan around the cell center along the boundary, counter clockwise.
+				std::vector<unsigned int> boundary;
+				boundary.push_back( v00 );
+				if( midBottom )
+					boundary.push_back( getVertex( xm, y0, vertexIndex, vertices_, texcoords_ ) );
+				boundary.push_back( v10 );
+				if( midRight )
+					boundary.push_back( getVertex( x1, ym, vertexIndex, vertices_, texcoords_ ) );
+				boundary.push_back( v11 );
+				if( midTop )
+					boundary.push_back( getVertex( xm, y1, vertexIndex, vertices_, texcoords_ ) );
+				boundary.push_back( v01 );
+				if( midLeft )
+					boundary.push_back( getVertex( x0, ym, vertexIndex, vertices_, texcoords_ ) );
+
+				unsigned int center = getVertex( xm, ym, vertexIndex, vertices_, texcoords_ );
+				for(unsigned int i=0; i<boundary.size(); i++)
+				{
+					indices_->push_back( center );
+					indices_->push_back( boundary[i] );
+					indices_->push_back( boundary[(i+1) % boundary.size()] );
+				}
+			}
+		}
+	}
+}
+
+void distortion_meshGenerator::generateUniform( unsigned int steps_, osg::Vec2Array* vertices_, osg::Vec2Array* texcoords_, osg::DrawElementsUInt* indices_ )
+{
+	vertices_->clear();
+	texcoords_->clear();
+	indices_->clear();
+	steps_ = osg::maximum( steps_, 2u );
+
+	for(unsigned int i=0; i<steps_; i++)
+	{
+		for(unsigned int j=0; j<steps_; j++)
+		{
+			osg::Vec2 position( (float)j/(float)(steps_-1), (float)i/(float)(steps_-1) );
+			vertices_->push_back( position );
+			texcoords_->push_back( getWarp( position.x(), position.y() ) );
+		}
+	}
+
+	for(unsigned int i=0; i<steps_-1; i++)
+	{
+		for(unsigned int j=0; j<steps_-1; j++)
+		{
+			unsigned int v = i*steps_ + j;
+			indices_->push_back( v );	indices_->push_back( v+1 );			indices_->push_back( v+steps_+1 );
+			indices_->push_back( v );	indices_->push_back( v+steps_+1 );	indices_->push_back( v+steps_ );
+		}
+	}
+}
+
+distortion_meshGenerator::errorReport distortion_meshGenerator::computeError( const osg::Vec2Array* vertices_, const osg::Vec2Array* texcoords_, const osg::DrawElementsUInt* indices_ ) const
+{
+	errorReport report;
+	report.numVertices = vertices_->size();
+	report.numTriangles = indices_->size() / 3;
+
+	// Sample twice as dense as the finest quadtree level.
+	int numSamples = 2 << maxLevel;
+	double sumError = 0.0;
+	unsigned int numErrors = 0;
+
+	for(unsigned int t=0; t+2<indices_->size(); t+=3)
+	{
+		const osg::Vec2& p0 = (*vertices_)[(*indices_)[t]];
+		const osg::Vec2& p1 = (*vertices_)[(*indices_)[t+1]];
+		const osg::Vec2& p2 = (*vertices_)[(*indices_)[t+2]];
+		const osg::Vec2& t0 = (*texcoords_)[(*indices_)[t]];
+		const osg::Vec2& t1 = (*texcoords_)[(*indices_)[t+1]];
+		const osg::Vec2& t2 = (*texcoords_)[(*indices_)[t+2]];
+
+		osg::Vec2 e1 = p1 - p0;
+		osg::Vec2 e2 = p2 - p0;
+		double denom = e1.x()*e2.y() - e2.x()*e1.y();
+		if( fabs(denom) < 1e-12 )
+			continue;
+
+		int ixMin = (int)ceil( osg::minimum( p0.x(), osg::minimum( p1.x(), p2.x() ) ) * numSamples );
+		int ixMax = (int)floor( osg::maximum( p0.x(), osg::maximum( p1.x(), p2.x() ) ) * numSamples );
+		int iyMin = (int)ceil( osg::minimum( p0.y(), osg::minimum( p1.y(), p2.y() ) ) * numSamples );
+		int iyMax = (int)floor( osg::maximum( p0.y(), osg::maximum( p1.y(), p2.y() ) ) * numSamples );
+
+		for(int iy=iyMin; iy<=iyMax; iy++)
+		{
+			for(int ix=ixMin; ix<=ixMax; ix++)
+			{
+				double u = (double)ix / numSamples;
+				double v = (double)iy / numSamples;
+				double du = u - p0.x();
+				double dv = v - p0.y();
+				double b1 = (du*e2.y() - e2.x()*dv) / denom;
+				double b2 = (e1.x()*dv - du*e1.y()) / denom;
+				double b0 = 1.0 - b1 - b2;
+				if( b0 < -1e-9 || b1 < -1e-9 || b2 < -1e-9 )
+					continue;
+
+				osg::Vec2 interpolated = t0*b0 + t1*b1 + t2*b2;
+				double error = getTexelDistance( interpolated, getWarp( u, v ) );
+				report.maxError = osg::maximum( report.maxError, error );
+				sumError += error;
+				numErrors++;
+			}
+		}
+	}
+
+	if( numErrors > 0 )
+		report.meanError = sumError / numErrors;
+	return report;
+}
@@ -0,0 +1,89 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <distortion_resolutionController.h>
+
+using namespace osgVisual;
+
+// Smoothed frame time above target*OVERLOAD reduces the scale, below target*HEADROOM raises it.
+static const double OVERLOAD = 1.05;
+static const double HEADROOM = 0.85;
+// Minimal hold times in s after a scale change before reducing or raising again. The smoothed frame time needs some frames to follow the change.
+static const double REDUCE_HOLD = 0.25;
+static const double RAISE_HOLD = 1.0;
+// Maximal step when raising the scale.
+static const double RAISE_STEP = 0.05;
+// Frames to settle after start, e.g. while the first terrain tiles are compiled.
+static const unsigned int SETTLE_FRAMES = 30;
+
+distortion_resolutionController::distortion_resolutionController( double targetFrameTime_, double minScale_, double maxScale_ )
+{
+	targetFrameTime = targetFrameTime_ > 0.0 ? targetFrameTime_ : 16.6;
+	minScale = osg::clampBetween( minScale_, 0.1, 1.0 );
+	maxScale = osg::clampBetween( maxScale_, minScale, 1.0 );
+	scale = maxScale;
+	smoothedFrameTime = 0.0;
+	smoothing = 0.1;
+	probeInterval = 5.0;
+	lastChangeTime = 0.0;
+	numFrames = 0;
+}
+
+double distortion_resolutionController::update( double frameTime_, double time_ )
+{
+	if( frameTime_ <= 0.0 )
+		return scale;
+
+	numFrames++;
+	if( numFrames == 1 )
+		smoothedFrameTime = frameTime_;
+	else
+		smoothedFrameTime += smoothing * (frameTime_ - smoothedFrameTime);
+
+	if( numFrames < SETTLE_FRAMES )
+	{
+		lastChangeTime = time_;
+		return scale;
+	}
+
+	double timeSinceChange = time_ - lastChangeTime;
+	if( smoothedFrameTime > targetFrameTime*OVERLOAD )
+	{
+		// The pixel count scales with the square of the scale factor.
+		if( scale > minScale && timeSinceChange > REDUCE_HOLD )
+			setScale( scale * sqrt( targetFrameTime / smoothedFrameTime ), time_ );
+	}
+	else if( scale < maxScale )
+	{
+		if( smoothedFrameTime < targetFrameTime*HEADROOM && timeSinceChange > RAISE_HOLD )
+			setScale( scale + osg::minimum( RAISE_STEP, scale * (sqrt( targetFrameTime*HEADROOM / smoothedFrameTime ) - 1.0) ), time_ );
+		else if( timeSinceChange > probeInterval )
+			setScale( scale + RAISE_STEP, time_ );
+	}
+
+	return scale;
+}
+
+void distortion_resolutionController::setScale( double scale_, double time_ )
+{
+	double newScale = osg::clampBetween( floor( scale_*64.0 + 0.5 ) / 64.0, minScale, maxScale );
+	// Ensure progress if the quantization swallows a small step.
+	if( newScale == scale && scale_ != scale )
+		newScale = osg::clampBetween( scale + (scale_ > scale ? 1.0 : -1.0) / 64.0, minScale, maxScale );
+
+	scale = newScale;
+	lastChangeTime = time_;
+}
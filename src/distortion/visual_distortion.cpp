@@ -25,13 +25,10 @@ visual_distortion::visual_distortion(osgViewer::Viewer* viewer_, osg::ArgumentPa
 	this->configFileName = configFileName;
 	initialized = false;
 	distortionEnabled = false;
-	parser = new CameraConfigParser();
+	resolutionScale = 1.0;
 
 	distortedGraph = NULL;
 	cleanGraph = NULL;
-
-	distortMapTexture = NULL;
-	blendMapTexture = NULL;
 }
 
 visual_distortion::~visual_distortion(void)
@@ -42,9 +39,8 @@ visual_distortion::~visual_distortion(void)
 bool visual_distortion::processXMLConfiguration()
 {
 	// Init XML
-	xmlDoc* tmpDoc;
 	bool disabled;
-	xmlNode* config = util::getModuleXMLConfig( configFileName, "distortion", tmpDoc, disabled );
+	const util_config::node* config = util::getModuleConfig( configFileName, "distortion", disabled );
 
 	if( disabled)
 	{
@@ -57,102 +53,124 @@ bool visual_distortion::processXMLConfiguration()
 	{
 		OSG_NOTIFY( osg::ALWAYS ) << "..using distortion." << std::endl;
 
-		xmlNode* a_node = config->children;
+		std::vector<channelSetup> additionalChannels;
+		bool useDynamicResolution = false;
+		double targetFrameTime = 16.6;
+		double minResolutionScale = 0.5;
+		double maxResolutionScale = 1.0;
 
-		for (xmlNode *cur_node = a_node; cur_node; cur_node = cur_node->next)
+		const util_config::node::NodeList& children = config->getChildren();
+		for(unsigned int i=0; i<children.size(); i++)
 		{
-			std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-			//OSG_ALWAYS << "----visual_distortion::processXMLConfiguration() - node type="<< cur_node->type <<", name=" << cur_node->name << std::endl;
+			const util_config::node* cur_node = children[i].get();
+			const std::string& node_name = cur_node->getName();
 
 			// Check for distortion node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "distortion")
+			if(node_name == "distortion")
 			{
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "channelname" )
-					{
-						std::string  channelname = attr_value;
-						OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Channelname:" << channelname << std::endl;
-
-						std::string pre_cfg("..\\resources\\distortion\\view_");
-						std::string pre_distortion("..\\resources\\distortion\\distort_");
-						std::string pre_blend("..\\resources\\distortion\\blend_");
-						std::string post_cfg(".cfg");
-						std::string post_distortion(".bmp");
-						std::string post_blend(".bmp");
-
-						// load channel config
-						parser->parseConfigFile((pre_cfg+channelname+post_cfg).data());
-						// load channel blendmap
-						blendMapFileName = (pre_blend+channelname+post_blend).data();
-						// load channel distortionmap
-						distortMapFileName = (pre_distortion+channelname+post_distortion).data(); 
-						// set channel frustum
-						if( parser->isConfigParsed())
- 							viewer->getCamera()->setProjectionMatrixAsFrustum((parser->getFrustumDataset())[0], (parser->getFrustumDataset())[1], (parser->getFrustumDataset())[2], (parser->getFrustumDataset())[3], (parser->getFrustumDataset())[4], (parser->getFrustumDataset())[5]);
-						else
-							OSG_NOTIFY(osg::WARN) << "WARNING: Unable to parse Frustum values from '" << pre_cfg<<channelname<<post_cfg << "' -- continue without valid frustum values." << std::endl;
-					}
-         			if( attr_name == "width" )
-					{
-						std::stringstream sstr(attr_value);
-						sstr >> tex_width;
-					}
-					if( attr_name == "height" )
-					{
-						std::stringstream sstr(attr_value);
-						sstr >> tex_height;
-					}
-					if( attr_name == "useshader" )
-						useShaderDistortion = (attr_value == "yes") ? true : false;
-					if( attr_name == "hdr" )
-						useHDR = (attr_value == "yes") ? true : false;
-					if( attr_name == "usetexturerectangle" )
-						useTextureRectangle = (attr_value == "yes") ? true : false;
-
-
-					attr = attr->next; 
-				}	// WHILE attrib END
+				if( cur_node->hasAttribute("channelname") )
+					setChannelName( channels.front(), cur_node->getString("channelname") );
+				tex_width = cur_node->getInt("width", tex_width);
+				tex_height = cur_node->getInt("height", tex_height);
+				useShaderDistortion = cur_node->getBool("useshader", useShaderDistortion);
+				useHDR = cur_node->getBool("hdr", useHDR);
+				useTextureRectangle = cur_node->getBool("usetexturerectangle", useTextureRectangle);
+				meshTolerance = cur_node->getDouble("meshtolerance", meshTolerance);
+				meshMinLevel = cur_node->getInt("meshminlevel", meshMinLevel);
+				meshMaxLevel = cur_node->getInt("meshmaxlevel", meshMaxLevel);
+				useDynamicResolution = cur_node->getBool("dynamicresolution", useDynamicResolution);
+				targetFrameTime = cur_node->getDouble("targetframetime", targetFrameTime);
+				minResolutionScale = cur_node->getDouble("minresolutionscale", minResolutionScale);
+				maxResolutionScale = cur_node->getDouble("maxresolutionscale", maxResolutionScale);
 			}	// IF Node == distortion END
 
 			// Check for distortionmap node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "distortionmap")
+			if(node_name == "distortionmap")
+				channels.front().distortMapFileName = cur_node->getString("filename", channels.front().distortMapFileName);
+
+			// Check for blendmap node
+			if(node_name == "blendmap")
+				channels.front().blendMapFileName = cur_node->getString("filename", channels.front().blendMapFileName);
+
+			// Check for channel node: each node adds a channel which is rendered by this process.
+			if(node_name == "channel")
 			{
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "filename" )
-					{
-						distortMapFileName = attr_value;
-					}
-					attr = attr->next; 
+				channelSetup channel;
+				if( cur_node->hasAttribute("channelname") )
+					setChannelName( channel, cur_node->getString("channelname") );
+				channel.distortMapFileName = cur_node->getString("distortionmap", channel.distortMapFileName);
+				channel.blendMapFileName = cur_node->getString("blendmap", channel.blendMapFileName);
+				channel.x = cur_node->getDouble("x", channel.x);
+				channel.y = cur_node->getDouble("y", channel.y);
+				channel.width = cur_node->getDouble("width", channel.width);
+				channel.height = cur_node->getDouble("height", channel.height);
+				bool areaConfigured = cur_node->hasAttribute("x") || cur_node->hasAttribute("y") || cur_node->hasAttribute("width") || cur_node->hasAttribute("height");
+
+				if( channel.cfgFileName.empty() )
+					OSG_NOTIFY(osg::WARN) << "WARNING: visual_distortion: <channel> without channelname ignored." << std::endl;
+				else
+				{
+					channel.useChannelFrustum = true;
+					if( !areaConfigured )
+						channel.width = -1.0;	// marks the channel for automatic layout
+					additionalChannels.push_back( channel );
 				}
 			}
+		}	// FOR all nodes END
 
-			// Check for distortionmap node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "blendmap")
+		// Multi channel mode: the <channel> entries replace the channel of the <distortion> node.
+		if( !additionalChannels.empty() )
+		{
+			if( !channels.front().name.empty() )
+				OSG_NOTIFY(osg::WARN) << "WARNING: visual_distortion: channelname '" << channels.front().name << "' is ignored because <channel> entries are configured." << std::endl;
+			channels = additionalChannels;
+
+			// Channels without configured area are placed side by side in the order of configuration.
+			for(unsigned int i=0; i<channels.size(); i++)
 			{
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "filename" )
-					{
-						blendMapFileName = attr_value;
-					}
-					attr = attr->next; 
+				if( channels[i].width < 0.0 )
+				{
+					channels[i].x = static_cast<double>(i) / channels.size();
+					channels[i].y = 0.0;
+					channels[i].width = 1.0 / channels.size();
+					channels[i].height = 1.0;
 				}
 			}
-		}	// FOR all nodes END
+			OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Rendering " << channels.size() << " channels in one process." << std::endl;
+		}
+
+		if( useDynamicResolution )
+		{
+			resolutionController = new distortion_resolutionController( targetFrameTime, minResolutionScale, maxResolutionScale );
+			OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Dynamic resolution between " << minResolutionScale << " and " << maxResolutionScale << " of " << tex_width << "x" << tex_height << " for a frame time of " << targetFrameTime << " ms." << std::endl;
+		}
+
+		// Load channels from the distortion cache. Requires all filenames and options, therefore called after parsing.
+		prepareChannels( false );
+
+		// The main camera uses the frustum of the first channel. In multi channel mode it is only used for interaction and picking.
+		if( channels.front().parser->isConfigParsed() )
+		{
+			std::vector<double> frustum = channels.front().parser->getFrustumDataset();
+			viewer->getCamera()->setProjectionMatrixAsFrustum(frustum[0], frustum[1], frustum[2], frustum[3], frustum[4], frustum[5]);
+		}
+
+		// The channel orientation is relative to the first channel, the design eye point of all channels is the main camera.
+		if( channels.size() > 1 )
+		{
+			std::vector<double> referenceTranslation = channels.front().parser->getTranslationDataset();
+			for(unsigned int i=0; i<channels.size(); i++)
+			{
+				std::vector<double> rotation = channels[i].parser->getRotationDataset();
+				std::vector<double> translation = channels[i].parser->getTranslationDataset();
+				osg::Matrixd channelPose = osg::Matrixd::rotate( osg::DegreesToRadians(rotation[0]), osg::X_AXIS, 
+																 osg::DegreesToRadians(rotation[1]), osg::Y_AXIS,
+																 osg::DegreesToRadians(rotation[2]), osg::Z_AXIS )
+										   * osg::Matrixd::translate( translation[0]-referenceTranslation[0], translation[1]-referenceTranslation[1], translation[2]-referenceTranslation[2] );
+				channels[i].viewOffset = osg::Matrixd::inverse( channelPose );
+			}
+		}
 
-		// clean up
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
 		return true;
 	}	// IF Config valid END
 	else
@@ -173,8 +191,13 @@ osg::Group* visual_distortion::initialize(osg::Group* subgraph, const osg::Vec4&
     tex_height = 2048;
 	useShaderDistortion = false;
 	useHDR = false; 
-	distortMapFileName = "..\\resources\\distortion\\distort_distDisabled.bmp";
-	blendMapFileName = "..\\resources\\distortion\\blend_distDisabled.bmp";
+	meshTolerance = 0.5;
+	meshMinLevel = 3;
+	meshMaxLevel = 8;
+	channels.clear();
+	channels.push_back( channelSetup() );
+	channels.front().distortMapFileName = "..\\resources\\distortion\\distort_distDisabled.bmp";
+	channels.front().blendMapFileName = "..\\resources\\distortion\\blend_distDisabled.bmp";
 
 	// Process XML configuration
 	if(!processXMLConfiguration())
@@ -190,10 +213,12 @@ osg::Group* visual_distortion::initialize(osg::Group* subgraph, const osg::Vec4&
 
 	cleanGraph = subgraph;
 	distortedGraph = createPreRenderSubGraph( subgraph, clearColor );
+	if( resolutionController.valid() )
+		setResolutionScale( resolutionController->getScale() );
 
-	// Create and install updateCallback (to get called for copying the main cameras view matrixes to the PRE_RENDER camera)
-	// -- must be called _AFTER_ createPreRenderSubGraph() (necessary because sceneCamera is set by createPreRenderSubGraph())
-	updateCallback = new distortionUpdateCallback( viewer, sceneCamera );
+	// Create and install updateCallback (to get called for copying the main cameras view matrixes to the PRE_RENDER cameras)
+	// -- must be called _AFTER_ createPreRenderSubGraph() (necessary because the scene cameras are set by createPreRenderSubGraph())
+	updateCallback = new distortionUpdateCallback( viewer, this );
 	this->setUpdateCallback( updateCallback );
 
 	// Note down state flags..
@@ -223,10 +248,59 @@ void visual_distortion::shutdown()
 
 void visual_distortion::distortionUpdateCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
 {
-	// Copy Main Camera's matrixes to the PRE_RENDER Camera.
+	OSGVISUAL_PROFILE_SCOPE("visual_distortion update");
+	OSGVISUAL_ALLOC_SCOPE(DISTORTION);
+	// Copy Main Camera's matrixes to the PRE_RENDER Cameras.
 	//std::cout << "distortion updatecallback" << std::endl;
-	sceneCamera->setViewMatrix( viewer->getCamera()->getViewMatrix() );
-	sceneCamera->setProjectionMatrix( viewer->getCamera()->getProjectionMatrix() );
+	osg::Camera* mainCamera = viewer->getCamera();
+
+	// Choose the resolution of the scene cameras from the duration of the last frame.
+	const osg::FrameStamp* frameStamp = nv->getFrameStamp();
+	if( distortion->resolutionController.valid() && frameStamp )
+	{
+		if( lastReferenceTime >= 0.0 )
+		{
+			double frameTime = (frameStamp->getReferenceTime() - lastReferenceTime) * 1000.0;
+			double scale = distortion->resolutionController->update( frameTime, frameStamp->getReferenceTime() );
+			if( scale != distortion->resolutionScale )
+				distortion->setResolutionScale( scale );
+
+			OSGVISUAL_LOG( osg::INFO ) << "visual_distortion: Frame " << frameStamp->getFrameNumber() << ": frame time " << frameTime << " ms, smoothed " << distortion->resolutionController->getSmoothedFrameTime() << " ms, resolution scale " << scale << std::endl;
+			if( viewer->getViewerStats() )
+				viewer->getViewerStats()->setAttribute( frameStamp->getFrameNumber(), "Distortion resolution scale", scale );
+		}
+		lastReferenceTime = frameStamp->getReferenceTime();
+	}
+
+	for(unsigned int i=0; i<distortion->channels.size(); i++)
+	{
+		channelSetup& channel = distortion->channels[i];
+		channel.sceneCamera->setViewMatrix( mainCamera->getViewMatrix() * channel.viewOffset );
+		if( !channel.useChannelFrustum )
+			channel.sceneCamera->setProjectionMatrix( mainCamera->getProjectionMatrix() );
+	}
+}
+
+void visual_distortion::setResolutionScale( double scale_ )
+{
+	resolutionScale = osg::clampBetween( scale_, 0.01, 1.0 );
+
+	// Texcoords are corrected by the rounded size which is actually rendered.
+	unsigned int width = osg::maximum( 1u, static_cast<unsigned int>( tex_width*resolutionScale + 0.5 ) );
+	unsigned int height = osg::maximum( 1u, static_cast<unsigned int>( tex_height*resolutionScale + 0.5 ) );
+	float scaleS = static_cast<float>(width) / tex_width;
+	float scaleT = static_cast<float>(height) / tex_height;
+
+	for(unsigned int i=0; i<channels.size(); i++)
+	{
+		// A new viewport object is used, the previous frame may still be drawn with the old one.
+		if( channels[i].sceneCamera.valid() )
+			channels[i].sceneCamera->setViewport( new osg::Viewport(0, 0, width, height) );
+		if( channels[i].texMat.valid() )
+			channels[i].texMat->setMatrix( osg::Matrix::scale(scaleS, scaleT, 1.0) );
+		if( channels[i].textureScale.valid() )
+			channels[i].textureScale->set( osg::Vec2(scaleS, scaleT) );
+	}
 }
 
 void visual_distortion::toggleDistortion()
@@ -250,18 +324,42 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
 {
     if (!subgraph) return 0;
 
-    // create a group to contain the flag and the pre rendering camera.
+    // create a group to contain the distortion camera and the pre rendering cameras.
     osg::Group* parent = new osg::Group;
 
-    // texture to render to and to use for rendering of flag.
-    //osg::Texture* texture = 0;
+    // set up the camera to render the distortion meshes of all channels
+    osg::Camera* camera = new osg::Camera;
+
+    // The meshes are placed in normalized window coordinates, so the camera inherits the window size from the main camera.
+    camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+    camera->setViewMatrix(osg::Matrix::identity());
+    camera->setProjectionMatrixAsOrtho2D(0,1,0,1);
+
+    // set the camera to render after the scene cameras.
+    camera->setRenderOrder(osg::Camera::POST_RENDER, 200);
+
+    // only clear the depth buffer
+    camera->setClearMask(0);
+
+    // build the distortion meshes which were not loaded from the distortion cache
+    prepareChannels( true );
+
+    // then create the scene camera and the distortion mesh for each channel
+    for(unsigned int i=0; i<channels.size(); i++)
+        parent->addChild( createChannelSubGraph( channels[i], subgraph, clearColor, camera ) );
+
+    parent->addChild(camera);
+    return parent;
+}
+
+osg::Camera* visual_distortion::createChannelSubGraph( channelSetup& channel_, osg::Group* subgraph, const osg::Vec4& clearColor, osg::Camera* distortionCamera )
+{
+    // texture to render to and to use for rendering of the distortion mesh.
     osg::Texture2D* texture = new osg::Texture2D;
     texture->setTextureSize(tex_width, tex_height);
     texture->setInternalFormat(GL_RGBA);
     texture->setFilter(osg::Texture2D::MIN_FILTER,osg::Texture2D::LINEAR);
     texture->setFilter(osg::Texture2D::MAG_FILTER,osg::Texture2D::LINEAR);
-    
-    //texture = texture2D;
 
     if (useHDR)
     {
@@ -270,23 +368,8 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
         texture->setSourceType(GL_FLOAT);
     }
 
-    // load a distortion map texture file
-	if ( osgDB::fileExists( distortMapFileName ) )
-		distortMapTexture = loadTexture(distortMapFileName);
-	else
-	{
-		OSG_NOTIFY(osg::FATAL) << "ERROR: Distortionmap file'" << distortMapFileName << "' not found! Please change the channelname, filename or copy the desired file to the applications root folder!" << std::endl;
-		exit(-1);
-	}
-
-    // load a blend map texture file
-	if ( osgDB::fileExists( blendMapFileName ) )
-		blendMapTexture = loadTexture(blendMapFileName);
-	else
-	{
-		OSG_NOTIFY(osg::FATAL) << "ERROR: Blendmap file'" << blendMapFileName << "' not found! Please change the channelname, filename or copy the desired file to the applications root folder!" << std::endl;
-		exit(-1);
-	}
+    osg::ref_ptr<osg::Texture> distortMapTexture = createTexture( channel_.data.distortImage.get() );
+    osg::ref_ptr<osg::Texture> blendMapTexture = createTexture( channel_.data.blendImage.get() );
 
     // set up the plane to render the rendered view.
     {
@@ -295,77 +378,25 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
 
         polyGeom->setSupportsDisplayList(false);
 
-        osg::Vec3 origin(0.0f,0.0f,0.0f);
-        osg::Vec3 xAxis(1.0f,0.0f,0.0f);
-        osg::Vec3 yAxis(0.0f,1.0f,0.0f);
-        osg::Vec3 zAxis(0.0f,0.0f,1.0f);
-        float width = 1600.0f;
-		float height = 900.0f;
-        int noSteps = 128;
-        if (useShaderDistortion)
-            noSteps = 2;
-
+        // place the normalized mesh in the channels area of the window
         osg::Vec3Array* vertices = new osg::Vec3Array;
-        osg::Vec2Array* texcoords = new osg::Vec2Array;
-        osg::Vec2Array* texcoords2 = useShaderDistortion?NULL:(new osg::Vec2Array);
-        osg::Vec4Array* colors = new osg::Vec4Array;
+        vertices->reserve(channel_.data.vertices->size());
+        for(unsigned int i=0;i<channel_.data.vertices->size();++i)
+            vertices->push_back(osg::Vec3(channel_.x + (*channel_.data.vertices)[i].x()*channel_.width, channel_.y + (*channel_.data.vertices)[i].y()*channel_.height, 0.0f));
 
-        osg::Vec3 bottom = origin;
-        osg::Vec3 dx = xAxis*(width/((float)(noSteps-1)));
-        osg::Vec3 dy = yAxis*(height/((float)(noSteps-1)));
-
-        osg::Vec2 bottom_texcoord(0.0f,0.0f);
-        osg::Vec2 dx_texcoord(1.0f/(float)(noSteps-1),0.0f);
-        osg::Vec2 dy_texcoord(0.0f,1.0f/(float)(noSteps-1));
-
-        osg::Vec3 cursor = bottom;
-        osg::Vec2 texcoord = bottom_texcoord;
-        int i,j;
-        for(i=0;i<noSteps;++i)
-        {
-            osg::Vec3 cursor = bottom+dy*(float)i;
-            osg::Vec2 texcoord = bottom_texcoord+dy_texcoord*(float)i;
-            for(j=0;j<noSteps;++j)
-            {
-                vertices->push_back(cursor);
-                if (distortMapTexture && !useShaderDistortion)
-                {
-                    osg::Vec2 imgcoord = osg::Vec2((distortMapTexture->getImage(0)->s()-1) * texcoord.x(),
-                                                   (distortMapTexture->getImage(0)->t()-1) * texcoord.y());
-                    unsigned char* pPixel = &distortMapTexture->getImage(0)->data()[(int)imgcoord.y()*distortMapTexture->getImage(0)->getRowSizeInBytes()+
-                                                                                    (int)imgcoord.x()*distortMapTexture->getImage(0)->getPixelSizeInBits()/8];
-                    texcoords->push_back(osg::Vec2(((float)pPixel[2] / 255.0f + (pPixel[0] % 16)) / 16.0f,
-                                                   1.0f - ((float)pPixel[1] / 255.0f + (pPixel[0] / 16)) / 16.0f));
-                    texcoords2->push_back(osg::Vec2(texcoord.x(), texcoord.y()));
-                }
-                else
-                    texcoords->push_back(osg::Vec2(texcoord.x(), texcoord.y()));
-                colors->push_back(osg::Vec4(1.0f,1.0f,1.0f,1.0f));
-
-                cursor += dx;
-                texcoord += dx_texcoord;
-            }
-        }
+        osg::Vec4Array* colors = new osg::Vec4Array;
+        colors->push_back(osg::Vec4(1.0f,1.0f,1.0f,1.0f));
 
         // pass the created vertex array to the points geometry object.
         polyGeom->setVertexArray(vertices);
 
         polyGeom->setColorArray(colors);
-        polyGeom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-        polyGeom->setTexCoordArray(0,texcoords);
+        polyGeom->setColorBinding(osg::Geometry::BIND_OVERALL);
+        polyGeom->setTexCoordArray(0,channel_.data.texcoords.get());
         if (!useShaderDistortion)
-            polyGeom->setTexCoordArray(2,texcoords2);
+            polyGeom->setTexCoordArray(2,channel_.data.texcoords2.get());
 
-        for(i=0;i<noSteps-1;++i)
-        {
-            osg::DrawElementsUShort* elements = new osg::DrawElementsUShort(osg::PrimitiveSet::QUAD_STRIP);
-            for(j=0;j<noSteps;++j)
-            {
-                elements->push_back(j+(i+1)*noSteps);
-                elements->push_back(j+(i)*noSteps);
-            }
-            polyGeom->addPrimitiveSet(elements);
-        }
+        polyGeom->addPrimitiveSet(channel_.data.indices.get());
 
         // new we need to add the texture to the Drawable, we do so by creating a 
         // StateSet to contain the Texture StateAttribute.
@@ -380,30 +411,13 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
         if (useShaderDistortion)
         {
             // apply the distortion map texture
-            if (distortMapTexture)
-                geode->getOrCreateStateSet()->setTextureAttributeAndModes(1, distortMapTexture, osg::StateAttribute::ON);
+            if (distortMapTexture.valid())
+                geode->getOrCreateStateSet()->setTextureAttributeAndModes(1, distortMapTexture.get(), osg::StateAttribute::ON);
         }
 
         // apply the blend map texture
-        if (blendMapTexture)
-            geode->getOrCreateStateSet()->setTextureAttributeAndModes(2, blendMapTexture, osg::StateAttribute::ON);
-
-        // set up the camera to render the textured quad
-        osg::Camera* camera = new osg::Camera;
-
-        // just inherit the main cameras view
-        camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
-        camera->setViewMatrix(osg::Matrix::identity());
-		camera->setProjectionMatrixAsOrtho2D(0,1600,0,900);		/** \todo: use screen size dynamically */
-		
-        // set the camera to render before the main camera.
-        camera->setRenderOrder(osg::Camera::POST_RENDER, 200);
-		
-        // only clear the depth buffer
-        camera->setClearMask(0);
-
-        // add subgraph to render
-        camera->addChild(geode);
+        if (blendMapTexture.valid())
+            geode->getOrCreateStateSet()->setTextureAttributeAndModes(2, blendMapTexture.get(), osg::StateAttribute::ON);
 
         if (useShaderDistortion)
         {
@@ -415,9 +429,14 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
             osg::Shader* distortVertObj = new osg::Shader( osg::Shader::VERTEX );
             osg::Shader* distortFragObj = new osg::Shader( osg::Shader::FRAGMENT );
 
+            // float warp maps contain the texcoords directly, legacy maps have to be decoded by the shader
+            std::string fragShaderFileName = "../resources/distortion/shader.frag";
+            if (channel_.data.distortImage.valid() && channel_.data.distortImage->getDataType() == GL_FLOAT)
+                fragShaderFileName = "../resources/distortion/shader_float.frag";
+
             if (loadShaderSource( distortVertObj, "../resources/distortion/shader.vert" ) &&
-                loadShaderSource( distortFragObj, "../resources/distortion/shader.frag" ) &&
-                distortMapTexture)
+                loadShaderSource( distortFragObj, fragShaderFileName ) &&
+                distortMapTexture.valid())
             {
                 distortProgram->addShader( distortFragObj );
                 distortProgram->addShader( distortVertObj );
@@ -433,52 +452,68 @@ osg::Group* visual_distortion::createPreRenderSubGraph(osg::Group* subgraph, con
 			}
         }
 
-        parent->addChild(camera);
+        // The dynamic resolution renders only into a part of the texture, the distortion mesh samples only this part.
+        if (useShaderDistortion)
+        {
+            channel_.textureScale = new osg::Uniform("textureScale", osg::Vec2(1.0f, 1.0f));
+            channel_.textureScale->setDataVariance(osg::Object::DYNAMIC);
+            geode->getOrCreateStateSet()->addUniform( channel_.textureScale.get() );
+        }
+        else
+        {
+            channel_.texMat = new osg::TexMat;
+            channel_.texMat->setDataVariance(osg::Object::DYNAMIC);
+            stateset->setTextureAttribute( 0, channel_.texMat.get() );
+        }
+
+        distortionCamera->addChild(geode);
     }
 
     // then create the camera node to do the render to texture
-    {    
-        osg::Camera* camera = new osg::Camera;
-
-        // set up the background color and clear mask.
-        camera->setClearColor(clearColor);
-        camera->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-
-        // just inherit the main cameras view
-		/* ABSOLUTE_RF required to make intersections possible.
-		Disadvantage of ABOLUTE_RF : the maincameras view matrix and projection
-		matrix has to copied to the PRE_RENDER camera by our self.
-		Therefore an update callback is installed.
-		*/
-		camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);	
-        camera->setProjectionMatrix(osg::Matrixd::identity());
-        camera->setViewMatrix(osg::Matrixd::identity());
+    osg::Camera* camera = new osg::Camera;
+
+    // set up the background color and clear mask.
+    camera->setClearColor(clearColor);
+    camera->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // just inherit the main cameras view
+	/* ABSOLUTE_RF required to make intersections possible.
+	Disadvantage of ABOLUTE_RF : the maincameras view matrix and projection
+	matrix has to copied to the PRE_RENDER camera by our self.
+	Therefore an update callback is installed.
+	*/
+	camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);	
+    camera->setProjectionMatrix(osg::Matrixd::identity());
+    camera->setViewMatrix(osg::Matrixd::identity());
+
+    // Channels of a multi channel setup use their own frustum, near and far are computed by the camera as usual.
+    if( channel_.useChannelFrustum )
+    {
+        std::vector<double> frustum = channel_.parser->getFrustumDataset();
+        camera->setProjectionMatrixAsFrustum(frustum[0], frustum[1], frustum[2], frustum[3], frustum[4], frustum[5]);
+    }
 
-        // set viewport
-        camera->setViewport(0,0,tex_width,tex_height);
+    // set viewport
+    camera->setViewport(0,0,tex_width,tex_height);
 
-        // set the camera to render before the main camera.
-        camera->setRenderOrder(osg::Camera::PRE_RENDER, 0);
+    // set the camera to render before the main camera.
+    camera->setRenderOrder(osg::Camera::PRE_RENDER, 0);
 
-		sceneCamera = camera;
+    channel_.sceneCamera = camera;
 
-        // tell the camera to use OpenGL frame buffer object where supported.
-        camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
+    // tell the camera to use OpenGL frame buffer object where supported.
+    camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
 
-        // attach the texture and use it as the color buffer.
-        //camera->attach(osg::Camera::COLOR_BUFFER, texture);	// No Multisampling/Antialiasing
-		camera->attach(osg::Camera::COLOR_BUFFER, texture, 0, 0, false, 4, 4); // 4x Multisampling/Antialiasing
+    // attach the texture and use it as the color buffer.
+    //camera->attach(osg::Camera::COLOR_BUFFER, texture);	// No Multisampling/Antialiasing
+	camera->attach(osg::Camera::COLOR_BUFFER, texture, 0, 0, false, 4, 4); // 4x Multisampling/Antialiasing
 
-        // add subgraph to render
-        camera->addChild(subgraph);
+    // add subgraph to render, all channels share the same scene graph
+    camera->addChild(subgraph);
 
-        parent->addChild(camera);
-    }    
-    return parent;
+    return camera;
 }
 
-
 bool visual_distortion::loadShaderSource( osg::Shader* shader, const std::string& fileName )
 {
     std::string foundFileName = osgDB::findDataFile(fileName);
@@ -492,26 +527,186 @@ bool visual_distortion::loadShaderSource( osg::Shader* shader, const std::string
     return false;
 }
 
-osg::Texture* visual_distortion::loadTexture( const std::string& fileName )
+osg::Image* visual_distortion::readMapImage( const std::string& fileName )
 {
-    std::string foundFileName = osgDB::findDataFile(fileName);
-    if (foundFileName.length() != 0 )
+	osg::Image* image = NULL;
+	std::string foundFileName = osgDB::findDataFile(fileName);
+	if (distortion_floatMap::isFloatMap(fileName))
+		image = distortion_floatMap::read(foundFileName);
+	else
+		image = osgDB::readImageFile(foundFileName);
+
+	if (!image)
+		OSG_NOTIFY(osg::WARN) << "File \"" << fileName << "\" not readable." << std::endl;
+	return image;
+}
+
+osg::Texture* visual_distortion::createTexture( osg::Image* image )
+{
+    if (!image)
+        return NULL;
+
+	osg::Texture2D* texture = new osg::Texture2D;
+    texture->setImage(image);
+    // float maps are uploaded as they are, without rescaling to power of two
+    if (image->getDataType() == GL_FLOAT)
+        texture->setResizeNonPowerOfTwoHint(false);
+    texture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::NEAREST);
+    texture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::NEAREST);
+    texture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::CLAMP_TO_EDGE);
+    texture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::CLAMP_TO_EDGE);
+    return texture;
+}
+
+unsigned int visual_distortion::getMeshBuildOptions()
+{
+	unsigned int tolerance = static_cast<unsigned int>( osg::clampBetween( meshTolerance, 0.0, 600.0 ) * 100.0 + 0.5 );
+	return (useShaderDistortion ? 1 : 0) | ((meshMinLevel & 15) << 1) | ((meshMaxLevel & 15) << 5) | (tolerance << 9);
+}
+
+std::vector<std::string> visual_distortion::getChannelSourceFiles( const channelSetup& channel_ )
+{
+	std::vector<std::string> sources;
+	sources.push_back( channel_.cfgFileName );
+	sources.push_back( channel_.distortMapFileName );
+	sources.push_back( channel_.blendMapFileName );
+	return sources;
+}
+
+void visual_distortion::setChannelName( channelSetup& channel_, const std::string& channelname_ )
+{
+	OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Channelname:" << channelname_ << std::endl;
+
+	std::string pre_cfg("..\\resources\\distortion\\view_");
+	std::string pre_distortion("..\\resources\\distortion\\distort_");
+	std::string pre_blend("..\\resources\\distortion\\blend_");
+	std::string post_cfg(".cfg");
+	std::string post_distortion(".bmp");
+	std::string post_blend(".bmp");
+
+	channel_.name = channelname_;
+	// channel config, parsed by loadChannel() if the distortion cache is outdated
+	channel_.cfgFileName = pre_cfg+channelname_+post_cfg;
+	// load channel blendmap, float maps are preferred if available
+	channel_.blendMapFileName = pre_blend+channelname_+post_blend;
+	if( osgDB::fileExists(pre_blend+channelname_+".fmap") )
+		channel_.blendMapFileName = pre_blend+channelname_+".fmap";
+	// load channel distortionmap, float maps are preferred if available
+	channel_.distortMapFileName = pre_distortion+channelname_+post_distortion; 
+	if( osgDB::fileExists(pre_distortion+channelname_+".fmap") )
+		channel_.distortMapFileName = pre_distortion+channelname_+".fmap";
+}
+
+void visual_distortion::loadChannel( channelSetup& channel_ )
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+	channel_.cacheFileName = distortion_meshCache::getCacheFilename( channel_.distortMapFileName );
+	channel_.cached = distortion_meshCache::load( channel_.cacheFileName, getChannelSourceFiles(channel_), getMeshBuildOptions(), channel_.data );
+	if( channel_.cached )
+	{
+		channel_.parser->setDatasets( channel_.data.frustum, channel_.data.rotation, channel_.data.translation );
+
+		// Float maps are not stored in the cache.
+		if( useShaderDistortion && !channel_.data.distortImage.valid() && distortion_floatMap::isFloatMap( channel_.distortMapFileName ) )
+			channel_.data.distortImage = readMapImage( channel_.distortMapFileName );
+		if( !channel_.data.blendImage.valid() && distortion_floatMap::isFloatMap( channel_.blendMapFileName ) )
+			channel_.data.blendImage = readMapImage( channel_.blendMapFileName );
+		OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Channel loaded from cache '" << channel_.cacheFileName << "' in " << osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) << " ms." << std::endl;
+	}
+	else if( !channel_.cfgFileName.empty() )
+		channel_.parser->parseConfigFile( channel_.cfgFileName.c_str() );
+
+	if( !channel_.cfgFileName.empty() && !channel_.parser->isConfigParsed() )
+	{
+		OSG_NOTIFY(osg::WARN) << "WARNING: Unable to parse Frustum values from '" << channel_.cfgFileName << "' -- continue without valid frustum values." << std::endl;
+		channel_.useChannelFrustum = false;
+	}
+}
+
+void visual_distortion::prepareChannels( bool build_ )
+{
+	std::vector< osg::ref_ptr<osg::Operation> > operations;
+	for(unsigned int i=0; i<channels.size(); i++)
+	{
+		if( !build_ || !channels[i].cached )
+			operations.push_back( new channelOperation(this, &channels[i], build_) );
+	}
+
+	// A single channel is prepared by the calling thread.
+	util_workerPool::getInstance()->runAndWait( operations );
+}
+
+void visual_distortion::buildChannel( channelSetup& channel_ )
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+    // load the distortion map and blend map
+	if ( !osgDB::fileExists( channel_.distortMapFileName ) )
+	{
+		OSG_NOTIFY(osg::FATAL) << "ERROR: Distortionmap file'" << channel_.distortMapFileName << "' not found! Please change the channelname, filename or copy the desired file to the applications root folder!" << std::endl;
+		exit(-1);
+	}
+	if ( !osgDB::fileExists( channel_.blendMapFileName ) )
+	{
+		OSG_NOTIFY(osg::FATAL) << "ERROR: Blendmap file'" << channel_.blendMapFileName << "' not found! Please change the channelname, filename or copy the desired file to the applications root folder!" << std::endl;
+		exit(-1);
+	}
+
+	osg::ref_ptr<osg::Image> distortImage = readMapImage( channel_.distortMapFileName );
+	osg::ref_ptr<osg::Image> blendImage = readMapImage( channel_.blendMapFileName );
+
+	channel_.data.vertices = new osg::Vec2Array;
+	channel_.data.texcoords = new osg::Vec2Array;
+	channel_.data.indices = new osg::DrawElementsUInt(GL_TRIANGLES);
+
+    if (distortImage.valid() && !useShaderDistortion)
     {
-        // load distortion map texture file
-        osg::Image* image = osgDB::readImageFile(foundFileName);
-        if (image)
-        {
-			osg::Texture2D* texture = new osg::Texture2D;
-            texture->setImage(image);
-            texture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::NEAREST);
-            texture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::NEAREST);
-            texture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::CLAMP_TO_EDGE);
-            texture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::CLAMP_TO_EDGE);
-            return texture;
-        }
+		// decode the distortion map into an adaptive mesh with normalized positions
+		distortion_meshGenerator generator(distortImage.get(), tex_width, tex_height);
+		generator.setTolerance(meshTolerance);
+		generator.setLevels(meshMinLevel, meshMaxLevel);
+		generator.generate(channel_.data.vertices.get(), channel_.data.texcoords.get(), channel_.data.indices.get());
+
+		// Report the deviation from the distortion map in comparison with the formerly used uniform 128x128 grid.
+		distortion_meshGenerator::errorReport report = generator.computeError(channel_.data.vertices.get(), channel_.data.texcoords.get(), channel_.data.indices.get());
+		osg::ref_ptr<osg::Vec2Array> uniformVertices = new osg::Vec2Array;
+		osg::ref_ptr<osg::Vec2Array> uniformTexcoords = new osg::Vec2Array;
+		osg::ref_ptr<osg::DrawElementsUInt> uniformIndices = new osg::DrawElementsUInt(GL_TRIANGLES);
+		generator.generateUniform(128, uniformVertices.get(), uniformTexcoords.get(), uniformIndices.get());
+		distortion_meshGenerator::errorReport uniformReport = generator.computeError(uniformVertices.get(), uniformTexcoords.get(), uniformIndices.get());
+
+		OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Distortion mesh error in texels of the " << tex_width << "x" << tex_height << " scene texture:" << std::endl;
+		OSG_NOTIFY(osg::ALWAYS) << "  adaptive (tolerance " << meshTolerance << "): " << report.numVertices << " vertices, " << report.numTriangles << " triangles, max error " << report.maxError << ", mean error " << report.meanError << std::endl;
+		OSG_NOTIFY(osg::ALWAYS) << "  uniform 128x128: " << uniformReport.numVertices << " vertices, " << uniformReport.numTriangles << " triangles, max error " << uniformReport.maxError << ", mean error " << uniformReport.meanError << std::endl;
+    }
+    else
+    {
+		// The shader distortion samples the distortion map per fragment and requires only a single quad.
+		distortion_meshGenerator generator(NULL, tex_width, tex_height);
+		generator.generateUniform(2, channel_.data.vertices.get(), channel_.data.texcoords.get(), channel_.data.indices.get());
     }
 
-    OSG_NOTIFY(osg::WARN) << "File \"" << fileName << "\" not found." << std::endl;
+	// The blend map is not warped.
+	channel_.data.texcoords2 = new osg::Vec2Array(channel_.data.vertices->begin(), channel_.data.vertices->end());
+
+	// The distortion map is sampled by the shader, the CPU distortion requires only the mesh.
+	channel_.data.distortImage = useShaderDistortion ? distortImage.get() : NULL;
+	channel_.data.blendImage = blendImage;
+	channel_.data.frustumValid = channel_.parser->isConfigParsed();
+	channel_.data.frustum = channel_.parser->getFrustumDataset();
+	channel_.data.rotation = channel_.parser->getRotationDataset();
+	channel_.data.translation = channel_.parser->getTranslationDataset();
+
+	OSG_NOTIFY(osg::ALWAYS) << "visual_distortion: Channel built in " << osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) << " ms." << std::endl;
+
+	// Float maps are mapped directly on every start, a copy in the cache would only slow down loading.
+	distortion_meshCache::channelData cacheData = channel_.data;
+	if( distortion_floatMap::isFloatMap( channel_.distortMapFileName ) )
+		cacheData.distortImage = NULL;
+	if( distortion_floatMap::isFloatMap( channel_.blendMapFileName ) )
+		cacheData.blendImage = NULL;
 
-    return NULL;
+	if( !distortion_meshCache::write( channel_.cacheFileName, getChannelSourceFiles(channel_), getMeshBuildOptions(), cacheData ) )
+		OSG_NOTIFY(osg::WARN) << "WARNING: Unable to write distortion cache '" << channel_.cacheFileName << "', the channel is built again on next start." << std::endl;
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ using namespace osgVisual;
 
 visual_debug_hud::visual_debug_hud(void)
 {
+	lat = lon = alt = hat = hot = 0.0;
 }
 
 visual_debug_hud::~visual_debug_hud(void)
@@ -37,9 +38,11 @@ bool visual_debug_hud::init( osgViewer::Viewer *viewer_, osg::CoordinateSystemNo
    	
 	visual_draw2D::getInstance()->addDrawContent( addContent(), "HUD" );
 
-	// Set callback.
-	updateCallback = new HudUpdateCallback( rootNode_, viewer_->getCamera() );
-	this->setEventCallback( updateCallback );
+	// Register frame jobs.
+	queryJob = new hudQueryJob( this, rootNode_, viewer_->getCamera() );
+	textJob = new hudTextJob( this );
+	util_taskScheduler::getInstance()->addJob( queryJob.get() );
+	util_taskScheduler::getInstance()->addJob( textJob.get() );
 
 	isInitialized = true;
 
@@ -53,9 +56,11 @@ void visual_debug_hud::shutdown()
 		// Remove Draw Content 
 		visual_draw2D::getInstance()->removeDrawContent("HUD");
 
-		// Remove updatecallback
-		this->removeEventCallback( updateCallback );
-		updateCallback = NULL;
+		// Remove frame jobs
+		util_taskScheduler::getInstance()->removeJob( queryJob.get() );
+		util_taskScheduler::getInstance()->removeJob( textJob.get() );
+		queryJob = NULL;
+		textJob = NULL;
 	}
 }
 
@@ -123,26 +128,23 @@ osg::ref_ptr<osg::Geode> visual_debug_hud::addContent()
 	return hudGeode.get();
 }
 
-void visual_debug_hud::HudUpdateCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
+visual_debug_hud::hudQueryJob::hudQueryJob(visual_debug_hud* hud_, osg::CoordinateSystemNode* csn_, osg::Camera* sceneCamera_)
+	: util_taskScheduler::job("visual_debug_hud terrain query", ORDER_DISPLAY), hud(hud_), csn(csn_), sceneCamera(sceneCamera_)
 {
-	visual_debug_hud* hud = dynamic_cast<visual_debug_hud*>(node);
-	if ( !hud )
-	{
-		OSG_NOTIFY(osg::FATAL) << "ERROR : No object found. Unable to apply this callback!" << std::endl;
-		return;
-	}
-
-	// Retrieving new HUD values
+	// The terrain queries attach completed KD-trees to the terrain, see util_kdTreeBuilder.
+	writes("scene graph");
+	reads("camera");
+	writes("hud values");
+}
 
-	double lat = 0;
-	double lon = 0;
-	double hat = 0;
-	double hot = 0;
-	double alt = 0;
+void visual_debug_hud::hudQueryJob::run( unsigned int begin_, unsigned int end_ )
+{
+	OSGVISUAL_ALLOC_SCOPE(TERRAIN);
 
-	util::getWGS84ofCamera( sceneCamera, csn, lat, lon, alt ); 
-	util::queryHeightAboveTerrainInWGS84(hat, csn, lat, lon, alt);
-	util::queryHeightOfTerrain(hot, csn, lat, lon);
+	// Retrieving new HUD values
+	util::getWGS84ofCamera( sceneCamera, csn, hud->lat, hud->lon, hud->alt ); 
+	util::queryHeightAboveTerrainInWGS84(hud->hat, csn, hud->lat, hud->lon, hud->alt);
+	util::queryHeightOfTerrain(hud->hot, csn, hud->lat, hud->lon);
 
 	/*double x = 0;
 	double y = 0;
@@ -151,36 +153,48 @@ void visual_debug_hud::HudUpdateCallback::operator()(osg::Node* node, osg::NodeV
 	util::getXYZofCamera( sceneCamera, x, y, z ); 
 	hat = terrainQuery::computeHeightAboveTerrain(csn, osg::Vec3d(x,y,z), terrainQuery::PAGE_HIGHEST_LOD);
 	hot = terrainQuery::computeHeightOfTerrain(csn, osg::Vec3d(x,y,z), terrainQuery::PAGE_HIGHEST_LOD);*/
+}
 
+visual_debug_hud::hudTextJob::hudTextJob(visual_debug_hud* hud_)
+	: util_taskScheduler::job("visual_debug_hud update", ORDER_APPLY, true), hud(hud_)
+{
+	reads("hud values");
+	writes("hud texts");
+}
+
+void visual_debug_hud::hudTextJob::run( unsigned int begin_, unsigned int end_ )
+{
+	OSGVISUAL_ALLOC_SCOPE(HUD);
 
-	// Updating Display Elements:
-	std::ostringstream valuestring;
-	
-	valuestring.str("");
-	valuestring << osg::RadiansToDegrees( lat );
-	hud->textLat->setText("LAT: "+valuestring.str());
+	// Updating Display Elements: the texts are formatted in the frame arena.
+	util_frameString valuestring;
 
-	valuestring.str("");
-	valuestring << osg::RadiansToDegrees( lon );
-	hud->textLon->setText("LON: "+valuestring.str());
+	valuestring.appendFormat( "LAT: %g", osg::RadiansToDegrees( hud->lat ) );
+	updateText( hud->textLat.get(), hud->displayedLat, valuestring );
 
-	valuestring << std::fixed;
-	valuestring.precision(2);
-	valuestring.fill('0');
+	valuestring.clear();
+	valuestring.appendFormat( "LON: %g", osg::RadiansToDegrees( hud->lon ) );
+	updateText( hud->textLon.get(), hud->displayedLon, valuestring );
 
-	valuestring.width(8);
-	valuestring.str("");
-	valuestring << alt;
-	hud->textAlt->setText("ALT: "+valuestring.str());
+	valuestring.clear();
+	valuestring.appendFormat( "ALT: %08.2f", hud->alt );
+	updateText( hud->textAlt.get(), hud->displayedAlt, valuestring );
 
+	valuestring.clear();
+	valuestring.appendFormat( "HAT: %08.2f", hud->hat );
+	updateText( hud->textHat.get(), hud->displayedHat, valuestring );
 
-	valuestring.width(8);
-	valuestring.str("");
-	valuestring << hat;
-	hud->textHat->setText("HAT: "+valuestring.str());
+	valuestring.clear();
+	valuestring.appendFormat( "HOT: %08.2f", hud->hot );
+	updateText( hud->textHot.get(), hud->displayedHot, valuestring );
+}
+
+void visual_debug_hud::hudTextJob::updateText( osgText::Text* text_, std::string& displayed_, const util_frameString& value_ )
+{
+	// osgText rebuilds all glyphs on setText(), so skip unchanged texts.
+	if( value_.equals( displayed_ ) )
+		return;
 
-	valuestring.width(8);
-	valuestring.str("");
-	valuestring << hot;
-	hud->textHot->setText("HOT: "+valuestring.str());
+	displayed_.assign( value_.c_str(), value_.length() );
+	text_->setText( displayed_ );
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 */
 
 #include <dataIO_extLinkDummy.h>
+#include <util_log.h>
 
 #include <visual_dataIO.h>	// include in.cpp to avoid circular inclusion (visual_dataIO <-> extLinkDummy)
 
@@ -31,13 +32,13 @@ dataIO_extLinkDummy::~dataIO_extLinkDummy(void)
 	OSG_NOTIFY( osg::ALWAYS ) << "extLinkDummy destroyed" << std::endl;
 }
 
-bool dataIO_extLinkDummy::init(xmlNode* configurationNode)
+bool dataIO_extLinkDummy::init(const util_config::node* configurationNode)
 {
 	OSG_NOTIFY( osg::ALWAYS ) << "extLinkDummy init()" << std::endl;
 	return true;
 }
 
-bool dataIO_extLinkDummy::processXMLConfiguration(xmlNode* extLinkConfig_)
+bool dataIO_extLinkDummy::processXMLConfiguration(const util_config::node* extLinkConfig_)
 {
 	OSG_NOTIFY( osg::ALWAYS ) << "extLinkDummy processXMLConfiguration()" << std::endl;
 	return true;
@@ -50,14 +51,14 @@ void dataIO_extLinkDummy::shutdown()
 
 bool dataIO_extLinkDummy::readTO_OBJvalues()
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "extLinkDummy readTO_OBJvalues()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "extLinkDummy readTO_OBJvalues()" << std::endl;
 
 	return true;
 }
 
-bool dataIO_extLinkDummy::writebackFROM_OBJvalues()
+bool dataIO_extLinkDummy::writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ )
 {
-	OSG_NOTIFY( osg::ALWAYS ) << "extLinkDummy writebackFROM_OBJvalues()" << std::endl;
+	OSGVISUAL_LOG_RATE( osg::ALWAYS, 1 ) << "extLinkDummy writebackFROM_OBJvalues()" << std::endl;
 
 	return true;
 }
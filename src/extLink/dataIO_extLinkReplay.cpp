@@ -0,0 +1,404 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <dataIO_extLinkReplay.h>
+#include <util_log.h>
+
+#include <visual_dataIO.h>	// include in.cpp to avoid circular inclusion (visual_dataIO <-> extLinkReplay)
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace osgVisual;
+
+/**
+ * \brief This class reads values from a mapped record and checks the bounds of the record.
+ *
+ */
+class recordReader
+{
+public:
+	recordReader( const unsigned char* data_, size_t size_ ) : position(data_), end(data_+size_) {};
+
+	bool read( void* value_, size_t size_ )
+	{
+		if( size_ > static_cast<size_t>(end-position) )
+			return false;
+		memcpy( value_, position, size_ );
+		position += size_;
+		return true;
+	};
+
+	const char* skip( size_t size_ )
+	{
+		if( size_ > static_cast<size_t>(end-position) )
+			return NULL;
+		const char* skipped = reinterpret_cast<const char*>( position );
+		position += size_;
+		return skipped;
+	};
+
+private:
+	const unsigned char* position;
+	const unsigned char* end;
+};
+
+// Orders the index entries by their recorded time.
+static bool frameBefore( const dataIO_recorder::indexEntry& entry_, double time_ )
+{
+	return entry_.time < time_;
+}
+
+dataIO_extLinkReplay::dataIO_extLinkReplay(std::vector<dataIO_slot *>& dataSlots_) : dataIO_extLink(dataSlots_)
+{
+	initialized = false;
+	speed = 1.0;
+	startTime = 0.0;
+	loop = false;
+	nextFrame = 0;
+	clockStarted = false;
+	clockStartTick = 0;
+	clockStartTime = 0.0;
+	finished = false;
+}
+
+dataIO_extLinkReplay::~dataIO_extLinkReplay(void)
+{
+}
+
+bool dataIO_extLinkReplay::init(const util_config::node* configurationNode)
+{
+	if (!configurationNode || !processXMLConfiguration(configurationNode))
+		return false;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "extLinkReplay init()" << std::endl;
+
+	file = new util_mappedFile();
+	dataIO_recorder::fileHeader header;
+	if( !file->open( filename ) || file->getSize() < sizeof(dataIO_recorder::fileHeader) )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "ERROR: Could not open the recording '" << filename << "', falling back to extLinkDummy" << std::endl;
+		file = NULL;
+		return false;
+	}
+
+	memcpy( &header, file->getData(), sizeof(dataIO_recorder::fileHeader) );
+	if( strncmp( header.magic, "OVRC", 4 ) != 0 || header.version != dataIO_recorder::FILE_VERSION )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "ERROR: '" << filename << "' is no recording of this version, falling back to extLinkDummy" << std::endl;
+		file = NULL;
+		return false;
+	}
+
+	if( !readIndex() )
+		scanRecords();
+
+	if( index.empty() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "ERROR: The recording '" << filename << "' contains no frames, falling back to extLinkDummy" << std::endl;
+		file = NULL;
+		return false;
+	}
+
+	seek( startTime );
+	initialized = true;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "extLinkReplay: Replaying " << index.size() << " frames (" << index.back().time << " s) from " << filename
+		<< " at speed " << speed << (loop ? ", looped" : "") << std::endl;
+	return true;
+}
+
+bool dataIO_extLinkReplay::processXMLConfiguration(const util_config::node* extLinkConfig_)
+{
+	// The replay is tried before the other implementations, so a configuration for another implementation is no warning.
+	bool isReplay = (extLinkConfig_->getString("implementation") == "replay");
+	filename = extLinkConfig_->getString( "filename", filename );
+	speed = extLinkConfig_->getDouble( "speed", speed );
+	startTime = extLinkConfig_->getDouble( "starttime", startTime );
+	loop = extLinkConfig_->getBool( "loop", loop );
+
+	if( speed < 0.0 )
+		speed = 0.0;
+
+	return isReplay;
+}
+
+void dataIO_extLinkReplay::shutdown()
+{
+	OSG_NOTIFY( osg::ALWAYS ) << "extLinkReplay shutdown()" << std::endl;
+
+	initialized = false;
+	index.clear();
+	slots.clear();
+	file = NULL;
+}
+
+bool dataIO_extLinkReplay::readTO_OBJvalues()
+{
+	if( !initialized || index.empty() )
+		return false;
+
+	if( nextFrame >= index.size() )
+	{
+		if( !loop )
+		{
+			if( !finished )
+				OSG_NOTIFY( osg::ALWAYS ) << "extLinkReplay: End of the recording reached, holding the values of the last frame." << std::endl;
+			finished = true;
+			return true;
+		}
+		seek( startTime );
+	}
+
+	unsigned int frame = nextFrame;
+	if( speed > 0.0 )
+	{
+		osg::Timer_t now = osg::Timer::instance()->tick();
+		if( !clockStarted )
+		{
+			clockStartTick = now;
+			clockStartTime = index[frame].time;
+			clockStarted = true;
+		}
+
+		// Not due yet: keep the values of the last replayed frame.
+		double recordedTime = clockStartTime + osg::Timer::instance()->delta_s( clockStartTick, now ) * speed;
+		if( index[frame].time > recordedTime )
+			return true;
+
+		// Each frame contains all values, so overdue frames are skipped.
+		while( frame+1 < index.size() && index[frame+1].time <= recordedTime )
+			frame++;
+	}
+
+	nextFrame = frame+1;
+	if( !applyFrame( frame ) )
+	{
+		OSGVISUAL_LOG( osg::WARN ) << "extLinkReplay: Invalid frame record " << frame << " in " << filename << ", the recording is cut off there." << std::endl;
+		index.resize( frame );
+		return false;
+	}
+
+	return true;
+}
+
+bool dataIO_extLinkReplay::writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ )
+{
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "extLinkReplay writebackFROM_OBJvalues()" << std::endl;
+
+	return true;
+}
+
+bool dataIO_extLinkReplay::seek( double time_ )
+{
+	if( index.empty() )
+		return false;
+
+	// First frame at or after the requested time.
+	nextFrame = std::lower_bound( index.begin(), index.end(), time_, frameBefore ) - index.begin();
+	if( nextFrame >= index.size() )
+		nextFrame = index.size()-1;
+
+	clockStarted = false;
+	finished = false;
+	return true;
+}
+
+bool dataIO_extLinkReplay::readIndex()
+{
+	const unsigned char* data = file->getData();
+	size_t size = file->getSize();
+	if( size < sizeof(dataIO_recorder::fileHeader) + sizeof(dataIO_recorder::fileTrailer) )
+		return false;
+
+	dataIO_recorder::fileTrailer trailer;
+	size_t trailerOffset = size - sizeof(dataIO_recorder::fileTrailer);
+	memcpy( &trailer, data+trailerOffset, sizeof(dataIO_recorder::fileTrailer) );
+	if( strncmp( trailer.magic, "OVRI", 4 ) != 0 || trailer.indexOffset < sizeof(dataIO_recorder::fileHeader) || trailer.indexOffset + sizeof(dataIO_recorder::recordHeader) > trailerOffset )
+		return false;
+
+	dataIO_recorder::recordHeader header;
+	size_t indexOffset = static_cast<size_t>( trailer.indexOffset );
+	memcpy( &header, data+indexOffset, sizeof(dataIO_recorder::recordHeader) );
+	if( header.type != dataIO_recorder::INDEX_RECORD || header.size < sizeof(dataIO_recorder::recordHeader) || header.size > trailerOffset-indexOffset )
+		return false;
+
+	recordReader reader( data+indexOffset+sizeof(dataIO_recorder::recordHeader), header.size-sizeof(dataIO_recorder::recordHeader) );
+	dataIO_recorder::indexHeader info;
+	if( !reader.read( &info, sizeof(dataIO_recorder::indexHeader) ) || info.numFrames > size / sizeof(dataIO_recorder::indexEntry) )
+		return false;
+
+	// Slot records
+	for(unsigned int i=0; i<info.numSlots; i++)
+	{
+		dataIO_recorder::recordHeader slotHeader;
+		if( !reader.read( &slotHeader, sizeof(dataIO_recorder::recordHeader) ) || slotHeader.type != dataIO_recorder::SLOT_RECORD || slotHeader.size < sizeof(dataIO_recorder::recordHeader) )
+			return false;
+		size_t slotSize = slotHeader.size - sizeof(dataIO_recorder::recordHeader);
+		const char* slot = reader.skip( slotSize );
+		if( !slot || !readSlotRecord( reinterpret_cast<const unsigned char*>(slot), slotSize ) )
+			return false;
+	}
+
+	// Frame index
+	index.resize( info.numFrames );
+	if( info.numFrames > 0 && !reader.read( &index[0], info.numFrames*sizeof(dataIO_recorder::indexEntry) ) )
+	{
+		index.clear();
+		return false;
+	}
+	for(unsigned int i=0; i<index.size(); i++)
+	{
+		if( index[i].offset < sizeof(dataIO_recorder::fileHeader) || index[i].offset >= trailer.indexOffset )
+		{
+			index.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void dataIO_extLinkReplay::scanRecords()
+{
+	const unsigned char* data = file->getData();
+	size_t size = file->getSize();
+	index.clear();
+	slots.clear();
+
+	size_t offset = sizeof(dataIO_recorder::fileHeader);
+	while( offset + sizeof(dataIO_recorder::recordHeader) <= size )
+	{
+		dataIO_recorder::recordHeader header;
+		memcpy( &header, data+offset, sizeof(dataIO_recorder::recordHeader) );
+		if( header.size < sizeof(dataIO_recorder::recordHeader) || header.size % 8 != 0 || header.size > size-offset )
+			break;
+
+		const unsigned char* content = data + offset + sizeof(dataIO_recorder::recordHeader);
+		size_t contentSize = header.size - sizeof(dataIO_recorder::recordHeader);
+		if( header.type == dataIO_recorder::SLOT_RECORD )
+		{
+			if( !readSlotRecord( content, contentSize ) )
+				break;
+		}
+		else if( header.type == dataIO_recorder::FRAME_RECORD && contentSize >= sizeof(dataIO_recorder::frameRecord) )
+		{
+			dataIO_recorder::frameRecord frame;
+			memcpy( &frame, content, sizeof(dataIO_recorder::frameRecord) );
+
+			dataIO_recorder::indexEntry entry;
+			entry.offset = offset;
+			entry.time = frame.time;
+			entry.frameID = frame.frameID;
+			entry.reserved = 0;
+			index.push_back( entry );
+		}
+		else	// Index record, or the zeros behind the last record of a recording which was not closed.
+			break;
+
+		offset += header.size;
+	}
+
+	OSG_NOTIFY( osg::NOTICE ) << "extLinkReplay: No index found in " << filename << ", scanned " << index.size() << " frames." << std::endl;
+}
+
+bool dataIO_extLinkReplay::readSlotRecord( const unsigned char* record_, size_t size_ )
+{
+	recordReader reader( record_, size_ );
+	dataIO_recorder::slotRecord record;
+	if( !reader.read( &record, sizeof(dataIO_recorder::slotRecord) ) )
+		return false;
+
+	const char* name = reader.skip( record.nameLength );
+	if( !name || record.index >= file->getSize() )
+		return false;
+
+	if( record.index >= slots.size() )
+		slots.resize( record.index+1 );
+
+	replaySlot& slot = slots[record.index];
+	slot.variableName.assign( name, record.nameLength );
+	slot.direction = record.direction == dataIO_slot::FROM_OBJ ? dataIO_slot::FROM_OBJ : dataIO_slot::TO_OBJ;
+	slot.variableType = record.variableType == dataIO_slot::STRING ? dataIO_slot::STRING : dataIO_slot::DOUBLE;
+	slot.slot = NULL;
+	slot.lastString.clear();
+	slot.defined = true;
+	return true;
+}
+
+bool dataIO_extLinkReplay::applyFrame( unsigned int frame_ )
+{
+	const dataIO_recorder::indexEntry& entry = index[frame_];
+	const unsigned char* data = file->getData();
+	size_t size = file->getSize();
+	if( entry.offset + sizeof(dataIO_recorder::recordHeader) > size )
+		return false;
+
+	dataIO_recorder::recordHeader header;
+	size_t offset = static_cast<size_t>( entry.offset );
+	memcpy( &header, data+offset, sizeof(dataIO_recorder::recordHeader) );
+	if( header.type != dataIO_recorder::FRAME_RECORD || header.size < sizeof(dataIO_recorder::recordHeader) || header.size > size-offset )
+		return false;
+
+	recordReader reader( data+offset+sizeof(dataIO_recorder::recordHeader), header.size-sizeof(dataIO_recorder::recordHeader) );
+	dataIO_recorder::frameRecord frame;
+	if( !reader.read( &frame, sizeof(dataIO_recorder::frameRecord) ) )
+		return false;
+	viewMatrix.set( frame.viewMatrix );
+
+	// Only the TO_OBJ values are replayed, the slots are resolved by name once.
+	visual_dataIO* dataIO = visual_dataIO::getInstance();
+	for(unsigned int i=0; i<frame.numValues; i++)
+	{
+		if( i >= slots.size() || !slots[i].defined )
+			return false;
+
+		replaySlot& slot = slots[i];
+		if( slot.variableType == dataIO_slot::DOUBLE )
+		{
+			double value;
+			if( !reader.read( &value, sizeof(double) ) )
+				return false;
+			if( slot.direction != dataIO_slot::TO_OBJ )
+				continue;
+
+			if( slot.slot )
+				dataIO->setSlotValue( slot.slot, value );
+			else
+				slot.slot = dataIO->setSlotData( slot.variableName, dataIO_slot::TO_OBJ, value );
+		}
+		else
+		{
+			unsigned int length;
+			const char* text = reader.read( &length, sizeof(unsigned int) ) ? reader.skip( length ) : NULL;
+			if( !text )
+				return false;
+			if( slot.direction != dataIO_slot::TO_OBJ )
+				continue;
+
+			// Strings are only set when they change, setSlotData() copies them.
+			if( !slot.slot || slot.lastString.compare( 0, std::string::npos, text, length ) != 0 )
+			{
+				slot.lastString.assign( text, length );
+				slot.slot = dataIO->setSlotData( slot.variableName, dataIO_slot::TO_OBJ, slot.lastString );
+			}
+		}
+	}
+
+	// The executers behind the values are not replayed.
+	return true;
+}
@@ -15,6 +15,7 @@
 */
 
 #include <dataIO_extLinkVCL.h>
+#include <util_log.h>
 
 #include <visual_dataIO.h>	// include in.cpp to avoid circular inclusion (visual_dataIO <-> extLinkVCL)
 
@@ -30,7 +31,7 @@ dataIO_extLinkVCL::~dataIO_extLinkVCL(void)
 	OSG_NOTIFY( osg::ALWAYS ) << "extLinkVCL destroyed" << std::endl;
 }
 
-bool dataIO_extLinkVCL::init(xmlNode* configurationNode)
+bool dataIO_extLinkVCL::init(const util_config::node* configurationNode)
 {
 	if (!configurationNode || !processXMLConfiguration(configurationNode))
 		return false;
@@ -53,28 +54,16 @@ bool dataIO_extLinkVCL::init(xmlNode* configurationNode)
 	return true;
 }
 
-bool dataIO_extLinkVCL::processXMLConfiguration(xmlNode* extLinkConfig_)
+bool dataIO_extLinkVCL::processXMLConfiguration(const util_config::node* extLinkConfig_)
 {
+	if( extLinkConfig_->hasAttribute("implementation") && extLinkConfig_->getString("implementation") != "vcl" )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "WARNING: extLink configuration does not match the currently used 'vcl' implementation, falling back to extLinkDummy" << std::endl;
+		return false;
+	}
+
 	// Extract VCL config file
-	xmlAttr  *attr = extLinkConfig_->properties;
-	while ( attr ) 
-	{ 
-		std::string attr_name=reinterpret_cast<const char*>(attr->name);
-		std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-		if( attr_name == "implementation" )
-		{
-			if(attr_value != "vcl")
-			{
-				OSG_NOTIFY( osg::ALWAYS ) << "WARNING: extLink configuration does not match the currently used 'vcl' implementation, falling back to extLinkDummy" << std::endl;
-				return false;
-			}
-		}
-		if( attr_name == "filename" )
-		{
-			VCLConfigFilename = attr_value;
-		}
-		attr = attr->next; 
-	}	// WHILE attrib END
+	VCLConfigFilename = extLinkConfig_->getString( "filename", VCLConfigFilename );
 
 	return true;
 }
@@ -86,7 +75,7 @@ void dataIO_extLinkVCL::shutdown()
 
 bool dataIO_extLinkVCL::readTO_OBJvalues()
 {
-	OSG_NOTIFY( osg::INFO ) << "extLinkVCL readTO_OBJvalues()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "extLinkVCL readTO_OBJvalues()" << std::endl;
 
 	// perform external data exchange
 	CVCLIO::GetInstance().DoDataExchange();
@@ -104,9 +93,9 @@ bool dataIO_extLinkVCL::readTO_OBJvalues()
 	return true;
 }
 
-bool dataIO_extLinkVCL::writebackFROM_OBJvalues()
+bool dataIO_extLinkVCL::writebackFROM_OBJvalues( const dataIO_slotSnapshot* snapshot_ )
 {
-	OSG_NOTIFY( osg::INFO ) << "extLinkVCL writebackFROM_OBJvalues()" << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "extLinkVCL writebackFROM_OBJvalues()" << std::endl;
 
 	// write FROM_OBJ values into VCL
 	for(unsigned int i=0;i<extLinkChannels.size();i++)
@@ -114,7 +103,7 @@ bool dataIO_extLinkVCL::writebackFROM_OBJvalues()
 		if(extLinkSlots[i]->getdataDirection() == osgVisual::dataIO_slot::FROM_OBJ && extLinkSlots[i]->getvarType() == osgVisual::dataIO_slot::DOUBLE)
 		{
 			//Copy data from slot to VCL. IMPORTANT: Due to VCL's string incapability only double slots are filled.
-			extLinkChannels[i]->SetValue( osgVisual::visual_dataIO::getInstance()->getSlotDataAsDouble( extLinkSlots[i]->getVariableName(), osgVisual::dataIO_slot::FROM_OBJ ) );
+			extLinkChannels[i]->SetValue( snapshot_->getSlotDataAsDouble( extLinkSlots[i]->getVariableName(), osgVisual::dataIO_slot::FROM_OBJ ) );
 		}	// IF (FROM_OBJ) END
 	}
 
@@ -135,7 +124,7 @@ bool dataIO_extLinkVCL::parseVCLConfig()
 	if (doc == NULL)
 	{
 		configFileValid = false;
-		std::cout << "error: could not parse file" << VCLConfigFilename;
+		OSGVISUAL_LOG( osg::WARN ) << "error: could not parse file" << VCLConfigFilename << std::endl;
 	}
 	else
 	{
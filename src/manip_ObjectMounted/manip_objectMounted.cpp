@@ -28,6 +28,37 @@ objectMountedManipulator::objectMountedManipulator()
 
 objectMountedManipulator::~objectMountedManipulator()
 {
+	setAttachedObject( NULL );
+}
+
+void objectMountedManipulator::setAttachedObject( osgVisual::visual_object* object_ )
+{
+	attachedObject = object_;
+
+	// The object matrices are calculated by the frame jobs after the event traversal, so the matrix is taken by a frame job too.
+	if( attachedObject.valid() && !matrixJob.valid() )
+	{
+		matrixJob = new cameraMatrixJob( this );
+		util_taskScheduler::getInstance()->addJob( matrixJob.get() );
+	}
+	else if( !attachedObject.valid() && matrixJob.valid() )
+	{
+		util_taskScheduler::getInstance()->removeJob( matrixJob.get() );
+		matrixJob = NULL;
+	}
+}
+
+objectMountedManipulator::cameraMatrixJob::cameraMatrixJob( objectMountedManipulator* manipulator_ )
+	: util_taskScheduler::job("objectMountedManipulator camera", ORDER_APPLY, true), manipulator(manipulator_)
+{
+	reads("object matrices");
+	writes("camera manipulator");
+}
+
+void objectMountedManipulator::cameraMatrixJob::run( unsigned int begin_, unsigned int end_ )
+{
+	if( manipulator->attachedObject.valid() )
+		manipulator->setByMatrix( manipulator->attachedObject->getCameraMatrix() );
 }
 
 void objectMountedManipulator::init(const GUIEventAdapter& ,GUIActionAdapter& )
@@ -40,18 +71,7 @@ void objectMountedManipulator::getUsage(osg::ApplicationUsage& usage) const
 
 bool objectMountedManipulator::handle(const GUIEventAdapter& ea,GUIActionAdapter& us)
 {
-    switch(ea.getEventType())
-    {
-    case(GUIEventAdapter::FRAME):
-        if (attachedObject.valid())
-		{
-			setByMatrix( attachedObject->getCameraMatrix() );
-		}
-        return false;
-    default:
-        break;
-    }
-
+	// The camera matrix of the attached object is taken by the cameraMatrixJob, the FRAME event is too early in the frame.
     return false;
 }
 
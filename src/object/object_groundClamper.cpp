@@ -0,0 +1,315 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <object_groundClamper.h>
+
+#include <osgTerrain/Terrain>
+
+#include <osg/Vec2d>
+
+#include <cmath>
+
+using namespace osgVisual;
+
+object_groundClamper::object_groundClamper()
+{
+	searchAbove = 100.0;
+	searchBelow = 1000.0;
+	queryInterval = 1;
+	terrainSearchFailed = false;
+	terrainSearchNumChildren = 0;
+
+	// Use only the loaded tiles: paging in the highest LOD synchronously would stall the frame.
+	query.setDatabaseCacheReadCallback( NULL );
+}
+
+object_groundClamper::~object_groundClamper()
+{
+}
+
+object_groundClamper* object_groundClamper::getInstance()
+{
+	static object_groundClamper instance;
+	return &instance;
+}
+
+void object_groundClamper::init( osgViewer::Viewer* viewer_, osg::CoordinateSystemNode* rootNode_ )
+{
+	viewer = viewer_;
+	rootNode = rootNode_;
+
+	clampJob = new groundClampJob();
+	util_taskScheduler::getInstance()->addJob( clampJob.get() );
+}
+
+void object_groundClamper::shutdown()
+{
+	if( clampJob.valid() )
+		util_taskScheduler::getInstance()->removeJob( clampJob.get() );
+
+	clampJob = NULL;
+	clampObjects.clear();
+	points.clear();
+	query.clearSegments();
+}
+
+void object_groundClamper::addObject( visual_object* object_ )
+{
+	for(unsigned int i=0; i<clampObjects.size(); i++)
+	{
+		if( clampObjects[i] == object_ )
+			return;
+	}
+	clampObjects.push_back( object_ );
+
+	// The points of the last query index clampObjects, so the next update has to query again.
+	points.clear();
+}
+
+void object_groundClamper::removeObject( visual_object* object_ )
+{
+	for(unsigned int i=0; i<clampObjects.size(); i++)
+	{
+		if( clampObjects[i] == object_ )
+		{
+			clampObjects.erase( clampObjects.begin()+i );
+			points.clear();
+			return;
+		}
+	}
+}
+
+object_groundClamper::groundClampJob::groundClampJob()
+	: util_taskScheduler::job("object_groundClamper", ORDER_GROUND_CLAMPING)
+{
+	// The terrain queries attach completed KD-trees to the terrain, see util_kdTreeBuilder.
+	writes("scene graph");
+	reads("objects");
+	writes("objects");
+	writes("object matrices");
+}
+
+void object_groundClamper::groundClampJob::run( unsigned int begin_, unsigned int end_ )
+{
+	object_groundClamper* clamper = object_groundClamper::getInstance();
+	osg::ref_ptr<osgViewer::Viewer> tmpViewer;
+	bool hasFrameStamp = clamper->viewer.lock(tmpViewer) && tmpViewer->getFrameStamp();
+	clamper->update( hasFrameStamp ? tmpViewer->getFrameStamp()->getFrameNumber() : 0 );
+}
+
+void object_groundClamper::update( unsigned int frameNumber_ )
+{
+	OSGVISUAL_PROFILE_SCOPE("object_groundClamper update");
+	OSGVISUAL_ALLOC_SCOPE(TERRAIN);
+	osg::ref_ptr<osg::CoordinateSystemNode> csn;
+	if( clampObjects.empty() || !rootNode.lock(csn) || !csn->getEllipsoidModel() )
+		return;
+	osg::EllipsoidModel* ellipsoid = csn->getEllipsoidModel();
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+	// Remove deleted objects
+	bool objectsRemoved = false;
+	for(unsigned int i=0; i<clampObjects.size(); )
+	{
+		if( !clampObjects[i].valid() )
+		{
+			clampObjects.erase( clampObjects.begin()+i );
+			objectsRemoved = true;
+		}
+		else
+			i++;
+	}
+
+	// Between two terrain queries, clamp with the terrain heights of the last query. The batch is only valid if no object was removed.
+	if( queryInterval > 1 && frameNumber_ % queryInterval != 0 && !objectsRemoved && !points.empty() )
+	{
+		clampBatch( ellipsoid );
+		return;
+	}
+
+	// Find terrain, if not done yet. After a failed search, search again only when nodes were added to or removed from the root.
+	osg::ref_ptr<osg::Node> terrainNode;
+	if( !terrain.lock(terrainNode) && (!terrainSearchFailed || csn->getNumChildren() != terrainSearchNumChildren) )
+	{
+		terrainNode = util::findTopMostNodeOfType<osgTerrain::Terrain>( csn.get() );
+		terrain = terrainNode.get();
+		terrainSearchFailed = !terrainNode.valid();
+		terrainSearchNumChildren = csn->getNumChildren();
+	}
+
+	// Without osgTerrain::Terrain, intersect the whole scene except the objects.
+	osg::Node* queryRoot = terrainNode.valid() ? terrainNode.get() : csn.get();
+	osg::Node::NodeMask queryMask = terrainNode.valid() ? 0xffffffff : visual_object::NODEMASK_TERRAIN_QUERY;
+
+	// Collect the footprint points of all objects and sample the height grid.
+	points.clear();
+	query.clearSegments();
+	util_terrainHeightGrid* heightGrid = util_terrainHeightGrid::getInstance();
+	for(unsigned int i=0; i<clampObjects.size(); i++)
+	{
+		visual_object* object = clampObjects[i].get();
+
+		osg::Matrixd localToWorld;
+		ellipsoid->computeLocalToWorldTransformFromLatLongHeight( object->lat, object->lon, object->alt, localToWorld );
+		localToWorld.preMult( osg::Matrixd::rotate( -object->azimuthAngle_psi, osg::Vec3d(0.0, 0.0, 1.0) ) );
+
+		unsigned int numPoints = object->footprint.empty() ? 1 : object->footprint.size();
+		for(unsigned int j=0; j<numPoints; j++)
+		{
+			clampPoint point;
+			osg::Vec3d footprintPoint = object->footprint.empty() ? osg::Vec3d(0.0, 0.0, 0.0) : object->footprint[j];
+			point.object = i;
+			point.x = footprintPoint.x();
+			point.y = footprintPoint.y();
+			point.z = footprintPoint.z();
+			point.valid = false;
+			point.segment = -1;
+
+			// Geodetic position of the footprint point, using the heading only.
+			osg::Vec3d world = osg::Vec3d(point.x, point.y, 0.0) * localToWorld;
+			double height;
+			ellipsoid->convertXYZToLatLongHeight( world.x(), world.y(), world.z(), point.lat, point.lon, height );
+
+			if( heightGrid->queryHeightOfTerrain( point.height, point.lat, point.lon ) )
+				point.valid = true;
+			else
+			{
+				osg::Vec3d start, end;
+				ellipsoid->convertLatLongHeightToXYZ( point.lat, point.lon, object->alt + searchAbove, start.x(), start.y(), start.z() );
+				ellipsoid->convertLatLongHeightToXYZ( point.lat, point.lon, object->alt - searchBelow, end.x(), end.y(), end.z() );
+				point.segment = query.addSegment( start, end );
+			}
+
+			points.push_back( point );
+		}
+	}
+
+	// Intersect all remaining points in one batch.
+	if( query.getNumSegments() > 0 )
+	{
+		query.computeLineOfSight( queryRoot, queryMask );
+
+		for(unsigned int i=0; i<points.size(); i++)
+		{
+			clampPoint& point = points[i];
+			if( point.segment >= 0 && query.getSegmentHit( point.segment ) )
+			{
+				const osg::Vec3d& hitPoint = query.getSegmentHitPoint( point.segment );
+				double lat, lon;
+				ellipsoid->convertXYZToLatLongHeight( hitPoint.x(), hitPoint.y(), hitPoint.z(), lat, lon, point.height );
+				point.valid = true;
+			}
+		}
+	}
+
+	// Fit the terrain plane for each object.
+	clampBatch( ellipsoid );
+
+	// Stats
+	osg::ref_ptr<osgViewer::Viewer> tmpViewer;
+	if( viewer.lock(tmpViewer) && tmpViewer->getViewerStats() )
+	{
+		double timeTaken = osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() );
+		tmpViewer->getViewerStats()->setAttribute( frameNumber_, "Ground clamp time taken", timeTaken );
+		tmpViewer->getViewerStats()->setAttribute( frameNumber_, "Ground clamp objects", clampObjects.size() );
+		tmpViewer->getViewerStats()->setAttribute( frameNumber_, "Ground clamp points", points.size() );
+	}
+}
+
+void object_groundClamper::clampBatch( osg::EllipsoidModel* ellipsoid_ )
+{
+	unsigned int first = 0;
+	while( first < points.size() )
+	{
+		unsigned int count = 1;
+		while( first+count < points.size() && points[first+count].object == points[first].object )
+			count++;
+
+		visual_object* object = clampObjects[points[first].object].get();
+		clampObject( object, first, count );
+		object->computeMatrix( ellipsoid_ );
+
+		first += count;
+	}
+}
+
+void object_groundClamper::clampObject( visual_object* object_, unsigned int first_, unsigned int count_ )
+{
+	// Mean of all valid points. The target height of the object origin at a point is the terrain height minus the contact point height.
+	unsigned int n = 0;
+	double xm = 0.0, ym = 0.0, hm = 0.0;
+	for(unsigned int i=first_; i<first_+count_; i++)
+	{
+		if( !points[i].valid )
+			continue;
+		xm += points[i].x;
+		ym += points[i].y;
+		hm += points[i].height - points[i].z;
+		n++;
+	}
+	if( n == 0 )
+		return;	// No terrain found: keep the received altitude.
+	xm /= n;
+	ym /= n;
+	hm /= n;
+
+	// Least squares plane h = a + b*x + c*y through the centered points.
+	double sxx = 0.0, sxy = 0.0, syy = 0.0, sxh = 0.0, syh = 0.0;
+	for(unsigned int i=first_; i<first_+count_; i++)
+	{
+		if( !points[i].valid )
+			continue;
+		double dx = points[i].x - xm;
+		double dy = points[i].y - ym;
+		double dh = points[i].height - points[i].z - hm;
+		sxx += dx*dx;
+		sxy += dx*dy;
+		syy += dy*dy;
+		sxh += dx*dh;
+		syh += dy*dh;
+	}
+
+	double b = 0.0, c = 0.0;
+	bool slopeValid = false;
+	double det = sxx*syy - sxy*sxy;
+	double spread = sxx + syy;
+	if( n >= 3 && det > 1e-6*spread*spread )
+	{
+		b = (sxh*syy - syh*sxy) / det;
+		c = (syh*sxx - sxh*sxy) / det;
+		slopeValid = true;
+	}
+	else if( spread > 1e-6 )
+	{
+		// Points are collinear (e.g. two wheels): slope is only known along the line.
+		osg::Vec2d u = sxx >= syy ? osg::Vec2d(sxx, sxy) : osg::Vec2d(sxy, syy);
+		u.normalize();
+		double stt = u.x()*u.x()*sxx + 2.0*u.x()*u.y()*sxy + u.y()*u.y()*syy;
+		double slope = (u.x()*sxh + u.y()*syh) / stt;
+		b = slope * u.x();
+		c = slope * u.y();
+		slopeValid = true;
+	}
+
+	// Apply: height at the object origin, pitch from the slope along y (forward), bank from the slope along x (right).
+	object_->alt = hm - b*xm - c*ym + object_->groundClampOffset;
+	if( object_->groundClampAttitude && slopeValid )
+	{
+		object_->pitchAngle_theta = atan( c );
+		object_->bankAngle_phi = -atan( b );
+	}
+}
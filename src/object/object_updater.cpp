@@ -15,6 +15,7 @@
 */
 
 #include <object_updater.h>
+#include <util_log.h>
 
 using namespace osgVisual;
 
@@ -27,7 +28,8 @@ object_updater::object_updater(osgVisual::visual_object* object_ )
 	updater_rot_y_rad = object_->getName()+"_ROT_Y";
 	updater_rot_z_rad = object_->getName()+"_ROT_Z";
 	updater_label = object_->getName()+"_LABEL";
-	object_->addLabel("default", " ");
+	appliedLabel = " ";
+	object_->addLabel("default", appliedLabel);
 }
 
 object_updater::~object_updater(void)
@@ -36,7 +38,7 @@ object_updater::~object_updater(void)
 
 void object_updater::preUpdate(osgVisual::visual_object* object_ )
 {
-	OSG_NOTIFY( osg::INFO ) << "preUpdate visual Object " << object_->getName() << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "preUpdate visual Object " << object_->getName() << std::endl;
 	// perform this preUpdater...
 	//For each visual_object.member,
 	//	try to search according variable in dataIO with direction TO_OBJ and copy value to visual_object.
@@ -54,7 +56,14 @@ void object_updater::preUpdate(osgVisual::visual_object* object_ )
 	if(!updater_rot_x_rad.empty())
 		object_->bankAngle_phi = osgVisual::visual_dataIO::getInstance()->getSlotDataAsDouble(updater_rot_x_rad, osgVisual::dataIO_slot::TO_OBJ );
 	if(!updater_label.empty())
-		object_->updateLabelText("default", osgVisual::visual_dataIO::getInstance()->getSlotDataAsString(updater_label, osgVisual::dataIO_slot::TO_OBJ ));
+	{
+		std::string label = osgVisual::visual_dataIO::getInstance()->getSlotDataAsString(updater_label, osgVisual::dataIO_slot::TO_OBJ );
+		if( label != appliedLabel )
+		{
+			object_->updateLabelText("default", label);
+			appliedLabel = label;
+		}
+	}
 
 	// Finally execute nested PreUpdater
 	if ( updater.valid() )
@@ -63,7 +72,7 @@ void object_updater::preUpdate(osgVisual::visual_object* object_ )
 
 void object_updater::postUpdate(osgVisual::visual_object* object_ )
 {
-	OSG_NOTIFY( osg::INFO ) << "postUpdate visual Object " << object_->getName() << std::endl;
+	OSGVISUAL_LOG( osg::DEBUG_INFO ) << "postUpdate visual Object " << object_->getName() << std::endl;
 
 	// Finally execute nested PostUpdater
 	if ( updater.valid() )
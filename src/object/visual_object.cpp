@@ -15,9 +15,29 @@
 */
 
 #include <visual_object.h>
+#include <object_groundClamper.h>
+#include <util_log.h>
+
+#include <algorithm>
 
 using namespace osgVisual;
 
+const osg::Node::NodeMask visual_object::NODEMASK_TERRAIN_QUERY;
+
+// Models loaded by preloadGeometry(), consumed by loadGeometry().
+typedef std::multimap< std::string, osg::ref_ptr<osg::Node> > PreloadedGeometryMap;
+static PreloadedGeometryMap preloadedGeometry;
+static OpenThreads::Mutex preloadedGeometryMutex;
+
+// Visibility of the labels of all objects, applied by the position callback.
+static bool labelsVisible = true;
+
+// All objects, processed by the frame jobs. Only modified by the main thread outside of util_taskScheduler::runFrame().
+static std::vector<visual_object*> allObjects;
+static osg::ref_ptr<util_taskScheduler::job> updaterJob;
+static osg::ref_ptr<util_taskScheduler::job> transformJob;
+static osg::ref_ptr<util_taskScheduler::job> matrixJob;
+
 visual_object::visual_object( osg::CoordinateSystemNode* sceneRoot_, std::string nodeName_)
 {
 	// Add this node to Scenegraph
@@ -26,6 +46,9 @@ visual_object::visual_object( osg::CoordinateSystemNode* sceneRoot_, std::string
 	// Set Nodename for further identification
 	this->setName( nodeName_ );
 
+	// Exclude the object from terrain queries on the whole scene.
+	this->setNodeMask( ~NODEMASK_TERRAIN_QUERY );
+
 	// Set callback.
 	/** \todo: welcher update ist der richtige? voraussichtlich event.) */
 	//this->setUpdateCallback( new visual_objectPositionCallback() );
@@ -63,247 +86,296 @@ visual_object::visual_object( osg::CoordinateSystemNode* sceneRoot_, std::string
 	// Tracking ID
 	trackingId = -1;
 
+	// Ground clamping
+	groundClamp = false;
+	groundClampAttitude = true;
+	groundClampOffset = 0.0;
+
 	// Labelnode hinzufgen
 	labels = new osg::Geode();
 	this->addChild( labels ); 
+
+	// Frame jobs
+	transformPending = false;
+	matrixPending = false;
+	registerObject( this );
 }
 
 visual_object::~visual_object()
 {
+	unregisterObject( this );
+}
 
+void visual_object::registerObject( visual_object* object_ )
+{
+	if( allObjects.empty() )
+	{
+		updaterJob = new objectUpdaterJob();
+		transformJob = new objectTransformJob();
+		matrixJob = new objectMatrixJob();
+		// The updater job is registered first, so the transforms of the same order key use the positions of this frame.
+		util_taskScheduler::getInstance()->addJob( updaterJob.get() );
+		util_taskScheduler::getInstance()->addJob( transformJob.get() );
+		util_taskScheduler::getInstance()->addJob( matrixJob.get() );
+	}
+	allObjects.push_back( object_ );
 }
 
-visual_object* visual_object::createNodeFromXMLConfig(osg::CoordinateSystemNode* sceneRoot_, xmlNode* a_node)
+void visual_object::unregisterObject( visual_object* object_ )
 {
-	if(a_node == NULL)
+	std::vector<visual_object*>::iterator position = std::find( allObjects.begin(), allObjects.end(), object_ );
+	if( position == allObjects.end() )
+		return;
+
+	allObjects.erase( position );
+	if( allObjects.empty() )
+	{
+		util_taskScheduler::getInstance()->removeJob( updaterJob.get() );
+		util_taskScheduler::getInstance()->removeJob( transformJob.get() );
+		util_taskScheduler::getInstance()->removeJob( matrixJob.get() );
+		updaterJob = NULL;
+		transformJob = NULL;
+		matrixJob = NULL;
+	}
+}
+
+visual_object::objectUpdaterJob::objectUpdaterJob()
+	: util_taskScheduler::job("visual_object updaters", ORDER_OBJECTS, true)
+{
+	reads("dataIO slots");
+	writes("objects");
+}
+
+void visual_object::objectUpdaterJob::run( unsigned int begin_, unsigned int end_ )
+{
+	OSGVISUAL_ALLOC_SCOPE(OBJECT);
+	// execute preUpdater to get new data of the objects. The slot values of this frame are read by dataIO during the event traversal.
+	for(unsigned int i=0; i<allObjects.size(); i++)
+	{
+		visual_object* object = allObjects[i];
+		if( object->updater.valid() )
+			object->updater->preUpdate(object);
+	}
+}
+
+visual_object::objectTransformJob::objectTransformJob()
+	: util_taskScheduler::job("visual_object transforms", ORDER_OBJECTS)
+{
+	reads("objects");
+	writes("object matrices");
+	setGrainSize( 16 );
+}
+
+unsigned int visual_object::objectTransformJob::getNumItems()
+{
+	return allObjects.size();
+}
+
+void visual_object::objectTransformJob::run( unsigned int begin_, unsigned int end_ )
+{
+	OSGVISUAL_ALLOC_SCOPE(OBJECT);
+	for(unsigned int i=begin_; i<end_; i++)
+	{
+		visual_object* object = allObjects[i];
+		if( object->transformPending && object->ellipsoid.valid() )
+			object->computeMatrix( object->ellipsoid.get() );
+		object->transformPending = false;
+	}
+}
+
+visual_object::objectMatrixJob::objectMatrixJob()
+	: util_taskScheduler::job("visual_object matrices", ORDER_APPLY, true)
+{
+	reads("objects");
+	reads("object matrices");
+	writes("scene graph");
+	writes("dataIO slots");
+}
+
+void visual_object::objectMatrixJob::run( unsigned int begin_, unsigned int end_ )
+{
+	OSGVISUAL_ALLOC_SCOPE(OBJECT);
+	bool isSlave = visual_dataIO::getInstance()->isSlave();
+	for(unsigned int i=0; i<allObjects.size(); i++)
+	{
+		visual_object* object = allObjects[i];
+		object->applyMatrix();
+
+		// If SLAVE: execute postUpdater to pass new data of this object to dataIO.
+		if( isSlave && object->updater.valid() )
+			object->updater->postUpdate(object);
+	}
+}
+
+visual_object* visual_object::createNodeFromXMLConfig(osg::CoordinateSystemNode* sceneRoot_, const util_config::node* a_node)
+{
+	objectConfig config;
+	if( !parseXMLConfig(a_node, config) )
 		return NULL;
 
-	OSG_NOTIFY( osg::ALWAYS ) << __FUNCTION__ << " - Try to creating a new Model.." << std::endl;
-	
-	// Prepare Variables
-	std::string objectname="", filename="", label="";
-	bool dynamic = false;
-	int trackingID=-1;
-	double lat=0.0, lon=0.0, alt=0.0, rot_x=0.0, rot_y=0.0, rot_z=0.0;
-	double cam_trans_x=0.0, cam_trans_y=0.0, cam_trans_z=0.0, cam_rot_x=0.0, cam_rot_y=0.0, cam_rot_z=0.0;
-	double geometry_rot_x=0.0, geometry_rot_y=0.0, geometry_rot_z=0.0;
-	double geometry_scale_x=1.0, geometry_scale_y=1.0, geometry_scale_z=1.0;
-	osg::ref_ptr<osgVisual::object_updater> updater = NULL;
-	std::string updater_lat="", updater_lon="", updater_alt="", updater_rot_x="", updater_rot_y="", updater_rot_z="", updater_label="";
+	return createNodeFromConfig(sceneRoot_, config);
+}
+
+bool visual_object::parseXMLConfig(const util_config::node* a_node, objectConfig& config_)
+{
+	if(a_node == NULL)
+		return false;
 
 	// extract model properties
-	xmlAttr  *attr = a_node->properties;
-	while ( attr ) 
-	{ 
-		std::string attr_name=reinterpret_cast<const char*>(attr->name);
-		std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-		if( attr_name == "objectname" ) objectname = attr_value;
-		if( attr_name == "trackingid" ) trackingID = util::strToInt(attr_value);
-		if( attr_name == "label" ) label = attr_value;
-		if( attr_name == "dynamic" ) dynamic = util::strToBool(attr_value);
-
-		attr = attr->next; 
-	}
-	for (xmlNode *cur_node = a_node->children; cur_node; cur_node = cur_node->next)
+	config_.objectname = a_node->getString("objectname", config_.objectname);
+	config_.trackingID = a_node->getInt("trackingid", config_.trackingID);
+	config_.label = a_node->getString("label", config_.label);
+	config_.dynamic = a_node->getBool("dynamic", config_.dynamic);
+
+	const util_config::node::NodeList& children = a_node->getChildren();
+	for(unsigned int i=0; i<children.size(); i++)
 	{
-		std::string node_name=reinterpret_cast<const char*>(cur_node->name);
+		const util_config::node* cur_node = children[i].get();
+		const std::string& node_name = cur_node->getName();
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "position")
+		if(node_name == "position")
 		{
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "lat" ) lat = osg::DegreesToRadians(util::strToDouble(attr_value));
-				if( attr_name == "lon" ) lon = osg::DegreesToRadians(util::strToDouble(attr_value));
-				if( attr_name == "alt" ) alt = util::strToDouble(attr_value);
-
-				attr = attr->next; 
-			}
+			config_.lat = osg::DegreesToRadians(cur_node->getDouble("lat", osg::RadiansToDegrees(config_.lat)));
+			config_.lon = osg::DegreesToRadians(cur_node->getDouble("lon", osg::RadiansToDegrees(config_.lon)));
+			config_.alt = cur_node->getDouble("alt", config_.alt);
 		}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "attitude")
+		if(node_name == "attitude")
 		{
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "rot_x" ) rot_x = osg::DegreesToRadians(util::strToDouble(attr_value));
-				if( attr_name == "rot_y" ) rot_y = osg::DegreesToRadians(util::strToDouble(attr_value));
-				if( attr_name == "rot_z" ) rot_z = osg::DegreesToRadians(util::strToDouble(attr_value));
-
-				attr = attr->next; 
-			}
+			config_.rot_x = osg::DegreesToRadians(cur_node->getDouble("rot_x", osg::RadiansToDegrees(config_.rot_x)));
+			config_.rot_y = osg::DegreesToRadians(cur_node->getDouble("rot_y", osg::RadiansToDegrees(config_.rot_y)));
+			config_.rot_z = osg::DegreesToRadians(cur_node->getDouble("rot_z", osg::RadiansToDegrees(config_.rot_z)));
 		}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "updater")
+		if(node_name == "updater")
 		{
-			for (xmlNode *sub_cur_node = cur_node->children; sub_cur_node; sub_cur_node = sub_cur_node->next)
-			{ 
-				std::string sub_node_name=reinterpret_cast<const char*>(sub_cur_node->name);
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "position")
-				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "lat" )
-							updater_lat = attr_value;
-						if( attr_name == "lon" )
-							updater_lon = attr_value;
-						if( attr_name == "alt" ) 
-							updater_alt = attr_value;
-						attr = attr->next; 
-					}
-				}
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "attitude")
+			const util_config::node::NodeList& updaterChildren = cur_node->getChildren();
+			for(unsigned int j=0; j<updaterChildren.size(); j++)
+			{
+				const util_config::node* sub_cur_node = updaterChildren[j].get();
+				const std::string& sub_node_name = sub_cur_node->getName();
+				if(sub_node_name == "position")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "rot_x" )
-							updater_rot_x = attr_value;
-						if( attr_name == "rot_y" )
-							updater_rot_y = attr_value;
-						if( attr_name == "rot_z" ) 
-							updater_rot_z = attr_value;
-						attr = attr->next; 
-					}
+					config_.updater_lat = sub_cur_node->getString("lat", config_.updater_lat);
+					config_.updater_lon = sub_cur_node->getString("lon", config_.updater_lon);
+					config_.updater_alt = sub_cur_node->getString("alt", config_.updater_alt);
 				}
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "label")
+				if(sub_node_name == "attitude")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "text" )
-							updater_label = attr_value;
-						attr = attr->next; 
-					}
+					config_.updater_rot_x = sub_cur_node->getString("rot_x", config_.updater_rot_x);
+					config_.updater_rot_y = sub_cur_node->getString("rot_y", config_.updater_rot_y);
+					config_.updater_rot_z = sub_cur_node->getString("rot_z", config_.updater_rot_z);
 				}
+				if(sub_node_name == "label")
+					config_.updater_label = sub_cur_node->getString("text", config_.updater_label);
 			}
 		}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "cameraoffset")
+		if(node_name == "cameraoffset")
 		{
-			for (xmlNode *sub_cur_node = cur_node->children; sub_cur_node; sub_cur_node = sub_cur_node->next)
+			const util_config::node::NodeList& offsetChildren = cur_node->getChildren();
+			for(unsigned int j=0; j<offsetChildren.size(); j++)
 			{
-				std::string sub_node_name=reinterpret_cast<const char*>(sub_cur_node->children->name);
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "translation")
+				const util_config::node* sub_cur_node = offsetChildren[j].get();
+				const std::string& sub_node_name = sub_cur_node->getName();
+				if(sub_node_name == "translation")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "trans_x" ) cam_trans_x = util::strToDouble(attr_value);
-						if( attr_name == "trans_y" ) cam_trans_y = util::strToDouble(attr_value);
-						if( attr_name == "trans_z" ) cam_trans_z = util::strToDouble(attr_value);
-
-						attr = attr->next; 
-					}
+					config_.cam_trans_x = sub_cur_node->getDouble("trans_x", config_.cam_trans_x);
+					config_.cam_trans_y = sub_cur_node->getDouble("trans_y", config_.cam_trans_y);
+					config_.cam_trans_z = sub_cur_node->getDouble("trans_z", config_.cam_trans_z);
 				}
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "rotation")
+				if(sub_node_name == "rotation")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "rot_x" ) cam_rot_x = osg::DegreesToRadians(util::strToDouble(attr_value));
-						if( attr_name == "rot_y" ) cam_rot_y = osg::DegreesToRadians(util::strToDouble(attr_value));
-						if( attr_name == "rot_z" ) cam_rot_z = osg::DegreesToRadians(util::strToDouble(attr_value));
-
-						attr = attr->next; 
-					}
+					config_.cam_rot_x = osg::DegreesToRadians(sub_cur_node->getDouble("rot_x", osg::RadiansToDegrees(config_.cam_rot_x)));
+					config_.cam_rot_y = osg::DegreesToRadians(sub_cur_node->getDouble("rot_y", osg::RadiansToDegrees(config_.cam_rot_y)));
+					config_.cam_rot_z = osg::DegreesToRadians(sub_cur_node->getDouble("rot_z", osg::RadiansToDegrees(config_.cam_rot_z)));
 				}
 			}
 		}
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "geometry")
+		if(node_name == "groundclamp")
 		{
-			// extract filename
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "filename" )
-					filename = attr_value;
-				attr = attr->next; 
-			}
+			config_.groundclamp = cur_node->getBool("enabled", config_.groundclamp);
+			if( cur_node->hasAttribute("mode") )
+				config_.groundclamp_attitude = (cur_node->getString("mode") != "altitude");
+			config_.groundclamp_offset = cur_node->getDouble("offset", config_.groundclamp_offset);
+
+			// Extract footprint points
+			std::vector<const util_config::node*> footprint = cur_node->getChildren("footprint");
+			for(unsigned int j=0; j<footprint.size(); j++)
+				config_.footprint.push_back( osg::Vec3d(footprint[j]->getDouble("x"), footprint[j]->getDouble("y"), footprint[j]->getDouble("z")) );
+		}
+
+		if(node_name == "geometry")
+		{
+			config_.filename = cur_node->getString("filename", config_.filename);
 
 			// Extract optional settings
-			for (xmlNode *sub_cur_node = cur_node->children; sub_cur_node; sub_cur_node = sub_cur_node->next)
+			const util_config::node::NodeList& geometryChildren = cur_node->getChildren();
+			for(unsigned int j=0; j<geometryChildren.size(); j++)
 			{
-				std::string sub_node_name=reinterpret_cast<const char*>(sub_cur_node->name);
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "offset")
+				const util_config::node* sub_cur_node = geometryChildren[j].get();
+				const std::string& sub_node_name = sub_cur_node->getName();
+				if(sub_node_name == "offset")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "rot_x" ) geometry_rot_x = osg::DegreesToRadians(util::strToDouble(attr_value));
-						if( attr_name == "rot_y" ) geometry_rot_y = osg::DegreesToRadians(util::strToDouble(attr_value));
-						if( attr_name == "rot_z" ) geometry_rot_z = osg::DegreesToRadians(util::strToDouble(attr_value));
-
-						attr = attr->next; 
-					}
+					config_.geometry_rot_x = osg::DegreesToRadians(sub_cur_node->getDouble("rot_x", osg::RadiansToDegrees(config_.geometry_rot_x)));
+					config_.geometry_rot_y = osg::DegreesToRadians(sub_cur_node->getDouble("rot_y", osg::RadiansToDegrees(config_.geometry_rot_y)));
+					config_.geometry_rot_z = osg::DegreesToRadians(sub_cur_node->getDouble("rot_z", osg::RadiansToDegrees(config_.geometry_rot_z)));
 				}
-				if(sub_cur_node->type == XML_ELEMENT_NODE && sub_node_name == "scalefactor")
+				if(sub_node_name == "scalefactor")
 				{
-					xmlAttr  *attr = sub_cur_node->properties;
-					while ( attr ) 
-					{ 
-						std::string attr_name=reinterpret_cast<const char*>(attr->name);
-						std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-						if( attr_name == "scale_x" ) geometry_scale_x = util::strToDouble(attr_value);
-						if( attr_name == "scale_y" ) geometry_scale_y = util::strToDouble(attr_value);
-						if( attr_name == "scale_z" ) geometry_scale_z = util::strToDouble(attr_value);
-
-						attr = attr->next; 
-					}
+					config_.geometry_scale_x = sub_cur_node->getDouble("scale_x", config_.geometry_scale_x);
+					config_.geometry_scale_y = sub_cur_node->getDouble("scale_y", config_.geometry_scale_y);
+					config_.geometry_scale_z = sub_cur_node->getDouble("scale_z", config_.geometry_scale_z);
 				}
 			}
 		}
 	}
 
+	return true;
+}
+
+visual_object* visual_object::createNodeFromConfig(osg::CoordinateSystemNode* sceneRoot_, const objectConfig& config_, osg::Node* geometry_)
+{
+	OSG_NOTIFY( osg::ALWAYS ) << __FUNCTION__ << " - Try to creating a new Model.." << std::endl;
 
-	osgVisual::visual_object* object = new osgVisual::visual_object( sceneRoot_, objectname );
-	object->lat = lat;
-	object->lon = lon;
-	object->alt = alt;
-	object->azimuthAngle_psi = rot_x;
-	object->pitchAngle_theta = rot_y;
-	object->bankAngle_phi = rot_z;
-	object->trackingId = trackingID;
-	if(label!="")
-		object->addLabel("default", label);
-	if(dynamic)
+	osg::ref_ptr<osgVisual::object_updater> updater = NULL;
+	osgVisual::visual_object* object = new osgVisual::visual_object( sceneRoot_, config_.objectname );
+	object->lat = config_.lat;
+	object->lon = config_.lon;
+	object->alt = config_.alt;
+	object->azimuthAngle_psi = config_.rot_x;
+	object->pitchAngle_theta = config_.rot_y;
+	object->bankAngle_phi = config_.rot_z;
+	object->trackingId = config_.trackingID;
+	if(config_.label!="")
+		object->addLabel("default", config_.label);
+	if(config_.dynamic)
 	{
 		updater = new osgVisual::object_updater(object);
 		object->addUpdater( updater );
 	}
-	object->setCameraOffset( cam_trans_x, cam_trans_y, cam_trans_z, cam_rot_x, cam_rot_y, cam_rot_z);
-	if(filename!="")
+	object->setCameraOffset( config_.cam_trans_x, config_.cam_trans_y, config_.cam_trans_z, config_.cam_rot_x, config_.cam_rot_y, config_.cam_rot_z);
+	if(geometry_ || config_.filename!="")
 	{
-		object->loadGeometry( filename );
-		object->setGeometryOffset( geometry_rot_x, geometry_rot_y, geometry_rot_z );
-		object->setScale( geometry_scale_x, geometry_scale_y, geometry_scale_z ); 
+		if(geometry_)
+			object->setGeometry( geometry_ );
+		else
+			object->loadGeometry( config_.filename );
+		object->setGeometryOffset( config_.geometry_rot_x, config_.geometry_rot_y, config_.geometry_rot_z );
+		object->setScale( config_.geometry_scale_x, config_.geometry_scale_y, config_.geometry_scale_z ); 
 	}
 
 	if(updater.valid())
 	{
-		updater->setUpdaterSlotNames( object, updater_lat, updater_lon, updater_alt, updater_rot_x, updater_rot_y, updater_rot_z, updater_label);
+		updater->setUpdaterSlotNames( object, config_.updater_lat, config_.updater_lon, config_.updater_alt, config_.updater_rot_x, config_.updater_rot_y, config_.updater_rot_z, config_.updater_label);
 	}
 
+	for(unsigned int i=0; i<config_.footprint.size(); i++)
+		object->addFootprintPoint( config_.footprint[i] );
+	if(config_.groundclamp)
+		object->setGroundClamp( true, config_.groundclamp_attitude, config_.groundclamp_offset );
+
 	OSG_NOTIFY( osg::ALWAYS ) << "Done." << std::endl;
 	return object;
 }
@@ -342,7 +414,7 @@ osg::Node* visual_object::findNodeByTrackingID(int trackingID, osg::Node* currNo
          foundNode = findNodeByTrackingID( trackingID, currGroup->getChild(i));
          if (foundNode)
 		 {
-			 std::cout << "Node gefunden in Ebene: " << i << std::endl;
+			 OSGVISUAL_LOG( osg::DEBUG_INFO ) << "Node gefunden in Ebene: " << i << std::endl;
             return foundNode; // found a match!
 		}
       }
@@ -377,6 +449,82 @@ void visual_object::setNewAttitude( double azimuthAngle_psi_, double pitchAngle_
 	bankAngle_phi = bankAngle_phi_;
 }
 
+void visual_object::calculateMatrix( osg::EllipsoidModel* ellipsoid_ )
+{
+	computeMatrix( ellipsoid_ );
+	applyMatrix();
+}
+
+void visual_object::computeMatrix( osg::EllipsoidModel* ellipsoid_ )
+{
+	osg::Matrixd matrix;
+
+	// Set position
+	ellipsoid_->computeLocalToWorldTransformFromLatLongHeight(lat, lon, alt, matrix);
+
+	// Set Upvector for position
+	double X,Y,Z;
+	ellipsoid_->convertLatLongHeightToXYZ(lat, lon, alt, X, Y, Z);
+	upVector = ellipsoid_->computeLocalUpVector(X,Y,Z);
+
+	// Set scale
+	osg::Matrixd scaleMatrix;
+	scaleMatrix.makeScale( scaleX, scaleY, scaleZ );
+	matrix.preMult( scaleMatrix );
+
+	// Set rotation
+	// rotation von links ranmultiplizieren, entspricht: matrix = rotation * matrix. Da rotation ein Quat ist, wre die direkte Multiplikation nur ber Umwege machbar.
+	// Rotate Object to Attitude.
+	osg::Matrixd rotationMatrix;
+	// Move Model by Azimuth
+	rotationMatrix.makeRotate( -azimuthAngle_psi, osg::Vec3d(0.0, 0.0, 1.0) );
+	matrix.preMult(rotationMatrix);	
+	// Move Model by Pitch
+	rotationMatrix.makeRotate( pitchAngle_theta, osg::Vec3d(1.0, 0.0, 0.0) );
+	matrix.preMult(rotationMatrix);
+	// Move Model by Bank
+	rotationMatrix.makeRotate( bankAngle_phi, osg::Vec3d(0.0, 1.0, 0.0) );
+	matrix.preMult(rotationMatrix);
+
+	// Also update camera matrix (without geometry offset, because camera is interested in the objects matrix, not in the model's matrix.)
+	cameraMatrix = matrix;
+	/** \todo : Clean up camera matrix management: try to solve it with a single matrix. (each frame two matrix mults less) */
+	// dont know, why this rotation is necessary - maybe manipulator and node MatrixTransform interpret a matrix in different way?
+	cameraMatrix.preMult( cameraTranslationOffset );
+	cameraMatrix.preMult( cameraRotationOffset );
+
+	// Set geometry correction
+	matrix.preMultRotate( geometry_offset_rotation );
+
+	// Keep the cumulated object matrix until it is applied as the matrix of this matrix transform
+	pendingMatrix = matrix;
+	matrixPending = true;
+}
+
+void visual_object::applyMatrix()
+{
+	if( !matrixPending )
+		return;
+
+	setMatrix( pendingMatrix );
+	matrixPending = false;
+}
+
+void visual_object::setGroundClamp( bool enabled_, bool clampAttitude_, double offset_ )
+{
+	groundClampAttitude = clampAttitude_;
+	groundClampOffset = offset_;
+
+	if( enabled_ == groundClamp )
+		return;
+
+	groundClamp = enabled_;
+	if( groundClamp )
+		object_groundClamper::getInstance()->addObject( this );
+	else
+		object_groundClamper::getInstance()->removeObject( this );
+}
+
 void visual_object::setGeometryOffset( double rotX_, double rotY_, double rotZ_ )
 {
 	geometry_offset_rotation.makeRotate( rotX_, osg::Vec3f(1.0, 0.0, 0.0), 
@@ -398,15 +546,45 @@ void visual_object::setScale( double scaleX_, double scaleY_, double scaleZ_ )
 	scaleZ = scaleZ_;
 }
 
+bool visual_object::preloadGeometry( const std::string& filename_ )
+{
+	osg::ref_ptr<osg::Node> tmpModel = util_modelCache::getInstance()->readNode( filename_ );
+	if( !tmpModel.valid() )
+		return false;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(preloadedGeometryMutex);
+	preloadedGeometry.insert( std::make_pair(filename_, tmpModel) );
+	return true;
+}
+
+void visual_object::clearPreloadedGeometry()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(preloadedGeometryMutex);
+	preloadedGeometry.clear();
+}
+
 bool visual_object::loadGeometry(std::string filename_)
 {
+	// Use the model if it was loaded during startup.
+	osg::ref_ptr<osg::Node> tmpModel;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(preloadedGeometryMutex);
+		PreloadedGeometryMap::iterator itr = preloadedGeometry.find( filename_ );
+		if( itr != preloadedGeometry.end() )
+		{
+			tmpModel = itr->second;
+			preloadedGeometry.erase( itr );
+		}
+	}
+
 	// Check if file exists
-	if( !osgDB::fileExists(filename_) )
+	if( !tmpModel.valid() && !osgDB::fileExists(filename_) )
 	{
 		OSG_NOTIFY(osg::FATAL) << "Error: Model not loaded. File '" << filename_ << "' does not exist." << std::endl;
 	}
 
-	osg::ref_ptr<osg::Node> tmpModel = osgDB::readNodeFile( filename_ );
+	if( !tmpModel.valid() )
+		tmpModel = util_modelCache::getInstance()->readNode( filename_ );
 	
 	if( tmpModel.valid() )
 	{
@@ -419,7 +597,7 @@ bool visual_object::loadGeometry(std::string filename_)
 	}
 	else
 	{
-		std::cout <<": No model loaded: " << filename_ << std::endl;
+		OSGVISUAL_LOG( osg::WARN ) << "visual_object::loadGeometry() : No model loaded: " << filename_ << std::endl;
         return false;
     }
 }
@@ -477,6 +655,8 @@ std::vector<object_updater*> visual_object::getUpdaterList()
 
 void visual_object::visual_objectPositionCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
 {
+	OSGVISUAL_PROFILE_SCOPE("visual_object update");
+	OSGVISUAL_ALLOC_SCOPE(OBJECT);
 	visual_object* object = dynamic_cast<visual_object*>(node);
 	if ( !object )
 	{
@@ -484,12 +664,8 @@ void visual_object::visual_objectPositionCallback::operator()(osg::Node* node, o
 		return;
 	}
 
-	// execute preUpdater to get new data of this object.
-	if ( object->updater.valid() )
-		object->updater->preUpdate(object);
-    
 	// Nodepath from this node to absolute parent (if no endnode specified)
-	osg::NodePath nodePath = nv->getNodePath();
+	const osg::NodePath& nodePath = nv->getNodePath();
 
 	// If Nodepath != empty, then mt = last element of node path
 	osg::MatrixTransform* mt = nodePath.empty() ? 0 : dynamic_cast<osg::MatrixTransform*>(nodePath.back());
@@ -511,73 +687,20 @@ void visual_object::visual_objectPositionCallback::operator()(osg::Node* node, o
 			osg::EllipsoidModel* ellipsoid = csn->getEllipsoidModel();
 			if (ellipsoid)
 			{
-				osg::Matrix inheritedMatrix;
-
-				// durch den _restlichen_ Nodepath durchgehen und alle anfallenden Transformationen durchfhren.
-				for(i+=1; i<nodePath.size()-1; ++i)
-				{
-					osg::Transform* transform = nodePath[i]->asTransform();	// Versuchen, den Node zu einer Transformation zu konvertieren
-                    
-					// wenn Node wirklich Trafo, dann die Tranformationsmatrix von Nodekoordinaten nach Global auf inheritedMatrix draufschlagen.
-					if (transform) transform->computeLocalToWorldMatrix(inheritedMatrix, nv);
-				}
-                
-				osg::Matrixd matrix(inheritedMatrix);
-
-				// Set position
-				ellipsoid->computeLocalToWorldTransformFromLatLongHeight(object->lat, object->lon, object->alt, matrix);
-
-				// Set Upvector for position
-				double X,Y,Z;
-				util::calculateXYZAtWGS84Coordinate(object->lat, object->lon, object->alt, csn, X, Y, Z );
-				object->upVector = ellipsoid->computeLocalUpVector(X,Y,Z);
-
-				// Set scale
-				osg::Matrixd scaleMatrix;
-				scaleMatrix.makeScale( object->scaleX, object->scaleY, object->scaleZ );
-				matrix.preMult( scaleMatrix );
-
-				// Set rotation
-				// rotation von links ranmultiplizieren, entspricht: matrix = rotation * matrix. Da rotation ein Quat ist, wre die direkte Multiplikation nur ber Umwege machbar.
-				// Rotate Object to Attitude.
-				osg::Matrixd rotationMatrix;
-				// Move Model by Azimuth
-				rotationMatrix.makeRotate( -object->azimuthAngle_psi, osg::Vec3d(0.0, 0.0, 1.0) );
-				matrix.preMult(rotationMatrix);	
-				// Move Model by Pitch
-				rotationMatrix.makeRotate( object->pitchAngle_theta, osg::Vec3d(1.0, 0.0, 0.0) );
-				matrix.preMult(rotationMatrix);
-				// Move Model by Bank
-				rotationMatrix.makeRotate( object->bankAngle_phi, osg::Vec3d(0.0, 1.0, 0.0) );
-				matrix.preMult(rotationMatrix);
-
-				// Also update camera matrix (without geometry offset, because camera is interested in the objects matrix, not in the model's matrix.)
-				object->cameraMatrix = matrix;
-				/** \todo : Clean up camera matrix management: try to solve it with a single matrix. (each frame two matrix mults less) */
-				// dont know, why this rotation is necessary - maybe manipulator and node MatrixTransform interpret a matrix in different way?
-				object->cameraMatrix.preMult( object->cameraTranslationOffset );
-				object->cameraMatrix.preMult( object->cameraRotationOffset );
-							
-
-				// Set geometry correction
-				matrix.preMultRotate( object->geometry_offset_rotation );
-
-				// Set cumulated object matrix as the matrix of this matrix transform
-				mt->setMatrix(matrix);
+				// The objects matrix is calculated from position and attitude by the object transform job after the event traversal.
+				if( object->ellipsoid != ellipsoid )
+					object->ellipsoid = ellipsoid;
+				object->transformPending = true;
 			}
 		}        
 	}
       
+	// Show or hide the labels.
+	object->labels->setNodeMask( labelsVisible ? 0xffffffff : 0x0 );
+
 	// Call any nested callbacks.
 	traverse(node,nv);
 
-	// If SLAVE: execute postUpdater to pass new data of this object to dataIO.
-	if( visual_dataIO::getInstance()->isSlave() )
-	{
-		if ( object->updater.valid() )
-			object->updater->postUpdate(object);
-	}
-
 }   // Callbackfunction [ Operater() ] END
 
 void visual_object::setCameraOffsetTranslation( double x_, double y_, double z_)
@@ -603,6 +726,16 @@ void visual_object::setCameraOffsetRotation(double rotX_, double rotY_, double r
 	cameraRotationOffset.preMult(tmp);
 }
 
+void visual_object::setLabelsVisible( bool visible_ )
+{
+	labelsVisible = visible_;
+}
+
+bool visual_object::getLabelsVisible()
+{
+	return labelsVisible;
+}
+
 void visual_object::clearLabels()
 {
 	labels->removeDrawables(0, labels->getNumDrawables());
@@ -36,13 +36,9 @@ visual_skySilverLining::visual_skySilverLining(osgViewer::Viewer* viewer_, std::
 	}
 
 	// Check if the module is en- or diabled by XML configuration.
-	xmlDoc* tmpDoc;
-	xmlNode* config = util::getModuleXMLConfig( configFileName, "sky_silverlining", tmpDoc, disabled );
+	util::getModuleConfig( configFileName, "sky_silverlining", disabled );
 	if( disabled)
 		OSG_NOTIFY( osg::ALWAYS ) << "..disabled by XML configuration file." << std::endl;
- 
-	if(config)
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
 
 }
 
@@ -55,6 +51,7 @@ visual_skySilverLining::~visual_skySilverLining(void)
 
 void visual_skySilverLining::skyUpdateCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
 {
+	OSGVISUAL_PROFILE_SCOPE("visual_skySilverLining update");
 	//std::cout << "Sky silverlining update callback" << std::endl;
 	// Check if atmosphere is initialized.
 	if (!sky->isInitialized())
@@ -741,101 +738,66 @@ void visual_skySilverLining::setSlotPrecipitation( int slot_, double rate_mmPerH
 	}
 }
 
-void visual_skySilverLining::configureCloudlayerbyXML( xmlNode* cloudlayerNode_ )
+void visual_skySilverLining::configureCloudlayerbyXML( const util_config::node* cloudlayerNode_ )
 {
-	std::string node_name=reinterpret_cast<const char*>(cloudlayerNode_->name);
-	if(cloudlayerNode_->type == XML_ELEMENT_NODE && node_name == "clouds")
+	if(cloudlayerNode_->getName() == "clouds")
 	{
-		for (cloudlayerNode_= cloudlayerNode_->children; cloudlayerNode_; cloudlayerNode_ = cloudlayerNode_->next)
+		std::vector<const util_config::node*> layerNodes = cloudlayerNode_->getChildren("cloudlayer");
+		for(unsigned int i=0; i<layerNodes.size(); i++)
 		{
-			node_name=reinterpret_cast<const char*>(cloudlayerNode_->name);
-			if(cloudlayerNode_->type == XML_ELEMENT_NODE && node_name == "cloudlayer")
-			{
-				int slot = -1;
-				bool enabled;
-				int fadetime = -1, baselength = -1, basewidth = -1, thickness = -1, baseHeight = -1 ;
-				float density = -1.0, rate_mmPerHour_rain = -1.0, rate_mmPerHour_drySnow = -1.0, rate_mmPerHour_wetSnow = -1.0, rate_mmPerHour_sleet = -1.0;
-				CloudTypes ctype = CUMULUS_CONGESTUS; 
-
-				xmlAttr  *attr = cloudlayerNode_->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "slot" ) slot = util::strToInt(attr_value);
-					if( attr_name == "enabled" ) enabled = util::strToBool(attr_value);
-					if( attr_name == "fadetime" ) fadetime = util::strToInt(attr_value);
-					if( attr_name == "type" )
-					{
-						if(attr_value=="CIRROCUMULUS")
-							ctype = CIRROCUMULUS;
-						if(attr_value=="CIRRUS_FIBRATUS")
-							ctype = CIRRUS_FIBRATUS;
-						if(attr_value=="STRATUS")
-							ctype = STRATUS;
-						if(attr_value=="CUMULUS_MEDIOCRIS")
-							ctype = CUMULUS_MEDIOCRIS;
-						if(attr_value=="CUMULUS_CONGESTUS")
-							ctype = CUMULUS_CONGESTUS;
-						if(attr_value=="CUMULONIMBUS_CAPPILATUS")
-							ctype = CUMULONIMBUS_CAPPILATUS;
-						if(attr_value=="STRATOCUMULUS")
-							ctype = STRATOCUMULUS;
-					}
-					attr = attr->next; 
-				}
-
-				if(!cloudlayerNode_->children)
-				{
-					OSG_NOTIFY( osg::ALWAYS ) << "ERROR - visual_skySilverLining::configureCloudlayerbyXML: Missing geometry specification for a cloudlayer." << std::endl;
-					return;
-				}
-
-				for (xmlNode *cur_node = cloudlayerNode_->children; cur_node; cur_node = cur_node->next)
-				{
-					node_name=reinterpret_cast<const char*>(cur_node->name);
-					if(cur_node->type == XML_ELEMENT_NODE && node_name == "geometry")
-					{
-						xmlAttr  *attr = cur_node->properties;
-						while ( attr ) 
-						{ 
-							std::string attr_name=reinterpret_cast<const char*>(attr->name);
-							std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-							if( attr_name == "baselength" )	baselength = util::strToInt(attr_value);
-							if( attr_name == "basewidth" )	basewidth = util::strToInt(attr_value);
-							if( attr_name == "thickness" )	thickness = util::strToInt(attr_value);
-							if( attr_name == "baseHeight" )	baseHeight = util::strToInt(attr_value);
-							if( attr_name == "density" ) density = util::strToDouble(attr_value);
-
-							attr = attr->next; 
-						}
-					}
+			const util_config::node* layerNode = layerNodes[i];
+			int slot = layerNode->getInt("slot", -1);
+			CloudTypes ctype = getCloudTypeByName( layerNode->getString("type"), CUMULUS_CONGESTUS );
 
-					if(cur_node->type == XML_ELEMENT_NODE && node_name == "precipitation")
-					{
-						xmlAttr  *attr = cur_node->properties;
-						while ( attr ) 
-						{ 
-							std::string attr_name=reinterpret_cast<const char*>(attr->name);
-							std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-							if( attr_name == "rate_mmPerHour_rain" ) rate_mmPerHour_rain = util::strToDouble(attr_value);
-							if( attr_name == "rate_mmPerHour_drySnow" ) rate_mmPerHour_drySnow = util::strToDouble(attr_value);
-							if( attr_name == "rate_mmPerHour_wetSnow" ) rate_mmPerHour_wetSnow = util::strToDouble(attr_value);
-							if( attr_name == "rate_mmPerHour_sleet" ) rate_mmPerHour_sleet = util::strToDouble(attr_value);
-
-							attr = attr->next; 
-						}
-					}
-				}
+			const util_config::node* geometry = layerNode->getChild("geometry");
+			if(!geometry)
+			{
+				OSG_NOTIFY( osg::ALWAYS ) << "ERROR - visual_skySilverLining::configureCloudlayerbyXML: Missing geometry specification for a cloudlayer." << std::endl;
+				return;
+			}
+
+			int baselength = geometry->getInt("baselength", -1);
+			int basewidth = geometry->getInt("basewidth", -1);
+			int thickness = geometry->getInt("thickness", -1);
+			int baseHeight = geometry->getInt("baseHeight", -1);
+			float density = geometry->getDouble("density", -1.0);
+
+			float rate_mmPerHour_rain = -1.0, rate_mmPerHour_drySnow = -1.0, rate_mmPerHour_wetSnow = -1.0, rate_mmPerHour_sleet = -1.0;
+			const util_config::node* precipitation = layerNode->getChild("precipitation");
+			if(precipitation)
+			{
+				rate_mmPerHour_rain = precipitation->getDouble("rate_mmPerHour_rain", -1.0);
+				rate_mmPerHour_drySnow = precipitation->getDouble("rate_mmPerHour_drySnow", -1.0);
+				rate_mmPerHour_wetSnow = precipitation->getDouble("rate_mmPerHour_wetSnow", -1.0);
+				rate_mmPerHour_sleet = precipitation->getDouble("rate_mmPerHour_sleet", -1.0);
+			}
 
-				if(slot!=-1 && baselength!=-1 && basewidth!=-1 && thickness!=-1 && baseHeight!=-1 && density!=-1 )
-					addCloudLayer( slot, baselength, basewidth, thickness, baseHeight, density, ctype );
+			if(slot!=-1 && baselength!=-1 && basewidth!=-1 && thickness!=-1 && baseHeight!=-1 && density!=-1 )
+				addCloudLayer( slot, baselength, basewidth, thickness, baseHeight, density, ctype );
 
-				if(slot!=-1 && rate_mmPerHour_rain!=-1 && rate_mmPerHour_drySnow!=-1 && thickness!=-1 && baseHeight!=-1 && density!=-1 )
-					setSlotPrecipitation( slot, rate_mmPerHour_rain, rate_mmPerHour_drySnow, rate_mmPerHour_wetSnow, rate_mmPerHour_sleet );
-			}	// If Node = cloudlayer END
+			if(slot!=-1 && rate_mmPerHour_rain!=-1 && rate_mmPerHour_drySnow!=-1 && thickness!=-1 && baseHeight!=-1 && density!=-1 )
+				setSlotPrecipitation( slot, rate_mmPerHour_rain, rate_mmPerHour_drySnow, rate_mmPerHour_wetSnow, rate_mmPerHour_sleet );
 		}	// FOR-loop end
 	}	// If Clouds END
-		else
-	OSG_NOTIFY( osg::ALWAYS ) << "ERROR - visual_skySilverLining::configureCloudlayerbyXML: Node is not a <clouds> node." << std::endl;
+	else
+		OSG_NOTIFY( osg::ALWAYS ) << "ERROR - visual_skySilverLining::configureCloudlayerbyXML: Node is not a <clouds> node." << std::endl;
+}
+
+CloudTypes visual_skySilverLining::getCloudTypeByName( const std::string& name_, CloudTypes default_ )
+{
+	if(name_=="CIRROCUMULUS")
+		return CIRROCUMULUS;
+	if(name_=="CIRRUS_FIBRATUS")
+		return CIRRUS_FIBRATUS;
+	if(name_=="STRATUS")
+		return STRATUS;
+	if(name_=="CUMULUS_MEDIOCRIS")
+		return CUMULUS_MEDIOCRIS;
+	if(name_=="CUMULUS_CONGESTUS")
+		return CUMULUS_CONGESTUS;
+	if(name_=="CUMULONIMBUS_CAPPILATUS")
+		return CUMULONIMBUS_CAPPILATUS;
+	if(name_=="STRATOCUMULUS")
+		return STRATOCUMULUS;
+	return default_;
 }
\ No newline at end of file
@@ -0,0 +1,500 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/CoordinateSystemNode>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Math>
+#include <osg/Notify>
+#include <osgText/Text>
+#include <osgUtil/LineSegmentIntersector>
+#include <osgUtil/IntersectionVisitor>
+#include <osgGA/EventVisitor>
+#include <osgViewer/Viewer>
+
+#include <util_allocTracker.h>
+#include <util_frameArena.h>
+#include <util_kdTreeBuilder.h>
+#include <util_terrainHeightGrid.h>
+#include <util_taskScheduler.h>
+#include <visual_util.h>
+#include <visual_debug_hud.h>
+#include <visual_object.h>
+#include <object_updater.h>
+#include <visual_dataIO.h>
+#include <dataIO_slot.h>
+#include <dataIO_slotSnapshot.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace osgVisual;
+
+/**
+ * Number of executions of each allocation free path, enough to pass the warm-up of lazily allocated buffers.
+ */
+static const unsigned int numExecutions = 1000;
+
+/**
+ * Extent of the test height grid in degrees and its sample spacing.
+ */
+static const double gridLatMin = 47.0;
+static const double gridLonMin = 11.0;
+static const double gridSpacing = 0.01;
+static const unsigned int gridSize = 11;
+
+/**
+ * Number of frames measured by measureFrameAllocations(), the last one is taken as steady state.
+ */
+static const unsigned int numFrames = 10;
+
+/**
+ * Number of objects and terrain queries per frame of the allocation reduction check.
+ */
+static const unsigned int numItemsPerFrame = 100;
+
+/**
+ * Allocations of the canary, stored globally so the compiler cannot remove the allocation.
+ */
+static std::vector<double>* canaryAllocation = NULL;
+
+/**
+ * \brief This function checks that the tracker detects an allocation in an allocation free path.
+ *
+ * @return : Number of failed checks.
+ */
+static unsigned int checkCanary()
+{
+	unsigned long violationsBefore = util_allocTracker::getInstance()->getNumViolations();
+	{
+		OSGVISUAL_ALLOC_ZERO_SCOPE("allocationTest canary");
+		canaryAllocation = new std::vector<double>( 16 );
+	}
+	delete canaryAllocation;
+	canaryAllocation = NULL;
+
+	if( util_allocTracker::getInstance()->getNumViolations() != violationsBefore + 1 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: An allocation in an allocation free path was not detected." << std::endl;
+		return 1;
+	}
+	OSG_NOTIFY( osg::INFO ) << "passed: canary allocation detected" << std::endl;
+	return 0;
+}
+
+/**
+ * \brief This function checks the height grid query of util::queryHeightOfTerrain(), which is an allocation free path.
+ *
+ * @param filename_ : File to write the test grid to.
+ * @return : Number of failed checks.
+ */
+static unsigned int checkHeightGridQuery( const std::string& filename_ )
+{
+	util_terrainHeightGrid::gridLevel level;
+	level.numLat = gridSize;
+	level.numLon = gridSize;
+	level.latMin = osg::DegreesToRadians( gridLatMin );
+	level.lonMin = osg::DegreesToRadians( gridLonMin );
+	level.latMax = osg::DegreesToRadians( gridLatMin + (gridSize-1)*gridSpacing );
+	level.lonMax = osg::DegreesToRadians( gridLonMin + (gridSize-1)*gridSpacing );
+	std::vector<util_terrainHeightGrid::gridLevel> levels( 1, level );
+	std::vector< std::vector<float> > heights( 1, std::vector<float>( gridSize*gridSize, 500.0f ) );
+	if( !util_terrainHeightGrid::write( filename_, levels, heights, 4 ) || !util_terrainHeightGrid::getInstance()->load( filename_ ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: Unable to write and load the height grid " << filename_ << std::endl;
+		return 1;
+	}
+
+	osg::ref_ptr<osg::CoordinateSystemNode> root = new osg::CoordinateSystemNode;
+	root->setEllipsoidModel( new osg::EllipsoidModel() );
+
+	unsigned int numFailed = 0;
+	for(unsigned int i=0; i<numExecutions; i++)
+	{
+		double lat = osg::DegreesToRadians( gridLatMin + (i % 97) * 0.001 );
+		double lon = osg::DegreesToRadians( gridLonMin + (i % 89) * 0.001 );
+		double hot = 0.0;
+		if( !util::queryHeightOfTerrain( hot, root.get(), lat, lon ) || fabs(hot - 500.0) > 0.001 )
+			numFailed++;
+	}
+	util_terrainHeightGrid::getInstance()->unload();
+	remove( filename_.c_str() );
+
+	if( numFailed > 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << numFailed << " height grid queries returned a wrong height." << std::endl;
+		return 1;
+	}
+	OSG_NOTIFY( osg::INFO ) << "passed: height grid queries" << std::endl;
+	return 0;
+}
+
+/**
+ * \brief This function checks the slot lookup of dataIO_slotSnapshot, which is an allocation free path.
+ *
+ * @return : Number of failed checks.
+ */
+static unsigned int checkSnapshotLookup()
+{
+	// Names longer than the small string buffer, so a copy of a name would allocate.
+	std::vector< osg::ref_ptr<dataIO_slot> > slots;
+	std::vector<dataIO_slot*> slotPointers;
+	std::vector<std::string> names;
+	for(unsigned int i=0; i<64; i++)
+	{
+		std::ostringstream name;
+		name << "ALLOCATION_TEST_SLOT_WITH_A_LONG_NAME_" << i;
+		osg::ref_ptr<dataIO_slot> slot = new dataIO_slot();
+		slot->variableName = name.str();
+		slot->direction = (i % 2) ? dataIO_slot::FROM_OBJ : dataIO_slot::TO_OBJ;
+		slot->variableType = dataIO_slot::DOUBLE;
+		slot->value = i;
+		slots.push_back( slot );
+		slotPointers.push_back( slot.get() );
+		names.push_back( name.str() );
+	}
+	osg::ref_ptr<dataIO_slotSnapshot> snapshot = new dataIO_slotSnapshot( slotPointers, 1 );
+
+	unsigned int numFailed = 0;
+	for(unsigned int i=0; i<numExecutions; i++)
+	{
+		unsigned int slot = i % slots.size();
+		if( snapshot->getSlotDataAsDouble( names[slot], slots[slot]->direction ) != static_cast<double>(slot) )
+			numFailed++;
+	}
+
+	if( numFailed > 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << numFailed << " snapshot lookups returned a wrong value." << std::endl;
+		return 1;
+	}
+	OSG_NOTIFY( osg::INFO ) << "passed: snapshot lookups" << std::endl;
+	return 0;
+}
+
+/**
+ * Scene data of the frame functions of checkAllocationReduction().
+ */
+static osg::ref_ptr<osg::Geode> terrain;
+static osg::ref_ptr<osg::CoordinateSystemNode> sceneRoot;
+static osg::ref_ptr<osgGA::EventVisitor> eventVisitor;
+static osg::NodePath objectNodePath;
+static std::vector<std::string> slotNames;
+static osg::ref_ptr<osgText::Text> hudTexts[5];
+static double hudValues[5] = {47.123456, 11.654321, 1234.5, 734.5, 500.0};
+static double resultSink = 0.0;
+
+/**
+ * \brief Slot lookup with the name passed by value, as visual_dataIO did before the names were passed by reference.
+ *
+ * @param variableName_ : Name of the slot.
+ * @return : Index of the slot.
+ */
+static double findSlotByValue( std::string variableName_ )
+{
+	for(unsigned int i=0; i<slotNames.size(); i++)
+		if( slotNames[i] == variableName_ )
+			return i;
+	return -1.0;
+}
+
+/**
+ * \brief One frame of the HUD texts, formatted with an ostringstream and set each frame as before the frame arena.
+ *
+ */
+static void hudFrameBefore()
+{
+	std::ostringstream valuestring;
+
+	valuestring.str("");
+	valuestring << hudValues[0];
+	hudTexts[0]->setText("LAT: "+valuestring.str());
+
+	valuestring.str("");
+	valuestring << hudValues[1];
+	hudTexts[1]->setText("LON: "+valuestring.str());
+
+	valuestring << std::fixed;
+	valuestring.precision(2);
+	valuestring.fill('0');
+
+	const char* labels[3] = {"ALT: ", "HAT: ", "HOT: "};
+	for(unsigned int i=2; i<5; i++)
+	{
+		valuestring.width(8);
+		valuestring.str("");
+		valuestring << hudValues[i];
+		hudTexts[i]->setText(labels[i-2]+valuestring.str());
+	}
+}
+
+/**
+ * \brief One frame of the frame jobs of visual_debug_hud, executed by util_taskScheduler like visual_core does.
+ *
+ * The objects and the terrain query of the HUD are registered as well, their allocations are accounted to the OBJECT and TERRAIN subsystems.
+ */
+static void hudFrameAfter()
+{
+	util_taskScheduler::getInstance()->runFrame();
+}
+
+/**
+ * \brief One frame of the object updates, copying the node path and the slot names as before.
+ *
+ */
+static void objectFrameBefore()
+{
+	for(unsigned int i=0; i<numItemsPerFrame; i++)
+	{
+		osg::NodePath nodePath = objectNodePath;
+		resultSink += nodePath.size();
+		for(unsigned int j=0; j<slotNames.size(); j++)
+			resultSink += findSlotByValue( slotNames[j] );
+	}
+}
+
+/**
+ * \brief One frame of the object updates: the event traversal with the position callbacks of the objects and the frame jobs of visual_object.
+ *
+ * The HUD is registered as well, its allocations are accounted to the HUD and TERRAIN subsystems.
+ */
+static void objectFrameAfter()
+{
+	eventVisitor->reset();
+	sceneRoot->accept( *eventVisitor );
+	util_taskScheduler::getInstance()->runFrame();
+}
+
+/**
+ * \brief One frame of terrain queries, allocating an intersector and a visitor for each query as util::intersect() did before.
+ *
+ */
+static void terrainFrameBefore()
+{
+	for(unsigned int i=0; i<numItemsPerFrame; i++)
+	{
+		osg::Vec3d start( i*10.0, i*10.0, 1000.0 );
+		osg::Vec3d end( i*10.0, i*10.0, -1000.0 );
+		osg::ref_ptr<osgUtil::LineSegmentIntersector> lsi = new osgUtil::LineSegmentIntersector(start,end);
+		osgUtil::IntersectionVisitor iv(lsi.get());
+		terrain->accept(iv);
+		if( lsi->containsIntersections() )
+			resultSink += lsi->getIntersections().begin()->getWorldIntersectPoint().z();
+	}
+}
+
+/**
+ * \brief One frame of terrain queries with util::intersect().
+ *
+ */
+static void terrainFrameAfter()
+{
+	for(unsigned int i=0; i<numItemsPerFrame; i++)
+	{
+		osg::Vec3d intersection;
+		if( util::intersect( osg::Vec3d( i*10.0, i*10.0, 1000.0 ), osg::Vec3d( i*10.0, i*10.0, -1000.0 ), intersection, terrain.get() ) )
+			resultSink += intersection.z();
+	}
+}
+
+/**
+ * \brief This function runs frames of a frame function and returns the allocations of its subsystem in the last frame.
+ *
+ * The first frames warm up lazily allocated buffers, so the last frame shows the steady state like the report of util_allocTracker.
+ *
+ * @param subsystem_ : Subsystem the allocations are accounted to.
+ * @param frame_ : Function which executes one frame.
+ * @return : Allocations in the last frame.
+ */
+static unsigned long measureFrameAllocations( util_allocTracker::subsystem subsystem_, void (*frame_)() )
+{
+	unsigned long allocations = 0;
+	for(unsigned int i=0; i<numFrames; i++)
+	{
+		util_frameArena::getInstance()->reset();
+		util_allocTracker::getInstance()->endFrame();
+		{
+			util_allocTracker::scopedTag tag( subsystem_ );
+			frame_();
+		}
+		util_allocTracker::getInstance()->endFrame();
+		allocations = util_allocTracker::getInstance()->getFrameAllocations( subsystem_ );
+	}
+	return allocations;
+}
+
+/**
+ * \brief This function checks that the HUD, object and terrain updates allocate less than the patterns they replaced.
+ *
+ * The former patterns are reproduced by this test, the current versions are the frame jobs of visual_object and visual_debug_hud
+ * and util::intersect(). Both versions run in the same way and their allocations per frame are printed like the HUD, OBJECT and
+ * TERRAIN rows of util_allocTracker::report().
+ *
+ * @return : Number of failed checks.
+ */
+static unsigned int checkAllocationReduction()
+{
+	// Flat terrain quad of 2x2 km. The KdTree construction is disabled to intersect the same geometry in both versions.
+	osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+	vertices->push_back( osg::Vec3( -1000.0f, -1000.0f, 0.0f ) );
+	vertices->push_back( osg::Vec3( 2000.0f, -1000.0f, 0.0f ) );
+	vertices->push_back( osg::Vec3( 2000.0f, 2000.0f, 0.0f ) );
+	vertices->push_back( osg::Vec3( -1000.0f, 2000.0f, 0.0f ) );
+	osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+	geometry->setVertexArray( vertices.get() );
+	geometry->addPrimitiveSet( new osg::DrawArrays( GL_QUADS, 0, 4 ) );
+	terrain = new osg::Geode;
+	terrain->addDrawable( geometry.get() );
+	bool kdTreesEnabled = util_kdTreeBuilder::getInstance()->isEnabled();
+	util_kdTreeBuilder::getInstance()->setEnabled( false );
+
+	// The five texts of the former HUD, the glyphs are computed with the default font.
+	for(unsigned int i=0; i<5; i++)
+		hudTexts[i] = new osgText::Text;
+
+	// Node path of an object below root, CSN and a transform, and the six slot names of an object updater.
+	for(unsigned int i=0; i<4; i++)
+		objectNodePath.push_back( terrain.get() );
+	for(unsigned int i=0; i<6; i++)
+	{
+		std::ostringstream name;
+		name << "ALLOCATION_TEST_OBJECT_UPDATER_SLOT_" << i;
+		slotNames.push_back( name.str() );
+	}
+
+	// Scene with the terrain and the objects, whose updaters read the slots above. No label slot, so the labels stay unchanged.
+	sceneRoot = new osg::CoordinateSystemNode;
+	sceneRoot->setEllipsoidModel( new osg::EllipsoidModel() );
+	sceneRoot->addChild( terrain.get() );
+	double slotValues[6] = {osg::DegreesToRadians( gridLatMin ), osg::DegreesToRadians( gridLonMin ), 1000.0, 0.0, 0.0, osg::DegreesToRadians( 90.0 )};
+	for(unsigned int i=0; i<6; i++)
+		visual_dataIO::getInstance()->setSlotData( slotNames[i], dataIO_slot::TO_OBJ, slotValues[i] );
+	for(unsigned int i=0; i<numItemsPerFrame; i++)
+	{
+		std::ostringstream name;
+		name << "ALLOCATION_TEST_OBJECT_" << i;
+		visual_object* object = new visual_object( sceneRoot.get(), name.str() );
+		osg::ref_ptr<object_updater> updater = new object_updater( object );
+		updater->setUpdaterSlotNames( object, slotNames[0], slotNames[1], slotNames[2], slotNames[3], slotNames[4], slotNames[5], "" );
+		object->addUpdater( updater.get() );
+	}
+	eventVisitor = new osgGA::EventVisitor;
+
+	// HUD with the camera of a viewer which is not realized, the viewport is set like the one of a window.
+	osg::ref_ptr<osgViewer::Viewer> viewer = new osgViewer::Viewer;
+	viewer->getCamera()->setViewport( 0, 0, 1280, 1024 );
+	osg::ref_ptr<visual_debug_hud> hud = new visual_debug_hud;
+	hud->init( viewer.get(), sceneRoot.get() );
+
+	struct comparison
+	{
+		util_allocTracker::subsystem subsystem;
+		void (*before)();
+		void (*after)();
+	};
+	comparison comparisons[3] = {
+		{util_allocTracker::OBJECT, objectFrameBefore, objectFrameAfter},
+		{util_allocTracker::HUD, hudFrameBefore, hudFrameAfter},
+		{util_allocTracker::TERRAIN, terrainFrameBefore, terrainFrameAfter}
+	};
+
+	unsigned int numFailed = 0;
+	OSG_NOTIFY( osg::ALWAYS ) << "Allocations per frame (" << numItemsPerFrame << " objects and terrain queries):" << std::endl;
+	OSG_NOTIFY( osg::ALWAYS ) << std::setw(12) << "subsystem" << std::setw(10) << "before" << std::setw(10) << "after" << std::endl;
+	for(unsigned int i=0; i<3; i++)
+	{
+		unsigned long before = measureFrameAllocations( comparisons[i].subsystem, comparisons[i].before );
+		unsigned long after = measureFrameAllocations( comparisons[i].subsystem, comparisons[i].after );
+		OSG_NOTIFY( osg::ALWAYS ) << std::setw(12) << util_allocTracker::getSubsystemName( comparisons[i].subsystem ) << std::setw(10) << before << std::setw(10) << after << std::endl;
+		if( after >= before )
+		{
+			OSG_NOTIFY( osg::WARN ) << "FAILED: The " << util_allocTracker::getSubsystemName( comparisons[i].subsystem ) << " updates do not allocate less than before." << std::endl;
+			numFailed++;
+		}
+	}
+
+	util_kdTreeBuilder::getInstance()->setEnabled( kdTreesEnabled );
+	hud->shutdown();
+	eventVisitor = NULL;
+	sceneRoot = NULL;
+	objectNodePath.clear();
+	terrain = NULL;
+	for(unsigned int i=0; i<5; i++)
+		hudTexts[i] = NULL;
+	return numFailed;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" checks that the allocation free paths of osgVisual do not allocate and that the HUD, object and terrain updates allocate less than the former code. It is built with allocation tracking.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options]");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("--grid <filename>","Temporary height grid file, default: allocationTest.heightgrid");
+
+	if( arguments.read("-h") || arguments.read("--help") )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string gridFilename = "allocationTest.heightgrid";
+	arguments.read("--grid", gridFilename);
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	if( !util_allocTracker::isTracking() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "The test is compiled without USE_ALLOCATION_TRACKING, no allocations are recorded." << std::endl;
+		return 1;
+	}
+
+	unsigned int numFailed = checkCanary();
+
+	// Only the violations of the osgVisual paths count, the canary reported one on purpose.
+	unsigned long violationsBefore = util_allocTracker::getInstance()->getNumViolations();
+	numFailed += checkHeightGridQuery( gridFilename );
+	numFailed += checkSnapshotLookup();
+	unsigned long violations = util_allocTracker::getInstance()->getNumViolations() - violationsBefore;
+	if( violations > 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: Allocation free paths allocated in " << violations << " executions." << std::endl;
+		numFailed++;
+	}
+
+	numFailed += checkAllocationReduction();
+
+	if( numFailed > 0 )
+	{
+		OSG_NOTIFY( osg::FATAL ) << numFailed << " allocation checks failed." << std::endl;
+		return 1;
+	}
+	OSG_NOTIFY( osg::ALWAYS ) << "All allocation free paths passed " << numExecutions << " executions without allocation, the HUD, object and terrain updates allocate less than before." << std::endl;
+	return 0;
+}
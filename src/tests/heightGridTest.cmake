@@ -0,0 +1,17 @@
+# Compiles the synthetic terrain of osgVisualHeightGridTest with osgVisualHeightGridCompiler and checks the lookups in the compiled grid.
+# Called by CTest: cmake -DTEST_PROGRAM=<osgVisualHeightGridTest> -DCOMPILER=<osgVisualHeightGridCompiler> -DWORK_DIR=<dir> -P heightGridTest.cmake
+# The levels must match testLevels in heightGridTest.cpp.
+
+FUNCTION(RUN_STEP)
+	EXECUTE_PROCESS(COMMAND ${ARGN} RESULT_VARIABLE result)
+	IF(NOT result EQUAL 0)
+		MESSAGE(FATAL_ERROR "Failed with ${result}: ${ARGN}")
+	ENDIF()
+ENDFUNCTION()
+
+SET(TERRAIN ${WORK_DIR}/heightGridTestTerrain.osgt)
+SET(GRID ${WORK_DIR}/heightGridTest.heightgrid)
+
+RUN_STEP(${TEST_PROGRAM} --create-terrain ${TERRAIN})
+RUN_STEP(${COMPILER} -o ${GRID} --tile-size 4 --level 47.0 11.0 47.1 11.1 0.02 --level 47.02 11.02 47.08 11.08 0.005 ${TERRAIN})
+RUN_STEP(${TEST_PROGRAM} --check ${GRID})
@@ -0,0 +1,473 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/CoordinateSystemNode>
+#include <osg/MatrixTransform>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Math>
+#include <osg/Notify>
+#include <osgDB/WriteFile>
+
+#include <util_terrainHeightGrid.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace osgVisual;
+
+/**
+ * \brief This struct describes a grid level in degrees, like the --level option of osgVisualHeightGridCompiler.
+ *
+ */
+struct testLevel
+{
+	double latMin;
+	double lonMin;
+	double latMax;
+	double lonMax;
+	double spacing;
+};
+
+/**
+ * Levels of the test grid, from the coarsest to the finest. heightGridTest.cmake passes the same values to the compiler.
+ * The fine level covers only the center of the coarse level, so lookups outside of it use the coarse level.
+ */
+static const testLevel testLevels[] = {
+	{ 47.0, 11.0, 47.1, 11.1, 0.02 },
+	{ 47.02, 11.02, 47.08, 11.08, 0.005 }
+};
+static const unsigned int numTestLevels = sizeof(testLevels) / sizeof(testLevels[0]);
+
+/**
+ * Extent and vertex spacing of the synthetic terrain in degrees. It is larger than the grid, so the border samples are not at the edge of the mesh,
+ * and the vertices are shifted against the grid samples, so no sample ray hits a vertex or an edge of the mesh exactly.
+ */
+static const double terrainLatMin = 46.99075;
+static const double terrainLonMin = 10.99075;
+static const double terrainSpacing = 0.0025;
+static const unsigned int terrainSize = 50;
+
+/**
+ * The terrain has a hole of 4 x 4 quads. The fine samples inside are without terrain, the coarse samples around the hole are valid.
+ */
+static const double holeMin = terrainLatMin + 22*terrainSpacing;
+static const double holeMax = terrainLatMin + 26*terrainSpacing;
+static const double holeLonOffset = terrainLonMin - terrainLatMin;
+
+/**
+ * \brief This function returns the height of the synthetic terrain. It is linear in latitude and longitude, so bilinear interpolation reproduces it exactly.
+ *
+ * @param latDeg_ : Latitude in degrees.
+ * @param lonDeg_ : Longitude in degrees.
+ * @return : Height in meter.
+ */
+static double terrainHeight( double latDeg_, double lonDeg_ )
+{
+	return 500.0 + 10000.0*(latDeg_-47.0) + 20000.0*(lonDeg_-11.0);
+}
+
+/**
+ * \brief This function returns if the position lies in the hole of the terrain.
+ *
+ * @param latDeg_ : Latitude in degrees.
+ * @param lonDeg_ : Longitude in degrees.
+ * @return : True if there is no terrain.
+ */
+static bool isInHole( double latDeg_, double lonDeg_ )
+{
+	return latDeg_ > holeMin && latDeg_ < holeMax && lonDeg_ > holeMin+holeLonOffset && lonDeg_ < holeMax+holeLonOffset;
+}
+
+/**
+ * \brief This function converts a test level into a grid level, with the same rounding as osgVisualHeightGridCompiler.
+ *
+ * @param level_ : Test level.
+ * @return : Grid level in radians.
+ */
+static util_terrainHeightGrid::gridLevel toGridLevel( const testLevel& level_ )
+{
+	util_terrainHeightGrid::gridLevel level;
+	level.numLat = static_cast<unsigned int>( (level_.latMax-level_.latMin)/level_.spacing + 0.5 ) + 1;
+	level.numLon = static_cast<unsigned int>( (level_.lonMax-level_.lonMin)/level_.spacing + 0.5 ) + 1;
+	level.latMin = osg::DegreesToRadians( level_.latMin );
+	level.lonMin = osg::DegreesToRadians( level_.lonMin );
+	level.latMax = osg::DegreesToRadians( level_.latMin + (level.numLat-1)*level_.spacing );
+	level.lonMax = osg::DegreesToRadians( level_.lonMin + (level.numLon-1)*level_.spacing );
+	return level;
+}
+
+/**
+ * \brief This function creates the synthetic terrain as one tile of triangles, located by a MatrixTransform like paged terrain databases do.
+ *
+ * @return : Terrain below a CoordinateSystemNode with WGS84 ellipsoid.
+ */
+static osg::CoordinateSystemNode* createTerrain()
+{
+	osg::CoordinateSystemNode* csn = new osg::CoordinateSystemNode;
+	csn->setEllipsoidModel( new osg::EllipsoidModel() );
+	osg::EllipsoidModel* em = csn->getEllipsoidModel();
+
+	double extent = (terrainSize-1)*terrainSpacing;
+	osg::Matrixd localToWorld;
+	em->computeLocalToWorldTransformFromLatLongHeight( osg::DegreesToRadians(terrainLatMin + extent*0.5), osg::DegreesToRadians(terrainLonMin + extent*0.5), 0.0, localToWorld );
+	osg::Matrixd worldToLocal = osg::Matrixd::inverse( localToWorld );
+
+	osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+	vertices->reserve( terrainSize*terrainSize );
+	for(unsigned int i=0; i<terrainSize; i++)
+	{
+		for(unsigned int j=0; j<terrainSize; j++)
+		{
+			double lat = terrainLatMin + i*terrainSpacing;
+			double lon = terrainLonMin + j*terrainSpacing;
+			osg::Vec3d world;
+			em->convertLatLongHeightToXYZ( osg::DegreesToRadians(lat), osg::DegreesToRadians(lon), terrainHeight(lat, lon), world.x(), world.y(), world.z() );
+			vertices->push_back( osg::Vec3( world * worldToLocal ) );
+		}
+	}
+
+	osg::ref_ptr<osg::DrawElementsUInt> triangles = new osg::DrawElementsUInt( GL_TRIANGLES );
+	for(unsigned int i=0; i<terrainSize-1; i++)
+	{
+		for(unsigned int j=0; j<terrainSize-1; j++)
+		{
+			if( isInHole( terrainLatMin + (i+0.5)*terrainSpacing, terrainLonMin + (j+0.5)*terrainSpacing ) )
+				continue;
+
+			unsigned int v = i*terrainSize + j;
+			triangles->push_back( v );	triangles->push_back( v+1 );			triangles->push_back( v+terrainSize );
+			triangles->push_back( v+1 );	triangles->push_back( v+terrainSize+1 );	triangles->push_back( v+terrainSize );
+		}
+	}
+
+	osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+	geometry->setVertexArray( vertices.get() );
+	geometry->addPrimitiveSet( triangles.get() );
+
+	osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+	geode->addDrawable( geometry.get() );
+
+	osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform( localToWorld );
+	transform->addChild( geode.get() );
+	csn->addChild( transform.get() );
+	return csn;
+}
+
+/**
+ * \brief This function writes the reference grid, whose samples are computed from the terrain function instead of sampling the terrain.
+ *
+ * @param filename_ : File to write.
+ * @return : True if successful.
+ */
+static bool writeReferenceGrid( const std::string& filename_ )
+{
+	std::vector<util_terrainHeightGrid::gridLevel> levels;
+	std::vector< std::vector<float> > heights;
+	for(unsigned int l=0; l<numTestLevels; l++)
+	{
+		util_terrainHeightGrid::gridLevel level = toGridLevel( testLevels[l] );
+		std::vector<float> samples( level.numLat * level.numLon );
+		for(unsigned int i=0; i<level.numLat; i++)
+		{
+			for(unsigned int j=0; j<level.numLon; j++)
+			{
+				double lat = testLevels[l].latMin + i*testLevels[l].spacing;
+				double lon = testLevels[l].lonMin + j*testLevels[l].spacing;
+				samples[i*level.numLon + j] = isInHole(lat, lon) ? util_terrainHeightGrid::NO_DATA : static_cast<float>( terrainHeight(lat, lon) );
+			}
+		}
+		levels.push_back( level );
+		heights.push_back( samples );
+	}
+
+	// A tile size which does not divide the levels tests the padding of the border tiles.
+	return util_terrainHeightGrid::write( filename_, levels, heights, 4 );
+}
+
+/**
+ * \brief This function checks a lookup inside the grid against the terrain function.
+ *
+ * @param description_ : Description of the checked case for the error message.
+ * @param lat_ : Latitude in radians.
+ * @param lon_ : Longitude in radians.
+ * @param tolerance_ : Allowed deviation in meter.
+ * @return : Number of failed checks.
+ */
+static unsigned int checkHeight( const std::string& description_, double lat_, double lon_, double tolerance_ )
+{
+	util_terrainHeightGrid* grid = util_terrainHeightGrid::getInstance();
+	double expected = terrainHeight( osg::RadiansToDegrees(lat_), osg::RadiansToDegrees(lon_) );
+
+	double hot = 0.0;
+	if( !grid->queryHeightOfTerrain( hot, lat_, lon_ ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << description_ << ": position is not covered, expected " << expected << std::endl;
+		return 1;
+	}
+	if( fabs(hot - expected) > tolerance_ )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << description_ << ": hot is " << hot << ", expected " << expected << std::endl;
+		return 1;
+	}
+
+	double hat = 0.0;
+	if( !grid->queryHeightAboveTerrain( hat, lat_, lon_, 5000.0 ) || fabs(hat - (5000.0-expected)) > tolerance_ )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << description_ << ": hat is " << hat << ", expected " << 5000.0-expected << std::endl;
+		return 1;
+	}
+
+	OSG_NOTIFY( osg::INFO ) << "passed: " << description_ << std::endl;
+	return 0;
+}
+
+/**
+ * \brief This function checks that a lookup outside of the grid fails and leaves the result unchanged.
+ *
+ * @param description_ : Description of the checked case for the error message.
+ * @param lat_ : Latitude in radians.
+ * @param lon_ : Longitude in radians.
+ * @return : Number of failed checks.
+ */
+static unsigned int checkNotCovered( const std::string& description_, double lat_, double lon_ )
+{
+	util_terrainHeightGrid* grid = util_terrainHeightGrid::getInstance();
+
+	double hot = 1234.5;
+	double hat = 1234.5;
+	if( grid->queryHeightOfTerrain( hot, lat_, lon_ ) || hot != 1234.5 || grid->queryHeightAboveTerrain( hat, lat_, lon_, 5000.0 ) || hat != 1234.5 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: " << description_ << ": position must not be covered, hot " << hot << ", hat " << hat << std::endl;
+		return 1;
+	}
+
+	OSG_NOTIFY( osg::INFO ) << "passed: " << description_ << std::endl;
+	return 0;
+}
+
+/**
+ * \brief This function loads a height grid of the test levels and checks the lookups.
+ *
+ * @param filename_ : Height grid file.
+ * @param tolerance_ : Allowed deviation in meter.
+ * @return : Number of failed checks.
+ */
+static unsigned int checkGrid( const std::string& filename_, double tolerance_ )
+{
+	if( !util_terrainHeightGrid::getInstance()->load( filename_ ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "FAILED: Unable to load " << filename_ << std::endl;
+		return 1;
+	}
+
+	util_terrainHeightGrid::gridLevel coarse = toGridLevel( testLevels[0] );
+	util_terrainHeightGrid::gridLevel fine = toGridLevel( testLevels[1] );
+	double fineLatSpacing = (fine.latMax - fine.latMin) / (fine.numLat-1);
+	double fineLonSpacing = (fine.lonMax - fine.lonMin) / (fine.numLon-1);
+
+	unsigned int numFailed = 0;
+
+	// Interior of the fine level, between and on samples
+	numFailed += checkHeight( "fine level interior", osg::DegreesToRadians(47.03), osg::DegreesToRadians(11.07), tolerance_ );
+	numFailed += checkHeight( "fine level between samples", osg::DegreesToRadians(47.0612), osg::DegreesToRadians(11.0233), tolerance_ );
+	numFailed += checkHeight( "fine level sample", fine.latMin + 3*fineLatSpacing, fine.lonMin + 9*fineLonSpacing, tolerance_ );
+
+	// Edge cells of the fine level: on the last sample the neighbour index is clamped
+	numFailed += checkHeight( "fine level south west corner", fine.latMin, fine.lonMin, tolerance_ );
+	numFailed += checkHeight( "fine level north east corner", fine.latMax, fine.lonMax, tolerance_ );
+	numFailed += checkHeight( "fine level north edge", fine.latMax, osg::DegreesToRadians(11.0433), tolerance_ );
+	numFailed += checkHeight( "fine level east edge", osg::DegreesToRadians(47.0317), fine.lonMax, tolerance_ );
+	numFailed += checkHeight( "fine level last cell", fine.latMax - 0.5*fineLatSpacing, fine.lonMax - 0.5*fineLonSpacing, tolerance_ );
+
+	// Only the coarse level covers these positions
+	numFailed += checkHeight( "coarse level outside of the fine level", osg::DegreesToRadians(47.09), osg::DegreesToRadians(11.09), tolerance_ );
+	numFailed += checkHeight( "coarse level south west corner", coarse.latMin, coarse.lonMin, tolerance_ );
+	numFailed += checkHeight( "coarse level north east corner", coarse.latMax, coarse.lonMax, tolerance_ );
+	numFailed += checkHeight( "coarse level north west corner", coarse.latMax, coarse.lonMin, tolerance_ );
+
+	// The fine samples in the hole are NO_DATA, the lookup falls back to the coarse level
+	numFailed += checkHeight( "fallback to the coarse level", osg::DegreesToRadians(47.0505), osg::DegreesToRadians(11.0505), tolerance_ );
+	numFailed += checkHeight( "fallback next to the hole", osg::DegreesToRadians(47.0475), osg::DegreesToRadians(11.0525), tolerance_ );
+
+	// Outside of all levels
+	numFailed += checkNotCovered( "north of the grid", coarse.latMax + 1e-9, osg::DegreesToRadians(11.05) );
+	numFailed += checkNotCovered( "south of the grid", coarse.latMin - 1e-9, osg::DegreesToRadians(11.05) );
+	numFailed += checkNotCovered( "east of the grid", osg::DegreesToRadians(47.05), coarse.lonMax + 1e-9 );
+	numFailed += checkNotCovered( "west of the grid", osg::DegreesToRadians(47.05), osg::DegreesToRadians(10.5) );
+	numFailed += checkNotCovered( "far away", osg::DegreesToRadians(-33.0), osg::DegreesToRadians(151.0) );
+
+	util_terrainHeightGrid::getInstance()->unload();
+	numFailed += checkNotCovered( "unloaded grid", osg::DegreesToRadians(47.05), osg::DegreesToRadians(11.05) );
+
+	return numFailed;
+}
+
+/**
+ * \brief This function writes a modified copy of a height grid file.
+ *
+ * @param data_ : Content of the original file.
+ * @param size_ : Size of the copy, at most the size of the original file.
+ * @param offset_ : Offset of an unsigned int to replace. Nothing is replaced if it is beyond the copy.
+ * @param value_ : New value of the unsigned int.
+ * @param filename_ : File to write.
+ * @return : True if successful.
+ */
+static bool writeCorruptGrid( const std::vector<char>& data_, size_t size_, size_t offset_, unsigned int value_, const std::string& filename_ )
+{
+	std::vector<char> corrupt( data_.begin(), data_.begin()+size_ );
+	if( offset_ + sizeof(unsigned int) <= corrupt.size() )
+		memcpy( &corrupt[offset_], &value_, sizeof(unsigned int) );
+
+	std::ofstream out( filename_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	out.write( &corrupt[0], corrupt.size() );
+	return out.good();
+}
+
+/**
+ * \brief This function checks that corrupt copies of a valid height grid are rejected by util_terrainHeightGrid::load().
+ *
+ * @param filename_ : Valid height grid, the corrupt copies are written next to it.
+ * @return : Number of failed checks.
+ */
+static unsigned int checkCorruptGrids( const std::string& filename_ )
+{
+	std::ifstream in( filename_.c_str(), std::ios::in | std::ios::binary );
+	std::vector<char> data( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+
+	// Offsets in the file layout of util_terrainHeightGrid: a 16 byte file header, followed by 48 byte level headers,
+	// which end with numLat, numLon, numTilesLat and numTilesLon.
+	const size_t numTilesLatOffset = 16 + 40;
+	const size_t numTilesLonOffset = 16 + 44;
+	unsigned int numTilesLat;
+	memcpy( &numTilesLat, &data[numTilesLatOffset], sizeof(unsigned int) );
+
+	struct corruption
+	{
+		const char* description;
+		size_t size;
+		size_t offset;
+		unsigned int value;
+	};
+	corruption corruptions[] = {
+		{"truncated samples", data.size()-4, data.size(), 0},
+		{"truncated level headers", 16+40, data.size(), 0},
+		{"tiles do not cover the samples", data.size(), numTilesLatOffset, numTilesLat-1},
+		{"tile count overflows the size", data.size(), numTilesLonOffset, 0xFFFFFFFF},
+		{"tile size too large", data.size(), 12, 0x80000000}
+	};
+
+	std::string corruptFilename = filename_ + ".corrupt";
+	unsigned int numFailed = 0;
+	for(unsigned int i=0; i<sizeof(corruptions)/sizeof(corruptions[0]); i++)
+	{
+		const corruption& c = corruptions[i];
+		if( !writeCorruptGrid( data, c.size, c.offset, c.value, corruptFilename ) )
+		{
+			OSG_NOTIFY( osg::WARN ) << "FAILED: Unable to write " << corruptFilename << std::endl;
+			return numFailed+1;
+		}
+		if( util_terrainHeightGrid::getInstance()->load( corruptFilename ) )
+		{
+			OSG_NOTIFY( osg::WARN ) << "FAILED: " << c.description << ": the corrupt grid was accepted." << std::endl;
+			util_terrainHeightGrid::getInstance()->unload();
+			numFailed++;
+		}
+		else
+			OSG_NOTIFY( osg::INFO ) << "passed: " << c.description << " rejected" << std::endl;
+	}
+	remove( corruptFilename.c_str() );
+
+	return numFailed;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" tests the terrain height grid lookups with a synthetic terrain of known heights.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options]");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("--create-terrain <filename>","Write the synthetic terrain, e.g. as input for osgVisualHeightGridCompiler.");
+	arguments.getApplicationUsage()->addCommandLineOption("--reference <filename>","Write a height grid computed from the terrain function and check it, and that corrupt copies of it are rejected.");
+	arguments.getApplicationUsage()->addCommandLineOption("--check <filename>","Check a height grid of the synthetic terrain, e.g. compiled by osgVisualHeightGridCompiler.");
+	arguments.getApplicationUsage()->addCommandLineOption("--tolerance <m>","Allowed deviation of the heights, default: 0.05");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string terrainFilename, referenceFilename, checkFilename;
+	arguments.read("--create-terrain", terrainFilename);
+	arguments.read("--reference", referenceFilename);
+	arguments.read("--check", checkFilename);
+
+	double tolerance = 0.05;
+	arguments.read("--tolerance", tolerance);
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	if( !terrainFilename.empty() )
+	{
+		osg::ref_ptr<osg::CoordinateSystemNode> terrain = createTerrain();
+		if( !osgDB::writeNodeFile( *terrain, terrainFilename ) )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Unable to write " << terrainFilename << std::endl;
+			return 1;
+		}
+		OSG_NOTIFY( osg::ALWAYS ) << "Terrain written to " << terrainFilename << std::endl;
+	}
+
+	unsigned int numFailed = 0;
+	if( !referenceFilename.empty() )
+	{
+		if( !writeReferenceGrid( referenceFilename ) )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Unable to write " << referenceFilename << std::endl;
+			return 1;
+		}
+		numFailed += checkGrid( referenceFilename, 0.001 );
+		numFailed += checkCorruptGrids( referenceFilename );
+	}
+
+	if( !checkFilename.empty() )
+		numFailed += checkGrid( checkFilename, tolerance );
+
+	if( numFailed > 0 )
+	{
+		OSG_NOTIFY( osg::FATAL ) << numFailed << " height grid checks failed." << std::endl;
+		return 1;
+	}
+
+	if( !referenceFilename.empty() || !checkFilename.empty() )
+		OSG_NOTIFY( osg::ALWAYS ) << "All height grid checks passed." << std::endl;
+	return 0;
+}
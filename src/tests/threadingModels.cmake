@@ -0,0 +1,68 @@
+# Runs a short headless benchmark of osgVisual in each threading model of the viewer. Built with USE_THREAD_SANITIZER, every data race
+# between the main thread, the task scheduler, the worker pool and the cull/draw threads is reported and fails the test.
+# Called by CTest: cmake -DOSGVISUAL=<osgVisual> -DTEST_PROGRAM=<osgVisualHeightGridTest> -DWORK_DIR=<dir> -P threadingModels.cmake
+# The pbuffer of --headless requires a display, e.g. run ctest with xvfb-run on a build server.
+
+SET(TERRAIN ${WORK_DIR}/threadingModelsTerrain.osgt)
+SET(CONFIG ${WORK_DIR}/threadingModels.xml)
+SET(PATH_FILE ${WORK_DIR}/threadingModels.path)
+
+# The synthetic terrain of the height grid test, queried by the ground clamping and the HUD.
+EXECUTE_PROCESS(COMMAND ${TEST_PROGRAM} --create-terrain ${TERRAIN} RESULT_VARIABLE result)
+IF(NOT result EQUAL 0)
+	MESSAGE(FATAL_ERROR "Unable to create the test terrain: ${result}")
+ENDIF()
+
+# Camera flying over the terrain at 47.05 N from 11.05 E to 11.07 E in 2500 m.
+FILE(WRITE ${PATH_FILE} "0.0 4274577.762 834765.621 4647383.819 0.0 0.0 0.0 1.0\n")
+FILE(APPEND ${PATH_FILE} "4.0 4274286.114 836257.679 4647383.819 0.0 0.0 0.0 1.0\n")
+
+# Master with the dummy cluster, so the swap barrier runs in the draw thread. A dynamic, ground clamped object runs the object jobs.
+FILE(WRITE ${CONFIG} "<?xml version=\"1.0\" encoding=\"ISO-8859-1\" ?>
+<osgvisualconfiguration>
+  <module name=\"distortion\" enabled=\"no\"></module>
+  <module name=\"sky_silverlining\" enabled=\"no\"></module>
+  <module name=\"vista2d\" enabled=\"no\"></module>
+  <module name=\"dataio\" enabled=\"yes\">
+    <dataio clusterrole=\"master\"></dataio>
+  </module>
+  <scenery>
+    <terrain filename=\"${TERRAIN}\"></terrain>
+    <models>
+      <model objectname=\"ThreadingTest\" trackingid=\"1\" label=\"ThreadingTest\" dynamic=\"yes\">
+        <position lat=\"47.05\" lon=\"11.06\" alt=\"2000.0\"></position>
+        <attitude rot_x=\"0.0\" rot_y=\"0.0\" rot_z=\"0.0\"></attitude>
+        <updater>
+          <position lat=\"OBJ_LAT\" lon=\"OBJ_LON\" alt=\"OBJ_ALT\"></position>
+          <attitude rot_x=\"OBJ_ROT_X\" rot_y=\"OBJ_ROT_Y\" rot_z=\"OBJ_ROT_Z\"></attitude>
+          <label text=\"OBJ_LABEL\"></label>
+        </updater>
+        <groundclamp enabled=\"yes\" mode=\"attitude\" offset=\"0.0\">
+          <footprint x=\"-1.5\" y=\"2.0\" z=\"-0.5\"></footprint>
+          <footprint x=\"1.5\" y=\"2.0\" z=\"-0.5\"></footprint>
+          <footprint x=\"0.0\" y=\"-3.0\" z=\"-0.5\"></footprint>
+        </groundclamp>
+      </model>
+    </models>
+  </scenery>
+</osgvisualconfiguration>
+")
+
+# Report all races of a run instead of stopping at the first one. TSan sets the exit code if it reported anything.
+SET(ENV{TSAN_OPTIONS} "halt_on_error=0 exitcode=66 second_deadlock_stack=1")
+
+SET(failed "")
+FOREACH(model SingleThreaded CullDrawThreadPerContext DrawThreadPerContext CullThreadPerCameraDrawThreadPerContext)
+	MESSAGE(STATUS "Threading model ${model}")
+	EXECUTE_PROCESS(COMMAND ${OSGVISUAL} -c ${CONFIG} --headless --benchmark ${PATH_FILE} --benchmark-frames 240 --${model}
+		WORKING_DIRECTORY ${WORK_DIR} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+	FILE(WRITE ${WORK_DIR}/threadingModels_${model}.log "${output}")
+	IF(NOT result EQUAL 0 OR output MATCHES "ThreadSanitizer")
+		MESSAGE(STATUS "${model} failed with ${result}, see ${WORK_DIR}/threadingModels_${model}.log")
+		LIST(APPEND failed ${model})
+	ENDIF()
+ENDFOREACH()
+
+IF(failed)
+	MESSAGE(FATAL_ERROR "Failed threading models: ${failed}")
+ENDIF()
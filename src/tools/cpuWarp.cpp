@@ -0,0 +1,214 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/ReadFile>
+#include <osgDB/WriteFile>
+
+#include <distortion_cpuWarp.h>
+#include <distortion_floatMap.h>
+#include <util_workerPool.h>
+
+using namespace osgVisual;
+
+/**
+ * \brief This function reads a distortion or blend map, either a float map or an image file.
+ *
+ */
+static osg::Image* readMap( const std::string& filename_ )
+{
+	if( distortion_floatMap::isFloatMap( filename_ ) )
+		return distortion_floatMap::read( filename_ );
+	return osgDB::readImageFile( filename_ );
+}
+
+/**
+ * \brief This function converts an 8 bit RGB image to RGBA, as required by distortion_cpuWarp.
+ *
+ * @param image_ : Image to convert.
+ * @return : RGBA image, the image itself if it is already RGBA, NULL if the format is not supported.
+ */
+static osg::Image* convertToRGBA( osg::Image* image_ )
+{
+	if( image_->getDataType() != GL_UNSIGNED_BYTE )
+		return NULL;
+	if( image_->getPixelFormat() == GL_RGBA )
+		return image_;
+	if( image_->getPixelFormat() != GL_RGB )
+		return NULL;
+
+	osg::Image* rgba = new osg::Image();
+	rgba->allocateImage( image_->s(), image_->t(), 1, GL_RGBA, GL_UNSIGNED_BYTE );
+	for(int y=0; y<image_->t(); y++)
+	{
+		const unsigned char* source = image_->data( 0, y );
+		unsigned char* target = rgba->data( 0, y );
+		for(int x=0; x<image_->s(); x++, source+=3, target+=4)
+		{
+			target[0] = source[0];
+			target[1] = source[1];
+			target[2] = source[2];
+			target[3] = 255;
+		}
+	}
+	return rgba;
+}
+
+/**
+ * \brief This function runs a kernel repeatedly and prints its throughput.
+ *
+ */
+static void benchmark( distortion_cpuWarp* warp_, const osg::Image* source_, osg::Image* target_, distortion_cpuWarp::kernelType kernel_, bool parallel_, unsigned int iterations_, const std::string& name_ )
+{
+	// The first run prepares the tables and is not measured.
+	warp_->apply( source_, target_, kernel_, parallel_ );
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	for(unsigned int i=0; i<iterations_; i++)
+		warp_->apply( source_, target_, kernel_, parallel_ );
+	double time = osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) / iterations_;
+
+	OSG_NOTIFY( osg::ALWAYS ) << name_ << ": " << time << " ms per frame, " << (target_->s() * target_->t()) / (time * 1000.0) << " Mpixel/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" warps and blends a rendered channel image on the CPU like the distortion shader of osgVisual.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options] --distortion <map> input output");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("--distortion <filename>","Distortion map, legacy 8 bit image or float map (*.fmap). Required.");
+	arguments.getApplicationUsage()->addCommandLineOption("--blend <filename>","Blend map, image or float map (*.fmap).");
+	arguments.getApplicationUsage()->addCommandLineOption("--size <width> <height>","Size of the output image, default: size of the input image.");
+	arguments.getApplicationUsage()->addCommandLineOption("--reference","Use the scalar reference kernel instead of the SIMD kernel.");
+	arguments.getApplicationUsage()->addCommandLineOption("--threads <n>","Number of worker threads, default: processors minus one. 0 processes on the calling thread only.");
+	arguments.getApplicationUsage()->addCommandLineOption("--validate","Compare the SIMD kernel with the reference kernel, fails if a channel differs by more than one.");
+	arguments.getApplicationUsage()->addCommandLineOption("--benchmark <iterations>","Measure the throughput of the kernels.");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string distortionFilename, blendFilename;
+	arguments.read("--distortion", distortionFilename);
+	arguments.read("--blend", blendFilename);
+
+	int width = 0, height = 0;
+	arguments.read("--size", width, height);
+
+	distortion_cpuWarp::kernelType kernel = arguments.read("--reference") ? distortion_cpuWarp::REFERENCE : distortion_cpuWarp::SIMD;
+
+	bool parallel = true;
+	int numThreads = -1;
+	if( arguments.read("--threads", numThreads) )
+	{
+		if( numThreads > 0 )
+			util_workerPool::getInstance()->start( numThreads );
+		else
+			parallel = false;
+	}
+
+	bool validate = arguments.read("--validate");
+	unsigned int iterations = 0;
+	arguments.read("--benchmark", iterations);
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	if( distortionFilename.empty() || arguments.argc() < 2 )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Distortion map, input and output file required." << std::endl;
+		return 1;
+	}
+	std::string inputFilename = arguments[1];
+	std::string outputFilename = arguments.argc() > 2 ? arguments[2] : "";
+
+	// Load maps and input
+	osg::ref_ptr<osg::Image> distortImage = readMap( distortionFilename );
+	osg::ref_ptr<osg::Image> blendImage = blendFilename.empty() ? NULL : readMap( blendFilename );
+	osg::ref_ptr<osg::Image> input = osgDB::readImageFile( inputFilename );
+	if( !distortImage.valid() || (!blendFilename.empty() && !blendImage.valid()) || !input.valid() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Unable to read distortion map, blend map or input image." << std::endl;
+		return 1;
+	}
+
+	osg::ref_ptr<osg::Image> source = convertToRGBA( input.get() );
+	if( !source.valid() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Unsupported input format, 8 bit RGB or RGBA required." << std::endl;
+		return 1;
+	}
+
+	osg::ref_ptr<osg::Image> target = new osg::Image();
+	target->allocateImage( width > 0 ? width : source->s(), height > 0 ? height : source->t(), 1, GL_RGBA, GL_UNSIGNED_BYTE );
+
+	osg::ref_ptr<distortion_cpuWarp> warp = new distortion_cpuWarp( distortImage.get(), blendImage.get() );
+
+	int result = 0;
+	if( validate )
+	{
+		osg::ref_ptr<osg::Image> reference = new osg::Image();
+		reference->allocateImage( target->s(), target->t(), 1, GL_RGBA, GL_UNSIGNED_BYTE );
+		warp->apply( source.get(), reference.get(), distortion_cpuWarp::REFERENCE, parallel );
+		warp->apply( source.get(), target.get(), distortion_cpuWarp::SIMD, parallel );
+
+		unsigned int maxDifference, numDifferentPixels;
+		distortion_cpuWarp::compare( reference.get(), target.get(), maxDifference, numDifferentPixels );
+		OSG_NOTIFY( osg::ALWAYS ) << "Validation (" << (distortion_cpuWarp::isSSE2Enabled() ? "SSE2" : "scalar") << " kernel): max difference " << maxDifference
+								  << ", " << numDifferentPixels << " of " << target->s()*target->t() << " pixels differ." << std::endl;
+		if( maxDifference > 1 )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Validation failed." << std::endl;
+			result = 1;
+		}
+	}
+
+	if( iterations > 0 )
+	{
+		std::string simdName = distortion_cpuWarp::isSSE2Enabled() ? "SIMD (SSE2)" : "SIMD (scalar fallback)";
+		benchmark( warp.get(), source.get(), target.get(), distortion_cpuWarp::SIMD, true, iterations, simdName + ", parallel" );
+		benchmark( warp.get(), source.get(), target.get(), distortion_cpuWarp::SIMD, false, iterations, simdName + ", single thread" );
+		benchmark( warp.get(), source.get(), target.get(), distortion_cpuWarp::REFERENCE, true, 1, "Reference, parallel" );
+	}
+
+	if( !outputFilename.empty() )
+	{
+		osg::Timer_t startTick = osg::Timer::instance()->tick();
+		warp->apply( source.get(), target.get(), kernel, parallel );
+		OSG_NOTIFY( osg::ALWAYS ) << "Warped " << inputFilename << " in " << osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) << " ms." << std::endl;
+
+		if( !osgDB::writeImageFile( *target, outputFilename ) )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Unable to write " << outputFilename << std::endl;
+			result = 1;
+		}
+	}
+
+	util_workerPool::getInstance()->shutdown();
+	return result;
+}
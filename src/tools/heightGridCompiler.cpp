@@ -0,0 +1,205 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/CoordinateSystemNode>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/ReadFile>
+#include <osgDB/Registry>
+#include <osgUtil/IntersectionVisitor>
+#include <osgUtil/LineSegmentIntersector>
+#include <osgSim/LineOfSight>
+
+#include <util_terrainHeightGrid.h>
+
+using namespace osgVisual;
+
+/**
+ * \brief This function samples one row of a height grid level by casting vertical rays through the terrain.
+ *
+ * The DatabaseCacheReadCallback pages in the highest level of detail for each ray.
+ *
+ * @param csn_ : Root of the terrain, including the ellipsoid model.
+ * @param readCallback_ : Read callback to load the highest level of detail.
+ * @param lat_ : Latitude of the row in radians.
+ * @param level_ : Level to sample.
+ * @param minHeight_ : Lowest height to test for.
+ * @param maxHeight_ : Highest height to test for.
+ * @param samples_ : Pointer to write the level_.numLon samples into.
+ * @return : Number of samples without terrain.
+ */
+static unsigned int sampleRow( osg::CoordinateSystemNode* csn_, osgSim::DatabaseCacheReadCallback* readCallback_, double lat_,
+							   const util_terrainHeightGrid::gridLevel& level_, double minHeight_, double maxHeight_, float* samples_ )
+{
+	osg::EllipsoidModel* em = csn_->getEllipsoidModel();
+	double lonSpacing = (level_.lonMax - level_.lonMin) / (level_.numLon-1);
+
+	osg::ref_ptr<osgUtil::IntersectorGroup> intersectorGroup = new osgUtil::IntersectorGroup();
+	for(unsigned int i=0; i<level_.numLon; i++)
+	{
+		double lon = level_.lonMin + i*lonSpacing;
+		osg::Vec3d start, end;
+		em->convertLatLongHeightToXYZ( lat_, lon, maxHeight_, start.x(), start.y(), start.z() );
+		em->convertLatLongHeightToXYZ( lat_, lon, minHeight_, end.x(), end.y(), end.z() );
+		intersectorGroup->addIntersector( new osgUtil::LineSegmentIntersector(start, end) );
+	}
+
+	osgUtil::IntersectionVisitor iv( intersectorGroup.get(), readCallback_ );
+	csn_->accept( iv );
+
+	unsigned int numNoData = 0;
+	osgUtil::IntersectorGroup::Intersectors& intersectors = intersectorGroup->getIntersectors();
+	for(unsigned int i=0; i<intersectors.size(); i++)
+	{
+		osgUtil::LineSegmentIntersector* lsi = static_cast<osgUtil::LineSegmentIntersector*>(intersectors[i].get());
+		if( lsi->containsIntersections() )
+		{
+			osg::Vec3d ip = lsi->getIntersections().begin()->getWorldIntersectPoint();
+			double lat, lon, height;
+			em->convertXYZToLatLongHeight( ip.x(), ip.y(), ip.z(), lat, lon, height );
+			samples_[i] = static_cast<float>(height);
+		}
+		else
+		{
+			samples_[i] = util_terrainHeightGrid::NO_DATA;
+			numNoData++;
+		}
+	}
+
+	return numNoData;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" samples a terrain database at its highest level of detail into a height grid file for osgVisual.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options] --level latMin lonMin latMax lonMax spacing terrainfile ...");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("-o <filename>","Output file, default: terrain.heightgrid");
+	arguments.getApplicationUsage()->addCommandLineOption("--level <latMin> <lonMin> <latMax> <lonMax> <spacing>","Add a grid level, all values in degrees. Specify levels from the coarsest to the finest. Required at least once.");
+	arguments.getApplicationUsage()->addCommandLineOption("--tile-size <n>","Edge length of the tiles in samples, default: 64");
+	arguments.getApplicationUsage()->addCommandLineOption("--min-height <m>","Lowest terrain height to test for, default: -1000");
+	arguments.getApplicationUsage()->addCommandLineOption("--max-height <m>","Highest terrain height to test for, default: 10000");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string outputFilename = "terrain.heightgrid";
+	arguments.read("-o", outputFilename);
+
+	unsigned int tileSize = 64;
+	arguments.read("--tile-size", tileSize);
+
+	double minHeight = -1000.0;
+	double maxHeight = 10000.0;
+	arguments.read("--min-height", minHeight);
+	arguments.read("--max-height", maxHeight);
+
+	// Parse grid levels
+	std::vector<util_terrainHeightGrid::gridLevel> levels;
+	double latMin, lonMin, latMax, lonMax, spacing;
+	while( arguments.read("--level", latMin, lonMin, latMax, lonMax, spacing) )
+	{
+		if( spacing <= 0.0 || latMax <= latMin || lonMax <= lonMin )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Invalid level: " << latMin << " " << lonMin << " " << latMax << " " << lonMax << " " << spacing << std::endl;
+			return 1;
+		}
+
+		util_terrainHeightGrid::gridLevel level;
+		level.numLat = static_cast<unsigned int>( (latMax-latMin)/spacing + 0.5 ) + 1;
+		level.numLon = static_cast<unsigned int>( (lonMax-lonMin)/spacing + 0.5 ) + 1;
+		level.latMin = osg::DegreesToRadians( latMin );
+		level.lonMin = osg::DegreesToRadians( lonMin );
+		level.latMax = osg::DegreesToRadians( latMin + (level.numLat-1)*spacing );	// Keep the spacing exact
+		level.lonMax = osg::DegreesToRadians( lonMin + (level.numLon-1)*spacing );
+		levels.push_back( level );
+	}
+	if( levels.empty() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "No grid level specified, use --level." << std::endl;
+		return 1;
+	}
+
+	// Load terrain. Each tile is intersected many times, so KdTrees pay off here.
+	osgDB::Registry::instance()->setBuildKdTreesHint(osgDB::ReaderWriter::Options::BUILD_KDTREES);
+	osg::ref_ptr<osg::Node> model = osgDB::readNodeFiles(arguments);
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+	if( !model.valid() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Unable to load terrain." << std::endl;
+		return 1;
+	}
+
+	osg::ref_ptr<osg::CoordinateSystemNode> csn = dynamic_cast<osg::CoordinateSystemNode*>( model.get() );
+	if( !csn.valid() )
+	{
+		csn = new osg::CoordinateSystemNode;
+		csn->setEllipsoidModel( new osg::EllipsoidModel() );
+		csn->addChild( model.get() );
+	}
+	else if( !csn->getEllipsoidModel() )
+		csn->setEllipsoidModel( new osg::EllipsoidModel() );
+
+	// Sample all levels row by row
+	osg::ref_ptr<osgSim::DatabaseCacheReadCallback> readCallback = new osgSim::DatabaseCacheReadCallback;
+	std::vector< std::vector<float> > heights( levels.size() );
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	for(unsigned int l=0; l<levels.size(); l++)
+	{
+		const util_terrainHeightGrid::gridLevel& level = levels[l];
+		OSG_NOTIFY( osg::ALWAYS ) << "Sampling level " << l << ": " << level.numLat << " x " << level.numLon << " samples" << std::endl;
+
+		heights[l].resize( level.numLat * level.numLon );
+		double latSpacing = (level.latMax - level.latMin) / (level.numLat-1);
+		unsigned int numNoData = 0;
+		unsigned int lastPercent = 0;
+		for(unsigned int i=0; i<level.numLat; i++)
+		{
+			numNoData += sampleRow( csn.get(), readCallback.get(), level.latMin + i*latSpacing, level, minHeight, maxHeight, &heights[l][i*level.numLon] );
+
+			unsigned int percent = (i+1)*100 / level.numLat;
+			if( percent >= lastPercent+10 )
+			{
+				OSG_NOTIFY( osg::ALWAYS ) << "  " << percent << "%" << std::endl;
+				lastPercent = percent;
+			}
+		}
+
+		if( numNoData > 0 )
+			OSG_NOTIFY( osg::WARN ) << "  " << numNoData << " samples without terrain." << std::endl;
+	}
+	OSG_NOTIFY( osg::ALWAYS ) << "Sampling done in " << osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() ) << " s." << std::endl;
+
+	if( !util_terrainHeightGrid::write( outputFilename, levels, heights, tileSize ) )
+		return 1;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "Height grid written to " << outputFilename << std::endl;
+	return 0;
+}
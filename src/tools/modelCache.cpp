@@ -0,0 +1,154 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/Registry>
+#include <osgDB/FileNameUtils>
+
+#include <util_modelCache.h>
+#include <visual_util.h>
+#include <util_config.h>
+
+using namespace osgVisual;
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" optimizes model files and writes them into the model cache of osgVisual.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options] [model files]");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("-c or --config <filename>","XML configuration filename: Uses its <modelcache> settings and adds the models of its scenery section.");
+	arguments.getApplicationUsage()->addCommandLineOption("-d <directory>","Cache directory, default: the <modelcache> directory of the configuration, otherwise modelcache");
+	arguments.getApplicationUsage()->addCommandLineOption("-p <path>","Add a path to search the model files in, like osgVisual does. May be used several times.");
+	arguments.getApplicationUsage()->addCommandLineOption("--rebuild","Rebuild existing cache entries.");
+	arguments.getApplicationUsage()->addCommandLineOption("--sharestate <yes|no>","Share duplicate state sets.");
+	arguments.getApplicationUsage()->addCommandLineOption("--merge <yes|no>","Merge geodes and geometries.");
+	arguments.getApplicationUsage()->addCommandLineOption("--tristrip <yes|no>","Convert the triangles into triangle strips.");
+	arguments.getApplicationUsage()->addCommandLineOption("--vertexcache <yes|no>","Optimize the vertex order for the post-transform vertex cache.");
+	arguments.getApplicationUsage()->addCommandLineOption("--texturecompression <none|arb|dxt>","Internal format of the textures.");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string configFilename = "";
+	if( !arguments.read("-c", configFilename) )
+		arguments.read("--config", configFilename);
+
+	std::string directory = "";
+	arguments.read("-d", directory);
+
+	std::string path;
+	while( arguments.read("-p", path) )
+		osgDB::Registry::instance()->getDataFilePathList().push_back( path );
+
+	bool rebuild = arguments.read("--rebuild");
+
+	// Settings of the configuration, overridden by the command line.
+	util_modelCache* cache = util_modelCache::getInstance();
+	std::vector<std::string> modelFiles;
+	if( !configFilename.empty() )
+	{
+		const util_config::node* scenery = util::getSceneryConfig(configFilename);
+		if( !scenery )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "No scenery section found in the configuration '" << configFilename << "'." << std::endl;
+			return 1;
+		}
+		cache->configure( scenery->getChild("modelcache") );
+		modelFiles = util::getModelFilesFromXMLConfig(configFilename);
+
+		// The terrain paths help osgVisual to find files, so they are searched here too.
+		std::vector<std::string> terrainFiles = util::getTerrainFromXMLConfig(configFilename);
+		for(unsigned int i=0;i<terrainFiles.size();i++)
+			osgDB::Registry::instance()->getDataFilePathList().push_back(osgDB::getFilePath(terrainFiles[i]));
+	}
+	if( !directory.empty() )
+		cache->setCacheDirectory( directory );
+	if( cache->getCacheDirectory().empty() )
+		cache->setCacheDirectory( "modelcache" );
+
+	util_modelCache::optimizerSettings settings = cache->getSettings();
+	std::string value;
+	if( arguments.read("--sharestate", value) )
+		settings.shareState = (value == "yes");
+	if( arguments.read("--merge", value) )
+		settings.mergeGeometry = (value == "yes");
+	if( arguments.read("--tristrip", value) )
+		settings.triStrip = (value == "yes");
+	if( arguments.read("--vertexcache", value) )
+		settings.vertexCache = (value == "yes");
+	if( arguments.read("--texturecompression", value) )
+	{
+		if( value == "none" )
+			settings.compression = util_modelCache::COMPRESSION_NONE;
+		else if( value == "arb" )
+			settings.compression = util_modelCache::COMPRESSION_ARB;
+		else if( value == "dxt" )
+			settings.compression = util_modelCache::COMPRESSION_DXT;
+		else
+			arguments.reportError("Unknown texture compression '"+value+"'.");
+	}
+	cache->setSettings( settings );
+
+	// All remaining non-option arguments are model files.
+	for(int i=1;i<arguments.argc();i++)
+	{
+		if( !arguments.isOption(i) )
+			modelFiles.push_back( arguments[i] );
+	}
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	if( modelFiles.empty() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "No model files to cache, use -c or list them on the command line." << std::endl;
+		return 1;
+	}
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	unsigned int numFailed = 0;
+	for(unsigned int i=0;i<modelFiles.size();i++)
+	{
+		osg::ref_ptr<osg::Node> model = cache->readNode( modelFiles[i], rebuild );
+		if( !model.valid() )
+		{
+			OSG_NOTIFY( osg::WARN ) << "Unable to read " << modelFiles[i] << std::endl;
+			numFailed++;
+		}
+		else if( cache->getCacheFilename( modelFiles[i] ).empty() )
+		{
+			OSG_NOTIFY( osg::WARN ) << "Unable to cache " << modelFiles[i] << ", the file is not found in the data file path list." << std::endl;
+			numFailed++;
+		}
+	}
+
+	cache->printReport();
+	OSG_NOTIFY( osg::ALWAYS ) << "Processed " << modelFiles.size() << " models in " << osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() ) << " s, " << numFailed << " failed." << std::endl;
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/Registry>
+#include <osgDB/FileNameUtils>
+
+#include <core_sceneryArchive.h>
+#include <visual_util.h>
+#include <util_config.h>
+#include <util_modelCache.h>
+
+using namespace osgVisual;
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" compiles the scenery section of an osgVisual configuration and the referenced models into a scenery archive.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options] -c XML-Configurationfile");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("-c or --config <filename>","XML configuration filename. Required.");
+	arguments.getApplicationUsage()->addCommandLineOption("-o <filename>","Output file, default: the <sceneryarchive> filename of the configuration, otherwise scenery.ovsc");
+	arguments.getApplicationUsage()->addCommandLineOption("-p <path>","Add a path to search the model files in, like osgVisual does. May be used several times.");
+	arguments.getApplicationUsage()->addCommandLineOption("--no-optimize","Store the models as loaded, without the optimizer chain of the <modelcache> configuration.");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string configFilename = "";
+	if( !arguments.read("-c", configFilename) )
+		arguments.read("--config", configFilename);
+
+	std::string outputFilename = "";
+	arguments.read("-o", outputFilename);
+
+	std::string path;
+	while( arguments.read("-p", path) )
+		osgDB::Registry::instance()->getDataFilePathList().push_back( path );
+
+	bool optimize = !arguments.read("--no-optimize");
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	const util_config::node* sceneryNode = configFilename.empty() ? NULL : util::getSceneryConfig(configFilename);
+	if( !sceneryNode )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "No scenery section found in the configuration '" << configFilename << "', use -c." << std::endl;
+		return 1;
+	}
+
+	// The terrain paths help osgVisual to find files, so they are searched here too.
+	std::vector<std::string> terrainFiles = util::getTerrainFromXMLConfig(configFilename);
+	for(unsigned int i=0;i<terrainFiles.size();i++)
+		osgDB::Registry::instance()->getDataFilePathList().push_back(osgDB::getFilePath(terrainFiles[i]));
+
+	// Optimize like osgVisual does when it loads the models itself.
+	util_modelCache::getInstance()->configure( sceneryNode->getChild("modelcache") );
+
+	if( outputFilename.empty() )
+		outputFilename = util::getSceneryArchiveFromXMLConfig(configFilename);
+	if( outputFilename.empty() )
+		outputFilename = "scenery.ovsc";
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	if( !core_sceneryArchive::write( outputFilename, sceneryNode, optimize ) )
+		return 1;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "Compiled in " << osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() ) << " s." << std::endl;
+	return 0;
+}
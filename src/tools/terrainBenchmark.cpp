@@ -0,0 +1,567 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/CoordinateSystemNode>
+#include <osg/MatrixTransform>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/KdTree>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/FileUtils>
+
+#include <visual_util.h>
+#include <terrainQuery.h>
+#include <util_kdTreeBuilder.h>
+#include <util_workerPool.h>
+#include <util_terrainHeightGrid.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+
+using namespace osgVisual;
+
+/**
+ * \brief This struct contains the result of one benchmark run.
+ *
+ */
+struct benchmarkResult
+{
+	std::string name;			// Benchmarked function
+	unsigned int tileSize;		// Vertices per tile edge, 0 if independent from the terrain
+	std::string kdTree;			// KdTree mode: none, prebuilt, lazy or n/a
+	std::string pass;			// cold (first pass over a fresh scene) or warm (repeated pass)
+	std::string access;			// random or coherent query order
+	unsigned int queries;		// Number of queries or segments
+	double totalTime;			// Total time in ms
+	unsigned int hits;			// Number of successful queries
+};
+
+/**
+ * \brief This struct describes a geodetic query position.
+ *
+ */
+struct queryPoint
+{
+	double lat;
+	double lon;
+
+	bool operator < (const queryPoint& rhs) const { return lat < rhs.lat || (lat == rhs.lat && lon < rhs.lon); }
+};
+
+/**
+ * \brief This function returns the height of the procedural terrain in meter.
+ *
+ * @param lat_ : Latitude in radians.
+ * @param lon_ : Longitude in radians.
+ * @return : Height in meter.
+ */
+static double terrainHeight( double lat_, double lon_ )
+{
+	return 500.0 + 150.0*sin(lat_*4000.0)*cos(lon_*3000.0) + 40.0*sin(lat_*17000.0 + lon_*11000.0);
+}
+
+/**
+ * \brief This function creates one terrain tile as regular grid of triangles, located by a MatrixTransform like paged terrain databases do.
+ *
+ * @param em_ : Ellipsoid model.
+ * @param latMin_ : Southern border in radians.
+ * @param lonMin_ : Western border in radians.
+ * @param extent_ : Edge length of the tile in radians.
+ * @param size_ : Number of vertices per tile edge.
+ * @return : Tile node.
+ */
+static osg::Node* createTile( osg::EllipsoidModel* em_, double latMin_, double lonMin_, double extent_, unsigned int size_ )
+{
+	osg::Matrixd localToWorld;
+	em_->computeLocalToWorldTransformFromLatLongHeight( latMin_ + extent_*0.5, lonMin_ + extent_*0.5, 0.0, localToWorld );
+	osg::Matrixd worldToLocal = osg::Matrixd::inverse( localToWorld );
+
+	osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+	vertices->reserve( size_*size_ );
+	for(unsigned int i=0; i<size_; i++)
+	{
+		for(unsigned int j=0; j<size_; j++)
+		{
+			double lat = latMin_ + extent_*i/(size_-1);
+			double lon = lonMin_ + extent_*j/(size_-1);
+			osg::Vec3d world;
+			em_->convertLatLongHeightToXYZ( lat, lon, terrainHeight(lat, lon), world.x(), world.y(), world.z() );
+			vertices->push_back( osg::Vec3( world * worldToLocal ) );
+		}
+	}
+
+	osg::ref_ptr<osg::DrawElementsUInt> triangles = new osg::DrawElementsUInt( GL_TRIANGLES );
+	triangles->reserve( (size_-1)*(size_-1)*6 );
+	for(unsigned int i=0; i<size_-1; i++)
+	{
+		for(unsigned int j=0; j<size_-1; j++)
+		{
+			unsigned int v = i*size_ + j;
+			triangles->push_back( v );	triangles->push_back( v+1 );		triangles->push_back( v+size_ );
+			triangles->push_back( v+1 );	triangles->push_back( v+size_+1 );	triangles->push_back( v+size_ );
+		}
+	}
+
+	osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+	geometry->setVertexArray( vertices.get() );
+	geometry->addPrimitiveSet( triangles.get() );
+
+	osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+	geode->addDrawable( geometry.get() );
+
+	osg::MatrixTransform* transform = new osg::MatrixTransform( localToWorld );
+	transform->addChild( geode.get() );
+	return transform;
+}
+
+/**
+ * \brief This function creates the synthetic terrain: numTiles_ x numTiles_ tiles below a CoordinateSystemNode.
+ *
+ */
+static osg::CoordinateSystemNode* createTerrain( double latMin_, double lonMin_, double tileExtent_, unsigned int numTiles_, unsigned int tileSize_ )
+{
+	osg::CoordinateSystemNode* csn = new osg::CoordinateSystemNode;
+	csn->setEllipsoidModel( new osg::EllipsoidModel() );
+
+	for(unsigned int i=0; i<numTiles_; i++)
+		for(unsigned int j=0; j<numTiles_; j++)
+			csn->addChild( createTile( csn->getEllipsoidModel(), latMin_ + i*tileExtent_, lonMin_ + j*tileExtent_, tileExtent_, tileSize_ ) );
+
+	return csn;
+}
+
+/**
+ * \brief This function creates deterministic pseudo random query points inside the terrain area.
+ *
+ */
+static std::vector<queryPoint> createQueryPoints( unsigned int num_, double latMin_, double lonMin_, double extent_, bool coherent_ )
+{
+	std::vector<queryPoint> points( num_ );
+	unsigned int seed = 12345;
+	for(unsigned int i=0; i<num_; i++)
+	{
+		seed = seed*1103515245 + 12345;
+		points[i].lat = latMin_ + extent_ * (0.02 + 0.96*((seed>>8) & 0xffff) / 65535.0);
+		seed = seed*1103515245 + 12345;
+		points[i].lon = lonMin_ + extent_ * (0.02 + 0.96*((seed>>8) & 0xffff) / 65535.0);
+	}
+
+	// Coherent access: neighbouring queries hit neighbouring triangles.
+	if( coherent_ )
+		std::sort( points.begin(), points.end() );
+
+	return points;
+}
+
+/**
+ * \brief This function waits until all lazily scheduled KdTrees are built and installs them.
+ *
+ */
+static void waitForKdTrees()
+{
+	while( util_kdTreeBuilder::getInstance()->getNumPendingTrees() > 0 )
+	{
+		util_kdTreeBuilder::getInstance()->installCompletedKdTrees();
+		OpenThreads::Thread::microSleep( 1000 );
+	}
+	util_kdTreeBuilder::getInstance()->installCompletedKdTrees();
+}
+
+static osg::Timer_t startTick;
+
+static void startTimer()
+{
+	startTick = osg::Timer::instance()->tick();
+}
+
+static benchmarkResult stopTimer( const std::string& name_, unsigned int tileSize_, const std::string& kdTree_, const std::string& pass_, const std::string& access_, unsigned int queries_, unsigned int hits_ )
+{
+	benchmarkResult result;
+	result.totalTime = osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() );
+	result.name = name_;
+	result.tileSize = tileSize_;
+	result.kdTree = kdTree_;
+	result.pass = pass_;
+	result.access = access_;
+	result.queries = queries_;
+	result.hits = hits_;
+	return result;
+}
+
+/**
+ * \brief This function benchmarks the geodetic conversions, which are independent from the terrain.
+ *
+ */
+static void benchmarkConversions( std::vector<benchmarkResult>& results_, const std::vector<queryPoint>& points_ )
+{
+	osg::ref_ptr<osg::CoordinateSystemNode> csn = new osg::CoordinateSystemNode;
+	csn->setEllipsoidModel( new osg::EllipsoidModel() );
+	osg::EllipsoidModel* em = csn->getEllipsoidModel();
+	std::vector<osg::Vec3d> xyz( points_.size() );
+	double sink = 0.0;
+
+	startTimer();
+	for(unsigned int i=0; i<points_.size(); i++)
+		em->convertLatLongHeightToXYZ( points_[i].lat, points_[i].lon, 500.0, xyz[i].x(), xyz[i].y(), xyz[i].z() );
+	results_.push_back( stopTimer("ellipsoid_latlonheight_to_xyz", 0, "n/a", "warm", "random", points_.size(), points_.size()) );
+
+	startTimer();
+	unsigned int hits = 0;
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		double x = 0.0, y, z;
+		if( util::calculateXYZAtWGS84Coordinate( points_[i].lat, points_[i].lon, 500.0, csn.get(), x, y, z ) )
+			hits++;
+		sink += x;
+	}
+	results_.push_back( stopTimer("util_calculateXYZAtWGS84Coordinate", 0, "n/a", "warm", "random", points_.size(), hits) );
+
+	startTimer();
+	for(unsigned int i=0; i<xyz.size(); i++)
+	{
+		double lat, lon, height;
+		em->convertXYZToLatLongHeight( xyz[i].x(), xyz[i].y(), xyz[i].z(), lat, lon, height );
+		sink += height;
+	}
+	results_.push_back( stopTimer("ellipsoid_xyz_to_latlonheight", 0, "n/a", "warm", "random", xyz.size(), xyz.size()) );
+
+	startTimer();
+	hits = 0;
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		double radius = 0.0;
+		if( util::calculateEarthRadiusAtWGS84Coordinate( points_[i].lat, points_[i].lon, csn.get(), radius ) )
+			hits++;
+		sink += radius;
+	}
+	results_.push_back( stopTimer("util_calculateEarthRadiusAtWGS84Coordinate", 0, "n/a", "warm", "random", points_.size(), hits) );
+
+	if( sink == 0.123 )	// Prevents the compiler from removing the loops.
+		OSG_NOTIFY( osg::ALWAYS ) << sink << std::endl;
+}
+
+/**
+ * \brief This function runs all single query benchmarks for one pass.
+ *
+ */
+static void benchmarkSingleQueries( std::vector<benchmarkResult>& results_, osg::CoordinateSystemNode* csn_, const std::vector<queryPoint>& points_,
+									unsigned int tileSize_, const std::string& kdTree_, const std::string& pass_, const std::string& access_ )
+{
+	osg::EllipsoidModel* em = csn_->getEllipsoidModel();
+	unsigned int hits = 0;
+
+	// util::intersect with vertical rays
+	startTimer();
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		osg::Vec3d start, end, ip;
+		em->convertLatLongHeightToXYZ( points_[i].lat, points_[i].lon, 2000.0, start.x(), start.y(), start.z() );
+		em->convertLatLongHeightToXYZ( points_[i].lat, points_[i].lon, -1000.0, end.x(), end.y(), end.z() );
+		if( util::intersect( start, end, ip, csn_ ) )
+			hits++;
+	}
+	results_.push_back( stopTimer("util_intersect", tileSize_, kdTree_, pass_, access_, points_.size(), hits) );
+
+	// util::queryHeightOfTerrain
+	hits = 0;
+	startTimer();
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		double hot;
+		if( util::queryHeightOfTerrain( hot, csn_, points_[i].lat, points_[i].lon ) )
+			hits++;
+	}
+	results_.push_back( stopTimer("util_queryHeightOfTerrain", tileSize_, kdTree_, pass_, access_, points_.size(), hits) );
+
+	// util::queryHeightAboveTerrainInWGS84
+	hits = 0;
+	startTimer();
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		double hat;
+		if( util::queryHeightAboveTerrainInWGS84( hat, csn_, points_[i].lat, points_[i].lon, 1500.0 ) )
+			hits++;
+	}
+	results_.push_back( stopTimer("util_queryHeightAboveTerrainInWGS84", tileSize_, kdTree_, pass_, access_, points_.size(), hits) );
+}
+
+/**
+ * \brief This function runs all batched query benchmarks for one pass.
+ *
+ */
+static void benchmarkBatchQueries( std::vector<benchmarkResult>& results_, osg::CoordinateSystemNode* csn_, const std::vector<queryPoint>& points_, unsigned int batchSize_,
+								   unsigned int tileSize_, const std::string& kdTree_, const std::string& pass_, const std::string& access_ )
+{
+	osg::EllipsoidModel* em = csn_->getEllipsoidModel();
+
+	// terrainQuery::computeIntersections (HAT batch)
+	terrainQuery hatQuery;
+	hatQuery.setDatabaseCacheReadCallback( NULL );
+	unsigned int hits = 0;
+	startTimer();
+	for(unsigned int first=0; first<points_.size(); first+=batchSize_)
+	{
+		hatQuery.clear();
+		unsigned int last = osg::minimum( first+batchSize_, (unsigned int)points_.size() );
+		for(unsigned int i=first; i<last; i++)
+		{
+			osg::Vec3d point;
+			em->convertLatLongHeightToXYZ( points_[i].lat, points_[i].lon, 1500.0, point.x(), point.y(), point.z() );
+			hatQuery.addPoint( point );
+		}
+		hatQuery.computeIntersections( csn_ );
+		for(unsigned int i=0; i<hatQuery.getNumPoints(); i++)
+			if( hatQuery.getHeightOfTerrain(i) != 0.0 )
+				hits++;
+	}
+	results_.push_back( stopTimer("terrainQuery_computeIntersections", tileSize_, kdTree_, pass_, access_, points_.size(), hits) );
+
+	// terrainQuery::computeLineOfSight with slanted segments, serial and parallel
+	for(unsigned int parallel=0; parallel<2; parallel++)
+	{
+		terrainQuery losQuery;
+		losQuery.setDatabaseCacheReadCallback( NULL );
+		losQuery.setMinSegmentsPerThread( parallel ? 64 : 0xffffffff );
+		hits = 0;
+		startTimer();
+		for(unsigned int first=0; first<points_.size(); first+=batchSize_)
+		{
+			losQuery.clearSegments();
+			unsigned int last = osg::minimum( first+batchSize_, (unsigned int)points_.size() );
+			for(unsigned int i=first; i<last; i++)
+			{
+				osg::Vec3d start, end;
+				em->convertLatLongHeightToXYZ( points_[i].lat, points_[i].lon, 1200.0, start.x(), start.y(), start.z() );
+				em->convertLatLongHeightToXYZ( points_[i].lat + 0.0001, points_[i].lon + 0.0001, 0.0, end.x(), end.y(), end.z() );
+				losQuery.addSegment( start, end );
+			}
+			losQuery.computeLineOfSight( csn_ );
+			for(unsigned int i=0; i<losQuery.getNumSegments(); i++)
+				if( losQuery.getSegmentHit(i) )
+					hits++;
+		}
+		results_.push_back( stopTimer(parallel ? "terrainQuery_computeLineOfSight_parallel" : "terrainQuery_computeLineOfSight_serial", tileSize_, kdTree_, pass_, access_, points_.size(), hits) );
+	}
+}
+
+/**
+ * \brief This function benchmarks the memory mapped height grid, sampled from the synthetic terrain.
+ *
+ */
+static void benchmarkHeightGrid( std::vector<benchmarkResult>& results_, osg::CoordinateSystemNode* csn_, const std::vector<queryPoint>& points_,
+								 double latMin_, double lonMin_, double extent_, unsigned int tileSize_, const std::string& access_ )
+{
+	std::vector<util_terrainHeightGrid::gridLevel> levels(1);
+	levels[0].latMin = latMin_;
+	levels[0].lonMin = lonMin_;
+	levels[0].latMax = latMin_ + extent_;
+	levels[0].lonMax = lonMin_ + extent_;
+	levels[0].numLat = 256;
+	levels[0].numLon = 256;
+
+	std::vector< std::vector<float> > heights(1);
+	heights[0].resize( levels[0].numLat * levels[0].numLon );
+	for(unsigned int i=0; i<levels[0].numLat; i++)
+	{
+		for(unsigned int j=0; j<levels[0].numLon; j++)
+		{
+			double hot;
+			if( !util::queryHeightOfTerrain( hot, csn_, latMin_ + extent_*i/(levels[0].numLat-1), lonMin_ + extent_*j/(levels[0].numLon-1) ) )
+				hot = util_terrainHeightGrid::NO_DATA;
+			heights[0][i*levels[0].numLon + j] = static_cast<float>(hot);
+		}
+	}
+
+	std::string filename = "osgVisualTerrainBenchmark.heightgrid";
+	if( !util_terrainHeightGrid::write( filename, levels, heights, 64 ) || !util_terrainHeightGrid::getInstance()->load( filename ) )
+		return;
+
+	unsigned int hits = 0;
+	startTimer();
+	for(unsigned int i=0; i<points_.size(); i++)
+	{
+		double hot;
+		if( util_terrainHeightGrid::getInstance()->queryHeightOfTerrain( hot, points_[i].lat, points_[i].lon ) )
+			hits++;
+	}
+	results_.push_back( stopTimer("util_terrainHeightGrid_queryHeightOfTerrain", tileSize_, "n/a", "warm", access_, points_.size(), hits) );
+
+	util_terrainHeightGrid::getInstance()->unload();
+	remove( filename.c_str() );
+}
+
+static void writeCSV( std::ostream& out_, const std::vector<benchmarkResult>& results_ )
+{
+	out_ << "name,tile_size,kdtree,pass,access,queries,total_ms,per_query_us,hits" << std::endl;
+	for(unsigned int i=0; i<results_.size(); i++)
+	{
+		const benchmarkResult& r = results_[i];
+		out_ << r.name << "," << r.tileSize << "," << r.kdTree << "," << r.pass << "," << r.access << "," << r.queries << ","
+			 << r.totalTime << "," << (r.queries ? r.totalTime*1000.0/r.queries : 0.0) << "," << r.hits << std::endl;
+	}
+}
+
+static void writeJSON( std::ostream& out_, const std::vector<benchmarkResult>& results_ )
+{
+	out_ << "{" << std::endl << "  \"benchmark\": \"osgVisualTerrainBenchmark\"," << std::endl << "  \"results\": [" << std::endl;
+	for(unsigned int i=0; i<results_.size(); i++)
+	{
+		const benchmarkResult& r = results_[i];
+		out_ << "    {\"name\": \"" << r.name << "\", \"tile_size\": " << r.tileSize << ", \"kdtree\": \"" << r.kdTree << "\", \"pass\": \"" << r.pass
+			 << "\", \"access\": \"" << r.access << "\", \"queries\": " << r.queries << ", \"total_ms\": " << r.totalTime
+			 << ", \"per_query_us\": " << (r.queries ? r.totalTime*1000.0/r.queries : 0.0) << ", \"hits\": " << r.hits << "}"
+			 << (i+1 < results_.size() ? "," : "") << std::endl;
+	}
+	out_ << "  ]" << std::endl << "}" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" benchmarks the terrain queries of osgVisual on a synthetic terrain. It requires no graphics context.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [options]");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("--sizes <n,n,..>","Vertices per tile edge to benchmark, default: 17,65,257");
+	arguments.getApplicationUsage()->addCommandLineOption("--tiles <n>","Number of tiles per terrain edge, default: 4");
+	arguments.getApplicationUsage()->addCommandLineOption("--queries <n>","Number of queries per benchmark, default: 2000");
+	arguments.getApplicationUsage()->addCommandLineOption("--batch <n>","Batch size for batched queries, default: 256");
+	arguments.getApplicationUsage()->addCommandLineOption("--threads <n>","Number of worker threads, default: processors minus one");
+	arguments.getApplicationUsage()->addCommandLineOption("--format <csv|json>","Output format, default: csv");
+	arguments.getApplicationUsage()->addCommandLineOption("-o <filename>","Write results to file instead of stdout.");
+
+	if( arguments.read("-h") || arguments.read("--help") )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	std::string sizesString = "17,65,257";
+	arguments.read("--sizes", sizesString);
+	std::vector<unsigned int> sizes;
+	std::stringstream sizesStream( sizesString );
+	std::string sizeString;
+	while( std::getline( sizesStream, sizeString, ',' ) )
+	{
+		int size = util::strToInt( sizeString );
+		if( size >= 2 )
+			sizes.push_back( size );
+	}
+
+	unsigned int numTiles = 4, numQueries = 2000, batchSize = 256, numThreads = 0;
+	arguments.read("--tiles", numTiles);
+	arguments.read("--queries", numQueries);
+	arguments.read("--batch", batchSize);
+	arguments.read("--threads", numThreads);
+	if( numTiles == 0 || batchSize == 0 )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Invalid --tiles or --batch." << std::endl;
+		return 1;
+	}
+
+	std::string format = "csv", outputFilename = "";
+	arguments.read("--format", format);
+	arguments.read("-o", outputFilename);
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	// Keep notifications of the queried functions out of the timing.
+	osg::setNotifyLevel( osg::WARN );
+	util_workerPool::getInstance()->start( numThreads );
+
+	// Terrain area around Munich, about 2.2 km per tile.
+	double latMin = osg::DegreesToRadians( 48.0 );
+	double lonMin = osg::DegreesToRadians( 11.0 );
+	double tileExtent = osg::DegreesToRadians( 0.02 );
+	double extent = tileExtent * numTiles;
+
+	std::vector<benchmarkResult> results;
+
+	std::vector<queryPoint> randomPoints = createQueryPoints( numQueries, latMin, lonMin, extent, false );
+	std::vector<queryPoint> coherentPoints = createQueryPoints( numQueries, latMin, lonMin, extent, true );
+
+	benchmarkConversions( results, randomPoints );
+
+	const char* kdTreeModes[] = { "none", "prebuilt", "lazy" };
+	for(unsigned int s=0; s<sizes.size(); s++)
+	{
+		for(unsigned int k=0; k<3; k++)
+		{
+			std::string kdTree = kdTreeModes[k];
+			OSG_NOTIFY( osg::WARN ) << "Benchmarking tile size " << sizes[s] << ", KdTree: " << kdTree << std::endl;
+
+			// Fresh terrain for each mode, so no KdTree survives from the previous mode.
+			osg::ref_ptr<osg::CoordinateSystemNode> csn = createTerrain( latMin, lonMin, tileExtent, numTiles, sizes[s] );
+			if( kdTree == "prebuilt" )
+			{
+				osg::ref_ptr<osg::KdTreeBuilder> kdTreeBuilder = new osg::KdTreeBuilder;
+				csn->accept( *kdTreeBuilder );
+			}
+			util_kdTreeBuilder::getInstance()->setEnabled( kdTree == "lazy" );
+
+			// Cold pass: first queries on the fresh scene, for lazy KdTrees including the scheduling of the builds.
+			benchmarkSingleQueries( results, csn.get(), randomPoints, sizes[s], kdTree, "cold", "random" );
+			if( kdTree == "lazy" )
+				waitForKdTrees();
+
+			// Warm passes
+			benchmarkSingleQueries( results, csn.get(), randomPoints, sizes[s], kdTree, "warm", "random" );
+			benchmarkSingleQueries( results, csn.get(), coherentPoints, sizes[s], kdTree, "warm", "coherent" );
+			benchmarkBatchQueries( results, csn.get(), randomPoints, batchSize, sizes[s], kdTree, "warm", "random" );
+			benchmarkBatchQueries( results, csn.get(), coherentPoints, batchSize, sizes[s], kdTree, "warm", "coherent" );
+
+			if( kdTree == "prebuilt" )
+			{
+				benchmarkHeightGrid( results, csn.get(), randomPoints, latMin, lonMin, extent, sizes[s], "random" );
+				benchmarkHeightGrid( results, csn.get(), coherentPoints, latMin, lonMin, extent, sizes[s], "coherent" );
+			}
+		}
+	}
+
+	util_workerPool::getInstance()->shutdown();
+
+	// Output
+	std::ofstream outFile;
+	if( !outputFilename.empty() )
+	{
+		outFile.open( outputFilename.c_str() );
+		if( !outFile )
+		{
+			OSG_NOTIFY( osg::FATAL ) << "Unable to open " << outputFilename << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = outputFilename.empty() ? std::cout : outFile;
+
+	if( format == "json" )
+		writeJSON( out, results );
+	else
+		writeCSV( out, results );
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <osg/ArgumentParser>
+#include <osg/ApplicationUsage>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/ReadFile>
+
+#include <distortion_floatMap.h>
+
+using namespace osgVisual;
+
+/**
+ * \brief This function converts one map and writes it as float map.
+ *
+ * @param inputFilename_ : Legacy 8 bit map.
+ * @param outputFilename_ : Float map to write.
+ * @param warpMap_ : True for a distortion map, false for a blend map.
+ * @return : True if successful.
+ */
+static bool convertMap( const std::string& inputFilename_, const std::string& outputFilename_, bool warpMap_ )
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+	osg::ref_ptr<osg::Image> image = osgDB::readImageFile( inputFilename_ );
+	if( !image.valid() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Unable to read " << inputFilename_ << std::endl;
+		return false;
+	}
+
+	osg::ref_ptr<osg::Image> floatMap = warpMap_ ? distortion_floatMap::convertLegacyWarpMap( image.get() ) : distortion_floatMap::convertBlendMap( image.get() );
+	if( !floatMap.valid() || !distortion_floatMap::write( outputFilename_, floatMap.get() ) )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Unable to convert " << inputFilename_ << std::endl;
+		return false;
+	}
+
+	// Verify the written file
+	osg::ref_ptr<osg::Image> verify = distortion_floatMap::read( outputFilename_ );
+	if( !verify.valid() || verify->s() != image->s() || verify->t() != image->t() )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Verification of " << outputFilename_ << " failed." << std::endl;
+		return false;
+	}
+
+	OSG_NOTIFY( osg::ALWAYS ) << (warpMap_ ? "Warp map " : "Blend map ") << inputFilename_ << " (" << image->s() << "x" << image->t() << ") converted to "
+							  << outputFilename_ << " in " << osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) << " ms." << std::endl;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	osg::ArgumentParser arguments(&argc,argv);
+
+	arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+	arguments.getApplicationUsage()->setDescription(arguments.getApplicationName()+" converts Projection Designer's 8 bit distortion and blend maps into float maps (*.fmap) for osgVisual.");
+	arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName()+" [--warp <input> <output>] [--blend <input> <output>] ...");
+	arguments.getApplicationUsage()->addCommandLineOption("-h or --help","Display this information.");
+	arguments.getApplicationUsage()->addCommandLineOption("--warp <input> <output>","Convert a distortion map, e.g. distort_center.bmp distort_center.fmap");
+	arguments.getApplicationUsage()->addCommandLineOption("--blend <input> <output>","Convert a blend map, e.g. blend_center.bmp blend_center.fmap");
+
+	if( arguments.read("-h") || arguments.read("--help") || arguments.argc() <= 1 )
+	{
+		arguments.getApplicationUsage()->write(std::cout, osg::ApplicationUsage::COMMAND_LINE_OPTION);
+		return 1;
+	}
+
+	unsigned int numConverted = 0;
+	std::string inputFilename, outputFilename;
+	while( arguments.read("--warp", inputFilename, outputFilename) )
+	{
+		if( !convertMap( inputFilename, outputFilename, true ) )
+			return 1;
+		numConverted++;
+	}
+	while( arguments.read("--blend", inputFilename, outputFilename) )
+	{
+		if( !convertMap( inputFilename, outputFilename, false ) )
+			return 1;
+		numConverted++;
+	}
+
+	arguments.reportRemainingOptionsAsUnrecognized();
+	if( arguments.errors() )
+	{
+		arguments.writeErrorMessages(std::cout);
+		return 1;
+	}
+
+	if( numConverted == 0 )
+	{
+		OSG_NOTIFY( osg::FATAL ) << "Nothing to convert, use --warp or --blend." << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -19,13 +19,53 @@
 
 #include <osg/Notify>
 #include <osgUtil/LineSegmentIntersector>
+#include <util_kdTreeBuilder.h>
+#include <util_workerPool.h>
+#include <visual_dataIO.h>
+#include <util_log.h>
+#include <util_allocTracker.h>
 
 using namespace osgVisual;
 using namespace osgSim;
 
+namespace osgVisual {
+
+/** Operation to intersect one chunk of the line of sight list on a worker thread.*/
+class lineOfSightOperation : public osg::Operation
+{
+    public :
+
+        lineOfSightOperation(osg::Node* scene, osg::Node::NodeMask traversalMask, osgUtil::IntersectionVisitor::ReadCallback* readCallback,
+                             terrainQuery::LOSList& losList, unsigned int begin, unsigned int end):
+            osg::Operation("lineOfSightOperation", false),
+            _scene(scene),
+            _traversalMask(traversalMask),
+            _readCallback(readCallback),
+            _losList(losList),
+            _begin(begin),
+            _end(end) {}
+
+        virtual void operator () (osg::Object*)
+        {
+            OSGVISUAL_ALLOC_SCOPE(TERRAIN);
+            terrainQuery::intersectSegments(_scene, _traversalMask, _readCallback, _losList, _begin, _end, _hitDrawables);
+        }
+
+        osg::Node*                                          _scene;
+        osg::Node::NodeMask                                 _traversalMask;
+        osgUtil::IntersectionVisitor::ReadCallback*         _readCallback;
+        terrainQuery::LOSList&                              _losList;
+        unsigned int                                        _begin;
+        unsigned int                                        _end;
+        std::vector< osg::ref_ptr<osg::Drawable> >          _hitDrawables;
+};
+
+}
+
 terrainQuery::terrainQuery()
 {
     _lowestHeight = -1000.0;
+    _minSegmentsPerThread = 64;
     
 	setDatabaseCacheReadCallback(new DatabaseCacheReadCallback);
 }
@@ -44,6 +84,7 @@ unsigned int terrainQuery::addPoint(const osg::Vec3d& point)
 
 void terrainQuery::computeIntersections(osg::Node* scene, osg::Node::NodeMask traversalMask)
 {
+    OSGVISUAL_ALLOC_SCOPE(TERRAIN);
     osg::CoordinateSystemNode* csn = dynamic_cast<osg::CoordinateSystemNode*>(scene);
     osg::EllipsoidModel* em = csn ? csn->getEllipsoidModel() : 0;
 
@@ -65,7 +106,7 @@ void terrainQuery::computeIntersections(osg::Node* scene, osg::Node::NodeMask tr
             
             itr->_hat = height;
 
-            OSG_NOTICE<<"lat = "<<latitude<<" longitude = "<<longitude<<" height = "<<height<<std::endl;
+            OSGVISUAL_LOG( osg::DEBUG_INFO )<<"lat = "<<latitude<<" longitude = "<<longitude<<" height = "<<height<<std::endl;
 
             osg::ref_ptr<osgUtil::LineSegmentIntersector> intersector = new osgUtil::LineSegmentIntersector(start, end);
             intersectorGroup->addIntersector( intersector.get() );
@@ -85,6 +126,9 @@ void terrainQuery::computeIntersections(osg::Node* scene, osg::Node::NodeMask tr
         }
     }
     
+    // Attach KdTrees which are completed in the background since the last query.
+    util_kdTreeBuilder::getInstance()->installCompletedKdTrees();
+
     _intersectionVisitor.reset();
     _intersectionVisitor.setTraversalMask(traversalMask);
     _intersectionVisitor.setIntersector( intersectorGroup.get() );
@@ -104,6 +148,8 @@ void terrainQuery::computeIntersections(osg::Node* scene, osg::Node::NodeMask tr
             if (!intersections.empty())
             {
                 const osgUtil::LineSegmentIntersector::Intersection& intersection = *intersections.begin();
+                util_kdTreeBuilder::getInstance()->requestKdTree( intersection.drawable.get() );
+
                 osg::Vec3d intersectionPoint = intersection.matrix.valid() ? intersection.localIntersectionPoint * (*intersection.matrix) :
                                                intersection.localIntersectionPoint;
                 // HAT
@@ -145,6 +191,128 @@ double terrainQuery::computeHeightOfTerrain(osg::Node* scene, const osg::Vec3d&
     return qt.getHeightOfTerrain(index);
 }
 
+unsigned int terrainQuery::addSegment(const osg::Vec3d& start, const osg::Vec3d& end, const std::string& resultSlotName)
+{
+    unsigned int index = _LOSList.size();
+    _LOSList.push_back(LOS(start, end, resultSlotName));
+    return index;
+}
+
+void terrainQuery::computeLineOfSight(osg::Node* scene, osg::Node::NodeMask traversalMask)
+{
+    OSGVISUAL_ALLOC_SCOPE(TERRAIN);
+    if (_LOSList.empty()) return;
+
+    // Attach KdTrees which are completed in the background since the last query.
+    // This must happen before the parallel traversals, as the scene must not change while they run.
+    util_kdTreeBuilder::getInstance()->installCompletedKdTrees();
+
+    unsigned int numSegments = _LOSList.size();
+    unsigned int numChunks = numSegments / _minSegmentsPerThread;
+    unsigned int maxChunks = util_workerPool::getInstance()->getNumThreads() + 1;
+    if (maxChunks < 2) maxChunks = OpenThreads::GetNumberOfProcessors();
+    if (numChunks > maxChunks) numChunks = maxChunks;
+
+    if (numChunks < 2)
+    {
+        // Small batch: one traversal on the calling thread.
+        std::vector< osg::ref_ptr<osg::Drawable> > hitDrawables;
+        intersectSegments(scene, traversalMask, _dcrc.get(), _LOSList, 0, numSegments, hitDrawables);
+        for(unsigned int i=0; i<hitDrawables.size(); i++)
+            util_kdTreeBuilder::getInstance()->requestKdTree( hitDrawables[i].get() );
+    }
+    else
+    {
+        // Large batch: split into chunks of similar size, each traversed by its own IntersectionVisitor.
+        std::vector< osg::ref_ptr<osg::Operation> > operations;
+        unsigned int chunkSize = (numSegments + numChunks - 1) / numChunks;
+        for(unsigned int begin = 0; begin < numSegments; begin += chunkSize)
+        {
+            unsigned int end = osg::minimum(begin + chunkSize, numSegments);
+            operations.push_back( new lineOfSightOperation(scene, traversalMask, _dcrc.get(), _LOSList, begin, end) );
+        }
+
+        util_workerPool::getInstance()->runAndWait( operations );
+
+        // The KdTree builder is not thread safe, so the hit drawables are scheduled by the calling thread.
+        for(unsigned int i=0; i<operations.size(); i++)
+        {
+            lineOfSightOperation* operation = static_cast<lineOfSightOperation*>(operations[i].get());
+            for(unsigned int j=0; j<operation->_hitDrawables.size(); j++)
+                util_kdTreeBuilder::getInstance()->requestKdTree( operation->_hitDrawables[j].get() );
+        }
+    }
+
+    writeSegmentsToSlots();
+}
+
+void terrainQuery::intersectSegments(osg::Node* scene, osg::Node::NodeMask traversalMask, osgUtil::IntersectionVisitor::ReadCallback* readCallback,
+                                     LOSList& losList, unsigned int begin, unsigned int end, std::vector< osg::ref_ptr<osg::Drawable> >& hitDrawables)
+{
+    osg::ref_ptr<osgUtil::IntersectorGroup> intersectorGroup = new osgUtil::IntersectorGroup();
+    for(unsigned int i=begin; i<end; i++)
+    {
+        osg::ref_ptr<osgUtil::LineSegmentIntersector> intersector = new osgUtil::LineSegmentIntersector(losList[i]._start, losList[i]._end);
+        intersectorGroup->addIntersector( intersector.get() );
+    }
+
+    osgUtil::IntersectionVisitor intersectionVisitor;
+    intersectionVisitor.setReadCallback(readCallback);
+    intersectionVisitor.setTraversalMask(traversalMask);
+    intersectionVisitor.setIntersector( intersectorGroup.get() );
+
+    scene->accept(intersectionVisitor);
+
+    unsigned int index = begin;
+    osgUtil::IntersectorGroup::Intersectors& intersectors = intersectorGroup->getIntersectors();
+    for(osgUtil::IntersectorGroup::Intersectors::iterator intersector_itr = intersectors.begin();
+        intersector_itr != intersectors.end();
+        ++intersector_itr, ++index)
+    {
+        LOS& los = losList[index];
+        los._hit = false;
+
+        osgUtil::LineSegmentIntersector* lsi = static_cast<osgUtil::LineSegmentIntersector*>(intersector_itr->get());
+        osgUtil::LineSegmentIntersector::Intersections& intersections = lsi->getIntersections();
+        if (!intersections.empty())
+        {
+            // Intersections are sorted by ratio, so the first one is nearest to the start point.
+            const osgUtil::LineSegmentIntersector::Intersection& intersection = *intersections.begin();
+            los._hit = true;
+            los._hitPoint = intersection.getWorldIntersectPoint();
+            hitDrawables.push_back( intersection.drawable );
+        }
+    }
+}
+
+void terrainQuery::writeSegmentsToSlots()
+{
+    for(LOSList::iterator itr = _LOSList.begin();
+        itr != _LOSList.end();
+        ++itr)
+    {
+        if (itr->_slotName.empty()) continue;
+
+        // The slot lookup is done once, afterwards the cached slots are updated directly.
+        if (!itr->_hitSlot)
+        {
+            itr->_hitSlot = visual_dataIO::getInstance()->setSlotData(itr->_slotName+"_HIT", dataIO_slot::FROM_OBJ, 0.0);
+            itr->_hitXSlot = visual_dataIO::getInstance()->setSlotData(itr->_slotName+"_HIT_X", dataIO_slot::FROM_OBJ, 0.0);
+            itr->_hitYSlot = visual_dataIO::getInstance()->setSlotData(itr->_slotName+"_HIT_Y", dataIO_slot::FROM_OBJ, 0.0);
+            itr->_hitZSlot = visual_dataIO::getInstance()->setSlotData(itr->_slotName+"_HIT_Z", dataIO_slot::FROM_OBJ, 0.0);
+        }
+
+        // Update via dataIO, which synchronizes with the snapshot copy.
+        visual_dataIO::getInstance()->setSlotValue( itr->_hitSlot, itr->_hit ? 1.0 : 0.0 );
+        if (itr->_hit)
+        {
+            visual_dataIO::getInstance()->setSlotValue( itr->_hitXSlot, itr->_hitPoint.x() );
+            visual_dataIO::getInstance()->setSlotValue( itr->_hitYSlot, itr->_hitPoint.y() );
+            visual_dataIO::getInstance()->setSlotValue( itr->_hitZSlot, itr->_hitPoint.z() );
+        }
+    }
+}
+
 void terrainQuery::setDatabaseCacheReadCallback(DatabaseCacheReadCallback* dcrc)
 {
     _dcrc = dcrc;
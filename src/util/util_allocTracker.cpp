@@ -0,0 +1,277 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_allocTracker.h>
+
+#include <osg/Math>
+
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+
+using namespace osgVisual;
+
+#if defined(USE_ALLOCATION_TRACKING) && defined(__GNUC__)
+
+// The counters are plain data, so they are valid for allocations during the static initialization of other files.
+static volatile unsigned long allocationCounter[util_allocTracker::NUM_SUBSYSTEMS];
+static volatile unsigned long byteCounter[util_allocTracker::NUM_SUBSYSTEMS];
+static __thread int threadSubsystem = util_allocTracker::OTHER;
+static __thread unsigned long threadAllocations = 0;
+
+// Each block starts with a header which stores the size for operator delete. 16 bytes keep the alignment of malloc.
+struct allocationHeader
+{
+	size_t size;
+	int subsystem;
+};
+static const size_t headerSize = 16;
+
+static void* trackedAllocate( size_t size_ )
+{
+	void* block = malloc( size_ + headerSize );
+	if( !block )
+		return NULL;
+
+	allocationHeader* header = static_cast<allocationHeader*>(block);
+	header->size = size_;
+	header->subsystem = threadSubsystem;
+	__sync_fetch_and_add( &allocationCounter[header->subsystem], 1 );
+	__sync_fetch_and_add( &byteCounter[header->subsystem], size_ );
+	threadAllocations++;
+
+	return static_cast<char*>(block) + headerSize;
+}
+
+static void trackedFree( void* pointer_ )
+{
+	if( pointer_ )
+		free( static_cast<char*>(pointer_) - headerSize );
+}
+
+#if __cplusplus >= 201103L
+	#define UTIL_ALLOC_THROW
+	#define UTIL_ALLOC_NOTHROW noexcept
+#else
+	#define UTIL_ALLOC_THROW throw(std::bad_alloc)
+	#define UTIL_ALLOC_NOTHROW throw()
+#endif
+
+void* operator new( size_t size_ ) UTIL_ALLOC_THROW
+{
+	void* pointer = trackedAllocate( size_ > 0 ? size_ : 1 );
+	if( !pointer )
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[]( size_t size_ ) UTIL_ALLOC_THROW
+{
+	void* pointer = trackedAllocate( size_ > 0 ? size_ : 1 );
+	if( !pointer )
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new( size_t size_, const std::nothrow_t& ) UTIL_ALLOC_NOTHROW
+{
+	return trackedAllocate( size_ > 0 ? size_ : 1 );
+}
+
+void* operator new[]( size_t size_, const std::nothrow_t& ) UTIL_ALLOC_NOTHROW
+{
+	return trackedAllocate( size_ > 0 ? size_ : 1 );
+}
+
+void operator delete( void* pointer_ ) UTIL_ALLOC_NOTHROW
+{
+	trackedFree( pointer_ );
+}
+
+void operator delete[]( void* pointer_ ) UTIL_ALLOC_NOTHROW
+{
+	trackedFree( pointer_ );
+}
+
+void operator delete( void* pointer_, const std::nothrow_t& ) UTIL_ALLOC_NOTHROW
+{
+	trackedFree( pointer_ );
+}
+
+void operator delete[]( void* pointer_, const std::nothrow_t& ) UTIL_ALLOC_NOTHROW
+{
+	trackedFree( pointer_ );
+}
+
+bool util_allocTracker::isTracking()
+{
+	return true;
+}
+
+util_allocTracker::subsystem util_allocTracker::setThreadSubsystem( subsystem subsystem_ )
+{
+	subsystem previous = static_cast<subsystem>(threadSubsystem);
+	threadSubsystem = subsystem_;
+	return previous;
+}
+
+unsigned long util_allocTracker::getThreadAllocations()
+{
+	return threadAllocations;
+}
+
+static unsigned long readCounter( volatile unsigned long& counter_ )
+{
+	return __sync_fetch_and_add( &counter_, 0 );
+}
+
+#else	// Allocation tracking disabled
+
+bool util_allocTracker::isTracking()
+{
+	return false;
+}
+
+util_allocTracker::subsystem util_allocTracker::setThreadSubsystem( subsystem subsystem_ )
+{
+	return OTHER;
+}
+
+unsigned long util_allocTracker::getThreadAllocations()
+{
+	return 0;
+}
+
+#endif
+
+util_allocTracker::util_allocTracker()
+{
+	numFrames = 0;
+	warmupFrames = 100;
+	for(unsigned int i=0; i<NUM_SUBSYSTEMS; i++)
+	{
+		statistics[i].lastAllocations = 0;
+		statistics[i].lastBytes = 0;
+		statistics[i].sumAllocations = 0.0;
+		statistics[i].sumBytes = 0.0;
+		statistics[i].maxAllocations = 0;
+		statistics[i].maxBytes = 0;
+		statistics[i].frameAllocations = 0;
+		statistics[i].frameBytes = 0;
+	}
+}
+
+util_allocTracker::~util_allocTracker()
+{
+}
+
+util_allocTracker* util_allocTracker::getInstance()
+{
+	static util_allocTracker instance;
+	return &instance;
+}
+
+const char* util_allocTracker::getSubsystemName( subsystem subsystem_ )
+{
+	static const char* names[NUM_SUBSYSTEMS] = {"other", "dataIO", "cluster", "object", "terrain", "HUD", "distortion"};
+	return subsystem_ < NUM_SUBSYSTEMS ? names[subsystem_] : "unknown";
+}
+
+void util_allocTracker::endFrame()
+{
+#if defined(USE_ALLOCATION_TRACKING) && defined(__GNUC__)
+	bool steadyState = ++numFrames > warmupFrames;
+	for(unsigned int i=0; i<NUM_SUBSYSTEMS; i++)
+	{
+		subsystemStatistics& s = statistics[i];
+		unsigned long allocations = readCounter( allocationCounter[i] );
+		unsigned long bytes = readCounter( byteCounter[i] );
+
+		s.frameAllocations = allocations - s.lastAllocations;
+		s.frameBytes = bytes - s.lastBytes;
+		s.lastAllocations = allocations;
+		s.lastBytes = bytes;
+
+		if( steadyState )
+		{
+			s.sumAllocations += s.frameAllocations;
+			s.sumBytes += s.frameBytes;
+			s.maxAllocations = osg::maximum( s.maxAllocations, s.frameAllocations );
+			s.maxBytes = osg::maximum( s.maxBytes, s.frameBytes );
+		}
+	}
+#endif
+}
+
+void util_allocTracker::reportViolation( const char* name_, unsigned long allocations_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(violationsMutex);
+
+	for(unsigned int i=0; i<violations.size(); i++)
+	{
+		if( violations[i].name == name_ )
+		{
+			violations[i].count++;
+			violations[i].allocations += allocations_;
+			return;
+		}
+	}
+
+	violation v;
+	v.name = name_;
+	v.count = 1;
+	v.allocations = allocations_;
+	violations.push_back( v );
+	OSG_NOTIFY( osg::WARN ) << "util_allocTracker: Allocation free path '" << name_ << "' allocated " << allocations_ << " times." << std::endl;
+}
+
+unsigned long util_allocTracker::getNumViolations()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(violationsMutex);
+
+	unsigned long count = 0;
+	for(unsigned int i=0; i<violations.size(); i++)
+		count += violations[i].count;
+	return count;
+}
+
+bool util_allocTracker::report()
+{
+	if( !isTracking() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_allocTracker: osgVisual is compiled without USE_ALLOCATION_TRACKING, no allocations recorded." << std::endl;
+		return true;
+	}
+
+	unsigned int steadyFrames = numFrames > warmupFrames ? numFrames - warmupFrames : 0;
+	OSG_NOTIFY( osg::ALWAYS ) << "util_allocTracker: Steady-state allocations per frame (" << steadyFrames << " frames, " << osg::minimum(numFrames, warmupFrames) << " warm-up frames skipped):" << std::endl;
+	OSG_NOTIFY( osg::ALWAYS ) << std::setw(12) << "subsystem" << std::setw(14) << "allocs/frame" << std::setw(14) << "bytes/frame" << std::setw(14) << "max allocs" << std::setw(14) << "max bytes" << std::endl;
+	for(unsigned int i=0; i<NUM_SUBSYSTEMS; i++)
+	{
+		const subsystemStatistics& s = statistics[i];
+		double allocationsPerFrame = steadyFrames > 0 ? s.sumAllocations / steadyFrames : 0.0;
+		double bytesPerFrame = steadyFrames > 0 ? s.sumBytes / steadyFrames : 0.0;
+		OSG_NOTIFY( osg::ALWAYS ) << std::setw(12) << getSubsystemName( static_cast<subsystem>(i) )
+			<< std::fixed << std::setprecision(1) << std::setw(14) << allocationsPerFrame << std::setw(14) << bytesPerFrame
+			<< std::setw(14) << s.maxAllocations << std::setw(14) << s.maxBytes << std::endl;
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(violationsMutex);
+	for(unsigned int i=0; i<violations.size(); i++)
+		OSG_NOTIFY( osg::WARN ) << "util_allocTracker: FAILED: Allocation free path '" << violations[i].name << "' allocated in " << violations[i].count << " executions (" << violations[i].allocations << " allocations)." << std::endl;
+
+	return violations.empty();
+}
@@ -0,0 +1,179 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_appendFile.h>
+
+#include <string.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace osgVisual;
+
+// Windows maps views at multiples of the allocation granularity, which is 64 kB.
+static const size_t WINDOW_GRANULARITY = 64*1024;
+
+util_appendFile::util_appendFile()
+{
+	window = NULL;
+	windowOffset = 0;
+	windowSize = 0;
+	size = 0;
+#ifdef WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+#else
+	fileDescriptor = -1;
+#endif
+}
+
+util_appendFile::~util_appendFile()
+{
+	close();
+}
+
+bool util_appendFile::open( const std::string& filename_, size_t windowSize_ )
+{
+	close();
+
+#ifdef WIN32
+	fileHandle = CreateFileA( filename_.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( fileHandle == INVALID_HANDLE_VALUE )
+#else
+	fileDescriptor = ::open( filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+	if( fileDescriptor < 0 )
+#endif
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_appendFile::open() :: Unable to create " << filename_ << std::endl;
+		return false;
+	}
+
+	filename = filename_;
+	windowSize = ((windowSize_ > 0 ? windowSize_ : 1) + WINDOW_GRANULARITY-1) / WINDOW_GRANULARITY * WINDOW_GRANULARITY;
+	size = 0;
+	if( !mapWindow( 0 ) )
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool util_appendFile::append( const void* data_, size_t size_ )
+{
+	const unsigned char* data = static_cast<const unsigned char*>( data_ );
+	while( size_ > 0 )
+	{
+		// Move the window behind the current one when it is full.
+		if( !window || size >= windowOffset+windowSize )
+		{
+			unsigned long long offset = window ? windowOffset+windowSize : size / windowSize * windowSize;
+			unmapWindow();
+			if( !mapWindow( offset ) )
+				return false;
+		}
+
+		size_t position = static_cast<size_t>( size - windowOffset );
+		size_t chunk = windowSize - position < size_ ? windowSize - position : size_;
+		memcpy( window + position, data, chunk );
+		data += chunk;
+		size_ -= chunk;
+		size += chunk;
+	}
+	return true;
+}
+
+void util_appendFile::close()
+{
+	if( filename.empty() )
+		return;
+
+	unmapWindow();
+
+	// Cut off the unused rest of the last window. The data is written back by the operating system, not flushed here.
+#ifdef WIN32
+	LARGE_INTEGER end;
+	end.QuadPart = size;
+	if( !SetFilePointerEx( fileHandle, end, NULL, FILE_BEGIN ) || !SetEndOfFile( fileHandle ) )
+		OSG_NOTIFY( osg::WARN ) << "util_appendFile::close() :: Unable to truncate " << filename << std::endl;
+	CloseHandle( fileHandle );
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if( ftruncate( fileDescriptor, static_cast<off_t>(size) ) != 0 )
+		OSG_NOTIFY( osg::WARN ) << "util_appendFile::close() :: Unable to truncate " << filename << std::endl;
+	::close( fileDescriptor );
+	fileDescriptor = -1;
+#endif
+
+	filename = "";
+}
+
+bool util_appendFile::mapWindow( unsigned long long offset_ )
+{
+#ifdef WIN32
+	unsigned long long end = offset_ + windowSize;
+
+	// A mapping larger than the file extends the file.
+	mappingHandle = CreateFileMapping( fileHandle, NULL, PAGE_READWRITE, static_cast<DWORD>(end >> 32), static_cast<DWORD>(end & 0xFFFFFFFF), NULL );
+	if( mappingHandle )
+		window = static_cast<unsigned char*>( MapViewOfFile( mappingHandle, FILE_MAP_WRITE, static_cast<DWORD>(offset_ >> 32), static_cast<DWORD>(offset_ & 0xFFFFFFFF), windowSize ) );
+	if( !window )
+	{
+		if( mappingHandle )
+			CloseHandle( mappingHandle );
+		mappingHandle = NULL;
+	}
+#else
+	// Reserve the disk space of the window: ftruncate() would extend the file sparse, and a full disk would raise SIGBUS on the write into the mapping.
+	int error = posix_fallocate( fileDescriptor, static_cast<off_t>(offset_), static_cast<off_t>(windowSize) );
+	if( error != 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_appendFile::mapWindow() :: Unable to reserve " << windowSize << " bytes in " << filename << " at offset " << offset_ << ": " << strerror( error ) << std::endl;
+		return false;
+	}
+	void* mapping = mmap( NULL, windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, static_cast<off_t>(offset_) );
+	if( mapping != MAP_FAILED )
+		window = static_cast<unsigned char*>( mapping );
+#endif
+
+	if( !window )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_appendFile::mapWindow() :: Unable to extend and map " << filename << " at offset " << offset_ << std::endl;
+		return false;
+	}
+	windowOffset = offset_;
+	return true;
+}
+
+void util_appendFile::unmapWindow()
+{
+	if( !window )
+		return;
+
+#ifdef WIN32
+	UnmapViewOfFile( window );
+	CloseHandle( mappingHandle );
+	mappingHandle = NULL;
+#else
+	munmap( window, windowSize );
+#endif
+
+	window = NULL;
+}
@@ -0,0 +1,315 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstdlib>
+
+using namespace osgVisual;
+
+util_config::node::node( xmlNode* xmlNode_ )
+{
+	name = reinterpret_cast<const char*>(xmlNode_->name);
+
+	for( xmlAttr* attr = xmlNode_->properties; attr; attr = attr->next )
+	{
+		std::string value = attr->children ? reinterpret_cast<const char*>(attr->children->content) : "";
+		attributes.push_back( std::make_pair( std::string(reinterpret_cast<const char*>(attr->name)), value ) );
+	}
+
+	for( xmlNode* child = xmlNode_->children; child; child = child->next )
+	{
+		if( child->type == XML_ELEMENT_NODE )
+			children.push_back( new node(child) );
+		else if( (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE) && child->content )
+			text += reinterpret_cast<const char*>(child->content);
+	}
+}
+
+bool util_config::node::hasAttribute( const std::string& name_ ) const
+{
+	for(unsigned int i=0; i<attributes.size(); i++)
+		if( attributes[i].first == name_ )
+			return true;
+	return false;
+}
+
+std::string util_config::node::getString( const std::string& name_, const std::string& default_ ) const
+{
+	for(unsigned int i=0; i<attributes.size(); i++)
+		if( attributes[i].first == name_ )
+			return attributes[i].second;
+	return default_;
+}
+
+double util_config::node::getDouble( const std::string& name_, double default_ ) const
+{
+	std::string value = getString( name_ );
+	if( value.empty() )
+		return default_;
+
+	char* end = NULL;
+	double result = strtod( value.c_str(), &end );
+	if( end == value.c_str() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "WARNING: util_config: Attribute '" << name_ << "' of <" << name << "> is not a number: '" << value << "', using " << default_ << std::endl;
+		return default_;
+	}
+	return result;
+}
+
+int util_config::node::getInt( const std::string& name_, int default_ ) const
+{
+	std::string value = getString( name_ );
+	if( value.empty() )
+		return default_;
+
+	char* end = NULL;
+	long result = strtol( value.c_str(), &end, 10 );
+	if( end == value.c_str() )
+	{
+		OSG_NOTIFY( osg::WARN ) << "WARNING: util_config: Attribute '" << name_ << "' of <" << name << "> is not an integer: '" << value << "', using " << default_ << std::endl;
+		return default_;
+	}
+	return static_cast<int>(result);
+}
+
+bool util_config::node::getBool( const std::string& name_, bool default_ ) const
+{
+	std::string value = getString( name_ );
+	if( value.empty() )
+		return default_;
+	if( value == "yes" || value == "true" || value == "1" )
+		return true;
+	if( value == "no" || value == "false" || value == "0" )
+		return false;
+
+	OSG_NOTIFY( osg::WARN ) << "WARNING: util_config: Attribute '" << name_ << "' of <" << name << "> is not a boolean: '" << value << "', using " << (default_ ? "yes" : "no") << std::endl;
+	return default_;
+}
+
+std::vector<const util_config::node*> util_config::node::getChildren( const std::string& name_ ) const
+{
+	std::vector<const node*> result;
+	for(unsigned int i=0; i<children.size(); i++)
+		if( children[i]->getName() == name_ )
+			result.push_back( children[i].get() );
+	return result;
+}
+
+const util_config::node* util_config::node::getChild( const std::string& name_ ) const
+{
+	for(unsigned int i=0; i<children.size(); i++)
+		if( children[i]->getName() == name_ )
+			return children[i].get();
+	return NULL;
+}
+
+bool util_config::node::equals( const node* other_ ) const
+{
+	if( !other_ || name != other_->name || text != other_->text || attributes != other_->attributes || children.size() != other_->children.size() )
+		return false;
+
+	for(unsigned int i=0; i<children.size(); i++)
+		if( !children[i]->equals( other_->children[i].get() ) )
+			return false;
+	return true;
+}
+
+util_config::util_config()
+{
+	modificationTime = 0;
+	lastCheckTick = 0;
+}
+
+util_config::~util_config()
+{
+	unload();
+}
+
+util_config* util_config::getInstance()
+{
+	static util_config instance;
+	return &instance;
+}
+
+bool util_config::load( const std::string& filename_ )
+{
+	if( filename_.empty() )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "ERROR - util_config::load() : Invalid Configuration Filename!" << std::endl;
+		return false;
+	}
+
+	// Already loaded?
+	if( root.valid() && filename_ == filename )
+		return true;
+
+	unload();
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	if( !parse( filename_, root ) )
+		return false;
+
+	filename = filename_;
+	modificationTime = getModificationTime();
+	lastCheckTick = osg::Timer::instance()->tick();
+	OSG_NOTIFY( osg::INFO ) << "util_config: Parsed '" << filename << "' in " << osg::Timer::instance()->delta_m( startTick, lastCheckTick ) << " ms." << std::endl;
+	return true;
+}
+
+void util_config::unload()
+{
+	if( root.valid() )
+		xmlCleanupParser();	// Free the global variables that may have been allocated by the parser.
+	root = NULL;
+	filename = "";
+	modificationTime = 0;
+}
+
+bool util_config::parse( const std::string& filename_, osg::ref_ptr<const node>& root_ )
+{
+	root_ = NULL;
+
+	// It is a valid XML document?
+	xmlDoc* doc = xmlReadFile( filename_.c_str(), NULL, 0 );
+	if( !doc )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "ERROR - util_config::load() : " << filename_ << " is not a valid XML file!" << std::endl;
+		return false;
+	}
+
+	// Check if it is an osgVisual configuration file
+	xmlNode* rootElement = xmlDocGetRootElement( doc );
+	std::string nodeName = rootElement ? reinterpret_cast<const char*>(rootElement->name) : "";
+	if( !rootElement || rootElement->type != XML_ELEMENT_NODE || nodeName != "osgvisualconfiguration" )
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "ERROR - util_config::load() : " << filename_ << " is not an osgVisual configuration file!" << std::endl;
+	}
+	else
+		root_ = new node( rootElement );
+
+	// The tree holds copies of all names and values, so the document is not needed anymore.
+	xmlFreeDoc( doc );
+	return root_.valid();
+}
+
+const util_config::node* util_config::getSection( const std::string& sectionName_ )
+{
+	if( !root.valid() )
+		return NULL;
+
+	const node::NodeList& sections = root->getChildren();
+	for(unsigned int i=0; i<sections.size(); i++)
+		if( getSectionName( sections[i].get() ) == sectionName_ )
+			return sections[i].get();
+	return NULL;
+}
+
+std::string util_config::getSectionName( const node* section_ )
+{
+	if( section_->getName() == "module" )
+		return section_->getString( "name" );
+	return section_->getName();
+}
+
+long long util_config::getModificationTime()
+{
+	struct stat fileStat;
+	if( filename.empty() || stat( filename.c_str(), &fileStat ) != 0 )
+		return 0;
+	return fileStat.st_mtime;
+}
+
+bool util_config::checkForChanges()
+{
+	if( !root.valid() )
+		return false;
+
+	osg::Timer_t now = osg::Timer::instance()->tick();
+	if( osg::Timer::instance()->delta_s( lastCheckTick, now ) < 1.0 )
+		return false;
+	lastCheckTick = now;
+
+	long long newModificationTime = getModificationTime();
+	if( newModificationTime == 0 || newModificationTime == modificationTime )
+		return false;
+	modificationTime = newModificationTime;
+
+	// Keep the old configuration if the modified file is invalid, e.g. saved by an editor in the middle of a change.
+	osg::ref_ptr<const node> newRoot;
+	if( !parse( filename, newRoot ) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "WARNING: util_config: Reloading '" << filename << "' failed, keeping the previous configuration." << std::endl;
+		return false;
+	}
+
+	osg::ref_ptr<const node> oldRoot = root;
+	root = newRoot;
+	OSG_NOTIFY( osg::ALWAYS ) << "util_config: Reloaded '" << filename << "'." << std::endl;
+
+	// Collect the changed sections, including removed ones.
+	std::vector<std::string> changedSections;
+	const node::NodeList& newSections = root->getChildren();
+	const node::NodeList& oldSections = oldRoot->getChildren();
+	for(unsigned int i=0; i<newSections.size(); i++)
+	{
+		std::string sectionName = getSectionName( newSections[i].get() );
+		const node* oldSection = NULL;
+		for(unsigned int j=0; j<oldSections.size() && !oldSection; j++)
+			if( getSectionName( oldSections[j].get() ) == sectionName )
+				oldSection = oldSections[j].get();
+		if( !newSections[i]->equals( oldSection ) )
+			changedSections.push_back( sectionName );
+	}
+	for(unsigned int j=0; j<oldSections.size(); j++)
+	{
+		std::string sectionName = getSectionName( oldSections[j].get() );
+		if( !getSection( sectionName ) )
+			changedSections.push_back( sectionName );
+	}
+
+	// Notify. A copy of the listeners allows them to unregister during the notification.
+	ListenerMap listenersToNotify = listeners;
+	for(unsigned int i=0; i<changedSections.size(); i++)
+	{
+		OSG_NOTIFY( osg::ALWAYS ) << "util_config: Section '" << changedSections[i] << "' changed." << std::endl;
+		std::pair<ListenerMap::iterator, ListenerMap::iterator> range = listenersToNotify.equal_range( changedSections[i] );
+		for( ListenerMap::iterator itr = range.first; itr != range.second; ++itr )
+			itr->second->configChanged( changedSections[i], getSection( changedSections[i] ) );
+	}
+
+	return true;
+}
+
+void util_config::addChangeListener( const std::string& sectionName_, changeListener* listener_ )
+{
+	listeners.insert( std::make_pair( sectionName_, osg::ref_ptr<changeListener>(listener_) ) );
+}
+
+void util_config::removeChangeListener( changeListener* listener_ )
+{
+	for( ListenerMap::iterator itr = listeners.begin(); itr != listeners.end(); )
+	{
+		if( itr->second.get() == listener_ )
+			listeners.erase( itr++ );
+		else
+			++itr;
+	}
+}
@@ -0,0 +1,125 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_frameArena.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER)
+	#define UTIL_FRAMEARENA_VSNPRINTF _vsnprintf
+#else
+	#define UTIL_FRAMEARENA_VSNPRINTF vsnprintf
+#endif
+
+using namespace osgVisual;
+
+util_frameArena::util_frameArena()
+{
+	currentBlock = 0;
+	offset = 0;
+	bytesUsed = 0;
+	peakBytesUsed = 0;
+	numBlockAllocations = 0;
+}
+
+util_frameArena::~util_frameArena()
+{
+	for(unsigned int i=0; i<blocks.size(); i++)
+		delete[] blocks[i].data;
+	blocks.clear();
+}
+
+util_frameArena* util_frameArena::getInstance()
+{
+	static util_frameArena instance;
+	return &instance;
+}
+
+void* util_frameArena::allocate( size_t size_, size_t alignment_ )
+{
+	// Search a block with enough space, starting with the current one. Blocks of previous frames are reused.
+	while( currentBlock < blocks.size() )
+	{
+		block& b = blocks[currentBlock];
+		size_t aligned = (reinterpret_cast<size_t>(b.data) + offset + alignment_-1) & ~(alignment_-1);
+		size_t start = aligned - reinterpret_cast<size_t>(b.data);
+		if( start + size_ <= b.size )
+		{
+			offset = start + size_;
+			bytesUsed += size_;
+			if( bytesUsed > peakBytesUsed )
+				peakBytesUsed = bytesUsed;
+			return b.data + start;
+		}
+
+		currentBlock++;
+		offset = 0;
+	}
+
+	// All blocks are full: add a new one.
+	block b;
+	b.size = size_ + alignment_ > blockSize ? size_ + alignment_ : blockSize;
+	b.data = new char[b.size];
+	blocks.push_back( b );
+	numBlockAllocations++;
+
+	return allocate( size_, alignment_ );
+}
+
+void util_frameArena::reset()
+{
+	currentBlock = 0;
+	offset = 0;
+	bytesUsed = 0;
+}
+
+util_frameString::util_frameString( unsigned int capacity_ )
+{
+	buffer.reserve( capacity_ );
+	buffer.push_back( '\0' );
+}
+
+util_frameString& util_frameString::append( const char* text_ )
+{
+	buffer.pop_back();
+	buffer.insert( buffer.end(), text_, text_+strlen(text_) );
+	buffer.push_back( '\0' );
+	return *this;
+}
+
+util_frameString& util_frameString::appendFormat( const char* format_, ... )
+{
+	char text[256];
+
+	va_list args;
+	va_start( args, format_ );
+	int length = UTIL_FRAMEARENA_VSNPRINTF( text, sizeof(text), format_, args );
+	va_end( args );
+
+	// Truncate on overflow, _vsnprintf returns -1 and does not terminate.
+	if( length < 0 || length >= static_cast<int>(sizeof(text)) )
+		text[sizeof(text)-1] = '\0';
+
+	return append( text );
+}
+
+void util_frameString::clear()
+{
+	buffer.clear();
+	buffer.push_back( '\0' );
+}
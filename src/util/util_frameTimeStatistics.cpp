@@ -0,0 +1,148 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_frameTimeStatistics.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+
+using namespace osgVisual;
+
+util_frameTimeStatistics::util_frameTimeStatistics()
+{
+	sorted = true;
+}
+
+void util_frameTimeStatistics::add( double frameTime_ )
+{
+	frameTimes.push_back( frameTime_ );
+	sorted = false;
+}
+
+void util_frameTimeStatistics::clear()
+{
+	frameTimes.clear();
+	sortedFrameTimes.clear();
+	sorted = true;
+}
+
+double util_frameTimeStatistics::getPercentile( double percentile_ )
+{
+	if( frameTimes.empty() )
+		return 0.0;
+
+	if( !sorted )
+	{
+		sortedFrameTimes = frameTimes;
+		std::sort( sortedFrameTimes.begin(), sortedFrameTimes.end() );
+		sorted = true;
+	}
+
+	// Nearest rank: smallest value which is greater or equal to percentile_ % of all values.
+	double rank = ceil( percentile_ / 100.0 * sortedFrameTimes.size() );
+	unsigned int index = rank < 1.0 ? 0 : static_cast<unsigned int>(rank) - 1;
+	if( index >= sortedFrameTimes.size() )
+		index = sortedFrameTimes.size() - 1;
+	return sortedFrameTimes[index];
+}
+
+double util_frameTimeStatistics::getMean()
+{
+	if( frameTimes.empty() )
+		return 0.0;
+
+	double sum = 0.0;
+	for(unsigned int i=0; i<frameTimes.size(); i++)
+		sum += frameTimes[i];
+	return sum / frameTimes.size();
+}
+
+double util_frameTimeStatistics::getStandardDeviation()
+{
+	if( frameTimes.size() < 2 )
+		return 0.0;
+
+	double mean = getMean();
+	double sum = 0.0;
+	for(unsigned int i=0; i<frameTimes.size(); i++)
+		sum += (frameTimes[i]-mean) * (frameTimes[i]-mean);
+	return sqrt( sum / (frameTimes.size()-1) );
+}
+
+unsigned int util_frameTimeStatistics::getNumFramesAbove( double frameTime_ )
+{
+	unsigned int count = 0;
+	for(unsigned int i=0; i<frameTimes.size(); i++)
+	{
+		if( frameTimes[i] > frameTime_ )
+			count++;
+	}
+	return count;
+}
+
+void util_frameTimeStatistics::writeReport( std::ostream& out_, const std::string& title_ )
+{
+	std::ios::fmtflags flags = out_.flags();
+	std::streamsize precision = out_.precision();
+
+	out_ << title_ << ": " << getNumFrames() << " frames" << std::endl;
+	out_ << std::fixed << std::setprecision(3);
+	out_ << "  mean " << getMean() << " ms, stddev " << getStandardDeviation() << " ms" << std::endl;
+	out_ << "  min " << getMin() << " ms, P50 " << getPercentile(50.0) << " ms, P90 " << getPercentile(90.0) << " ms, P95 " << getPercentile(95.0)
+		 << " ms, P99 " << getPercentile(99.0) << " ms, max " << getMax() << " ms" << std::endl;
+
+	out_.flags( flags );
+	out_.precision( precision );
+}
+
+bool util_frameTimeStatistics::writeCSV( const std::string& filename_ )
+{
+	std::ofstream file( filename_.c_str() );
+	if( !file )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_frameTimeStatistics: Unable to write '" << filename_ << "'." << std::endl;
+		return false;
+	}
+
+	file << "frame,frame_time_ms" << std::endl;
+	for(unsigned int i=0; i<frameTimes.size(); i++)
+		file << i << "," << frameTimes[i] << std::endl;
+	return file.good();
+}
+
+bool util_frameTimeStatistics::readCSV( const std::string& filename_ )
+{
+	std::ifstream file( filename_.c_str() );
+	if( !file )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_frameTimeStatistics: Unable to read '" << filename_ << "'." << std::endl;
+		return false;
+	}
+
+	std::string line;
+	std::getline( file, line );	// header
+	while( std::getline( file, line ) )
+	{
+		std::string::size_type separator = line.find( ',' );
+		if( separator == std::string::npos )
+			continue;
+		add( atof( line.c_str() + separator + 1 ) );
+	}
+	return true;
+}
@@ -0,0 +1,188 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_kdTreeBuilder.h>
+
+using namespace osgVisual;
+
+util_kdTreeBuilder::util_kdTreeBuilder()
+{
+	enabled = true;
+	numPending = 0;
+	numBuilt = 0;
+	totalBuildTime = 0.0;
+	frameBuildTime = 0.0;
+}
+
+util_kdTreeBuilder::~util_kdTreeBuilder()
+{
+}
+
+util_kdTreeBuilder* util_kdTreeBuilder::getInstance()
+{
+	static util_kdTreeBuilder instance;
+	return &instance;
+}
+
+void util_kdTreeBuilder::requestKdTree( osg::Drawable* drawable_ )
+{
+	if( !enabled || !drawable_ )
+		return;
+
+	// Trees built during loading (e.g. by a file with embedded KdTree) are used as they are.
+	if( dynamic_cast<osg::KdTree*>(drawable_->getShape()) )
+		return;
+
+	osg::Geometry* geometry = drawable_->asGeometry();
+	if( !geometry )
+		return;
+
+	{
+		// Several jobs query the terrain in parallel, so the scheduled drawables are protected by the mutex.
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+
+		// Already scheduled? Only if the observed drawable is still alive, otherwise the address was recycled by a new drawable.
+		ScheduledMap::iterator itr = scheduled.find( drawable_ );
+		if( itr != scheduled.end() && itr->second.valid() )
+			return;
+
+		scheduled[drawable_] = drawable_;
+		numPending++;
+	}
+
+	util_workerPool::getInstance()->add( new buildOperation(this, geometry) );
+}
+
+void util_kdTreeBuilder::requestKdTrees( const osgUtil::LineSegmentIntersector::Intersections& intersections_ )
+{
+	if( !enabled )
+		return;
+
+	for( osgUtil::LineSegmentIntersector::Intersections::const_iterator itr = intersections_.begin(); itr != intersections_.end(); ++itr )
+		requestKdTree( itr->drawable.get() );
+}
+
+void util_kdTreeBuilder::buildOperation::operator () (osg::Object*)
+{
+	osg::ref_ptr<osg::Geometry> tmpGeometry;
+	if( !geometry.lock(tmpGeometry) )
+	{
+		// Geometry was deleted meanwhile, e.g. tile expired by the pager.
+		builder->reportCompletedTree( NULL, NULL, 0.0 );
+		return;
+	}
+
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+	osg::ref_ptr<osg::KdTree> kdTree = new osg::KdTree();
+	osg::KdTree::BuildOptions options = builder->buildOptions;
+	if( !kdTree->build(options, tmpGeometry.get()) )
+		kdTree = NULL;
+
+	double buildTime = osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() );
+	builder->reportCompletedTree( tmpGeometry.get(), kdTree.get(), buildTime );
+}
+
+void util_kdTreeBuilder::reportCompletedTree( osg::Geometry* geometry_, osg::KdTree* kdTree_, double buildTime_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+
+	if( numPending > 0 )
+		numPending--;
+	totalBuildTime += buildTime_;
+	frameBuildTime += buildTime_;
+
+	if( geometry_ && kdTree_ )
+	{
+		completedTree tree;
+		tree.geometry = geometry_;
+		tree.kdTree = kdTree_;
+		completedTrees.push_back( tree );
+	}
+}
+
+void util_kdTreeBuilder::installCompletedKdTrees()
+{
+	std::vector<completedTree> treesToInstall;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		if( completedTrees.empty() )
+			return;
+		treesToInstall.swap( completedTrees );
+	}
+
+	unsigned int numInstalled = 0;
+	for(unsigned int i=0; i<treesToInstall.size(); i++)
+	{
+		osg::ref_ptr<osg::Geometry> geometry;
+		if( treesToInstall[i].geometry.lock(geometry) )
+		{
+			geometry->setShape( treesToInstall[i].kdTree.get() );
+			numInstalled++;
+		}
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	numBuilt += numInstalled;
+
+	// Forget about drawables which are deleted meanwhile.
+	for( ScheduledMap::iterator itr = scheduled.begin(); itr != scheduled.end(); )
+	{
+		if( !itr->second.valid() )
+			scheduled.erase( itr++ );
+		else
+			++itr;
+	}
+}
+
+void util_kdTreeBuilder::updateStats( osg::Stats* stats_, unsigned int frameNumber_ )
+{
+	if( !stats_ )
+		return;
+
+	double buildTime;
+	unsigned int pending;
+	unsigned int built;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		buildTime = frameBuildTime;
+		frameBuildTime = 0.0;
+		pending = numPending + completedTrees.size();
+		built = numBuilt;
+	}
+
+	stats_->setAttribute( frameNumber_, "KdTree build time taken", buildTime );
+	stats_->setAttribute( frameNumber_, "KdTrees built", built );
+	stats_->setAttribute( frameNumber_, "KdTrees pending", pending );
+}
+
+double util_kdTreeBuilder::getTotalBuildTime()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	return totalBuildTime;
+}
+
+unsigned int util_kdTreeBuilder::getNumBuiltTrees()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	return numBuilt;
+}
+
+unsigned int util_kdTreeBuilder::getNumPendingTrees()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	return numPending + completedTrees.size();
+}
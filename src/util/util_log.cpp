@@ -0,0 +1,264 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_log.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <iomanip>
+
+// Each thread keeps a pointer to its buffer, so logging requires no lookup.
+#if defined(_MSC_VER)
+	#define UTIL_LOG_THREAD_LOCAL __declspec(thread)
+#else
+	#define UTIL_LOG_THREAD_LOCAL __thread
+#endif
+
+using namespace osgVisual;
+
+bool util_log::destroyed = false;
+
+static UTIL_LOG_THREAD_LOCAL void* localBuffer = NULL;
+
+util_log::util_log()
+{
+	thread = NULL;
+	flushInterval = 20;
+	prefixEnabled = false;
+	startTick = osg::Timer::instance()->tick();
+}
+
+util_log::~util_log()
+{
+	stop();
+	destroyed = true;
+
+	for(unsigned int i=0; i<buffers.size(); i++)
+		delete buffers[i];
+	buffers.clear();
+}
+
+util_log* util_log::getInstance()
+{
+	static util_log instance;
+	return &instance;
+}
+
+util_log::threadBuffer* util_log::getThreadBuffer()
+{
+	if( localBuffer )
+		return static_cast<threadBuffer*>(localBuffer);
+
+	threadBuffer* buffer = new threadBuffer;
+	buffer->records.resize( bufferCapacity );
+	buffer->reportedDropped = 0;
+	buffer->formatting = false;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+		buffer->id = buffers.size();
+		buffers.push_back( buffer );
+	}
+
+	localBuffer = buffer;
+	return buffer;
+}
+
+bool util_log::isAllowed( site* site_, unsigned int maxPerSecond_ )
+{
+	if( maxPerSecond_ == 0 )
+		return true;
+
+	unsigned int now = static_cast<unsigned int>( osg::Timer::instance()->time_s() );
+	if( load(site_->second) != now )
+	{
+		// Only the thread which switches the window resets the counter.
+		if( site_->second.exchange(now) != now )
+			site_->count.exchange(0);
+	}
+
+	if( ++site_->count > maxPerSecond_ )
+	{
+		++site_->suppressed;
+		return false;
+	}
+	return true;
+}
+
+util_log::messageStream::messageStream( osg::NotifySeverity level_, const char* file_, int line_, site* site_ )
+	: level(level_), buffer(NULL), rec(NULL), nested(NULL)
+{
+	if( !util_log::destroyed )
+		buffer = util_log::getInstance()->getThreadBuffer();
+
+	if( !buffer || buffer->formatting )
+	{
+		nested = new std::ostringstream;
+		out = nested;
+		return;
+	}
+	buffer->formatting = true;
+
+	// The flusher reads at most up to the last committed record, so the record at writeCount is free even if the buffer is full.
+	rec = &buffer->records[ load(buffer->writeCount) & (bufferCapacity-1) ];
+	rec->tick = osg::Timer::instance()->tick();
+	rec->level = level_;
+	rec->file = file_;
+	rec->line = line_;
+	rec->suppressed = site_ ? site_->suppressed.exchange(0) : 0;
+
+	// The stream is reused, so reset the formatting of the previous message.
+	buffer->streambuf.reset( rec->text, maxMessageLength );
+	buffer->stream.clear();
+	buffer->stream.flags( std::ios_base::dec | std::ios_base::skipws );
+	buffer->stream.precision( 6 );
+	buffer->stream.fill( ' ' );
+	out = &buffer->stream;
+}
+
+util_log::messageStream::~messageStream()
+{
+	if( nested )
+	{
+		if( util_log::destroyed )
+			osg::notify(level) << nested->str();
+		else
+		{
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(util_log::getInstance()->writeMutex);
+			osg::notify(level) << nested->str();
+		}
+		delete nested;
+		return;
+	}
+
+	rec->length = buffer->streambuf.length();
+	buffer->formatting = false;
+
+	util_log* log = util_log::getInstance();
+	if( !log->isRunning() )
+	{
+		log->write( *rec, buffer->id );
+		return;
+	}
+
+	// Keep one record free, see constructor.
+	if( load(buffer->writeCount) - load(buffer->readCount) >= bufferCapacity-1 )
+	{
+		++buffer->dropped;
+		return;
+	}
+
+	// Publishes the record to the flusher.
+	++buffer->writeCount;
+}
+
+void util_log::write( const record& record_, unsigned int threadId_ )
+{
+	// The line end is added below, so remove the one of std::endl.
+	unsigned int length = record_.length;
+	while( length > 0 && (record_.text[length-1] == '\n' || record_.text[length-1] == '\r') )
+		length--;
+
+	std::ostringstream prefix;
+	if( prefixEnabled )
+	{
+		prefix << "[" << std::fixed << std::setprecision(6) << osg::Timer::instance()->delta_s(startTick, record_.tick)
+			<< " T" << threadId_ << " " << osgDB::getSimpleFileName(record_.file) << ":" << record_.line << "] ";
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(writeMutex);
+	std::ostream& out = osg::notify( record_.level );
+	out << prefix.str();
+	out.write( record_.text, length );
+	if( record_.suppressed > 0 )
+		out << " (" << record_.suppressed << " similar messages suppressed)";
+	out << std::endl;
+}
+
+void util_log::flush()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> flushLock(flushMutex);
+
+	std::vector<threadBuffer*> currentBuffers;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+		currentBuffers = buffers;
+	}
+
+	for(unsigned int i=0; i<currentBuffers.size(); i++)
+	{
+		threadBuffer* buffer = currentBuffers[i];
+
+		unsigned int end = load(buffer->writeCount);
+		for(unsigned int j=load(buffer->readCount); j!=end; j++)
+		{
+			write( buffer->records[j & (bufferCapacity-1)], buffer->id );
+			// Releases the record to the writing thread.
+			++buffer->readCount;
+		}
+
+		unsigned int dropped = load(buffer->dropped);
+		if( dropped != buffer->reportedDropped )
+		{
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(writeMutex);
+			OSG_NOTIFY( osg::WARN ) << "util_log: " << dropped-buffer->reportedDropped << " messages of thread " << buffer->id << " dropped, its buffer was full." << std::endl;
+			buffer->reportedDropped = dropped;
+		}
+	}
+}
+
+void util_log::start( unsigned int flushInterval_ )
+{
+	if( thread )
+		return;
+
+	flushInterval = flushInterval_ > 0 ? flushInterval_ : 1;
+	running.exchange( 1 );
+	thread = new flushThread( this );
+	thread->startThread();
+}
+
+void util_log::stop()
+{
+	if( !thread )
+		return;
+
+	running.exchange( 0 );
+	thread->join();
+	delete thread;
+	thread = NULL;
+
+	// Write what was logged after the last flush of the thread.
+	flush();
+}
+
+unsigned int util_log::getNumDroppedMessages()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+
+	unsigned int dropped = 0;
+	for(unsigned int i=0; i<buffers.size(); i++)
+		dropped += load(buffers[i]->dropped);
+	return dropped;
+}
+
+void util_log::flushThread::run()
+{
+	while( log->isRunning() )
+	{
+		log->flush();
+		OpenThreads::Thread::microSleep( log->flushInterval*1000 );
+	}
+}
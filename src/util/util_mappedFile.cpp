@@ -0,0 +1,128 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_mappedFile.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace osgVisual;
+
+util_mappedFile::util_mappedFile()
+{
+	data = NULL;
+	size = 0;
+#ifdef WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+#endif
+}
+
+util_mappedFile::~util_mappedFile()
+{
+	close();
+}
+
+bool util_mappedFile::open( const std::string& filename_ )
+{
+	close();
+
+#ifdef WIN32
+	fileHandle = CreateFileA( filename_.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( fileHandle == INVALID_HANDLE_VALUE )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Unable to open " << filename_ << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( fileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Empty or invalid file " << filename_ << std::endl;
+		CloseHandle( fileHandle );
+		fileHandle = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	mappingHandle = CreateFileMapping( fileHandle, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mappingHandle )
+		data = static_cast<const unsigned char*>( MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 ) );
+
+	if( !data )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Unable to map " << filename_ << std::endl;
+		if( mappingHandle )
+			CloseHandle( mappingHandle );
+		CloseHandle( fileHandle );
+		mappingHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+		return false;
+	}
+	size = static_cast<size_t>( fileSize.QuadPart );
+#else
+	int fd = ::open( filename_.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Unable to open " << filename_ << std::endl;
+		return false;
+	}
+
+	struct stat fileStat;
+	if( fstat( fd, &fileStat ) != 0 || fileStat.st_size == 0 )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Empty or invalid file " << filename_ << std::endl;
+		::close( fd );
+		return false;
+	}
+
+	void* mapping = mmap( NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	::close( fd );	// The mapping stays valid after closing the descriptor.
+	if( mapping == MAP_FAILED )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_mappedFile::open() :: Unable to map " << filename_ << std::endl;
+		return false;
+	}
+	data = static_cast<const unsigned char*>( mapping );
+	size = static_cast<size_t>( fileStat.st_size );
+#endif
+
+	filename = filename_;
+	return true;
+}
+
+void util_mappedFile::close()
+{
+	if( !data )
+		return;
+
+#ifdef WIN32
+	UnmapViewOfFile( data );
+	CloseHandle( mappingHandle );
+	CloseHandle( fileHandle );
+	mappingHandle = NULL;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	munmap( const_cast<unsigned char*>(data), size );
+#endif
+
+	data = NULL;
+	size = 0;
+	filename = "";
+}
@@ -0,0 +1,514 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_modelCache.h>
+
+#include <osg/Geode>
+#include <osg/ProxyNode>
+#include <osg/Texture>
+#include <osg/TriangleFunctor>
+#include <osg/NodeVisitor>
+#include <osg/Timer>
+#include <osg/Version>
+#include <osgDB/ReadFile>
+#include <osgDB/WriteFile>
+#include <osgDB/FileUtils>
+#include <osgDB/FileNameUtils>
+#include <osgDB/Options>
+#include <osgUtil/Optimizer>
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+using namespace osgVisual;
+
+// Version of the cache content, increment it if the optimizer chain changes to invalidate existing cache files.
+static const unsigned int CACHE_VERSION = 1;
+
+// Counts the triangles of a drawable, strips and fans included.
+struct triangleCounter
+{
+	triangleCounter() : numTriangles(0) {};
+	void operator() ( const osg::Vec3&, const osg::Vec3&, const osg::Vec3&, bool ) {numTriangles++;};
+	unsigned int numTriangles;
+};
+
+// Collects the statistics of a model.
+class statisticsVisitor : public osg::NodeVisitor
+{
+public:
+	statisticsVisitor() : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN) {};
+
+	virtual void apply( osg::Node& node_ )
+	{
+		addStateSet( node_.getStateSet() );
+		traverse( node_ );
+	}
+
+	virtual void apply( osg::Geode& geode_ )
+	{
+		addStateSet( geode_.getStateSet() );
+		for(unsigned int i=0; i<geode_.getNumDrawables(); i++)
+		{
+			osg::Drawable* drawable = geode_.getDrawable(i);
+			addStateSet( drawable->getStateSet() );
+
+			osg::TriangleFunctor<triangleCounter> counter;
+			drawable->accept( counter );
+			statistics.numTriangles += counter.numTriangles;
+			statistics.numDrawables++;
+		}
+	}
+
+	util_modelCache::modelStatistics getStatistics()
+	{
+		statistics.numStateSets = stateSets.size();
+		statistics.numTextures = textures.size();
+		return statistics;
+	}
+
+private:
+	void addStateSet( osg::StateSet* stateSet_ )
+	{
+		if( !stateSet_ || !stateSets.insert( stateSet_ ).second )
+			return;
+
+		for(unsigned int unit=0; unit<stateSet_->getTextureAttributeList().size(); unit++)
+		{
+			osg::StateAttribute* texture = stateSet_->getTextureAttribute( unit, osg::StateAttribute::TEXTURE );
+			if( texture )
+				textures.insert( texture );
+		}
+	}
+
+	util_modelCache::modelStatistics statistics;
+	std::set<osg::StateSet*> stateSets;
+	std::set<osg::StateAttribute*> textures;
+};
+
+// Sets the internal format of all textures to a compressed format, the driver compresses them on upload.
+class textureCompressionVisitor : public osg::NodeVisitor
+{
+public:
+	textureCompressionVisitor( util_modelCache::textureCompression compression_ )
+		: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN), compression(compression_) {};
+
+	virtual void apply( osg::Node& node_ )
+	{
+		compress( node_.getStateSet() );
+		traverse( node_ );
+	}
+
+	virtual void apply( osg::Geode& geode_ )
+	{
+		compress( geode_.getStateSet() );
+		for(unsigned int i=0; i<geode_.getNumDrawables(); i++)
+			compress( geode_.getDrawable(i)->getStateSet() );
+	}
+
+private:
+	void compress( osg::StateSet* stateSet_ )
+	{
+		if( !stateSet_ )
+			return;
+
+		for(unsigned int unit=0; unit<stateSet_->getTextureAttributeList().size(); unit++)
+		{
+			osg::Texture* texture = dynamic_cast<osg::Texture*>( stateSet_->getTextureAttribute( unit, osg::StateAttribute::TEXTURE ) );
+			if( !texture )
+				continue;
+
+			if( compression == util_modelCache::COMPRESSION_ARB )
+				texture->setInternalFormatMode( osg::Texture::USE_ARB_COMPRESSION );
+			else
+			{
+				// DXT1 has no usable alpha channel.
+				osg::Image* image = texture->getNumImages() > 0 ? texture->getImage(0) : NULL;
+				bool translucent = image && image->isImageTranslucent();
+				texture->setInternalFormatMode( translucent ? osg::Texture::USE_S3TC_DXT5_COMPRESSION : osg::Texture::USE_S3TC_DXT1_COMPRESSION );
+			}
+		}
+	}
+
+	util_modelCache::textureCompression compression;
+};
+
+// Collects the file names of the images and the external references of a model.
+class dependencyVisitor : public osg::NodeVisitor
+{
+public:
+	dependencyVisitor() : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN) {};
+
+	virtual void apply( osg::Node& node_ )
+	{
+		addStateSet( node_.getStateSet() );
+		traverse( node_ );
+	}
+
+	virtual void apply( osg::ProxyNode& proxy_ )
+	{
+		for(unsigned int i=0; i<proxy_.getNumFileNames(); i++)
+		{
+			if( !proxy_.getFileName(i).empty() )
+				filenames.insert( proxy_.getFileName(i) );
+		}
+		apply( static_cast<osg::Node&>(proxy_) );
+	}
+
+	virtual void apply( osg::Geode& geode_ )
+	{
+		addStateSet( geode_.getStateSet() );
+		for(unsigned int i=0; i<geode_.getNumDrawables(); i++)
+			addStateSet( geode_.getDrawable(i)->getStateSet() );
+	}
+
+	std::set<std::string> filenames;
+
+private:
+	void addStateSet( osg::StateSet* stateSet_ )
+	{
+		if( !stateSet_ )
+			return;
+
+		for(unsigned int unit=0; unit<stateSet_->getTextureAttributeList().size(); unit++)
+		{
+			osg::Texture* texture = dynamic_cast<osg::Texture*>( stateSet_->getTextureAttribute( unit, osg::StateAttribute::TEXTURE ) );
+			if( !texture )
+				continue;
+
+			for(unsigned int i=0; i<texture->getNumImages(); i++)
+			{
+				osg::Image* image = texture->getImage(i);
+				if( image && !image->getFileName().empty() )
+					filenames.insert( image->getFileName() );
+			}
+		}
+	}
+};
+
+// Returns modification time and size of a file, -1 and 0 if it does not exist.
+static void getFileInfo( const std::string& path_, long long& modificationTime_, unsigned long long& size_ )
+{
+	struct stat info;
+	if( path_.empty() || stat( path_.c_str(), &info ) != 0 )
+	{
+		modificationTime_ = -1;
+		size_ = 0;
+		return;
+	}
+	modificationTime_ = static_cast<long long>( info.st_mtime );
+	size_ = static_cast<unsigned long long>( info.st_size );
+}
+
+// Returns the dependency file of a cache file.
+static std::string getDependencyFilename( const std::string& cacheFilename_ )
+{
+	return osgDB::getNameLessExtension( cacheFilename_ ) + ".deps";
+}
+
+static std::string toString( const util_modelCache::modelStatistics& statistics_ )
+{
+	std::ostringstream out;
+	out << statistics_.numTriangles << " triangles, " << statistics_.numDrawables << " drawables, " << statistics_.numStateSets << " state sets, " << statistics_.numTextures << " textures";
+	return out.str();
+}
+
+util_modelCache::util_modelCache()
+{
+	numLoads = 0;
+	numCacheHits = 0;
+	totalLoadTime = 0.0;
+	numTemporaryFiles = 0;
+}
+
+util_modelCache::~util_modelCache()
+{
+}
+
+util_modelCache* util_modelCache::getInstance()
+{
+	static util_modelCache instance;
+	return &instance;
+}
+
+void util_modelCache::configure( const util_config::node* config_ )
+{
+	if( !config_ )
+	{
+		cacheDirectory = "";
+		return;
+	}
+
+	cacheDirectory = config_->getString("directory", "modelcache");
+	settings.shareState = config_->getBool("sharestate", true);
+	settings.mergeGeometry = config_->getBool("merge", true);
+	settings.triStrip = config_->getBool("tristrip", false);
+	settings.vertexCache = config_->getBool("vertexcache", true);
+
+	std::string compression = config_->getString("texturecompression", "none");
+	if( compression == "arb" )
+		settings.compression = COMPRESSION_ARB;
+	else if( compression == "dxt" )
+		settings.compression = COMPRESSION_DXT;
+	else
+	{
+		if( compression != "none" )
+			OSG_NOTIFY( osg::WARN ) << "WARNING: util_modelCache: Unknown texture compression '" << compression << "', using none." << std::endl;
+		settings.compression = COMPRESSION_NONE;
+	}
+}
+
+osg::Node* util_modelCache::readNode( const std::string& filename_, bool rebuild_ )
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	std::string cacheFilename = getCacheFilename( filename_ );
+
+	// Load the optimized model from the cache, unless one of the files embedded into it was changed.
+	if( !cacheFilename.empty() && !rebuild_ && osgDB::fileExists( cacheFilename ) )
+	{
+		DependencyList dependencies;
+		bool upToDate = readDependencies( getDependencyFilename( cacheFilename ), dependencies ) && isUpToDate( dependencies );
+		osg::ref_ptr<osg::Node> node = upToDate ? osgDB::readNodeFile( cacheFilename ) : NULL;
+		if( !upToDate )
+		{
+			OSG_NOTIFY( osg::NOTICE ) << "util_modelCache: A file referenced by " << filename_ << " was changed, rebuilding " << cacheFilename << std::endl;
+		}
+		else if( node.valid() )
+		{
+			double loadTime = osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() );
+			OSG_NOTIFY( osg::NOTICE ) << "util_modelCache: " << filename_ << " loaded from the cache in " << loadTime*1000.0 << " ms: " << toString( computeStatistics( node.get() ) ) << std::endl;
+
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+			numLoads++;
+			numCacheHits++;
+			totalLoadTime += loadTime;
+			return node.release();
+		}
+		else
+		{
+			OSG_NOTIFY( osg::WARN ) << "util_modelCache::readNode() :: Unable to read " << cacheFilename << ", rebuilding it." << std::endl;
+		}
+	}
+
+	osg::ref_ptr<osg::Node> node = osgDB::readNodeFile( filename_ );
+	if( !node.valid() )
+		return NULL;
+
+	if( cacheFilename.empty() )
+	{
+		double loadTime = osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() );
+		OSG_NOTIFY( osg::NOTICE ) << "util_modelCache: " << filename_ << " loaded in " << loadTime*1000.0 << " ms: " << toString( computeStatistics( node.get() ) ) << std::endl;
+
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		numLoads++;
+		totalLoadTime += loadTime;
+		return node.release();
+	}
+
+	modelStatistics loaded = computeStatistics( node.get() );
+	DependencyList dependencies = collectDependencies( node.get(), filename_ );
+	optimize( node.get() );
+
+	// Write into temporary files first, so a concurrent reader never sees a partial cache file.
+	std::string temporaryFilename, temporaryDependencyFilename;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		if( !osgDB::makeDirectory( cacheDirectory ) )
+			OSG_NOTIFY( osg::WARN ) << "util_modelCache::readNode() :: Unable to create the cache directory " << cacheDirectory << std::endl;
+		std::ostringstream name;
+		name << osgDB::getNameLessExtension( cacheFilename ) << ".tmp" << numTemporaryFiles++;
+		temporaryFilename = name.str() + ".osgb";
+		temporaryDependencyFilename = name.str() + ".deps";
+	}
+	// The dependency file is renamed after the model, so a concurrent reader never accepts the old model with the new dependency file.
+	osg::ref_ptr<osgDB::Options> options = new osgDB::Options("WriteImageHint=IncludeData");
+	std::string dependencyFilename = getDependencyFilename( cacheFilename );
+	bool cached = writeDependencies( temporaryDependencyFilename, dependencies ) && osgDB::writeNodeFile( *node, temporaryFilename, options.get() );
+	if( cached && rename( temporaryFilename.c_str(), cacheFilename.c_str() ) != 0 )
+	{
+		// The cache file exists already, e.g. written by another thread or rebuilt.
+		remove( cacheFilename.c_str() );
+		cached = rename( temporaryFilename.c_str(), cacheFilename.c_str() ) == 0;
+	}
+	if( cached && rename( temporaryDependencyFilename.c_str(), dependencyFilename.c_str() ) != 0 )
+	{
+		remove( dependencyFilename.c_str() );
+		cached = rename( temporaryDependencyFilename.c_str(), dependencyFilename.c_str() ) == 0;
+	}
+	if( !cached )
+	{
+		remove( temporaryFilename.c_str() );
+		remove( temporaryDependencyFilename.c_str() );
+		OSG_NOTIFY( osg::WARN ) << "util_modelCache::readNode() :: Unable to write " << cacheFilename << std::endl;
+	}
+
+	double loadTime = osg::Timer::instance()->delta_s( startTick, osg::Timer::instance()->tick() );
+	OSG_NOTIFY( osg::NOTICE ) << "util_modelCache: " << filename_ << " loaded and optimized in " << loadTime*1000.0 << " ms: " << toString( loaded ) << " -> " << toString( computeStatistics( node.get() ) ) << std::endl;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	numLoads++;
+	totalLoadTime += loadTime;
+	return node.release();
+}
+
+void util_modelCache::optimize( osg::Node* node_ ) const
+{
+	if( !node_ )
+		return;
+
+	unsigned int options = osgUtil::Optimizer::REMOVE_REDUNDANT_NODES | osgUtil::Optimizer::REMOVE_LOADED_PROXY_NODES
+		| osgUtil::Optimizer::CHECK_GEOMETRY | osgUtil::Optimizer::STATIC_OBJECT_DETECTION;
+	if( settings.shareState )
+		options |= osgUtil::Optimizer::SHARE_DUPLICATE_STATE;
+	if( settings.mergeGeometry )
+		options |= osgUtil::Optimizer::MERGE_GEODES | osgUtil::Optimizer::MERGE_GEOMETRY;
+	if( settings.triStrip )
+		options |= osgUtil::Optimizer::TRISTRIP_GEOMETRY;
+	if( settings.vertexCache )
+		options |= osgUtil::Optimizer::VERTEX_POSTTRANSFORM | osgUtil::Optimizer::VERTEX_PRETRANSFORM;
+
+	osgUtil::Optimizer optimizer;
+	optimizer.optimize( node_, options );
+
+	if( settings.compression != COMPRESSION_NONE )
+	{
+		textureCompressionVisitor visitor( settings.compression );
+		node_->accept( visitor );
+	}
+}
+
+std::string util_modelCache::getCacheFilename( const std::string& filename_ ) const
+{
+	if( cacheDirectory.empty() )
+		return "";
+
+	std::string path = osgDB::findDataFile( filename_ );
+	struct stat info;
+	if( path.empty() || stat( path.c_str(), &info ) != 0 )
+		return "";
+
+	// The key covers the model file and the optimizer chain. The images and external references embedded into the cached model
+	// are only known after loading, they are checked with the dependency file of the entry.
+	std::ostringstream key;
+	key << osgDB::getRealPath( path ) << '|' << static_cast<long long>(info.st_mtime) << '|' << static_cast<unsigned long long>(info.st_size)
+		<< '|' << CACHE_VERSION << '|' << osgGetVersion() << '|' << settings.shareState << settings.mergeGeometry << settings.triStrip
+		<< settings.vertexCache << settings.compression;
+
+	// FNV-1a
+	std::string keyString = key.str();
+	unsigned long long hash = 14695981039346656037ULL;
+	for(unsigned int i=0; i<keyString.size(); i++)
+	{
+		hash ^= static_cast<unsigned char>( keyString[i] );
+		hash *= 1099511628211ULL;
+	}
+
+	std::ostringstream name;
+	name << osgDB::getStrippedName( filename_ ) << "_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".osgb";
+	return osgDB::concatPaths( cacheDirectory, name.str() );
+}
+
+util_modelCache::DependencyList util_modelCache::collectDependencies( osg::Node* node_, const std::string& filename_ )
+{
+	DependencyList dependencies;
+	if( !node_ )
+		return dependencies;
+
+	dependencyVisitor visitor;
+	node_->accept( visitor );
+
+	// Plugins resolve relative references against the directory of the model file, then against the data file path list.
+	std::string modelDirectory = osgDB::getFilePath( osgDB::findDataFile( filename_ ) );
+	for( std::set<std::string>::const_iterator itr = visitor.filenames.begin(); itr != visitor.filenames.end(); ++itr )
+	{
+		std::string path = osgDB::concatPaths( modelDirectory, *itr );
+		if( modelDirectory.empty() || !osgDB::fileExists( path ) )
+			path = osgDB::findDataFile( *itr );
+
+		dependency entry;
+		entry.filename = path.empty() ? *itr : osgDB::getRealPath( path );
+		getFileInfo( path, entry.modificationTime, entry.fileSize );
+		dependencies.push_back( entry );
+	}
+	return dependencies;
+}
+
+bool util_modelCache::isUpToDate( const DependencyList& dependencies_ )
+{
+	for(unsigned int i=0; i<dependencies_.size(); i++)
+	{
+		long long modificationTime;
+		unsigned long long fileSize;
+		getFileInfo( dependencies_[i].filename, modificationTime, fileSize );
+		if( modificationTime != dependencies_[i].modificationTime || fileSize != dependencies_[i].fileSize )
+			return false;
+	}
+	return true;
+}
+
+bool util_modelCache::readDependencies( const std::string& filename_, DependencyList& dependencies_ )
+{
+	// One line per file: modification time, size and path.
+	std::ifstream in( filename_.c_str() );
+	if( !in )
+		return false;
+
+	std::string line;
+	while( std::getline( in, line ) )
+	{
+		std::istringstream fields( line );
+		dependency entry;
+		if( !(fields >> entry.modificationTime >> entry.fileSize) )
+			return false;
+		fields.ignore( 1 );
+		std::getline( fields, entry.filename );
+		dependencies_.push_back( entry );
+	}
+	return true;
+}
+
+bool util_modelCache::writeDependencies( const std::string& filename_, const DependencyList& dependencies_ )
+{
+	std::ofstream out( filename_.c_str(), std::ios::out | std::ios::trunc );
+	for(unsigned int i=0; i<dependencies_.size(); i++)
+		out << dependencies_[i].modificationTime << ' ' << dependencies_[i].fileSize << ' ' << dependencies_[i].filename << '\n';
+	out.close();
+	return out.good();
+}
+
+util_modelCache::modelStatistics util_modelCache::computeStatistics( osg::Node* node_ )
+{
+	statisticsVisitor visitor;
+	if( node_ )
+		node_->accept( visitor );
+	return visitor.getStatistics();
+}
+
+void util_modelCache::printReport()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	if( numLoads == 0 )
+		return;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "Model loading: " << numLoads << " models in " << totalLoadTime << " s";
+	if( !cacheDirectory.empty() )
+		OSG_NOTIFY( osg::ALWAYS ) << ", " << numCacheHits << " from the cache " << cacheDirectory;
+	OSG_NOTIFY( osg::ALWAYS ) << std::endl;
+}
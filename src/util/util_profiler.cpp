@@ -0,0 +1,210 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_profiler.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <fstream>
+#include <sstream>
+
+// Each thread keeps a pointer to its buffer, so recording requires no lookup.
+#if defined(_MSC_VER)
+	#define UTIL_PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+	#define UTIL_PROFILER_THREAD_LOCAL __thread
+#endif
+
+using namespace osgVisual;
+
+OpenThreads::Atomic util_profiler::enabled(0);
+
+static UTIL_PROFILER_THREAD_LOCAL void* localBuffer = NULL;
+
+static std::string escapeJSON( const std::string& value_ )
+{
+	std::string result;
+	for(unsigned int i=0; i<value_.size(); i++)
+	{
+		if( value_[i] == '"' || value_[i] == '\\' )
+			result += '\\';
+		result += value_[i];
+	}
+	return result;
+}
+
+util_profiler::util_profiler()
+{
+	bufferSize = 65536;
+	frameNumber.exchange( 0 );
+	startTick = osg::Timer::instance()->tick();
+}
+
+util_profiler::~util_profiler()
+{
+	enabled.exchange( 0 );
+	for(unsigned int i=0; i<buffers.size(); i++)
+		delete buffers[i];
+	buffers.clear();
+}
+
+util_profiler* util_profiler::getInstance()
+{
+	static util_profiler instance;
+	return &instance;
+}
+
+util_profiler::threadBuffer* util_profiler::getThreadBuffer()
+{
+	if( localBuffer )
+		return static_cast<threadBuffer*>(localBuffer);
+
+	threadBuffer* buffer = new threadBuffer;
+	buffer->events.resize( bufferSize );
+	buffer->next = 0;
+	buffer->wrapped = false;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+		buffer->id = buffers.size();
+		buffers.push_back( buffer );
+	}
+	std::stringstream name;
+	name << "thread " << buffer->id;
+	buffer->name = name.str();
+
+	localBuffer = buffer;
+	return buffer;
+}
+
+void util_profiler::setThreadName( const std::string& name_ )
+{
+	threadBuffer* buffer = getThreadBuffer();
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer->mutex);
+	buffer->name = name_;
+}
+
+void util_profiler::record( const char* name_, osg::Timer_t start_, osg::Timer_t end_ )
+{
+	threadBuffer* buffer = getThreadBuffer();
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer->mutex);
+
+	event& e = buffer->events[buffer->next];
+	e.name = name_;
+	e.start = start_;
+	e.end = end_;
+	e.frameNumber = frameNumber.OR( 0 );	// Atomic read, see isEnabled()
+
+	if( ++buffer->next == buffer->events.size() )
+	{
+		buffer->next = 0;
+		buffer->wrapped = true;
+	}
+}
+
+void util_profiler::clear()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+	for(unsigned int i=0; i<buffers.size(); i++)
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> bufferLock(buffers[i]->mutex);
+		buffers[i]->next = 0;
+		buffers[i]->wrapped = false;
+	}
+}
+
+void util_profiler::copyEvents( threadBuffer* buffer_, std::vector<event>& events_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer_->mutex);
+	events_.clear();
+	if( buffer_->wrapped )
+		events_.insert( events_.end(), buffer_->events.begin()+buffer_->next, buffer_->events.end() );
+	events_.insert( events_.end(), buffer_->events.begin(), buffer_->events.begin()+buffer_->next );
+}
+
+bool util_profiler::writeChromeTrace( const std::string& filename_ )
+{
+	std::ofstream file( filename_.c_str() );
+	if( !file )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_profiler: Unable to write '" << filename_ << "'." << std::endl;
+		return false;
+	}
+
+	osg::Timer* timer = osg::Timer::instance();
+	file << "{\"traceEvents\":[" << std::endl;
+	bool first = true;
+	unsigned int numEvents = 0;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+	std::vector<event> events;
+	for(unsigned int i=0; i<buffers.size(); i++)
+	{
+		copyEvents( buffers[i], events );
+
+		// Metadata event to show the thread name instead of its id.
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffers[i]->id << ",\"args\":{\"name\":\"" << escapeJSON(buffers[i]->name) << "\"}}";
+		first = false;
+
+		for(unsigned int j=0; j<events.size(); j++)
+		{
+			file << ",\n{\"name\":\"" << escapeJSON(events[j].name) << "\",\"cat\":\"osgVisual\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffers[i]->id
+				 << ",\"ts\":" << timer->delta_u( startTick, events[j].start ) << ",\"dur\":" << timer->delta_u( events[j].start, events[j].end )
+				 << ",\"args\":{\"frame\":" << events[j].frameNumber << "}}";
+		}
+		numEvents += events.size();
+	}
+	file << std::endl << "]}" << std::endl;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "util_profiler: Wrote " << numEvents << " events of " << buffers.size() << " threads to '" << filename_ << "'." << std::endl;
+	return file.good();
+}
+
+bool util_profiler::writeCSV( const std::string& filename_ )
+{
+	std::ofstream file( filename_.c_str() );
+	if( !file )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_profiler: Unable to write '" << filename_ << "'." << std::endl;
+		return false;
+	}
+
+	osg::Timer* timer = osg::Timer::instance();
+	file << "thread,frame,name,start_ms,duration_ms" << std::endl;
+	unsigned int numEvents = 0;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+	std::vector<event> events;
+	for(unsigned int i=0; i<buffers.size(); i++)
+	{
+		copyEvents( buffers[i], events );
+		for(unsigned int j=0; j<events.size(); j++)
+		{
+			file << buffers[i]->name << "," << events[j].frameNumber << "," << events[j].name << ","
+				 << timer->delta_m( startTick, events[j].start ) << "," << timer->delta_m( events[j].start, events[j].end ) << std::endl;
+		}
+		numEvents += events.size();
+	}
+
+	OSG_NOTIFY( osg::ALWAYS ) << "util_profiler: Wrote " << numEvents << " events of " << buffers.size() << " threads to '" << filename_ << "'." << std::endl;
+	return file.good();
+}
+
+bool util_profiler::write( const std::string& filename_ )
+{
+	if( osgDB::getLowerCaseFileExtension( filename_ ) == "csv" )
+		return writeCSV( filename_ );
+	return writeChromeTrace( filename_ );
+}
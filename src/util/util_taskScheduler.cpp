@@ -0,0 +1,334 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_taskScheduler.h>
+#include <util_profiler.h>
+
+#include <algorithm>
+
+using namespace osgVisual;
+
+util_taskScheduler::job::job( const char* name_, int order_, bool mainThread_ )
+{
+	name = name_;
+	orderKey = order_;
+	mainThread = mainThread_;
+	grainSize = 1;
+	numDependencies = 0;
+}
+
+bool util_taskScheduler::job::dependsOn( const job* other_ ) const
+{
+	for(unsigned int i=0; i<other_->writeResources.size(); i++)
+	{
+		const std::string& resource = other_->writeResources[i];
+		if( std::find( readResources.begin(), readResources.end(), resource ) != readResources.end()
+			|| std::find( writeResources.begin(), writeResources.end(), resource ) != writeResources.end() )
+			return true;
+	}
+
+	for(unsigned int i=0; i<other_->readResources.size(); i++)
+	{
+		if( std::find( writeResources.begin(), writeResources.end(), other_->readResources[i] ) != writeResources.end() )
+			return true;
+	}
+
+	return false;
+}
+
+void util_taskScheduler::taskQueue::push( const task& task_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	tasks.push_back( task_ );
+}
+
+bool util_taskScheduler::taskQueue::pop( task& task_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	if( head == tasks.size() )
+		return false;
+
+	task_ = tasks.back();
+	tasks.pop_back();
+	if( head == tasks.size() )
+	{
+		tasks.clear();
+		head = 0;
+	}
+	return true;
+}
+
+bool util_taskScheduler::taskQueue::steal( task& task_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	if( head == tasks.size() )
+		return false;
+
+	task_ = tasks[head++];
+	if( head == tasks.size() )
+	{
+		tasks.clear();
+		head = 0;
+	}
+	return true;
+}
+
+void util_taskScheduler::workerThread::run()
+{
+	scheduler->workerLoop( index );
+}
+
+util_taskScheduler::util_taskScheduler()
+{
+	graphDirty = false;
+	queues.push_back( new taskQueue() );
+}
+
+util_taskScheduler::~util_taskScheduler()
+{
+	shutdown();
+	for(unsigned int i=0; i<queues.size(); i++)
+		delete queues[i];
+	queues.clear();
+}
+
+util_taskScheduler* util_taskScheduler::getInstance()
+{
+	static util_taskScheduler instance;
+	return &instance;
+}
+
+void util_taskScheduler::addJob( job* job_ )
+{
+	// Insert behind all jobs with the same or a lower order key.
+	std::vector< osg::ref_ptr<job> >::iterator position = jobs.begin();
+	while( position != jobs.end() && (*position)->getOrder() <= job_->getOrder() )
+		++position;
+	jobs.insert( position, job_ );
+	graphDirty = true;
+}
+
+void util_taskScheduler::removeJob( job* job_ )
+{
+	for(unsigned int i=0; i<jobs.size(); i++)
+	{
+		if( jobs[i] == job_ )
+		{
+			jobs.erase( jobs.begin()+i );
+			graphDirty = true;
+			return;
+		}
+	}
+}
+
+void util_taskScheduler::buildGraph()
+{
+	for(unsigned int i=0; i<jobs.size(); i++)
+	{
+		jobs[i]->successors.clear();
+		jobs[i]->numDependencies = 0;
+	}
+
+	for(unsigned int j=1; j<jobs.size(); j++)
+	{
+		for(unsigned int i=0; i<j; i++)
+		{
+			if( jobs[j]->dependsOn( jobs[i].get() ) )
+			{
+				jobs[i]->successors.push_back( j );
+				jobs[j]->numDependencies++;
+			}
+		}
+	}
+
+	graphDirty = false;
+}
+
+void util_taskScheduler::runFrame()
+{
+	if( jobs.empty() )
+		return;
+
+	if( graphDirty )
+		buildGraph();
+
+	pendingJobs.exchange( jobs.size() );
+	for(unsigned int i=0; i<jobs.size(); i++)
+		jobs[i]->pendingDependencies.exchange( jobs[i]->numDependencies );
+
+	for(unsigned int i=0; i<jobs.size(); i++)
+	{
+		if( jobs[i]->numDependencies == 0 )
+			release( i, 0 );
+	}
+
+	// Execute main thread jobs and help the workers until all jobs are completed.
+	task t;
+	while( load(pendingJobs) > 0 )
+	{
+		if( mainQueue.pop( t ) )
+		{
+			--queuedMainTasks;
+			execute( t, 0 );
+			continue;
+		}
+
+		if( findTask( 0, t ) )
+		{
+			execute( t, 0 );
+			continue;
+		}
+
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(wakeMutex);
+		if( load(pendingJobs) > 0 && load(queuedMainTasks) == 0 && load(queuedTasks) == 0 )
+			wakeCondition.wait( &wakeMutex );
+	}
+}
+
+void util_taskScheduler::release( unsigned int job_, unsigned int queue_ )
+{
+	job* releasedJob = jobs[job_].get();
+	unsigned int numItems = releasedJob->getNumItems();
+	if( numItems == 0 )
+	{
+		complete( job_, queue_ );
+		return;
+	}
+
+	unsigned int grainSize = releasedJob->getGrainSize();
+	unsigned int numTasks = (numItems + grainSize-1) / grainSize;
+	releasedJob->pendingTasks.exchange( numTasks );
+
+	// The counter is raised before the tasks are queued, so a thread which finds a task never decrements it below zero.
+	taskQueue& queue = releasedJob->isMainThreadJob() ? mainQueue : *queues[queue_];
+	OpenThreads::Atomic& counter = releasedJob->isMainThreadJob() ? queuedMainTasks : queuedTasks;
+	for(unsigned int i=0; i<numTasks; i++)
+		++counter;
+
+	for(unsigned int i=0; i<numTasks; i++)
+	{
+		task t;
+		t.job = job_;
+		t.begin = i*grainSize;
+		t.end = std::min( t.begin+grainSize, numItems );
+		queue.push( t );
+	}
+
+	wake();
+}
+
+void util_taskScheduler::complete( unsigned int job_, unsigned int queue_ )
+{
+	const std::vector<unsigned int>& successors = jobs[job_]->successors;
+	for(unsigned int i=0; i<successors.size(); i++)
+	{
+		if( --jobs[successors[i]]->pendingDependencies == 0 )
+			release( successors[i], queue_ );
+	}
+
+	if( --pendingJobs == 0 )
+		wake();
+}
+
+void util_taskScheduler::execute( const task& task_, unsigned int queue_ )
+{
+	job* executedJob = jobs[task_.job].get();
+	{
+		OSGVISUAL_PROFILE_SCOPE( executedJob->getName() );
+		executedJob->run( task_.begin, task_.end );
+	}
+
+	if( --executedJob->pendingTasks == 0 )
+		complete( task_.job, queue_ );
+}
+
+bool util_taskScheduler::findTask( unsigned int queue_, task& task_ )
+{
+	bool found = queues[queue_]->pop( task_ );
+
+	// Steal from the other queues, starting with the next one to spread the thieves.
+	for(unsigned int i=1; i<queues.size() && !found; i++)
+		found = queues[(queue_+i) % queues.size()]->steal( task_ );
+
+	if( found )
+		--queuedTasks;
+	return found;
+}
+
+void util_taskScheduler::workerLoop( unsigned int queue_ )
+{
+	task t;
+	while( load(running) )
+	{
+		if( findTask( queue_, t ) )
+		{
+			execute( t, queue_ );
+			continue;
+		}
+
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(wakeMutex);
+		if( load(running) && load(queuedTasks) == 0 )
+			wakeCondition.wait( &wakeMutex );
+	}
+}
+
+void util_taskScheduler::wake()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(wakeMutex);
+	wakeCondition.broadcast();
+}
+
+void util_taskScheduler::start( unsigned int numThreads_ )
+{
+	if( !threads.empty() )
+		return;
+
+	if( numThreads_ == 0 )
+		numThreads_ = OpenThreads::GetNumberOfProcessors() > 1 ? OpenThreads::GetNumberOfProcessors() - 1 : 0;
+
+	running.exchange( 1 );
+	for(unsigned int i=0; i<numThreads_; i++)
+		queues.push_back( new taskQueue() );
+	for(unsigned int i=0; i<numThreads_; i++)
+	{
+		workerThread* thread = new workerThread( this, i+1 );
+		threads.push_back( thread );
+		thread->startThread();
+	}
+
+	OSG_NOTIFY( osg::NOTICE ) << "util_taskScheduler: Started " << numThreads_ << " worker threads." << std::endl;
+}
+
+void util_taskScheduler::shutdown()
+{
+	if( threads.empty() )
+		return;
+
+	running.exchange( 0 );
+	wake();
+
+	for(unsigned int i=0; i<threads.size(); i++)
+	{
+		threads[i]->join();
+		delete threads[i];
+	}
+	threads.clear();
+
+	// Keep the queue of the main thread.
+	for(unsigned int i=1; i<queues.size(); i++)
+		delete queues[i];
+	queues.resize( 1 );
+}
@@ -0,0 +1,248 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under 
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_terrainHeightGrid.h>
+
+#include <osg/Math>
+
+#include <fstream>
+#include <cmath>
+#include <cstring>
+
+using namespace osgVisual;
+
+const float util_terrainHeightGrid::NO_DATA = -32768.0f;
+
+static const unsigned int HEIGHTGRID_VERSION = 1;
+
+// Largest accepted tile edge length, which keeps the size computations of load() free of overflows.
+static const unsigned int MAX_TILE_SIZE = 65536;
+
+util_terrainHeightGrid::util_terrainHeightGrid()
+{
+	tileSize = 0;
+}
+
+util_terrainHeightGrid::~util_terrainHeightGrid()
+{
+	unload();
+}
+
+util_terrainHeightGrid* util_terrainHeightGrid::getInstance()
+{
+	static util_terrainHeightGrid instance;
+	return &instance;
+}
+
+bool util_terrainHeightGrid::load( const std::string& filename_ )
+{
+	unload();
+
+	osg::ref_ptr<util_mappedFile> tmpFile = new util_mappedFile();
+	if( !tmpFile->open( filename_ ) )
+		return false;
+
+	// Check file header
+	fileHeader header;
+	if( tmpFile->getSize() < sizeof(fileHeader) )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::load() :: File too small: " << filename_ << std::endl;
+		return false;
+	}
+	memcpy( &header, tmpFile->getData(), sizeof(fileHeader) );
+	if( strncmp( header.magic, "OVHG", 4 ) != 0 || header.version != HEIGHTGRID_VERSION || header.numLevels == 0 || header.tileSize == 0 || header.tileSize > MAX_TILE_SIZE )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::load() :: Invalid header or unsupported version: " << filename_ << std::endl;
+		return false;
+	}
+
+	// Read level headers and locate the samples of each level
+	size_t offset = sizeof(fileHeader) + header.numLevels * sizeof(levelHeader);
+	if( tmpFile->getSize() < offset )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::load() :: File truncated: " << filename_ << std::endl;
+		return false;
+	}
+
+	std::vector<mappedLevel> tmpLevels( header.numLevels );
+	for(unsigned int i=0; i<header.numLevels; i++)
+	{
+		mappedLevel& level = tmpLevels[i];
+		memcpy( &level.header, tmpFile->getData() + sizeof(fileHeader) + i*sizeof(levelHeader), sizeof(levelHeader) );
+
+		// The tiles have to cover all samples, otherwise getSample() reads behind the level.
+		if( level.header.numLat < 2 || level.header.numLon < 2 || level.header.latMax <= level.header.latMin || level.header.lonMax <= level.header.lonMin
+			|| static_cast<unsigned long long>(level.header.numTilesLat) * header.tileSize < level.header.numLat
+			|| static_cast<unsigned long long>(level.header.numTilesLon) * header.tileSize < level.header.numLon )
+		{
+			OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::load() :: Invalid level " << i << ": " << filename_ << std::endl;
+			return false;
+		}
+
+		level.latScale = (level.header.numLat-1) / (level.header.latMax - level.header.latMin);
+		level.lonScale = (level.header.numLon-1) / (level.header.lonMax - level.header.lonMin);
+
+		// The samples of the level have to be inside the file. The divisions avoid an overflow with corrupt tile counts.
+		unsigned long long tileBytes = static_cast<unsigned long long>(header.tileSize) * header.tileSize * sizeof(float);
+		unsigned long long remaining = tmpFile->getSize() - offset;
+		if( level.header.numTilesLat > remaining / tileBytes || level.header.numTilesLon > remaining / tileBytes / level.header.numTilesLat )
+		{
+			OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::load() :: File truncated: " << filename_ << std::endl;
+			return false;
+		}
+
+		level.samples = reinterpret_cast<const float*>( tmpFile->getData() + offset );
+		offset += static_cast<size_t>( tileBytes * level.header.numTilesLat * level.header.numTilesLon );
+	}
+
+	file = tmpFile;
+	levels = tmpLevels;
+	tileSize = header.tileSize;
+
+	OSG_NOTIFY( osg::ALWAYS ) << "util_terrainHeightGrid: Loaded " << filename_ << " with " << levels.size() << " levels." << std::endl;
+	return true;
+}
+
+void util_terrainHeightGrid::unload()
+{
+	levels.clear();
+	file = NULL;
+	tileSize = 0;
+}
+
+bool util_terrainHeightGrid::queryHeightOfTerrain( double& hot_, double lat_, double lon_ ) const
+{
+	// Use the finest level which covers the position and has valid data
+	for(int i=static_cast<int>(levels.size())-1; i>=0; i--)
+	{
+		const mappedLevel& level = levels[i];
+
+		double u = (lon_ - level.header.lonMin) * level.lonScale;
+		double v = (lat_ - level.header.latMin) * level.latScale;
+		if( u < 0.0 || v < 0.0 || u > level.header.numLon-1 || v > level.header.numLat-1 )
+			continue;
+
+		unsigned int iLon0 = static_cast<unsigned int>(u);
+		unsigned int iLat0 = static_cast<unsigned int>(v);
+		unsigned int iLon1 = osg::minimum( iLon0+1, level.header.numLon-1 );
+		unsigned int iLat1 = osg::minimum( iLat0+1, level.header.numLat-1 );
+
+		float h00 = getSample( level, iLat0, iLon0 );
+		float h01 = getSample( level, iLat0, iLon1 );
+		float h10 = getSample( level, iLat1, iLon0 );
+		float h11 = getSample( level, iLat1, iLon1 );
+		if( h00 == NO_DATA || h01 == NO_DATA || h10 == NO_DATA || h11 == NO_DATA )
+			continue;
+
+		double fu = u - iLon0;
+		double fv = v - iLat0;
+		hot_ = (h00*(1.0-fu) + h01*fu) * (1.0-fv) + (h10*(1.0-fu) + h11*fu) * fv;
+		return true;
+	}
+
+	return false;
+}
+
+bool util_terrainHeightGrid::queryHeightAboveTerrain( double& hat_, double lat_, double lon_, double height_ ) const
+{
+	double hot;
+	if( !queryHeightOfTerrain( hot, lat_, lon_ ) )
+		return false;
+
+	hat_ = height_ - hot;
+	return true;
+}
+
+bool util_terrainHeightGrid::write( const std::string& filename_, const std::vector<gridLevel>& levels_, const std::vector< std::vector<float> >& heights_, unsigned int tileSize_ )
+{
+	if( levels_.empty() || levels_.size() != heights_.size() || tileSize_ == 0 || tileSize_ > MAX_TILE_SIZE )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::write() :: Invalid arguments." << std::endl;
+		return false;
+	}
+
+	std::ofstream out( filename_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if( !out )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::write() :: Unable to open " << filename_ << std::endl;
+		return false;
+	}
+
+	// File header
+	fileHeader header;
+	memcpy( header.magic, "OVHG", 4 );
+	header.version = HEIGHTGRID_VERSION;
+	header.numLevels = levels_.size();
+	header.tileSize = tileSize_;
+	out.write( reinterpret_cast<const char*>(&header), sizeof(fileHeader) );
+
+	// Level headers
+	std::vector<levelHeader> levelHeaders( levels_.size() );
+	for(unsigned int i=0; i<levels_.size(); i++)
+	{
+		if( levels_[i].numLat < 2 || levels_[i].numLon < 2 || heights_[i].size() != levels_[i].numLat * levels_[i].numLon )
+		{
+			OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::write() :: Invalid sample count in level " << i << std::endl;
+			return false;
+		}
+
+		levelHeader& lh = levelHeaders[i];
+		memset( &lh, 0, sizeof(levelHeader) );
+		lh.latMin = levels_[i].latMin;
+		lh.lonMin = levels_[i].lonMin;
+		lh.latMax = levels_[i].latMax;
+		lh.lonMax = levels_[i].lonMax;
+		lh.numLat = levels_[i].numLat;
+		lh.numLon = levels_[i].numLon;
+		lh.numTilesLat = (lh.numLat + tileSize_ - 1) / tileSize_;
+		lh.numTilesLon = (lh.numLon + tileSize_ - 1) / tileSize_;
+		out.write( reinterpret_cast<const char*>(&lh), sizeof(levelHeader) );
+	}
+
+	// Samples, reordered into tiles. Tiles at the border are filled up with NO_DATA.
+	std::vector<float> tile( tileSize_*tileSize_ );
+	for(unsigned int i=0; i<levels_.size(); i++)
+	{
+		const levelHeader& lh = levelHeaders[i];
+		for(unsigned int tLat=0; tLat<lh.numTilesLat; tLat++)
+		{
+			for(unsigned int tLon=0; tLon<lh.numTilesLon; tLon++)
+			{
+				for(unsigned int y=0; y<tileSize_; y++)
+				{
+					unsigned int iLat = tLat*tileSize_ + y;
+					for(unsigned int x=0; x<tileSize_; x++)
+					{
+						unsigned int iLon = tLon*tileSize_ + x;
+						if( iLat < lh.numLat && iLon < lh.numLon )
+							tile[y*tileSize_ + x] = heights_[i][iLat*lh.numLon + iLon];
+						else
+							tile[y*tileSize_ + x] = NO_DATA;
+					}
+				}
+				out.write( reinterpret_cast<const char*>(&tile[0]), tile.size()*sizeof(float) );
+			}
+		}
+	}
+
+	if( !out )
+	{
+		OSG_NOTIFY( osg::WARN ) << "util_terrainHeightGrid::write() :: Error while writing " << filename_ << std::endl;
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,198 @@
+/* -*-c++-*- osgVisual - Copyright (C) 2009-2011 Torben Dannhauer
+ *
+ * This library is based on OpenSceneGraph, open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * osgVisual requires for some proprietary modules a license from the correspondig manufacturer.
+ * You have to aquire licenses for all used proprietary modules.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+*/
+
+#include <util_workerPool.h>
+
+using namespace osgVisual;
+
+util_workerPool::util_workerPool()
+{
+	generation = 0;
+	stopped = false;
+}
+
+util_workerPool::~util_workerPool()
+{
+	shutdown();
+}
+
+util_workerPool* util_workerPool::getInstance()
+{
+	static util_workerPool instance;
+	return &instance;
+}
+
+void util_workerPool::workerThread::run()
+{
+	pool->workerLoop( generation );
+}
+
+void util_workerPool::start( unsigned int numThreads_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+
+	stopped = false;
+	startThreads( numThreads_ );
+}
+
+void util_workerPool::startThreads( unsigned int numThreads_ )
+{
+	if( !threads.empty() )
+		return;
+
+	if( numThreads_ == 0 )
+	{
+		int numProcessors = OpenThreads::GetNumberOfProcessors();
+		numThreads_ = numProcessors > 1 ? numProcessors-1 : 1;
+	}
+
+	OSG_NOTIFY( osg::INFO ) << "util_workerPool: Starting " << numThreads_ << " worker threads." << std::endl;
+
+	for(unsigned int i=0; i<numThreads_; i++)
+	{
+		workerThread* thread = new workerThread( this, generation );
+		threads.push_back( thread );
+		thread->startThread();
+	}
+}
+
+void util_workerPool::shutdown()
+{
+	// The threads are joined without holding the mutex, so they can finish their current operation.
+	std::vector<workerThread*> stoppingThreads;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		stopped = true;
+		generation++;
+		stoppingThreads.swap( threads );
+		condition.broadcast();
+	}
+
+	for(unsigned int i=0; i<stoppingThreads.size(); i++)
+	{
+		stoppingThreads[i]->join();
+		delete stoppingThreads[i];
+	}
+
+	// Inform the background operations which were not executed, so nobody waits for them forever.
+	std::deque< osg::ref_ptr<osg::Operation> > discarded;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		discarded.swap( backgroundOperations );
+	}
+	for(unsigned int i=0; i<discarded.size(); i++)
+		discardOperation( discarded[i].get() );
+}
+
+bool util_workerPool::add( osg::Operation* operation_ )
+{
+	osg::ref_ptr<osg::Operation> operation = operation_;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		if( !stopped )
+		{
+			startThreads( 0 );
+			backgroundOperations.push_back( operation );
+			condition.broadcast();
+			return true;
+		}
+	}
+
+	OSG_NOTIFY( osg::INFO ) << "util_workerPool: Rejecting operation " << operation->getName() << ", the pool is shut down." << std::endl;
+	discardOperation( operation.get() );
+	return false;
+}
+
+void util_workerPool::runAndWait( std::vector< osg::ref_ptr<osg::Operation> >& operations_ )
+{
+	if( operations_.empty() )
+		return;
+
+	unsigned int pending = operations_.size()-1;
+	if( pending > 0 )
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		for(unsigned int i=0; i<operations_.size()-1; i++)
+			batchOperations.push_back( batchEntry(operations_[i].get(), &pending) );
+		condition.broadcast();
+	}
+
+	// Use the calling thread instead of letting it idle.
+	(*operations_.back())(NULL);
+
+	// Help with the queued operations until the own ones are completed, even if they belong to another call.
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	while( pending > 0 )
+	{
+		if( !batchOperations.empty() )
+			executeBatchEntry();
+		else
+			condition.wait( &mutex );
+	}
+}
+
+void util_workerPool::executeBatchEntry()
+{
+	batchEntry entry = batchOperations.front();
+	batchOperations.pop_front();
+	{
+		OpenThreads::ReverseScopedLock<OpenThreads::Mutex> unlock(mutex);
+		(*entry.operation)(NULL);
+	}
+
+	if( --(*entry.pending) == 0 )
+		condition.broadcast();
+}
+
+void util_workerPool::workerLoop( unsigned int generation_ )
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	while( generation == generation_ )
+	{
+		if( !batchOperations.empty() )
+			executeBatchEntry();
+		else if( !backgroundOperations.empty() )
+		{
+			osg::ref_ptr<osg::Operation> operation = backgroundOperations.front();
+			backgroundOperations.pop_front();
+
+			OpenThreads::ReverseScopedLock<OpenThreads::Mutex> unlock(mutex);
+			(*operation)(NULL);
+			operation = NULL;
+		}
+		else
+			condition.wait( &mutex );
+	}
+}
+
+unsigned int util_workerPool::getNumThreads()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	return threads.size();
+}
+
+unsigned int util_workerPool::getNumPendingOperations()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+	return batchOperations.size() + backgroundOperations.size();
+}
+
+void util_workerPool::discardOperation( osg::Operation* operation_ )
+{
+	discardableOperation* discardable = dynamic_cast<discardableOperation*>( operation_ );
+	if( discardable )
+		discardable->discard();
+}
@@ -16,184 +16,65 @@
 
 #include <visual_util.h>
 #include <osg/Material>
+#include <util_kdTreeBuilder.h>
+#include <util_terrainHeightGrid.h>
+#include <util_log.h>
+#include <util_allocTracker.h>
+
+#include <OpenThreads/ScopedLock>
+
+// Each thread keeps a pointer to its intersection context, see util::intersect().
+#if defined(_MSC_VER)
+	#define VISUAL_UTIL_THREAD_LOCAL __declspec(thread)
+#else
+	#define VISUAL_UTIL_THREAD_LOCAL __thread
+#endif
 
 using namespace osgVisual;
 
-util::util(void)
+/**
+ * Intersector and visitor of one thread, reused by util::intersect() instead of allocating both for every query.
+ */
+struct intersectionContext
 {
-}
+	intersectionContext() : intersector(new osgUtil::LineSegmentIntersector(osg::Vec3d(), osg::Vec3d())) {visitor.setIntersector(intersector.get());};
 
-util::~util(void)
-{
-}
+	osg::ref_ptr<osgUtil::LineSegmentIntersector> intersector;
+	osgUtil::IntersectionVisitor visitor;
+};
 
-xmlNode* util::getSceneryXMLConfig(std::string configFilename, xmlDoc*& doc)
+/**
+ * Owner of the intersection contexts of all threads, deletes them on program exit.
+ */
+class intersectionContextList
 {
-	doc = NULL;
-	xmlNode *root_element = NULL;
-
-	// Check for valid parameters
-	if(configFilename == "")
+public:
+	~intersectionContextList()
 	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : Invalid Configuration Filename!" << std::endl;
-		return NULL;
-	}
-
-	// It is a valid XML document?
-	doc = xmlReadFile(configFilename.c_str(), NULL, 0);	
-	if (doc == NULL)
-	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : " << configFilename << " is not a valid XML file!" << std::endl;
-		return NULL;
+		for(unsigned int i=0; i<contexts.size(); i++)
+			delete contexts[i];
 	}
 
-	//  Get the root element node
-	root_element = xmlDocGetRootElement(doc);
-
-	// If file is a valid osgVisual config file, check all the root xml node and all of it's children of osgvisualconfiguration for the specified module
-	xmlNode* tmpNode = checkXMLNodeChildrenForScenery(root_element);
-
-	if( !tmpNode ) // if no valid node was found: clena up. Otherwise: the caller has to clean up.
+	void add( intersectionContext* context_ )
 	{
-		xmlFreeDoc(doc);	// free the document
-		xmlCleanupParser();	// Free the global variables that may have been allocated by the parser.
-		return NULL;
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+		contexts.push_back( context_ );
 	}
-	else
-		return tmpNode;
-}
 
-xmlNode* util::checkXMLNodeChildrenForScenery(xmlNode* node)
-{
-	for (xmlNode *cur_node = node; cur_node; cur_node = cur_node->next)	// iterate through all elements 
-	{
-		// Is the node the one we are searching for?
-		if (cur_node->type == XML_ELEMENT_NODE)
-		{
-			std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-			if (node_name == "scenery")
-			{
-				OSG_DEBUG << "XML node scenery found" << std::endl;
-				return cur_node;
-			}
-			else	// Otherwise: check its children..
-			{
-				xmlNode* tmp_XmlNode = checkXMLNodeChildrenForScenery(cur_node->children);
-				if(tmp_XmlNode)
-					return tmp_XmlNode;
-			}
-		}	// IF NODE TYPE = ELEMENT END
+private:
+	OpenThreads::Mutex mutex;
+	std::vector<intersectionContext*> contexts;
+};
 
-		// Proceed with next node in this loop.
-	}
-	return NULL;
-}
+static intersectionContextList allIntersectionContexts;
+static VISUAL_UTIL_THREAD_LOCAL intersectionContext* localIntersectionContext = NULL;
 
-xmlNode* util::getModuleXMLConfig(std::string configFilename, std::string moduleName, xmlDoc*& doc, bool& disabled)
+util::util(void)
 {
-	doc = NULL;
-	disabled = false;
-	xmlNode *root_element = NULL;
-
-	// Check for valid parameters
-	if(configFilename == "")
-	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : Invalid Configuration Filename!" << std::endl;
-		return NULL;
-	}
-	if(moduleName == "")
-	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : Invalid Module Filename!" << std::endl;
-		return NULL;
-	}
-
-	// It is a valid XML document?
-	doc = xmlReadFile(configFilename.c_str(), NULL, 0);	
-	if (doc == NULL)
-	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : " << configFilename << " is not a valid XML file!" << std::endl;
-		return NULL;
-	}
-
-	//  Get the root element node
-	root_element = xmlDocGetRootElement(doc);
-
-	// Check if it is an osgVisual configuration file
-	std::string node_name=reinterpret_cast<const char*>(root_element->name);
-	if(!(root_element->type == XML_ELEMENT_NODE && node_name == "osgvisualconfiguration"))
-	{
-		OSG_ALWAYS << "ERROR - util::getModuleXMLConfig() : " << configFilename << " is not an osgVisual configuration file!" << std::endl;
-		return NULL;
-	}
-
-	// If file is a valid osgVisual config file, check all the root xml node and all of it's children of osgvisualconfiguration for the specified module
-	xmlNode* tmpNode = checkXMLNodeChildrenForModule(root_element, moduleName, disabled);
-
-	if( !tmpNode ) // if no valid node was found or the module is disabled: clean up. Otherwise: the caller has to clean up.
-	{
-		xmlFreeDoc(doc);	// free the document
-		xmlCleanupParser();	// Free the global variables that may have been allocated by the parser.
-		return NULL;
-	}
-	else
-		return tmpNode;
-
 }
 
-xmlNode* util::checkXMLNodeChildrenForModule(xmlNode* node, std::string moduleName, bool& disabled)
+util::~util(void)
 {
-	for (xmlNode *cur_node = node; cur_node; cur_node = cur_node->next)	// iterate through all XML elements 
-	{
-		// Is the node the one we are searching for?
-		if (cur_node->type == XML_ELEMENT_NODE)
-		{
-			// Extract Node Name and the first attribute: "module name"
-			std::string node_name = reinterpret_cast<const char*>(cur_node->name);
-			std::string modName = "";
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "name" )
-					modName = attr_value;
-				attr = attr->next;
-			}
-			
-			// Check each node for the searched module
-			if (node_name == "module" && modName == moduleName)
-			{
-				// Check if the module is active
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-					if( attr_name == "enabled" && attr_value == "yes" )
-					{
-						OSG_DEBUG << "Found XML module configuration for " << moduleName << std::endl;
-						return cur_node;
-					}
-					if( attr_name == "enabled" && attr_value == "no" )
-					{
-						disabled = true;
-						OSG_DEBUG << "Found XML module configuration for " << moduleName << ", but it is DISABLED." << std::endl;
-						return NULL;
-					}
-					attr = attr->next;
-				}
-			}
-			else	// Otherwise: check its children..
-			{
-				xmlNode* tmp_XmlNode = checkXMLNodeChildrenForModule(cur_node->children, moduleName, disabled);
-				if(tmp_XmlNode)
-					return tmp_XmlNode;
-			}
-		}	// IF NODE TYPE = ELEMENT END
-
-		// Proceed with next node in this loop.
-	}
-	return NULL;
 }
 
 osg::Node* util::findNamedNode(const std::string& searchName_, osg::Node* currNode_)
@@ -230,7 +111,7 @@ osg::Node* util::findNamedNode(const std::string& searchName_, osg::Node* currNo
          foundNode = findNamedNode(searchName_, currGroup->getChild(i));
          if (foundNode)
 		 {
-			 std::cout << "Node gefunden in Ebene: " << i << std::endl;
+			 OSGVISUAL_LOG( osg::DEBUG_INFO ) << "Node gefunden in Ebene: " << i << std::endl;
             return foundNode; // found a match!
 		}
       }
@@ -264,19 +145,37 @@ osg::ref_ptr<osg::Geode> util::getDemoSphere(double radius_, osg::Vec3 offset_ )
 
 bool util::intersect(const osg::Vec3d& start_, const osg::Vec3d& end_, osg::Vec3d& intersection_, osg::Node* node_, osg::Node::NodeMask intersectTraversalMask_ )
 {
-	osg::ref_ptr<osgUtil::LineSegmentIntersector> lsi = new osgUtil::LineSegmentIntersector(start_,end_);
+	// Attach KdTrees which are completed in the background since the last query.
+	util_kdTreeBuilder::getInstance()->installCompletedKdTrees();
+
+	// Reuse the intersector and visitor of this thread.
+	if( !localIntersectionContext )
+	{
+		localIntersectionContext = new intersectionContext;
+		allIntersectionContexts.add( localIntersectionContext );
+	}
+	osgUtil::LineSegmentIntersector* lsi = localIntersectionContext->intersector.get();
+	osgUtil::IntersectionVisitor& iv = localIntersectionContext->visitor;
 
-	osgUtil::IntersectionVisitor iv(lsi.get());
+	lsi->setStart(start_);
+	lsi->setEnd(end_);
+	iv.reset();
 	iv.setTraversalMask(intersectTraversalMask_);
     
 	node_->accept(iv);
     
+	bool found = false;
 	if (lsi->containsIntersections())
 	{
 		intersection_ = lsi->getIntersections().begin()->getWorldIntersectPoint();
-		return true;	// Intersect found
+		// Hit drawables without KdTree are intersected brute force: schedule their KdTree construction.
+		util_kdTreeBuilder::getInstance()->requestKdTree( lsi->getIntersections().begin()->drawable.get() );
+		found = true;	// Intersect found
 	}
-	return false;	// No intersect found
+
+	// Release the hit nodes, as the intersector outlives this query.
+	lsi->getIntersections().clear();
+	return found;
 }
 
 bool util::queryHeightOfTerrain(double& hot_, osg::Node* rootNode_, double lat_, double lon_, osg::Node::NodeMask traversalMask_)
@@ -295,6 +194,13 @@ bool util::queryHeightOfTerrain(double& hot_, osg::Node* rootNode_, double lat_,
 		return false;
 	}
 
+	// Use the precompiled height grid if it covers the position: constant time and independent of the paged tiles.
+	{
+		OSGVISUAL_ALLOC_ZERO_SCOPE("util_terrainHeightGrid query");
+		if ( util_terrainHeightGrid::getInstance()->queryHeightOfTerrain(hot_, lat_, lon_) )
+			return true;
+	}
+
 	// Setup both endpoints of intersect line
 	double X,Y,Z;
 	ellipsoid->convertLatLongHeightToXYZ(lat_, lon_, 30000, X, Y, Z);
@@ -323,7 +229,7 @@ bool util::queryHeightAboveTerrainInWGS84(double& hat_, osg::Node* rootNode_, do
 	double HOT;
 	if ( !util::queryHeightOfTerrain(HOT, rootNode_, lat_, lon_, traversalMask_) )
 	{
-		OSG_NOTIFY( osg::INFO ) << "util::queryHeightAboveTerrainInWGS84() :: Unable to get HOT, will use 0 for HOT!" << std::endl;
+		OSGVISUAL_LOG_RATE( osg::INFO, 1 ) << "util::queryHeightAboveTerrainInWGS84() :: Unable to get HOT, will use 0 for HOT!" << std::endl;
 	}
 
 	// Calculate HAT
@@ -464,35 +370,19 @@ bool util::setTransparentWindowBackground(osgViewer::Viewer* viewer_)
 
 std::vector<std::string> util::getTerrainFromXMLConfig(std::string configFilename)
 {
-	xmlDoc* tmpDoc;
-	xmlNode* sceneryNode = util::getSceneryXMLConfig(configFilename, tmpDoc);
 	std::vector<std::string> filenames;
+	const util_config::node* scenery = getSceneryConfig(configFilename);
+	if( !scenery )
+		return filenames;
 
-	// Iterate through nodes and search for terrian entry
-	for (xmlNode *cur_node = sceneryNode->children; cur_node; cur_node = cur_node->next)
+	// All attributes containing "filename" of all terrain entries
+	std::vector<const util_config::node*> terrains = scenery->getChildren("terrain");
+	for(unsigned int i=0;i<terrains.size();i++)
 	{
-		std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "terrain")
-		{
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name.find("filename") != std::string::npos )
-				{
-					filenames.push_back(attr_value);
-				}
-				attr = attr->next; 
-			}
-		}
-	}// FOR all nodes END
-
-	// Cleanup
-	if(sceneryNode)
-	{
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
+		const util_config::node::AttributeList& attributes = terrains[i]->getAttributes();
+		for(unsigned int j=0;j<attributes.size();j++)
+			if( attributes[j].first.find("filename") != std::string::npos )
+				filenames.push_back(attributes[j].second);
 	}
 
 	return filenames;
@@ -500,38 +390,82 @@ std::vector<std::string> util::getTerrainFromXMLConfig(std::string configFilenam
 
 std::string util::getAnimationPathFromXMLConfig(std::string configFilename)
 {
-	xmlDoc* tmpDoc;
-	xmlNode* sceneryNode = util::getSceneryXMLConfig(configFilename, tmpDoc);
-	std::string animationpath = "";
+	const util_config::node* scenery = getSceneryConfig(configFilename);
+	const util_config::node* animationpath = scenery ? scenery->getChild("animationpath") : NULL;
+	return animationpath ? animationpath->getString("filename") : "";
+}
 
-	// Iterate through nodes and search for terrian entry
-	for (xmlNode *cur_node = sceneryNode->children; cur_node; cur_node = cur_node->next)
-	{
-		std::string node_name=reinterpret_cast<const char*>(cur_node->name);
+std::string util::getHeightGridFromXMLConfig(std::string configFilename)
+{
+	const util_config::node* scenery = getSceneryConfig(configFilename);
+	const util_config::node* heightgrid = scenery ? scenery->getChild("heightgrid") : NULL;
+	return heightgrid ? heightgrid->getString("filename") : "";
+}
+
+std::string util::getSceneryArchiveFromXMLConfig(std::string configFilename)
+{
+	const util_config::node* scenery = getSceneryConfig(configFilename);
+	const util_config::node* archive = scenery ? scenery->getChild("sceneryarchive") : NULL;
+	return archive ? archive->getString("filename") : "";
+}
+
+std::vector<std::string> util::getModelFilesFromXMLConfig(std::string configFilename)
+{
+	std::vector<std::string> filenames;
+	const util_config::node* scenery = getSceneryConfig(configFilename);
+	if( !scenery )
+		return filenames;
 
-		if(cur_node->type == XML_ELEMENT_NODE && node_name == "animationpath")
+	// scenery/models/model/geometry entries
+	std::vector<const util_config::node*> modelLists = scenery->getChildren("models");
+	for(unsigned int i=0;i<modelLists.size();i++)
+	{
+		std::vector<const util_config::node*> models = modelLists[i]->getChildren("model");
+		for(unsigned int j=0;j<models.size();j++)
 		{
-			xmlAttr  *attr = cur_node->properties;
-			while ( attr ) 
-			{ 
-				std::string attr_name=reinterpret_cast<const char*>(attr->name);
-				std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-				if( attr_name == "filename" )
-				{
-					animationpath = attr_value;
-				}
-				attr = attr->next; 
+			std::vector<const util_config::node*> geometries = models[j]->getChildren("geometry");
+			for(unsigned int k=0;k<geometries.size();k++)
+			{
+				std::string filename = geometries[k]->getString("filename");
+				if( !filename.empty() )
+					filenames.push_back(filename);
 			}
 		}
-	}// FOR all nodes END
+	}
+
+	return filenames;
+}
 
-	// Cleanup
-	if(sceneryNode)
+const util_config::node* util::getSceneryConfig(std::string configFilename)
+{
+	if( !util_config::getInstance()->load(configFilename) )
+		return NULL;
+	return util_config::getInstance()->getSection("scenery");
+}
+
+const util_config::node* util::getModuleConfig(std::string configFilename, std::string moduleName, bool& disabled)
+{
+	disabled = false;
+	if( !util_config::getInstance()->load(configFilename) )
+		return NULL;
+
+	const util_config::node* module = util_config::getInstance()->getSection(moduleName);
+	if( !module || module->getName() != "module" )
+		return NULL;
+
+	// Only an explicitly enabled module is configured.
+	std::string enabled = module->getString("enabled");
+	if( enabled == "no" )
 	{
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
+		disabled = true;
+		OSG_DEBUG << "Found module configuration for " << moduleName << ", but it is DISABLED." << std::endl;
+		return NULL;
 	}
+	if( enabled != "yes" )
+		return NULL;
 
-	return animationpath;
+	OSG_DEBUG << "Found module configuration for " << moduleName << std::endl;
+	return module;
 }
 
 double util::strToDouble(std::string s)
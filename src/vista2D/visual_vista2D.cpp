@@ -59,9 +59,8 @@ void visual_vista2D::startVista2D()
 bool visual_vista2D::processXMLConfiguration()
 {
 	// Init XML
-	xmlDoc* tmpDoc;
 	bool disabled;
-	xmlNode* config = util::getModuleXMLConfig( configFileName, "vista2d", tmpDoc, disabled );
+	const util_config::node* config = util::getModuleConfig( configFileName, "vista2d", disabled );
 
 	if( disabled)
 	{
@@ -72,63 +71,18 @@ bool visual_vista2D::processXMLConfiguration()
 	// extract configuration values
 	if(config)
 	{
-		xmlNode* a_node = config->children;
-
-		for (xmlNode *cur_node = a_node; cur_node; cur_node = cur_node->next)
+		// Check for vista2d node
+		const util_config::node* vista2dNode = config->getChild("vista2d");
+		if(vista2dNode)
 		{
-		std::string node_name=reinterpret_cast<const char*>(cur_node->name);
-			//OSG_ALWAYS << "----visual_vista2D::processXMLConfiguration() - node type="<< cur_node->type <<", name=" << cur_node->name << std::endl;
-
-			// Check for vista2d node
-			if(cur_node->type == XML_ELEMENT_NODE && node_name == "vista2d")
-			{
-				// Check attributes
-				xmlAttr  *attr = cur_node->properties;
-				while ( attr ) 
-				{ 
-					std::string attr_name=reinterpret_cast<const char*>(attr->name);
-					std::string attr_value=reinterpret_cast<const char*>(attr->children->content);
-
-					if( attr_name == "filename" )
-					{
-						vistaProjectfile=attr_value;
-					}
-
-					if( attr_name == "paintBackground" )
-					{
-						paintBackground = (attr_value == "yes") ? true : false;
-					}
-
-					if( attr_name == "position_x" )
-					{
-						std::stringstream sstr(attr_value);
-						sstr >> position_x;
-					}
-
-					if( attr_name == "position_y" )
-					{
-						std::stringstream sstr(attr_value);
-						sstr >> position_y;
-					}
-
-					if( attr_name == "zoom" )
-					{
-						std::stringstream sstr(attr_value);
-						sstr >> zoom;
-					}
-
-					if( attr_name == "playanimation" )
-					{
-						playanimation = (attr_value == "yes") ? true : false;
-					}
-
-					attr = attr->next;
-				}	// WHILE attr END
-			}	// IF node == vista2d END
-		}	// FOR end
+			vistaProjectfile = vista2dNode->getString("filename", vistaProjectfile);
+			paintBackground = vista2dNode->getBool("paintBackground", paintBackground);
+			position_x = vista2dNode->getInt("position_x", position_x);
+			position_y = vista2dNode->getInt("position_y", position_y);
+			zoom = vista2dNode->getDouble("zoom", zoom);
+			playanimation = vista2dNode->getBool("playanimation", playanimation);
+		}	// IF node == vista2d END
 	
-		// clean up
-		xmlFreeDoc(tmpDoc); xmlCleanupParser();
 		return true;
 	}	// IF Config valid END
 	else